@@ -0,0 +1,234 @@
+/**
+ * @file
+ * @brief Macros for implementing a file block source using the `IterFileBlocks` struct, over a pluggable read backend.
+ *
+ * An IterFileBlocks struct is a struct that reads a file in blocks of a fixed size, and yields each block as a
+ * `Slice(char)`, in file order. Reads are issued through an #ItplReadBackend, into a ring of `depth` caller supplied
+ * slots- all slots are kept busy, so with an asynchronous backend (e.g io_uring, POSIX AIO, or a pool of threads
+ * calling `pread`), there are `depth` reads in flight while the consumer works through the block it was handed.
+ *
+ * A backend is a pair of functions-
+ * * `submit` - Start reading (up to) `cap` bytes at offset `slot->off` into `slot->buf`. Reads are submitted in
+ *   increasing order of offset, one block after the other.
+ * * `wait` - Wait for the read of a slot to complete, setting `slot->len` to the number of bytes read (less than
+ *   `cap` only at the end of the file), and `slot->failed` on error. Slots are waited for in the order they were
+ *   submitted.
+ *
+ * #itpl_stdio_backend is a synchronous backend over a `FILE*`, which reads in `submit` directly into the slots. Turn
+ * off the buffering of the file (`setvbuf(f, NULL, _IONBF, 0)`) so the data isn't copied through the stdio buffer
+ * first.
+ *
+ * A yielded block stays valid until the next one is requested, at which point its slot is reused for the next read.
+ * If a read fails, or can't be submitted, the blocks before it are still yielded, and the reads in flight waited for,
+ * before iteration stops. If iteration is stopped early instead, `inflight` reads are left in flight, starting from the
+ * slot at `head`- wait for them before reusing the slots' buffers.
+ */
+
+#ifndef LIB_ITPLUS_BLOCKREAD_H
+#define LIB_ITPLUS_BLOCKREAD_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief A slot for a block read.
+ *
+ * `buf` is filled in by the caller, and must have room for a block. `user` is free for the backend to use, e.g for its
+ * own per read state.
+ */
+typedef struct
+{
+    unsigned char* buf;
+    uint64_t off;
+    size_t len;
+    bool failed;
+    void* user;
+} ItplReadSlot;
+
+/**
+ * @brief A backend to issue block reads through.
+ */
+typedef struct
+{
+    /* Start reading up to `cap` bytes at `slot->off` into `slot->buf`, `false` if the read could not be started */
+    bool (*submit)(void* ctx, ItplReadSlot* slot, size_t cap);
+    /* Wait for the read of `slot` to complete, setting `slot->len` and `slot->failed` */
+    void (*wait)(void* ctx, ItplReadSlot* slot);
+    void* ctx;
+} ItplReadBackend;
+
+static inline bool itpl_stdio_submit(void* ctx, ItplReadSlot* slot, size_t cap)
+{
+    FILE* const f  = ctx;
+    long const pos = ftell(f);
+    /* Reads are submitted in file order, so the file is only out of place for the first one */
+    if (pos >= 0 && (uint64_t)pos != slot->off) {
+        if (slot->off > LONG_MAX || fseek(f, (long)slot->off, SEEK_SET) != 0) {
+            return false;
+        }
+    }
+    slot->len    = fread(slot->buf, 1, cap, f);
+    slot->failed = ferror(f) != 0;
+    return true;
+}
+
+static inline void itpl_stdio_wait(void* ctx, ItplReadSlot* slot)
+{
+    (void)ctx;
+    (void)slot;
+}
+
+/**
+ * @def itpl_stdio_backend(f)
+ * @brief Get a synchronous #ItplReadBackend reading from a `FILE*`.
+ *
+ * The file is positioned at the offset of each read, if it isn't there already. A stream that can't be positioned
+ * (e.g a pipe) is read from wherever it is, so the offset to start reading from must be its current position.
+ */
+#define itpl_stdio_backend(f) ((ItplReadBackend){.submit = itpl_stdio_submit, .wait = itpl_stdio_wait, .ctx = (f)})
+
+/**
+ * @brief A file block iterator, yielding `Slice(char)`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `backend` - The backend to read through.
+ * * `slots`, `depth` - The ring of slots to read into, each with a buffer of `blocksize` bytes.
+ * * `blocksize` - The size of each block.
+ * * `off` - (Optional) The offset to start reading from, `0` by default.
+ *
+ * After iteration, `failed` tells whether a read failed.
+ */
+typedef struct
+{
+    ItplReadBackend backend;
+    ItplReadSlot* slots;
+    size_t depth;
+    size_t blocksize;
+    uint64_t off;
+    /* The next slot to yield, and the number of slots with a read in flight */
+    size_t head;
+    size_t inflight;
+    bool started;
+    bool eof;
+    bool failed;
+    ITPL_STATS_MEMBER
+} IterFileBlocks;
+
+/* Submit a read for the next block into given slot */
+static inline void itpl_blockread_submit(IterFileBlocks* self, size_t i)
+{
+    if (self->eof || self->failed) {
+        return;
+    }
+    ItplReadSlot* const slot = self->slots + i;
+    slot->off                = self->off;
+    slot->len                = 0;
+    slot->failed             = false;
+    if (!self->backend.submit(self->backend.ctx, slot, self->blocksize)) {
+        self->failed = true;
+        return;
+    }
+    self->off += self->blocksize;
+    ++(self->inflight);
+}
+
+/**
+ * @brief Get the next block read, keeping all the slots busy.
+ *
+ * @return The slot holding the block, or `NULL` if there are no more blocks, or a read failed. No reads are in flight
+ * once this returns `NULL`.
+ */
+static inline ItplReadSlot* itpl_blockread_next(IterFileBlocks* self)
+{
+    if (!self->started) {
+        self->started = true;
+        for (size_t i = 0; i < self->depth; i++) {
+            itpl_blockread_submit(self, i);
+        }
+    } else if (self->depth > 0) {
+        /* The slot yielded last is free again */
+        itpl_blockread_submit(self, (self->head + self->depth - 1) % self->depth);
+    }
+    /* A read that could not be submitted only stops further submissions- the ones before it are still yielded */
+    if (self->inflight == 0) {
+        return NULL;
+    }
+    ItplReadSlot* const slot = self->slots + self->head;
+    self->backend.wait(self->backend.ctx, slot);
+    --(self->inflight);
+    self->head = (self->head + 1) % self->depth;
+    if (slot->failed) {
+        self->failed = true;
+        /* Wait for the rest of the reads, so none is still writing into a slot once iteration stops */
+        for (; self->inflight > 0; --(self->inflight)) {
+            self->backend.wait(self->backend.ctx, self->slots + self->head);
+            self->head = (self->head + 1) % self->depth;
+        }
+        return NULL;
+    }
+    if (slot->len < self->blocksize) {
+        /* End of the file- the reads already in flight past it will come back empty */
+        self->eof = true;
+    }
+    return slot;
+}
+
+/**
+ * @def define_iterfileblocks_func(Name)
+ * @brief Define a function to turn an #IterFileBlocks into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterFileBlocks struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterFileBlocks*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterFileBlocks`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_fileblocks(IterFileBlocks* x)`
+ * define_iterfileblocks_func(wrap_fileblocks)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char bufs[4][1 << 20];
+ * ItplReadSlot slots[4] = {{.buf = bufs[0]}, {.buf = bufs[1]}, {.buf = bufs[2]}, {.buf = bufs[3]}};
+ * // Read `f` (of type `FILE*`) in blocks of 1 MiB
+ * setvbuf(f, NULL, _IONBF, 0);
+ * IterFileBlocks fb            = {.backend = itpl_stdio_backend(f), .slots = slots, .depth = 4, .blocksize = 1 << 20};
+ * Iterable(Slice(char)) blocks = wrap_fileblocks(&fb);
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfileblocks_func(Name)                                                                               \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterFileBlocks * self)                                           \
+    {                                                                                                                  \
+        ItplReadSlot* slot;                                                                                            \
+        while ((slot = itpl_blockread_next(self)) != NULL) {                                                           \
+            if (slot->len > 0) {                                                                                       \
+                return Just(SliceOf((char const*)slot->buf, slot->len, char), Slice(char));                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Slice(char));                                                                                   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterFileBlocks*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_BLOCKREAD_H */
@@ -52,6 +52,7 @@
     {                                                                                                                  \
         Iterable(T) curr;                                                                                              \
         Iterable(T) nxt;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterChain(T)
 
 /**
@@ -91,6 +92,8 @@
 #define define_iterchain_func(T, Name)                                                                                 \
     static Maybe(T) ITPL_CONCAT(IterChain(T), _nxt)(IterChain(T) * self)                                               \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->curr);                                                                           \
+        ITPL_STATS_SRC(self, 1, self->nxt);                                                                            \
         Iterable(T) const srcit = self->curr;                                                                          \
         Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
         if (is_just(res)) {                                                                                            \
@@ -100,6 +103,6 @@
         Iterable(T) re_srcit = self->curr;                                                                             \
         return re_srcit.tc->next(re_srcit.self);                                                                       \
     }                                                                                                                  \
-    impl_iterator(IterChain(T)*, T, Name, ITPL_CONCAT(IterChain(T), _nxt))
+    impl_instrumented_iterator(IterChain(T)*, T, Name, ITPL_CONCAT(IterChain(T), _nxt))
 
 #endif /* !LIB_ITPLUS_CHAIN_H */
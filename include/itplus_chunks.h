@@ -0,0 +1,208 @@
+/**
+ * @file
+ * @brief Macros for implementing the `chunks` abstraction using the `IterChunks` and `IterArrChunks` structs.
+ *
+ * https://doc.rust-lang.org/std/primitive.slice.html#method.chunks
+ * An IterChunks struct is a struct that groups the elements of its source iterable into non overlapping chunks of
+ * a fixed size, and yields a #Slice(T) view of each chunk. The last chunk may be shorter than the chunk size.
+ *
+ * Elements pulled out of an arbitrary iterable have to be stored somewhere, so `IterChunks` reuses one buffer supplied
+ * by the caller for every chunk. When the elements already live in an array, `IterArrChunks` should be used instead -
+ * it yields views directly into the array, nothing is copied.
+ */
+
+#ifndef LIB_ITPLUS_CHUNKS_H
+#define LIB_ITPLUS_CHUNKS_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stddef.h>
+
+/**
+ * @def IterChunks(T)
+ * @brief Convenience macro to get the type of the IterChunks struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterChunks(int);
+ * IterChunks(int) i; // Declares a variable of type IterChunks(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield. Must be the same type name passed
+ * to #DefineIterChunks(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterChunks(T) ITPL_CONCAT(IterChunks_, T)
+
+/**
+ * @def DefineIterChunks(T)
+ * @brief Define an IterChunks struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterChunks(int); // Defines an IterChunks(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterChunks(T)                                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t size;                                                                                                   \
+        /* Buffer of at least `size` elements, reused for every chunk */                                               \
+        T* buf;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterChunks(T)
+
+/**
+ * @def define_iterchunks_func(T, Name)
+ * @brief Define a function to turn an #IterChunks(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterChunks(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterChunks(T)*` and wraps it in an `Iterable(Slice(T))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterChunks(int);
+ *
+ * // Implement `Iterator` for `IterChunks(int)`
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intchunks(IterChunks(int)* x)`
+ * define_iterchunks_func(int, wrap_intchunks)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Group `it` (of type `Iterable(int)`) into chunks of 64 elements
+ * int buf[64];
+ * Iterable(Slice(int)) blocks = wrap_intchunks(&(IterChunks(int)){ .size = 64, .buf = buf, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterChunks(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note A yielded slice points into `buf` and is only valid until the next element is extracted.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterchunks_func(T, Name)                                                                                \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterChunks(T), _nxt)(IterChunks(T) * self)                                      \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        size_t n                = 0;                                                                                   \
+        while (n < self->size) {                                                                                       \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                break;                                                                                                 \
+            }                                                                                                          \
+            self->buf[n++] = from_just_(res);                                                                          \
+        }                                                                                                              \
+        return n == 0 ? Nothing(Slice(T)) : Just(SliceOf(self->buf, n, T), Slice(T));                                  \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterChunks(T)*, Slice(T), Name, ITPL_CONCAT(IterChunks(T), _nxt))
+
+/**
+ * @def IterArrChunks(T)
+ * @brief Convenience macro to get the type of the IterArrChunks struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrChunks(int);
+ * IterArrChunks(int) i; // Declares a variable of type IterArrChunks(int)
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`. Must be the same type name passed to
+ * #DefineIterArrChunks(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterArrChunks(T) ITPL_CONCAT(IterArrChunks_, T)
+
+/**
+ * @def DefineIterArrChunks(T)
+ * @brief Define an IterArrChunks struct that works on arrays of `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrChunks(int); // Defines an IterArrChunks(int) struct
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define DefineIterArrChunks(T)                                                                                         \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        size_t size;                                                                                                   \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrChunks(T)
+
+/**
+ * @def define_iterarrchunks_func(T, Name)
+ * @brief Define a function to turn an #IterArrChunks(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * The defined function takes in a value of type `IterArrChunks(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice points directly into the source array.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrChunks(int);
+ *
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intarrchunks(IterArrChunks(int)* x)`
+ * define_iterarrchunks_func(int, wrap_intarrchunks)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Split `arr` (an array of `arrlen` ints) into chunks of 64 elements
+ * Iterable(Slice(int)) blocks = wrap_intarrchunks(&(IterArrChunks(int)){ .size = 64, .len = arrlen, .arr = arr });
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterArrChunks(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterarrchunks_func(T, Name)                                                                             \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterArrChunks(T), _nxt)(IterArrChunks(T) * self)                                \
+    {                                                                                                                  \
+        if (self->size == 0 || self->i >= self->len) {                                                                 \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        size_t const n   = self->len - self->i < self->size ? self->len - self->i : self->size;                        \
+        T const* const p = self->arr + self->i;                                                                        \
+        self->i += n;                                                                                                  \
+        return Just(SliceOf(p, n, T), Slice(T));                                                                       \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterArrChunks(T)*, Slice(T), Name, ITPL_CONCAT(IterArrChunks(T), _nxt))
+
+#endif /* !LIB_ITPLUS_CHUNKS_H */
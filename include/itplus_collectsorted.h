@@ -0,0 +1,174 @@
+/**
+ * @file
+ * @brief Macros for implementing the `collect_sorted` abstraction.
+ *
+ * `collect_sorted` turns an iterable into an array, like `collect`, and sorts it by an unsigned integer key extracted
+ * from each element. The sort is an LSD radix sort on 8 bit digits- it never compares elements, the key of each
+ * element is extracted exactly once, and it is stable. Digits that are the same for every key (e.g the upper half of
+ * keys that fit in 32 bits) are skipped entirely.
+ *
+ * Keys of other types can be mapped to order preserving unsigned keys- e.g flip the sign bit of signed integers.
+ */
+
+#ifndef LIB_ITPLUS_COLLECTSORTED_H
+#define LIB_ITPLUS_COLLECTSORTED_H
+
+#include "itplus_collect.h"
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Count the occurrences of every value of every digit of given keys, in one pass.
+ */
+static inline void itpl_radix_count(uint64_t const* keys, size_t n, size_t counts[8][256])
+{
+    memset(counts, 0, 8 * sizeof(*counts));
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const k = keys[i];
+        for (unsigned d = 0; d < 8; d++) {
+            ++(counts[d][(k >> (d * 8)) & 0xFF]);
+        }
+    }
+}
+
+/**
+ * @brief Turn the counts of a digit's values into the offsets their elements start at.
+ *
+ * @return `false` if every one of the `n` keys has the same value for this digit, in which case the pass can be
+ * skipped, and the counts are left as is.
+ */
+static inline bool itpl_radix_offsets(size_t counts[256], size_t n)
+{
+    size_t sum = 0;
+    for (unsigned v = 0; v < 256; v++) {
+        if (counts[v] == n) {
+            return false;
+        }
+    }
+    for (unsigned v = 0; v < 256; v++) {
+        size_t const c = counts[v];
+        counts[v]      = sum;
+        sum += c;
+    }
+    return true;
+}
+
+/**
+ * @def define_itercollectsorted_func(T, Name)
+ * @brief Define the `collect_sorted` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, and a key function of type `uint64_t (*key)(T x)`, and turns
+ * the iterable into an array sorted by the key, in ascending order. Elements with equal keys stay in the order they
+ * were yielded in.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { uint32_t id; double score; } Row;
+ *
+ * // The defined function has the signature:-
+ * // `Row* collect_sorted_row(Iterable(Row) x, size_t* len, uint64_t (*key)(Row x))`
+ * define_itercollectsorted_func(Row, collect_sorted_row)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t row_id(Row x) { return x.id; }
+ * @endcode
+ *
+ * @code
+ * size_t arrlen = 0;
+ * // Collect `it` (of type `Iterable(Row)`) into an array sorted by id
+ * Row* rows = collect_sorted_row(it, &arrlen, row_id);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note The returned array must be freed.
+ * @note Apart from the returned array, the sort needs memory for another array of the same length, and 2 arrays of
+ * keys, all of which are freed before returning.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_itercollectsorted_func(T, Name)                                                                         \
+    T* Name(Iterable(T) it, size_t* len, uint64_t (*key)(T x))                                                         \
+    {                                                                                                                  \
+        size_t size    = ITPLUS_COLLECT_BUFSZ;                                                                         \
+        *len           = 0;                                                                                            \
+        T* arr         = malloc(size * sizeof(*arr));                                                                  \
+        uint64_t* keys = malloc(size * sizeof(*keys));                                                                 \
+        if (arr == NULL || keys == NULL) {                                                                             \
+            free(arr);                                                                                                 \
+            free(keys);                                                                                                \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (*len == size) {                                                                                        \
+                size *= 2;                                                                                             \
+                T* const temp = realloc(arr, size * sizeof(*arr));                                                     \
+                if (temp == NULL) {                                                                                    \
+                    free(arr);                                                                                         \
+                    free(keys);                                                                                        \
+                    return NULL;                                                                                       \
+                }                                                                                                      \
+                arr                      = temp;                                                                       \
+                uint64_t* const tempkeys = realloc(keys, size * sizeof(*keys));                                        \
+                if (tempkeys == NULL) {                                                                                \
+                    free(arr);                                                                                         \
+                    free(keys);                                                                                        \
+                    return NULL;                                                                                       \
+                }                                                                                                      \
+                keys = tempkeys;                                                                                       \
+            }                                                                                                          \
+            arr[*len]      = x;                                                                                        \
+            keys[(*len)++] = key(x);                                                                                   \
+        }                                                                                                              \
+        if (*len > 1) {                                                                                                \
+            size_t counts[8][256];                                                                                     \
+            size_t const n    = *len;                                                                                  \
+            T* altarr         = malloc(n * sizeof(*altarr));                                                           \
+            uint64_t* altkeys = malloc(n * sizeof(*altkeys));                                                          \
+            if (altarr == NULL || altkeys == NULL) {                                                                   \
+                free(altarr);                                                                                          \
+                free(altkeys);                                                                                         \
+                free(arr);                                                                                             \
+                free(keys);                                                                                            \
+                return NULL;                                                                                           \
+            }                                                                                                          \
+            itpl_radix_count(keys, n, counts);                                                                         \
+            for (unsigned d = 0; d < 8; d++) {                                                                         \
+                if (!itpl_radix_offsets(counts[d], n)) {                                                               \
+                    continue;                                                                                          \
+                }                                                                                                      \
+                for (size_t i = 0; i < n; i++) {                                                                       \
+                    size_t const pos = counts[d][(keys[i] >> (d * 8)) & 0xFF]++;                                       \
+                    altarr[pos]      = arr[i];                                                                         \
+                    altkeys[pos]     = keys[i];                                                                        \
+                }                                                                                                      \
+                T* const temp            = arr;                                                                        \
+                uint64_t* const tempkeys = keys;                                                                       \
+                arr                      = altarr;                                                                     \
+                keys                     = altkeys;                                                                    \
+                altarr                   = temp;                                                                       \
+                altkeys                  = tempkeys;                                                                   \
+            }                                                                                                          \
+            free(altarr);                                                                                              \
+            free(altkeys);                                                                                             \
+        }                                                                                                              \
+        free(keys);                                                                                                    \
+        return arr;                                                                                                    \
+    }
+
+#endif /* !LIB_ITPLUS_COLLECTSORTED_H */
@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief Macros for implementing a CSV (or TSV) record source using the `IterCsv` struct.
+ *
+ * An IterCsv struct is a struct that parses a buffer of CSV data (RFC 4180), and yields one #ItplCsvRecord per record.
+ * A record is an array of field views pointing into the buffer- nothing is copied, and nothing is allocated. The array
+ * is supplied by the caller, and reused for every record, so a record is only valid until the next one is requested.
+ *
+ * * Fields are separated by a delimiter (`,` by default, e.g `\t` for TSV), and records by `\n`, `\r\n` or `\r`.
+ * * A field starting with `"` is quoted- it may contain delimiters, newlines, and `""` for a literal `"`. The view of a
+ *   quoted field excludes the surrounding quotes, but still contains the doubled quotes. #itpl_csv_unquote copies such
+ *   a field, with the quotes undoubled.
+ * * Empty lines are skipped.
+ * * Malformed input (characters after a closing quote, or an unterminated quote) is parsed leniently, and flagged.
+ *
+ * Unquoted fields, usually the bulk of the input, are scanned 8 bytes at a time for the delimiter and line endings, and
+ * quoted fields using `memchr` for the quote.
+ */
+
+#ifndef LIB_ITPLUS_CSV_H
+#define LIB_ITPLUS_CSV_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief A view of a field of a CSV record.
+ */
+typedef struct
+{
+    char const* ptr;
+    size_t len;
+    /* Whether the field was quoted, in which case it may contain doubled quotes */
+    bool quoted;
+} ItplCsvField;
+
+/**
+ * @brief A record of a CSV buffer.
+ *
+ * `fields` holds the first `len` fields. `nfields` is the actual number of fields in the record, which is larger than
+ * `len` if the field array was too small to hold all of them.
+ */
+typedef struct
+{
+    ItplCsvField const* fields;
+    size_t len;
+    size_t nfields;
+} ItplCsvRecord;
+
+/**
+ * @brief A CSV record iterator, yielding `ItplCsvRecord`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to parse.
+ * * `fields`, `cap` - The array to store the fields of each record in.
+ * * `delim` - (Optional) The field delimiter. Defaults to `,`.
+ *
+ * After iteration, `malformed` tells whether any malformed input was encountered.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    ItplCsvField* fields;
+    size_t cap;
+    char delim;
+    size_t pos;
+    bool malformed;
+    ITPL_STATS_MEMBER
+} IterCsv;
+
+/* Check whether any byte of `x` is equal to the byte repeated in `pattern` */
+static inline bool itpl_csv_hasbyte(uint64_t x, uint64_t pattern)
+{
+    uint64_t const v = x ^ pattern;
+    return ((v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL) != 0;
+}
+
+/**
+ * @brief Find the first delimiter, `\n` or `\r` in a buffer, or the end of the buffer.
+ */
+static inline size_t itpl_csv_scan(char const* s, size_t len, char delim)
+{
+    uint64_t const ones = 0x0101010101010101ULL;
+    uint64_t const d    = ones * (unsigned char)delim;
+    uint64_t const lf   = ones * '\n';
+    uint64_t const cr   = ones * '\r';
+    size_t i            = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (itpl_csv_hasbyte(word, d) || itpl_csv_hasbyte(word, lf) || itpl_csv_hasbyte(word, cr)) {
+            break;
+        }
+    }
+    while (i < len && s[i] != delim && s[i] != '\n' && s[i] != '\r') {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Parse the field starting at `self->pos`, advancing `self->pos` to the byte that ends it.
+ */
+static inline ItplCsvField itpl_csv_field(IterCsv* self, char delim)
+{
+    char const* const buf = self->buf;
+    size_t const len      = self->len;
+    size_t i              = self->pos;
+    if (i == len || buf[i] != '"') {
+        size_t const n = itpl_csv_scan(buf + i, len - i, delim);
+        self->pos      = i + n;
+        return (ItplCsvField){.ptr = buf + i, .len = n, .quoted = false};
+    }
+    size_t const start = ++i;
+    while (1) {
+        char const* const q = memchr(buf + i, '"', len - i);
+        if (q == NULL) {
+            /* Unterminated quote, the field extends to the end */
+            self->malformed = true;
+            self->pos       = len;
+            return (ItplCsvField){.ptr = buf + start, .len = len - start, .quoted = true};
+        }
+        i = (size_t)(q - buf) + 1;
+        if (i < len && buf[i] == '"') {
+            /* Doubled quote */
+            i++;
+            continue;
+        }
+        ItplCsvField const field = {.ptr = buf + start, .len = i - 1 - start, .quoted = true};
+        if (i < len && buf[i] != delim && buf[i] != '\n' && buf[i] != '\r') {
+            /* Skip whatever follows the closing quote */
+            self->malformed = true;
+            i += itpl_csv_scan(buf + i, len - i, delim);
+        }
+        self->pos = i;
+        return field;
+    }
+}
+
+/**
+ * @brief Parse the next record into `self->fields`.
+ *
+ * @return `false` if there are no more records.
+ */
+static inline bool itpl_csv_record(IterCsv* self, ItplCsvRecord* rec)
+{
+    char const delim = self->delim == '\0' ? ',' : self->delim;
+    /* Skip empty lines */
+    while (self->pos < self->len && (self->buf[self->pos] == '\n' || self->buf[self->pos] == '\r')) {
+        ++(self->pos);
+    }
+    if (self->pos == self->len) {
+        return false;
+    }
+    rec->fields  = self->fields;
+    rec->len     = 0;
+    rec->nfields = 0;
+    while (1) {
+        ItplCsvField const field = itpl_csv_field(self, delim);
+        if (rec->nfields++ < self->cap) {
+            self->fields[rec->len++] = field;
+        }
+        if (self->pos == self->len) {
+            return true;
+        }
+        char const c = self->buf[(self->pos)++];
+        if (c == '\r' && self->pos < self->len && self->buf[self->pos] == '\n') {
+            ++(self->pos);
+        }
+        if (c != delim) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Copy a field, undoubling the quotes of quoted fields.
+ *
+ * @param field The field to copy.
+ * @param out Where to copy it to, must have room for `field.len` bytes.
+ *
+ * @return The length of the copy.
+ */
+static inline size_t itpl_csv_unquote(ItplCsvField field, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < field.len; i++) {
+        out[n++] = field.ptr[i];
+        if (field.quoted && field.ptr[i] == '"' && i + 1 < field.len && field.ptr[i + 1] == '"') {
+            i++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @def define_itercsv_func(Name)
+ * @brief Define a function to turn an #IterCsv into an `Iterable(ItplCsvRecord)`.
+ *
+ * Define the `next` function implementation for the #IterCsv struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterCsv*` and wraps it in an `Iterable(ItplCsvRecord)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineMaybe(ItplCsvRecord)
+ * DefineIteratorOf(ItplCsvRecord);
+ *
+ * // Implement `Iterator` for `IterCsv`
+ * // The defined function has the signature- `Iterable(ItplCsvRecord) wrap_csv(IterCsv* x)`
+ * define_itercsv_func(wrap_csv)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * ItplCsvField fields[16];
+ * // Parse the CSV data in `data` (of type `char const*`), of length `datalen`
+ * Iterable(ItplCsvRecord) records = wrap_csv(&(IterCsv){ .buf = data, .len = datalen, .fields = fields, .cap = 16 });
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = ItplCsvRecord` **must** exist.
+ * @note The fields of a record are overwritten by the next record, copy them out of the record if they're needed after.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itercsv_func(Name)                                                                                      \
+    static Maybe(ItplCsvRecord) ITPL_CONCAT(Name, _nxt)(IterCsv * self)                                                \
+    {                                                                                                                  \
+        ItplCsvRecord rec;                                                                                             \
+        if (!itpl_csv_record(self, &rec)) {                                                                            \
+            return Nothing(ItplCsvRecord);                                                                             \
+        }                                                                                                              \
+        return Just(rec, ItplCsvRecord);                                                                               \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterCsv*, ItplCsvRecord, Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_CSV_H */
@@ -0,0 +1,308 @@
+/**
+ * @file
+ * @brief Macros for implementing the `distinct` and `dedup` abstractions using the `IterDistinct` and `IterDedup`
+ * structs.
+ *
+ * https://docs.rs/itertools/0.10.1/itertools/trait.Itertools.html#method.unique
+ * https://docs.rs/itertools/0.10.1/itertools/trait.Itertools.html#method.dedup
+ * An IterDistinct struct is a struct that yields only the first occurrence of every element of its source iterable.
+ * The elements seen so far are remembered in an open addressing hash set (see itplus_hash.h), using hash and equality
+ * functions supplied by the caller.
+ *
+ * An IterDedup struct is a struct that only removes *consecutive* duplicates. It needs no memory at all, and on a
+ * sorted (or otherwise clustered) source it yields the same elements as `IterDistinct`.
+ */
+
+#ifndef LIB_ITPLUS_DISTINCT_H
+#define LIB_ITPLUS_DISTINCT_H
+
+#include "itplus_hash.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @def IterDistinct(T)
+ * @brief Convenience macro to get the type of the IterDistinct struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int);
+ * IterDistinct(int) i; // Declares a variable of type IterDistinct(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield. Must be the same type name
+ * passed to #DefineIterDistinct(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDistinct(T) ITPL_CONCAT(IterDistinct_, T)
+
+/**
+ * @def DefineIterDistinct(T)
+ * @brief Define an IterDistinct struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `hash` - The hash function. Only the first occurrence of elements with equal hashes *and* equal values is yielded.
+ * * `eq` - The equality function.
+ * * `ctrl`, `slots`, `cap` - (Optional) Initial storage for the set. `cap` must be a power of 2, `ctrl` must point to
+ *   `cap` zeroed bytes, and `slots` to `cap` elements. If the set outgrows this storage (or none is given), it is moved
+ *   to (and grown on) the heap.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int); // Defines an IterDistinct(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDistinct(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        uint64_t (*hash)(T x);                                                                                         \
+        bool (*eq)(T a, T b);                                                                                          \
+        uint8_t* ctrl;                                                                                                 \
+        T* slots;                                                                                                      \
+        size_t cap;                                                                                                    \
+        size_t len;                                                                                                    \
+        /* Whether `ctrl` and `slots` were allocated by the iterator */                                                \
+        bool owned;                                                                                                    \
+        /* Set if the set could not be grown, iteration stops early */                                                 \
+        bool failed;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDistinct(T)
+
+/**
+ * @def iterdistinct_free(x)
+ * @brief Free the heap storage of an #IterDistinct(T) (given as a pointer), if it owns any.
+ *
+ * Caller supplied storage is left alone.
+ */
+#define iterdistinct_free(x)                                                                                           \
+    do {                                                                                                               \
+        if ((x)->owned) {                                                                                              \
+            free((x)->ctrl);                                                                                           \
+            free((x)->slots);                                                                                          \
+            (x)->owned = false;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def define_iterdistinct_func(T, Name)
+ * @brief Define a function to turn an #IterDistinct(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDistinct(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDistinct(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int);
+ *
+ * // Implement `Iterator` for `IterDistinct(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intdistinct(IterDistinct(int)* x)`
+ * define_iterdistinct_func(int, wrap_intdistinct)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * static bool int_eq(int a, int b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Yield each distinct element of `it` (of type `Iterable(int)`) once, starting off with a set of 1024 slots
+ * uint8_t ctrl[1024] = { 0 };
+ * int slots[1024];
+ * IterDistinct(int) d = { .hash = int_hash, .eq = int_eq, .ctrl = ctrl, .slots = slots, .cap = 1024, .src = it };
+ * Iterable(int) uniq  = wrap_intdistinct(&d);
+ * // Use `uniq`, and then free the set
+ * iterdistinct_free(&d);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDistinct(T) for the given `T` **must** exist.
+ * @note If the set needs to grow and the allocation fails, iteration stops and the `failed` member is set.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdistinct_func(T, Name)                                                                              \
+    static bool ITPL_CONCAT(IterDistinct(T), _grow)(IterDistinct(T) * self)                                            \
+    {                                                                                                                  \
+        size_t const cap    = itpl_hash_growcap(self->cap, 0);                                                         \
+        uint8_t* const ctrl = calloc(cap, sizeof(*ctrl));                                                              \
+        T* const slots      = malloc(cap * sizeof(*slots));                                                            \
+        if (ctrl == NULL || slots == NULL) {                                                                           \
+            free(ctrl);                                                                                                \
+            free(slots);                                                                                               \
+            return false;                                                                                              \
+        }                                                                                                              \
+        for (size_t i = 0; i < self->cap; i++) {                                                                       \
+            if (self->ctrl[i] != ITPL_HASH_EMPTY) {                                                                    \
+                slots[itpl_hash_claim(ctrl, cap, self->hash(self->slots[i]))] = self->slots[i];                        \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (self->owned) {                                                                                             \
+            free(self->ctrl);                                                                                          \
+            free(self->slots);                                                                                         \
+        }                                                                                                              \
+        self->ctrl  = ctrl;                                                                                            \
+        self->slots = slots;                                                                                           \
+        self->cap   = cap;                                                                                             \
+        self->owned = true;                                                                                            \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterDistinct(T), _nxt)(IterDistinct(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (self->failed || (self->cap == 0 && !ITPL_CONCAT(IterDistinct(T), _grow)(self))) {                          \
+            self->failed = true;                                                                                       \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        while (1) {                                                                                                    \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            T const x        = from_just_(res);                                                                        \
+            uint64_t const h = self->hash(x);                                                                          \
+            size_t pos;                                                                                                \
+            ITPL_HASH_FIND(self->ctrl, self->cap, self->slots, self->eq, x, h, pos);                                   \
+            if (self->ctrl[pos] != ITPL_HASH_EMPTY) {                                                                  \
+                continue;                                                                                              \
+            }                                                                                                          \
+            if (itpl_hash_fits(self->len + 1, self->cap)) {                                                            \
+                self->ctrl[pos] = itpl_hash_tag(h);                                                                    \
+            } else if (ITPL_CONCAT(IterDistinct(T), _grow)(self)) {                                                    \
+                pos = itpl_hash_claim(self->ctrl, self->cap, h);                                                       \
+            } else {                                                                                                   \
+                self->failed = true;                                                                                   \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            self->slots[pos] = x;                                                                                      \
+            ++(self->len);                                                                                             \
+            return Just(x, T);                                                                                         \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDistinct(T)*, T, Name, ITPL_CONCAT(IterDistinct(T), _nxt))
+
+/**
+ * @def IterDedup(T)
+ * @brief Convenience macro to get the type of the IterDedup struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int);
+ * IterDedup(int) i; // Declares a variable of type IterDedup(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield. Must be the same type name passed
+ * to #DefineIterDedup(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDedup(T) ITPL_CONCAT(IterDedup_, T)
+
+/**
+ * @def DefineIterDedup(T)
+ * @brief Define an IterDedup struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int); // Defines an IterDedup(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDedup(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        bool (*eq)(T a, T b);                                                                                          \
+        bool started;                                                                                                  \
+        T last;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDedup(T)
+
+/**
+ * @def define_iterdedup_func(T, Name)
+ * @brief Define a function to turn an #IterDedup(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDedup(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDedup(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int);
+ *
+ * // Implement `Iterator` for `IterDedup(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intdedup(IterDedup(int)* x)`
+ * define_iterdedup_func(int, wrap_intdedup)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static bool int_eq(int a, int b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Collapse runs of equal elements in `it` (of type `Iterable(int)`)
+ * Iterable(int) runs = wrap_intdedup(&(IterDedup(int)){ .eq = int_eq, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDedup(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdedup_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterDedup(T), _nxt)(IterDedup(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        while (1) {                                                                                                    \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            if (!self->started || !self->eq(self->last, from_just_(res))) {                                            \
+                self->started = true;                                                                                  \
+                self->last    = from_just_(res);                                                                       \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDedup(T)*, T, Name, ITPL_CONCAT(IterDedup(T), _nxt))
+
+#endif /* !LIB_ITPLUS_DISTINCT_H */
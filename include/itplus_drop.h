@@ -58,6 +58,7 @@
         size_t i;                                                                                                      \
         size_t limit;                                                                                                  \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterDrop(T)
 
 /**
@@ -97,6 +98,7 @@
 #define define_iterdrop_func(T, Name)                                                                                  \
     static Maybe(T) ITPL_CONCAT(IterDrop(T), _nxt)(IterDrop(T) * self)                                                 \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(T) const srcit = self->src;                                                                           \
         foreach (T, x, srcit) {                                                                                        \
             if (self->i >= self->limit) {                                                                              \
@@ -106,6 +108,6 @@
         }                                                                                                              \
         return Nothing(T);                                                                                             \
     }                                                                                                                  \
-    impl_iterator(IterDrop(T)*, T, Name, ITPL_CONCAT(IterDrop(T), _nxt))
+    impl_instrumented_iterator(IterDrop(T)*, T, Name, ITPL_CONCAT(IterDrop(T), _nxt))
 
 #endif /* !LIB_ITPLUS_DROP_H */
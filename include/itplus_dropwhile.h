@@ -55,6 +55,7 @@
         bool (*pred)(T x);                                                                                             \
         bool done;                                                                                                     \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterDropWhile(T)
 
 /**
@@ -98,6 +99,7 @@
 #define define_iterdropwhile_func(T, Name)                                                                             \
     static Maybe(T) ITPL_CONCAT(IterDropWhile(T), _nxt)(IterDropWhile(T) * self)                                       \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         if (self->done) {                                                                                              \
             return Nothing(T);                                                                                         \
         }                                                                                                              \
@@ -110,6 +112,6 @@
         }                                                                                                              \
         return Nothing(T);                                                                                             \
     }                                                                                                                  \
-    impl_iterator(IterDropWhile(T)*, T, Name, ITPL_CONCAT(IterDropWhile(T), _nxt))
+    impl_instrumented_iterator(IterDropWhile(T)*, T, Name, ITPL_CONCAT(IterDropWhile(T), _nxt))
 
 #endif /* !LIB_ITPLUS_DROPWHILE_H */
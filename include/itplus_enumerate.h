@@ -57,6 +57,7 @@
     {                                                                                                                  \
         size_t i;                                                                                                      \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterEnumr(T)
 
 /**
@@ -97,11 +98,12 @@
 #define define_iterenumr_func(T, Name)                                                                                 \
     static Maybe(Pair(size_t, T)) ITPL_CONCAT(IterEnumr(T), _nxt)(IterEnumr(T) * self)                                 \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(T) const srcit = self->src;                                                                           \
         Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
         return is_just(res) ? Just(PairOf(self->i++, from_just_(res), size_t, T), Pair(size_t, T))                     \
                             : Nothing(Pair(size_t, T));                                                                \
     }                                                                                                                  \
-    impl_iterator(IterEnumr(T)*, Pair(size_t, T), Name, ITPL_CONCAT(IterEnumr(T), _nxt))
+    impl_instrumented_iterator(IterEnumr(T)*, Pair(size_t, T), Name, ITPL_CONCAT(IterEnumr(T), _nxt))
 
 #endif /* !LIB_ITPLUS_ENUMR_H */
@@ -0,0 +1,439 @@
+/**
+ * @file
+ * @brief Macros for implementing external memory sorting using the `IterExternalSort` struct.
+ *
+ * An IterExternalSort struct is a struct that yields the elements of its source iterable in sorted order, using no
+ * more than a fixed amount of memory for the elements themselves- so the source can be far larger than memory.
+ *
+ * The source is consumed in runs that fill a buffer supplied by the caller. Each run is sorted in memory, and spilled
+ * into a temporary file as raw elements. The sorted runs are then merged lazily, as elements are extracted- the buffer
+ * is split into one block per run, refilled from its file whenever it runs out, and a heap picks the smallest head
+ * element among the runs. If there are too many runs to give each a block, runs are first merged into bigger ones.
+ * If the whole source fits in the buffer, nothing is spilled.
+ *
+ * The type independent parts of the implementation are the `itpl_extsort_*` functions, working on an `ItplExtSort`.
+ */
+
+#ifndef LIB_ITPLUS_EXTSORT_H
+#define LIB_ITPLUS_EXTSORT_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ITPLUS_EXTSORT_FANIN
+#define ITPLUS_EXTSORT_FANIN 64
+#endif /* !ITPLUS_EXTSORT_FANIN */
+
+/* A sorted run spilled to a temporary file, along with its block of the merge buffer */
+typedef struct
+{
+    FILE* f;
+    /* Id used in the file's name, `0` for anonymous files created with `tmpfile` */
+    unsigned long id;
+    unsigned char* blk;
+    size_t pos;
+    size_t len;
+} ItplExtRun;
+
+/* State of an external sort, independent of the element type */
+typedef struct
+{
+    size_t elsz;
+    int (*cmp)(void const* a, void const* b);
+    unsigned char* buf;
+    size_t cap;
+    char const* tmpdir;
+    ItplExtRun* runs;
+    size_t nruns;
+    size_t runcap;
+    /* Min heap of the indices of runs that still have elements, ordered by their head element */
+    size_t* heap;
+    size_t hlen;
+    /* Number of elements in the block of each run */
+    size_t blklen;
+    unsigned long nextid;
+    /* Position and length of the sorted elements, when everything fit in memory */
+    size_t mempos;
+    size_t memlen;
+    bool started;
+    bool inmem;
+    bool failed;
+} ItplExtSort;
+
+static inline void itpl_extsort_path(ItplExtSort const* s, unsigned long id, char* path, size_t n)
+{
+    snprintf(path, n, "%s/itplus-%p-%lu.run", s->tmpdir, (void const*)s, id);
+}
+
+/* Create a temporary file, in `tmpdir` if one was given */
+static inline FILE* itpl_extsort_open(ItplExtSort* s, unsigned long* id)
+{
+    char path[FILENAME_MAX];
+    if (s->tmpdir == NULL) {
+        *id = 0;
+        return tmpfile();
+    }
+    while (1) {
+        *id = ++(s->nextid);
+        itpl_extsort_path(s, *id, path, sizeof(path));
+        FILE* const existing = fopen(path, "rb");
+        if (existing == NULL) {
+            break;
+        }
+        fclose(existing);
+    }
+    return fopen(path, "w+b");
+}
+
+static inline void itpl_extsort_close(ItplExtSort const* s, ItplExtRun const* run)
+{
+    char path[FILENAME_MAX];
+    fclose(run->f);
+    if (run->id != 0) {
+        itpl_extsort_path(s, run->id, path, sizeof(path));
+        remove(path);
+    }
+}
+
+static inline bool itpl_extsort_addrun(ItplExtSort* s, FILE* f, unsigned long id)
+{
+    if (s->nruns == s->runcap) {
+        size_t const runcap    = s->runcap == 0 ? 8 : s->runcap * 2;
+        ItplExtRun* const temp = realloc(s->runs, runcap * sizeof(*temp));
+        if (temp == NULL) {
+            return false;
+        }
+        s->runs   = temp;
+        s->runcap = runcap;
+    }
+    s->runs[s->nruns++] = (ItplExtRun){.f = f, .id = id};
+    return true;
+}
+
+/* Spill the first `n` (sorted) elements of the buffer into a new run */
+static inline bool itpl_extsort_spill(ItplExtSort* s, size_t n)
+{
+    unsigned long id = 0;
+    FILE* const f    = itpl_extsort_open(s, &id);
+    if (f == NULL) {
+        return false;
+    }
+    if (fwrite(s->buf, s->elsz, n, f) != n || fflush(f) != 0 || !itpl_extsort_addrun(s, f, id)) {
+        itpl_extsort_close(s, &(ItplExtRun){.f = f, .id = id});
+        return false;
+    }
+    return true;
+}
+
+static inline bool itpl_extsort_less(ItplExtSort const* s, size_t a, size_t b)
+{
+    ItplExtRun const* const ra = s->runs + a;
+    ItplExtRun const* const rb = s->runs + b;
+    return s->cmp(ra->blk + ra->pos * s->elsz, rb->blk + rb->pos * s->elsz) < 0;
+}
+
+static inline void itpl_extsort_siftdown(ItplExtSort* s, size_t i)
+{
+    size_t* const heap = s->heap;
+    while (1) {
+        size_t const l = 2 * i + 1;
+        if (l >= s->hlen) {
+            break;
+        }
+        size_t const c = l + 1 < s->hlen && itpl_extsort_less(s, heap[l + 1], heap[l]) ? l + 1 : l;
+        if (!itpl_extsort_less(s, heap[c], heap[i])) {
+            break;
+        }
+        size_t const temp = heap[i];
+        heap[i]           = heap[c];
+        heap[c]           = temp;
+        i                 = c;
+    }
+}
+
+/* Refill the block of a run from its file, returns `false` if the run is exhausted */
+static inline bool itpl_extsort_fill(ItplExtSort* s, ItplExtRun* run)
+{
+    run->pos = 0;
+    run->len = fread(run->blk, s->elsz, s->blklen, run->f);
+    if (ferror(run->f)) {
+        s->failed = true;
+    }
+    return run->len > 0;
+}
+
+/* Start merging the first `k` runs */
+static inline void itpl_extsort_merge_open(ItplExtSort* s, size_t k)
+{
+    s->blklen = s->cap / k;
+    s->hlen   = 0;
+    for (size_t i = 0; i < k; i++) {
+        ItplExtRun* const run = s->runs + i;
+        run->blk              = s->buf + i * s->blklen * s->elsz;
+        rewind(run->f);
+        if (itpl_extsort_fill(s, run)) {
+            s->heap[s->hlen++] = i;
+        }
+    }
+    for (size_t i = s->hlen / 2; i-- > 0;) {
+        itpl_extsort_siftdown(s, i);
+    }
+}
+
+/* Get the smallest element among the runs being merged, `NULL` if they're all exhausted */
+static inline void const* itpl_extsort_merge_peek(ItplExtSort const* s)
+{
+    if (s->hlen == 0) {
+        return NULL;
+    }
+    ItplExtRun const* const run = s->runs + s->heap[0];
+    return run->blk + run->pos * s->elsz;
+}
+
+/* Move past the smallest element among the runs being merged */
+static inline void itpl_extsort_merge_pop(ItplExtSort* s)
+{
+    ItplExtRun* const run = s->runs + s->heap[0];
+    if (++(run->pos) == run->len && !itpl_extsort_fill(s, run)) {
+        s->heap[0] = s->heap[--(s->hlen)];
+    }
+    itpl_extsort_siftdown(s, 0);
+}
+
+/* Merge runs together until there are few enough to merge at once, and start merging them */
+static inline bool itpl_extsort_prepare(ItplExtSort* s)
+{
+    size_t const fanin = s->cap < ITPLUS_EXTSORT_FANIN ? s->cap : ITPLUS_EXTSORT_FANIN;
+    if (fanin < 2 || (s->heap = malloc(fanin * sizeof(*(s->heap)))) == NULL) {
+        return false;
+    }
+    while (s->nruns > fanin) {
+        unsigned long id = 0;
+        FILE* const f    = itpl_extsort_open(s, &id);
+        if (f == NULL) {
+            return false;
+        }
+        itpl_extsort_merge_open(s, fanin);
+        for (void const* x = itpl_extsort_merge_peek(s); x != NULL; x = itpl_extsort_merge_peek(s)) {
+            if (fwrite(x, s->elsz, 1, f) != 1) {
+                s->failed = true;
+                break;
+            }
+            itpl_extsort_merge_pop(s);
+        }
+        if (s->failed || fflush(f) != 0) {
+            itpl_extsort_close(s, &(ItplExtRun){.f = f, .id = id});
+            return false;
+        }
+        for (size_t i = 0; i < fanin; i++) {
+            itpl_extsort_close(s, s->runs + i);
+        }
+        s->nruns -= fanin;
+        memmove(s->runs, s->runs + fanin, s->nruns * sizeof(*(s->runs)));
+        /* Can't fail, there's room for at least `fanin` runs */
+        itpl_extsort_addrun(s, f, id);
+    }
+    itpl_extsort_merge_open(s, s->nruns);
+    return !s->failed;
+}
+
+/* Close (and remove) all temporary files, and free the bookkeeping memory */
+static inline void itpl_extsort_free(ItplExtSort* s)
+{
+    for (size_t i = 0; i < s->nruns; i++) {
+        itpl_extsort_close(s, s->runs + i);
+    }
+    free(s->runs);
+    free(s->heap);
+    s->runs   = NULL;
+    s->heap   = NULL;
+    s->nruns  = 0;
+    s->runcap = 0;
+    s->hlen   = 0;
+}
+
+/**
+ * @def IterExternalSort(T)
+ * @brief Convenience macro to get the type of the IterExternalSort struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int);
+ * IterExternalSort(int) i; // Declares a variable of type IterExternalSort(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield. Must be the same type name
+ * passed to #DefineIterExternalSort(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterExternalSort(T) ITPL_CONCAT(IterExternalSort_, T)
+
+/**
+ * @def DefineIterExternalSort(T)
+ * @brief Define an IterExternalSort struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `cmp` - The comparison function, same as the one `qsort` takes.
+ * * `buf` - The buffer to sort runs in, and to merge them from. This is the memory limit of the sort.
+ * * `cap` - The number of elements `buf` can hold. Must be at least 2, the fewest runs that can be merged at once.
+ * * `tmpdir` - (Optional) The directory to create temporary files in. If `NULL`, `tmpfile` is used.
+ * * `src` - The source iterable.
+ *
+ * The `state` member must be zero initialized.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int); // Defines an IterExternalSort(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterExternalSort(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        int (*cmp)(void const* a, void const* b);                                                                      \
+        T* buf;                                                                                                        \
+        size_t cap;                                                                                                    \
+        char const* tmpdir;                                                                                            \
+        ItplExtSort state;                                                                                             \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterExternalSort(T)
+
+/**
+ * @def iterextsort_free(x)
+ * @brief Remove the temporary files of an #IterExternalSort(T) (given as a pointer), and free its bookkeeping memory.
+ *
+ * This happens automatically once the sorted elements are exhausted, it only needs to be called if the iteration is
+ * abandoned before that.
+ */
+#define iterextsort_free(x) itpl_extsort_free(&(x)->state)
+
+/**
+ * @def define_iterextsort_func(T, Name)
+ * @brief Define a function to turn an #IterExternalSort(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterExternalSort(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterExternalSort(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int);
+ *
+ * // Implement `Iterator` for `IterExternalSort(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intextsort(IterExternalSort(int)* x)`
+ * define_iterextsort_func(int, wrap_intextsort)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static int cmp_int(void const* a, void const* b)
+ * {
+ *     int const x = *(int const*)a, y = *(int const*)b;
+ *     return (x > y) - (x < y);
+ * }
+ * @endcode
+ *
+ * @code
+ * // Sort `it` (of type `Iterable(int)`) using at most 1 GiB of memory for the elements
+ * size_t const cap = (1UL << 30) / sizeof(int);
+ * int* const buf   = malloc(cap * sizeof(*buf));
+ * Iterable(int) sorted = wrap_intextsort(
+ *     &(IterExternalSort(int)){ .cmp = cmp_int, .buf = buf, .cap = cap, .tmpdir = "/scratch", .src = it });
+ * // Use `sorted`, and then free the buffer
+ * free(buf);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterExternalSort(T) for the given `T` **must** exist.
+ * @note The whole source is consumed when the first element is extracted.
+ * @note If `cap` is less than 2, or a temporary file can't be created or written, or memory can't be allocated,
+ * iteration stops and the `failed` member of `state` is set.
+ * @note Elements are spilled as raw bytes, so types that own memory through pointers are spilled as the pointers.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterextsort_func(T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(IterExternalSort(T), _nxt)(IterExternalSort(T) * self)                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        ItplExtSort* const s = &self->state;                                                                           \
+        if (s->failed) {                                                                                               \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!s->started && self->cap < 2) {                                                                            \
+            s->failed = true;                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!s->started) {                                                                                             \
+            Iterable(T) const srcit = self->src;                                                                       \
+            bool done               = false;                                                                           \
+            s->started              = true;                                                                            \
+            s->elsz                 = sizeof(T);                                                                       \
+            s->cmp                  = self->cmp;                                                                       \
+            s->buf                  = (unsigned char*)self->buf;                                                       \
+            s->cap                  = self->cap;                                                                       \
+            s->tmpdir               = self->tmpdir;                                                                    \
+            /* Consume the source in sorted runs */                                                                    \
+            while (!done) {                                                                                            \
+                size_t n = 0;                                                                                          \
+                while (n < self->cap) {                                                                                \
+                    Maybe(T) const res = srcit.tc->next(srcit.self);                                                   \
+                    if (is_nothing(res)) {                                                                             \
+                        done = true;                                                                                   \
+                        break;                                                                                         \
+                    }                                                                                                  \
+                    self->buf[n++] = from_just_(res);                                                                  \
+                }                                                                                                      \
+                qsort(self->buf, n, sizeof(T), self->cmp);                                                             \
+                if (done && s->nruns == 0) {                                                                           \
+                    s->inmem  = true;                                                                                  \
+                    s->memlen = n;                                                                                     \
+                } else if (n > 0 && !itpl_extsort_spill(s, n)) {                                                       \
+                    s->failed = true;                                                                                  \
+                    itpl_extsort_free(s);                                                                              \
+                    return Nothing(T);                                                                                 \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (!s->inmem && !itpl_extsort_prepare(s)) {                                                               \
+                s->failed = true;                                                                                      \
+                itpl_extsort_free(s);                                                                                  \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (s->inmem) {                                                                                                \
+            return s->mempos < s->memlen ? Just(self->buf[s->mempos++], T) : Nothing(T);                               \
+        }                                                                                                              \
+        void const* const x = itpl_extsort_merge_peek(s);                                                              \
+        if (x == NULL || s->failed) {                                                                                  \
+            itpl_extsort_free(s);                                                                                      \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T res;                                                                                                         \
+        memcpy(&res, x, sizeof(res));                                                                                  \
+        itpl_extsort_merge_pop(s);                                                                                     \
+        return Just(res, T);                                                                                           \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterExternalSort(T)*, T, Name, ITPL_CONCAT(IterExternalSort(T), _nxt))
+
+#endif /* !LIB_ITPLUS_EXTSORT_H */
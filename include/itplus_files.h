@@ -0,0 +1,368 @@
+/**
+ * @file
+ * @brief Macros for implementing sources over many files, using the `IterGlob` and `IterFileContents` structs.
+ *
+ * An IterGlob struct is a struct that filters an iterator of paths, yielding only those that match a glob pattern- see
+ * #itpl_glob_match. Listing a directory is outside of standard C, so the paths come from an iterable filled in by the
+ * caller, e.g with the output of a directory listing, or the command line arguments.
+ *
+ * An IterFileContents struct is a struct that reads each file of an iterator of paths in turn, and yields all of their
+ * contents, one after the other, as `Slice(char)` blocks- so a directory of files can be processed as one stream,
+ * rather than by chaining an iterator per file by hand. The paths are looked ahead of the file being read, into a ring
+ * of `depth` caller supplied slots. An optional `prefetch` hook is called with each path as it enters the ring, i.e
+ * `depth - 1` files before it is opened- it can be used to warm up the page cache for the file (e.g with
+ * `posix_fadvise(POSIX_FADV_WILLNEED)`, `readahead`, or by handing it to a background thread), so there is no cold
+ * stall at each file boundary.
+ *
+ * To fold many files in parallel, the paths can be split between workers with an #IterShard(T), before reading them.
+ */
+
+#ifndef LIB_ITPLUS_FILES_H
+#define LIB_ITPLUS_FILES_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Match `c` against the bracket expression at `*pat` (at its `[`), and move `*pat` past it */
+static inline bool itpl_glob_class(char const** pat, char c)
+{
+    char const* p  = *pat + 1;
+    bool const neg = *p == '!' || *p == '^';
+    if (neg) {
+        p++;
+    }
+    char const* const first = p;
+    bool found              = false;
+    /* A `]` right after the `[` (or its negation) is part of the set */
+    while (*p != '\0' && (*p != ']' || p == first)) {
+        unsigned char const lo = (unsigned char)*p;
+        unsigned char hi       = lo;
+        if (p[1] == '-' && p[2] != ']' && p[2] != '\0') {
+            hi  = (unsigned char)p[2];
+            p  += 2;
+        }
+        if ((unsigned char)c >= lo && (unsigned char)c <= hi) {
+            found = true;
+        }
+        p++;
+    }
+    if (*p == '\0') {
+        /* No closing `]`- the `[` is an ordinary character */
+        *pat += 1;
+        return c == '[';
+    }
+    *pat = p + 1;
+    return found != neg;
+}
+
+/**
+ * @brief Check whether a string matches a glob pattern.
+ *
+ * `*` matches any run of characters (including `/`), `?` matches any one character, and `[...]` matches any one of the
+ * characters, or ranges of characters (`a-z`), in it- or any one that isn't, when it starts with `!` or `^`. Every
+ * other character matches itself.
+ *
+ * @param pat The pattern.
+ * @param s The string to match.
+ *
+ * @return Whether `s` matches `pat`.
+ */
+static inline bool itpl_glob_match(char const* pat, char const* s)
+{
+    /* Where to resume from, if the rest fails to match after the last `*` */
+    char const* star = NULL;
+    char const* back = NULL;
+    while (*s != '\0') {
+        if (*pat == '*') {
+            star = ++pat;
+            back = s;
+            continue;
+        }
+        char const* p = pat;
+        bool matched;
+        if (*p == '[') {
+            matched = itpl_glob_class(&p, *s);
+        } else {
+            matched = *p != '\0' && (*p == '?' || *p == *s);
+            p++;
+        }
+        if (matched) {
+            pat = p;
+            s++;
+        } else if (star != NULL) {
+            /* Let the last `*` swallow one more character */
+            pat = star;
+            s   = ++back;
+        } else {
+            return false;
+        }
+    }
+    while (*pat == '*') {
+        pat++;
+    }
+    return *pat == '\0';
+}
+
+/**
+ * @brief Get the file name part of a path, i.e the part after its last separator.
+ */
+static inline char const* itpl_path_base(char const* path)
+{
+    char const* base = path;
+    for (char const* p = path; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+/**
+ * @def IterGlob(T)
+ * @brief Convenience macro to get the type of the IterGlob struct with given path type.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string);
+ * IterGlob(string) i; // Declares a variable of type IterGlob(string)
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield, a typedef of `char const*` (or
+ * `char*`). Must be the same type name passed to #DefineIterGlob(T).
+ */
+#define IterGlob(T) ITPL_CONCAT(IterGlob_, T)
+
+/**
+ * @def DefineIterGlob(T)
+ * @brief Define an IterGlob struct that works on `Iterable(T)`s of paths.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string); // Defines an IterGlob(string) struct
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGlob(T)                                                                                              \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        char const* pattern;                                                                                           \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGlob(T)
+
+/**
+ * @def define_iterglob_func(T, Name)
+ * @brief Define a function to turn an #IterGlob(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterGlob(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterGlob(T)*` and wraps it in an `Iterable(T)`, yielding the paths
+ * that match `pattern`. A pattern without a `/` is matched against the file name part of each path only (e.g `*.log`),
+ * and one with a `/` against the whole path (e.g `logs/2024-*.log`).
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string);
+ *
+ * // Implement `Iterator` for `IterGlob(string)`
+ * // The defined function has the signature- `Iterable(string) wrap_glob(IterGlob(string)* x)`
+ * define_iterglob_func(string, wrap_glob)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Only the log files, out of `paths` (of type `Iterable(string)`)
+ * Iterable(string) logs = wrap_glob(&(IterGlob(string)){.pattern = "*.log", .src = paths});
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterGlob(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterglob_func(T, Name)                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterGlob(T), _nxt)(IterGlob(T) * self)                                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        bool const whole        = strchr(self->pattern, '/') != NULL;                                                  \
+        Iterable(T) const srcit = self->src;                                                                           \
+        for (Maybe(T) res = srcit.tc->next(srcit.self); is_just(res); res = srcit.tc->next(srcit.self)) {              \
+            char const* const path = from_just_(res);                                                                  \
+            if (itpl_glob_match(self->pattern, whole ? path : itpl_path_base(path))) {                                 \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGlob(T)*, T, Name, ITPL_CONCAT(IterGlob(T), _nxt))
+
+/**
+ * @def IterFileContents(T)
+ * @brief Convenience macro to get the type of the IterFileContents struct with given path type.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string);
+ * IterFileContents(string) i; // Declares a variable of type IterFileContents(string)
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield, a typedef of
+ * `char const*` (or `char*`). Must be the same type name passed to #DefineIterFileContents(T).
+ */
+#define IterFileContents(T) ITPL_CONCAT(IterFileContents_, T)
+
+/**
+ * @def DefineIterFileContents(T)
+ * @brief Define an IterFileContents struct that works on `Iterable(T)`s of paths.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `cap` - The buffer to read the blocks into, and its size.
+ * * `ahead`, `depth` - The ring of paths looked ahead, with room for at least 1 path.
+ * * `prefetch`, `ctx` - (Optional) The hook called with each path as it enters the ring, and its first argument.
+ * * `src` - The paths of the files to read.
+ *
+ * While iterating, `path` is the path of the file the last block came from. After iteration, `failed` tells whether a
+ * file could not be opened, or read. If iteration is stopped early, the file being read, `f`, is left open.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string); // Defines an IterFileContents(string) struct
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterFileContents(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char* buf;                                                                                            \
+        size_t cap;                                                                                                    \
+        T* ahead;                                                                                                      \
+        size_t depth;                                                                                                  \
+        void (*prefetch)(void* ctx, char const* path);                                                                 \
+        void* ctx;                                                                                                     \
+        FILE* f;                                                                                                       \
+        T path;                                                                                                        \
+        /* The first path in the ring, and the number of paths in it */                                                \
+        size_t head;                                                                                                   \
+        size_t count;                                                                                                  \
+        bool done;                                                                                                     \
+        bool failed;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterFileContents(T)
+
+/**
+ * @def define_iterfilecontents_func(T, Name)
+ * @brief Define a function to turn an #IterFileContents(T) into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterFileContents(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterFileContents(T)*` and wraps it in an `Iterable(Slice(char))`. A
+ * yielded block stays valid until the next one is requested. The paths must stay valid until their file has been read.
+ * Empty files yield no blocks.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string);
+ *
+ * // Implement `Iterator` for `IterFileContents(string)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_contents(IterFileContents(string)* x)`
+ * define_iterfilecontents_func(string, wrap_contents)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char buf[1 << 16];
+ * string ahead[4];
+ * // Read all the files in `logs` (of type `Iterable(string)`), asking for each to be prefetched 3 files ahead
+ * IterFileContents(string) fc = {
+ *     .buf = buf, .cap = sizeof(buf), .ahead = ahead, .depth = 4, .prefetch = willneed, .src = logs};
+ * foreach (Slice(char), blk, wrap_contents(&fc)) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterFileContents(T) for the given `T` **must** exist.
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfilecontents_func(T, Name)                                                                          \
+    static Maybe(Slice(char)) ITPL_CONCAT(IterFileContents(T), _nxt)(IterFileContents(T) * self)                       \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        while (!self->failed) {                                                                                        \
+            if (self->f != NULL) {                                                                                     \
+                size_t const n = fread(self->buf, 1, self->cap, self->f);                                              \
+                if (n > 0) {                                                                                           \
+                    return Just(SliceOf((char const*)self->buf, n, char), Slice(char));                                \
+                }                                                                                                      \
+                self->failed = ferror(self->f) != 0;                                                                   \
+                fclose(self->f);                                                                                       \
+                self->f = NULL;                                                                                        \
+                continue;                                                                                              \
+            }                                                                                                          \
+            /* Top up the ring of paths looked ahead */                                                                \
+            Iterable(T) const srcit = self->src;                                                                       \
+            while (!self->done && self->count < self->depth) {                                                         \
+                Maybe(T) const res = srcit.tc->next(srcit.self);                                                       \
+                if (is_nothing(res)) {                                                                                 \
+                    self->done = true;                                                                                 \
+                    break;                                                                                             \
+                }                                                                                                      \
+                self->ahead[(self->head + self->count) % self->depth]  = from_just_(res);                              \
+                self->count                                           += 1;                                            \
+                if (self->prefetch != NULL) {                                                                          \
+                    self->prefetch(self->ctx, from_just_(res));                                                        \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->count == 0) {                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            self->path   = self->ahead[self->head];                                                                    \
+            self->head   = (self->head + 1) % self->depth;                                                             \
+            self->count -= 1;                                                                                          \
+            self->f      = fopen(self->path, "rb");                                                                    \
+            if (self->f == NULL) {                                                                                     \
+                self->failed = true;                                                                                   \
+            } else {                                                                                                   \
+                /* The blocks are read straight into `buf`, rather than through the stdio buffer */                    \
+                setvbuf(self->f, NULL, _IONBF, 0);                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Slice(char));                                                                                   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterFileContents(T)*, Slice(char), Name, ITPL_CONCAT(IterFileContents(T), _nxt))
+
+#endif /* !LIB_ITPLUS_FILES_H */
@@ -54,6 +54,7 @@
     {                                                                                                                  \
         bool (*pred)(T x);                                                                                             \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterFilt(T)
 
 /**
@@ -97,6 +98,7 @@
 #define define_iterfilt_func(T, Name)                                                                                  \
     static Maybe(T) ITPL_CONCAT(IterFilt(T), _nxt)(IterFilt(T) * self)                                                 \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(T) const srcit = self->src;                                                                           \
         foreach (T, el, srcit) {                                                                                       \
             if (self->pred(el)) {                                                                                      \
@@ -105,6 +107,6 @@
         }                                                                                                              \
         return Nothing(T);                                                                                             \
     }                                                                                                                  \
-    impl_iterator(IterFilt(T)*, T, Name, ITPL_CONCAT(IterFilt(T), _nxt))
+    impl_instrumented_iterator(IterFilt(T)*, T, Name, ITPL_CONCAT(IterFilt(T), _nxt))
 
 #endif /* !LIB_ITPLUS_FILT_H */
@@ -63,6 +63,7 @@
     {                                                                                                                  \
         Maybe(FnRetType) (*f)(ElmntType x);                                                                            \
         Iterable(ElmntType) src;                                                                                       \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterFiltMap(ElmntType, FnRetType)
 
 /**
@@ -111,6 +112,7 @@
     static Maybe(FnRetType)                                                                                            \
         ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt)(IterFiltMap(ElmntType, FnRetType) * self)                 \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(ElmntType) const srcit = self->src;                                                                   \
         foreach (ElmntType, el, srcit) {                                                                               \
             Maybe(FnRetType) const mapped = self->f(el);                                                               \
@@ -120,7 +122,7 @@
         }                                                                                                              \
         return Nothing(FnRetType);                                                                                     \
     }                                                                                                                  \
-    impl_iterator(                                                                                                     \
+    impl_instrumented_iterator(                                                                                        \
         IterFiltMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt))
 
 #endif /* !LIB_ITPLUS_FILTMAP_H */
@@ -0,0 +1,225 @@
+/**
+ * @file
+ * @brief Macros for implementing index driven access to columns using the `IterGather` struct, and the `scatter_into`
+ * abstraction.
+ *
+ * An IterGather struct is a struct that turns an iterator of row indices (e.g the rows a filter kept) into the values
+ * of a column at those rows- a contiguous array of values. It replaces a `map` whose callback looks up the column
+ * through a function pointer, once per row, for each column.
+ *
+ * IterGather extracts indices from its source in batches of #ITPLUS_GATHER_BATCH. The rows of the whole batch are
+ * prefetched while the indices are extracted, and then loaded in one tight loop- so the cache misses of a batch
+ * overlap instead of adding up, and the loop is left for the compiler to vectorize into gather instructions where the
+ * target has them.
+ *
+ * `scatter_into` is the reverse- it writes the elements of an iterable into a column, at the rows given by an iterator
+ * of indices, in the same batches.
+ */
+
+#ifndef LIB_ITPLUS_GATHER_H
+#define LIB_ITPLUS_GATHER_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ITPLUS_GATHER_BATCH
+#define ITPLUS_GATHER_BATCH 32
+#endif /* !ITPLUS_GATHER_BATCH */
+
+/**
+ * @def IterGather(T)
+ * @brief Convenience macro to get the type of the IterGather struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(int);
+ * IterGather(int) i; // Declares a variable of type IterGather(int)
+ * @endcode
+ *
+ * @param T The type of the values in the column. Must be the same type name passed to #DefineIterGather(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterGather(T) ITPL_CONCAT(IterGather_, T)
+
+/**
+ * @def DefineIterGather(T)
+ * @brief Define an IterGather struct that gathers values of type `T` at the indices yielded by an
+ * `Iterable(uint32_t)`.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `col`, `len` - The column, and its length.
+ * * `src` - The source iterable of indices.
+ *
+ * After iteration, `failed` tells whether an index was out of the column's range- the iteration stops at that index.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(int); // Defines an IterGather(int) struct
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for `T = uint32_t` **must** also exist.
+ */
+#define DefineIterGather(T)                                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T const* col;                                                                                                  \
+        size_t len;                                                                                                    \
+        /* The values of the current batch, and the position of the next one to yield */                               \
+        T batch[ITPLUS_GATHER_BATCH];                                                                                  \
+        size_t pos;                                                                                                    \
+        size_t n;                                                                                                      \
+        bool exhausted;                                                                                                \
+        bool failed;                                                                                                   \
+        Iterable(uint32_t) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGather(T)
+
+/**
+ * @def ITPL_GATHER_IDXS(src, idxs, n, col, len, exhausted, failed)
+ * @brief Extract the next batch of indices from `src` into `idxs` (and their count into `n`), prefetching the rows of
+ * `col` they point to. Sets `exhausted` once the source is exhausted, and `failed` as well if an index was out of the
+ * range of the column.
+ */
+#define ITPL_GATHER_IDXS(src, idxs, n, col, len, exhausted, failed)                                                    \
+    do {                                                                                                               \
+        (n) = 0;                                                                                                       \
+        while ((n) < ITPLUS_GATHER_BATCH) {                                                                            \
+            Maybe(uint32_t) const itpl_res = (src).tc->next((src).self);                                               \
+            if (is_nothing(itpl_res)) {                                                                                \
+                (exhausted) = true;                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            uint32_t const itpl_idx = from_just_(itpl_res);                                                            \
+            if (itpl_idx >= (len)) {                                                                                   \
+                (exhausted) = true;                                                                                    \
+                (failed)    = true;                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            ITPL_PREFETCH((col) + itpl_idx);                                                                           \
+            (idxs)[(n)++] = itpl_idx;                                                                                  \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def define_itergather_func(T, Name)
+ * @brief Define a function to turn an #IterGather(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterGather(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterGather(T)*` and wraps it in an `Iterable(T)`, yielding the values
+ * of the column at the indices yielded by its source, in the same order.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(double);
+ *
+ * // Implement `Iterator` for `IterGather(double)`
+ * // The defined function has the signature- `Iterable(double) wrap_dblgather(IterGather(double)* x)`
+ * define_itergather_func(double, wrap_dblgather)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // The prices (of type `double const*`, with `nrows` rows) at the rows in `rows` (of type `Iterable(uint32_t)`)
+ * Iterable(double) sel = wrap_dblgather(&(IterGather(double)){.col = prices, .len = nrows, .src = rows});
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to #ITPLUS_GATHER_BATCH indices are extracted from the source ahead of the value being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGather(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergather_func(T, Name)                                                                                \
+    static Maybe(T) ITPL_CONCAT(IterGather(T), _nxt)(IterGather(T) * self)                                             \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        if (self->pos == self->n) {                                                                                    \
+            if (self->exhausted) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            uint32_t idxs[ITPLUS_GATHER_BATCH];                                                                        \
+            size_t n;                                                                                                  \
+            ITPL_GATHER_IDXS(self->src, idxs, n, self->col, self->len, self->exhausted, self->failed);                 \
+            T const* const col = self->col;                                                                            \
+            for (size_t k = 0; k < n; k++) {                                                                           \
+                self->batch[k] = col[idxs[k]];                                                                         \
+            }                                                                                                          \
+            self->pos = 0;                                                                                             \
+            self->n   = n;                                                                                             \
+            if (n == 0) {                                                                                              \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Just(self->batch[self->pos++], T);                                                                      \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGather(T)*, T, Name, ITPL_CONCAT(IterGather(T), _nxt))
+
+/**
+ * @def define_scatterinto_func(T, Name)
+ * @brief Define the `scatter_into` function for an iterable.
+ *
+ * The defined function takes in an iterable of row indices, an iterable of type `T`, a column, and its length. It
+ * writes each element of the iterable into the column, at the row given by the matching index- until either
+ * iterable is exhausted. It returns `false` if an index was out of the column's range, in which case the elements
+ * from that index onwards are not written.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool scatter_dbl(Iterable(uint32_t) idxs, Iterable(double) it, double* col, size_t len)`
+ * define_scatterinto_func(double, scatter_dbl)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Write the new prices `it` (of type `Iterable(double)`) at the rows in `rows` (of type `Iterable(uint32_t)`)
+ * bool const ok = scatter_dbl(rows, it, prices, nrows);
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T`, and for `T = uint32_t`, **must** exist.
+ */
+#define define_scatterinto_func(T, Name)                                                                               \
+    bool Name(Iterable(uint32_t) idxs, Iterable(T) it, T* col, size_t len)                                             \
+    {                                                                                                                  \
+        bool exhausted = false;                                                                                        \
+        bool failed    = false;                                                                                        \
+        while (!exhausted) {                                                                                           \
+            uint32_t batch[ITPLUS_GATHER_BATCH];                                                                       \
+            size_t n;                                                                                                  \
+            ITPL_GATHER_IDXS(idxs, batch, n, col, len, exhausted, failed);                                             \
+            for (size_t k = 0; k < n; k++) {                                                                           \
+                Maybe(T) const res = it.tc->next(it.self);                                                             \
+                if (is_nothing(res)) {                                                                                 \
+                    return true;                                                                                       \
+                }                                                                                                      \
+                col[batch[k]] = from_just_(res);                                                                       \
+            }                                                                                                          \
+        }                                                                                                              \
+        return !failed;                                                                                                \
+    }
+
+#endif /* !LIB_ITPLUS_GATHER_H */
@@ -0,0 +1,230 @@
+/**
+ * @file
+ * @brief Macros for writing sources as generators- straight line loops that yield elements, instead of hand written
+ * state machines.
+ *
+ * A generator is a `next` function whose body is written between #ITPL_GEN_BEGIN and #ITPL_GEN_END, and yields
+ * elements using #ITPL_YIELD. Every call resumes right after the yield it last returned from, the same way a
+ * coroutine would- using a `switch` on the line number of that yield (the technique known as Duff's device), stored in
+ * the generator's struct. A generator finishes once its body runs to the end, and yields nothing from then on.
+ *
+ * The generator does not have its own stack, so local variables do not survive across yields- anything that needs to,
+ * like loop counters, must live in the struct. For the same reason, `switch` statements can't contain a yield, and a
+ * yield can't be used twice on the same line.
+ *
+ * # Example
+ *
+ * @code
+ * // A generator of the pairs `(i, j)` with `0 <= j < i < n`, as `i * 100 + j`
+ * typedef struct
+ * {
+ *     uint32_t n, i, j;
+ *     ITPL_GEN_MEMBER
+ * } Pairs;
+ *
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_pairs(Pairs* x)`
+ * ITPL_GENERATOR(Pairs, uint32_t, wrap_pairs)
+ * {
+ *     ITPL_GEN_BEGIN(self);
+ *     for (self->i = 0; self->i < self->n; self->i++) {
+ *         for (self->j = 0; self->j < self->i; self->j++) {
+ *             ITPL_YIELD(self, uint32_t, self->i * 100 + self->j);
+ *         }
+ *     }
+ *     ITPL_GEN_END(self, uint32_t);
+ * }
+ * @endcode
+ *
+ * Generators can also fill a buffer with many elements per call, and only suspend once it's full- see
+ * #ITPL_FILL_BEGIN. #define_iterfill_func defines the same kind of function for any iterable.
+ */
+
+#ifndef LIB_ITPLUS_GEN_H
+#define LIB_ITPLUS_GEN_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stddef.h>
+
+/**
+ * @def ITPL_GEN_MEMBER
+ * @brief The members of a generator's struct used to resume it. Must be the last member of the struct.
+ *
+ * @note This should not be delimited by a semicolon.
+ */
+#define ITPL_GEN_MEMBER                                                                                                \
+    int itpl_line;                                                                                                     \
+    ITPL_STATS_MEMBER
+
+/**
+ * @def ITPL_GENERATOR(GenType, T, Name)
+ * @brief Start the definition of a generator, and use it to implement the Iterator typeclass.
+ *
+ * Declares the `next` function for `GenType`, implements Iterator for it, and begins its definition- to be followed
+ * by its body. The struct is available in the body as `self`.
+ *
+ * The defined function takes in a value of type `GenType*` and wraps it in an `Iterable(T)`. The struct must be zero
+ * initialized (apart from the members the generator takes as parameters) before its first call.
+ *
+ * @param GenType The type of the generator's struct, which must end with #ITPL_GEN_MEMBER.
+ * @param T The type of value the generator yields.
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for the given `T` **must** exist.
+ */
+#define ITPL_GENERATOR(GenType, T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(Name, _nxt)(GenType * self);                                                           \
+    impl_instrumented_iterator(GenType*, T, Name, ITPL_CONCAT(Name, _nxt))                                             \
+    static Maybe(T) ITPL_CONCAT(Name, _nxt)(GenType * self)
+
+/**
+ * @def ITPL_GEN_BEGIN(self)
+ * @brief Begin the body of a generator.
+ *
+ * @param self Pointer to the generator's struct.
+ */
+#define ITPL_GEN_BEGIN(self)                                                                                           \
+    switch ((self)->itpl_line) {                                                                                       \
+    case 0:
+
+/**
+ * @def ITPL_YIELD(self, T, x)
+ * @brief Yield an element from a generator, resuming right after this on the next call.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param T The type of value the generator yields.
+ * @param x The element to yield.
+ */
+#define ITPL_YIELD(self, T, x)                                                                                         \
+    do {                                                                                                               \
+        (self)->itpl_line = __LINE__;                                                                                  \
+        return Just(x, T);                                                                                             \
+    case __LINE__:;                                                                                                    \
+    } while (0)
+
+/**
+ * @def ITPL_GEN_END(self, T)
+ * @brief End the body of a generator. The generator yields nothing once this is reached.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param T The type of value the generator yields.
+ */
+#define ITPL_GEN_END(self, T)                                                                                          \
+    }                                                                                                                  \
+    (self)->itpl_line = -1;                                                                                            \
+    return Nothing(T)
+
+/**
+ * @def ITPL_FILL_BEGIN(self, cap)
+ * @brief Begin the body of a generator that fills a buffer.
+ *
+ * A filling generator is a function with the signature `size_t Name(GenType* self, T* out, size_t cap)`, that writes
+ * up to `cap` elements into `out` per call, and returns the number of elements written- `0` once it has finished. It
+ * only suspends when the buffer is full, so it costs one call per buffer rather than one per element. A call with a
+ * `cap` of `0` returns `0` right away, without resuming the generator.
+ *
+ * # Example
+ *
+ * @code
+ * size_t fill_pairs(Pairs* self, uint32_t* out, size_t cap)
+ * {
+ *     ITPL_FILL_BEGIN(self, cap);
+ *     for (self->i = 0; self->i < self->n; self->i++) {
+ *         for (self->j = 0; self->j < self->i; self->j++) {
+ *             ITPL_YIELD_INTO(self, out, cap, self->i * 100 + self->j);
+ *         }
+ *     }
+ *     ITPL_FILL_END(self);
+ * }
+ * @endcode
+ *
+ * @param self Pointer to the generator's struct, which must end with #ITPL_GEN_MEMBER.
+ * @param cap The capacity of the buffer.
+ */
+#define ITPL_FILL_BEGIN(self, cap)                                                                                     \
+    size_t itpl_filled = 0;                                                                                            \
+    if ((cap) == 0) {                                                                                                  \
+        return 0;                                                                                                      \
+    }                                                                                                                  \
+    switch ((self)->itpl_line) {                                                                                       \
+    case 0:
+
+/**
+ * @def ITPL_YIELD_INTO(self, out, cap, x)
+ * @brief Write an element into the buffer of a filling generator, suspending once the buffer is full.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param out The buffer.
+ * @param cap The capacity of the buffer.
+ * @param x The element to write.
+ */
+#define ITPL_YIELD_INTO(self, out, cap, x)                                                                             \
+    do {                                                                                                               \
+        (out)[itpl_filled++] = (x);                                                                                    \
+        if (itpl_filled == (cap)) {                                                                                    \
+            (self)->itpl_line = __LINE__;                                                                              \
+            return itpl_filled;                                                                                        \
+        case __LINE__:;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def ITPL_FILL_END(self)
+ * @brief End the body of a filling generator, returning the elements written to the buffer so far.
+ *
+ * @param self Pointer to the generator's struct.
+ */
+#define ITPL_FILL_END(self)                                                                                            \
+    }                                                                                                                  \
+    (self)->itpl_line = -1;                                                                                            \
+    return itpl_filled
+
+/**
+ * @def define_iterfill_func(T, Name)
+ * @brief Define the `fill` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, and its capacity. It writes the next elements of
+ * the iterable into the buffer until it's full, or the iterable is exhausted, and returns the number of elements
+ * written. It can be called repeatedly, to process an iterable one buffer at a time.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature- `size_t fill_int(Iterable(int) it, int* out, size_t cap)`
+ * define_iterfill_func(int, fill_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * int buf[256];
+ * size_t n;
+ * // Process `it` (of type `Iterable(int)`) 256 elements at a time
+ * while ((n = fill_int(it, buf, 256)) > 0) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_iterfill_func(T, Name)                                                                                  \
+    size_t Name(Iterable(T) it, T* out, size_t cap)                                                                    \
+    {                                                                                                                  \
+        size_t n = 0;                                                                                                  \
+        while (n < cap) {                                                                                              \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                break;                                                                                                 \
+            }                                                                                                          \
+            out[n++] = from_just_(res);                                                                                \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
+
+#endif /* !LIB_ITPLUS_GEN_H */
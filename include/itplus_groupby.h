@@ -0,0 +1,387 @@
+/**
+ * @file
+ * @brief Macros for implementing the `group_by` abstraction using the `IterGroupBy`, `IterGroupFold`, and
+ * `IterArrGroupBy` structs.
+ *
+ * https://hackage.haskell.org/package/base-4.15.0.0/docs/Data-List.html#v:groupBy
+ * These structs group *consecutive* elements of their source that have equal keys, so a sorted (or otherwise
+ * clustered) source produces exactly one group per key. The groups themselves are never materialized-
+ * * `IterGroupBy` yields a `Pair` of each group's key and its length (run length encoding).
+ * * `IterGroupFold` yields a `Pair` of each group's key and the result of folding the group's elements.
+ * * `IterArrGroupBy` works on an array, and yields a `Pair` of each group's key and a #Slice(T) view of the group.
+ *
+ * `IterGroupBy` and `IterGroupFold` compute the key of each element exactly once.
+ */
+
+#ifndef LIB_ITPLUS_GROUPBY_H
+#define LIB_ITPLUS_GROUPBY_H
+
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_pair.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @def IterGroupBy(T, K)
+ * @brief Convenience macro to get the type of the IterGroupBy struct with given element type and key type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char);
+ * IterGroupBy(int, char) i; // Declares a variable of type IterGroupBy(int, char)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield. Must be the same type name
+ * passed to #DefineIterGroupBy(T, K).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to #DefineIterGroupBy(T, K).
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterGroupBy(T, K) ITPL_CONCAT(ITPL_CONCAT(IterGroupBy_, T), ITPL_CONCAT(_, K))
+
+/**
+ * @def DefineIterGroupBy(T, K)
+ * @brief Define an IterGroupBy struct that groups the elements of an `Iterable(T)` by keys of type `K`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char); // Defines an IterGroupBy(int, char) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield.
+ * @param K The type of the key elements are grouped by.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGroupBy(T, K)                                                                                        \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        bool started;                                                                                                  \
+        /* First element of the next group, already pulled out of the source */                                        \
+        Maybe(T) pending;                                                                                              \
+        K pendkey;                                                                                                     \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGroupBy(T, K)
+
+/**
+ * @def define_itergroupby_func(T, K, Name)
+ * @brief Define a function to turn an #IterGroupBy(T, K) into an #Iterable(T) where `T = Pair(K, size_t)`.
+ *
+ * Define the `next` function implementation for the #IterGroupBy(T, K) struct, and use it to implement the Iterator
+ * typeclass, for given `T` and `K`.
+ *
+ * The defined function takes in a value of type `IterGroupBy(T, K)*` and wraps it in an `Iterable(Pair(K, size_t))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char);
+ *
+ * // Implement `Iterator` for `IterGroupBy(int, char)`
+ * // The defined function has the signature- `Iterable(Pair(char, size_t)) wrap_intchrgrp(IterGroupBy(int, char)* x)`
+ * define_itergroupby_func(int, char, wrap_intchrgrp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static char bucket(int x) { return x / 100; }
+ * static bool chr_eq(char a, char b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Count the runs of elements within the same bucket of 100 in `it` (of type `Iterable(int)`)
+ * Iterable(Pair(char, size_t)) runs = wrap_intchrgrp(&(IterGroupBy(int, char)){
+ *     .key = bucket, .eq = chr_eq, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGroupBy(T, K) for the given `T` and `K` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, size_t)`, for the given `K` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergroupby_func(T, K, Name)                                                                            \
+    static Maybe(Pair(K, size_t)) ITPL_CONCAT(IterGroupBy(T, K), _nxt)(IterGroupBy(T, K) * self)                       \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->pending = srcit.tc->next(srcit.self);                                                                \
+            if (is_just(self->pending)) {                                                                              \
+                self->pendkey = self->key(from_just_(self->pending));                                                  \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (is_nothing(self->pending)) {                                                                               \
+            return Nothing(Pair(K, size_t));                                                                           \
+        }                                                                                                              \
+        K const grpkey = self->pendkey;                                                                                \
+        size_t count   = 1;                                                                                            \
+        foreach (T, x, srcit) {                                                                                        \
+            K const k = self->key(x);                                                                                  \
+            if (!self->eq(grpkey, k)) {                                                                                \
+                self->pending = Just(x, T);                                                                            \
+                self->pendkey = k;                                                                                     \
+                return Just(PairOf(grpkey, count, K, size_t), Pair(K, size_t));                                        \
+            }                                                                                                          \
+            ++count;                                                                                                   \
+        }                                                                                                              \
+        self->pending = Nothing(T);                                                                                    \
+        return Just(PairOf(grpkey, count, K, size_t), Pair(K, size_t));                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGroupBy(T, K)*, Pair(K, size_t), Name, ITPL_CONCAT(IterGroupBy(T, K), _nxt))
+
+/**
+ * @def IterGroupFold(T, K, Acc)
+ * @brief Convenience macro to get the type of the IterGroupFold struct with given element, key, and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long);
+ * IterGroupFold(int, char, long) i; // Declares a variable of type IterGroupFold(int, char, long)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield. Must be the same type name
+ * passed to #DefineIterGroupFold(T, K, Acc).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to
+ * #DefineIterGroupFold(T, K, Acc).
+ * @param Acc The accumulator type each group is folded into. Must be the same type name passed to
+ * #DefineIterGroupFold(T, K, Acc).
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterGroupFold(T, K, Acc)                                                                                       \
+    ITPL_CONCAT(ITPL_CONCAT(ITPL_CONCAT(IterGroupFold_, T), ITPL_CONCAT(_, K)), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineIterGroupFold(T, K, Acc)
+ * @brief Define an IterGroupFold struct that groups the elements of an `Iterable(T)` by keys of type `K`, and folds
+ * each group into an `Acc`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long); // Defines an IterGroupFold(int, char, long) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Acc The accumulator type each group is folded into.
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGroupFold(T, K, Acc)                                                                                 \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        Acc init;                                                                                                      \
+        Acc (*f)(Acc acc, T x);                                                                                        \
+        bool started;                                                                                                  \
+        /* First element of the next group, already pulled out of the source */                                        \
+        Maybe(T) pending;                                                                                              \
+        K pendkey;                                                                                                     \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGroupFold(T, K, Acc)
+
+/**
+ * @def define_itergroupfold_func(T, K, Acc, Name)
+ * @brief Define a function to turn an #IterGroupFold(T, K, Acc) into an #Iterable(T) where `T = Pair(K, Acc)`.
+ *
+ * Define the `next` function implementation for the #IterGroupFold(T, K, Acc) struct, and use it to implement the
+ * Iterator typeclass, for given `T`, `K`, and `Acc`.
+ *
+ * The defined function takes in a value of type `IterGroupFold(T, K, Acc)*` and wraps it in an
+ * `Iterable(Pair(K, Acc))`. Each group is folded by starting with `init` and repeatedly applying `f`, exactly like
+ * #define_iterfold_func(T, Acc, Name).
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long);
+ *
+ * // Implement `Iterator` for `IterGroupFold(int, char, long)`
+ * // The defined function has the signature-
+ * // `Iterable(Pair(char, long)) wrap_grpsum(IterGroupFold(int, char, long)* x)`
+ * define_itergroupfold_func(int, char, long, wrap_grpsum)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static char bucket(int x) { return x / 100; }
+ * static bool chr_eq(char a, char b) { return a == b; }
+ * static long add(long acc, int x) { return acc + x; }
+ * @endcode
+ *
+ * @code
+ * // Sum up each run of elements within the same bucket of 100 in `it` (of type `Iterable(int)`)
+ * Iterable(Pair(char, long)) sums = wrap_grpsum(&(IterGroupFold(int, char, long)){
+ *     .key = bucket, .eq = chr_eq, .init = 0, .f = add, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Acc The accumulator type each group is folded into.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGroupFold(T, K, Acc) for the given `T`, `K`, and `Acc` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Acc)`, for the given `K` and `Acc` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergroupfold_func(T, K, Acc, Name)                                                                     \
+    static Maybe(Pair(K, Acc)) ITPL_CONCAT(IterGroupFold(T, K, Acc), _nxt)(IterGroupFold(T, K, Acc) * self)            \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->pending = srcit.tc->next(srcit.self);                                                                \
+            if (is_just(self->pending)) {                                                                              \
+                self->pendkey = self->key(from_just_(self->pending));                                                  \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (is_nothing(self->pending)) {                                                                               \
+            return Nothing(Pair(K, Acc));                                                                              \
+        }                                                                                                              \
+        K const grpkey = self->pendkey;                                                                                \
+        Acc acc        = self->f(self->init, from_just_(self->pending));                                               \
+        foreach (T, x, srcit) {                                                                                        \
+            K const k = self->key(x);                                                                                  \
+            if (!self->eq(grpkey, k)) {                                                                                \
+                self->pending = Just(x, T);                                                                            \
+                self->pendkey = k;                                                                                     \
+                return Just(PairOf(grpkey, acc, K, Acc), Pair(K, Acc));                                                \
+            }                                                                                                          \
+            acc = self->f(acc, x);                                                                                     \
+        }                                                                                                              \
+        self->pending = Nothing(T);                                                                                    \
+        return Just(PairOf(grpkey, acc, K, Acc), Pair(K, Acc));                                                        \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterGroupFold(T, K, Acc)*, Pair(K, Acc), Name, ITPL_CONCAT(IterGroupFold(T, K, Acc), _nxt))
+
+/**
+ * @def IterArrGroupBy(T, K)
+ * @brief Convenience macro to get the type of the IterArrGroupBy struct with given element type and key type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char);
+ * IterArrGroupBy(int, char) i; // Declares a variable of type IterArrGroupBy(int, char)
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`. Must be the same type name passed
+ * to #DefineIterArrGroupBy(T, K).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to
+ * #DefineIterArrGroupBy(T, K).
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterArrGroupBy(T, K) ITPL_CONCAT(ITPL_CONCAT(IterArrGroupBy_, T), ITPL_CONCAT(_, K))
+
+/**
+ * @def DefineIterArrGroupBy(T, K)
+ * @brief Define an IterArrGroupBy struct that groups the elements of an array of `T` by keys of type `K`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char); // Defines an IterArrGroupBy(int, char) struct
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`.
+ * @param K The type of the key elements are grouped by.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define DefineIterArrGroupBy(T, K)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        size_t i;                                                                                                      \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrGroupBy(T, K)
+
+/**
+ * @def define_iterarrgroupby_func(T, K, Name)
+ * @brief Define a function to turn an #IterArrGroupBy(T, K) into an #Iterable(T) where `T = Pair(K, Slice(T))`.
+ *
+ * The defined function takes in a value of type `IterArrGroupBy(T, K)*` and wraps it in an
+ * `Iterable(Pair(K, Slice(T)))`. Each yielded slice points directly into the source array.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char);
+ *
+ * // The defined function has the signature-
+ * // `Iterable(Pair(char, Slice(int))) wrap_intchrarrgrp(IterArrGroupBy(int, char)* x)`
+ * define_iterarrgroupby_func(int, char, wrap_intchrarrgrp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // View the runs of elements within the same bucket of 100 in `arr` (an array of `arrlen` ints)
+ * Iterable(Pair(char, Slice(int))) runs = wrap_intchrarrgrp(&(IterArrGroupBy(int, char)){
+ *     .key = bucket, .eq = chr_eq, .len = arrlen, .arr = arr });
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`.
+ * @param K The type of the key elements are grouped by.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterArrGroupBy(T, K) for the given `T` and `K` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Slice(T))`, for the given `T` and `K` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterarrgroupby_func(T, K, Name)                                                                         \
+    static Maybe(Pair(K, Slice(T))) ITPL_CONCAT(IterArrGroupBy(T, K), _nxt)(IterArrGroupBy(T, K) * self)               \
+    {                                                                                                                  \
+        if (self->i >= self->len) {                                                                                    \
+            return Nothing(Pair(K, Slice(T)));                                                                         \
+        }                                                                                                              \
+        size_t const start = self->i;                                                                                  \
+        K const grpkey     = self->key(self->arr[self->i++]);                                                          \
+        while (self->i < self->len && self->eq(grpkey, self->key(self->arr[self->i]))) {                               \
+            ++(self->i);                                                                                               \
+        }                                                                                                              \
+        return Just(PairOf(grpkey, SliceOf(self->arr + start, self->i - start, T), K, Slice(T)), Pair(K, Slice(T)));   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterArrGroupBy(T, K)*, Pair(K, Slice(T)), Name, ITPL_CONCAT(IterArrGroupBy(T, K), _nxt))
+
+#endif /* !LIB_ITPLUS_GROUPBY_H */
@@ -0,0 +1,122 @@
+/**
+ * @file
+ * Helpers shared by the hash table backed iterplus utilities.
+ *
+ * The tables are open addressing tables with linear probing. The control bytes are stored separately from the slots
+ * (struct of arrays), one byte per slot. A control byte of `0` marks an empty slot, full slots store 7 bits of the
+ * element's hash with the high bit set. Probing only touches the densely packed control bytes until a tag matches, so
+ * most mismatches never load the slot itself, let alone call the equality function.
+ *
+ * Capacities are always powers of 2, and tables are kept at most 7/8ths full, with at least one empty slot.
+ */
+
+#ifndef LIB_ITPLUS_HASH_H
+#define LIB_ITPLUS_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ITPLUS_HASH_MINCAP
+#define ITPLUS_HASH_MINCAP 16
+#endif /* !ITPLUS_HASH_MINCAP */
+
+/**
+ * @def ITPL_HASH_EMPTY
+ * @brief The control byte of an empty slot.
+ */
+#define ITPL_HASH_EMPTY 0
+
+/**
+ * @brief Mix the bits of a 64 bit integer. Serves as a good hash function for integer keys.
+ *
+ * This is the finalizer of splitmix64.
+ */
+static inline uint64_t itpl_hash_u64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief Hash an arbitrary sequence of bytes (FNV-1a, with the result mixed through #itpl_hash_u64).
+ */
+static inline uint64_t itpl_hash_bytes(void const* p, size_t n)
+{
+    unsigned char const* b = p;
+    uint64_t h             = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+    return itpl_hash_u64(h);
+}
+
+/**
+ * @brief Get the control byte for a full slot holding an element with given hash.
+ */
+static inline uint8_t itpl_hash_tag(uint64_t h) { return (uint8_t)(0x80 | (h >> 57)); }
+
+/**
+ * @brief Check whether a table of given capacity can hold `len` elements without exceeding its maximum load.
+ *
+ * At least one slot is always left empty, even in tables too small for 7/8ths to leave any, so that probing for a
+ * missing element terminates.
+ */
+static inline int itpl_hash_fits(size_t len, size_t cap) { return len < cap && len <= cap - cap / 8; }
+
+/**
+ * @brief Get the smallest table capacity that can hold `n` elements.
+ */
+static inline size_t itpl_hash_capfor(size_t n)
+{
+    size_t cap = ITPLUS_HASH_MINCAP;
+    while (!itpl_hash_fits(n, cap)) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+/**
+ * @brief Get the capacity to grow a table of given capacity to- double, or large enough for `hint` elements if the
+ * table has no storage yet.
+ */
+static inline size_t itpl_hash_growcap(size_t cap, size_t hint) { return cap == 0 ? itpl_hash_capfor(hint) : cap * 2; }
+
+/**
+ * @brief Find the first empty slot in the probe sequence of given hash, and mark it full.
+ *
+ * This inserts an element known not to be in the table, e.g when moving elements into a grown table- the caller then
+ * stores the element itself at the returned position. The table must have an empty slot (see #itpl_hash_fits).
+ */
+static inline size_t itpl_hash_claim(uint8_t* ctrl, size_t cap, uint64_t h)
+{
+    size_t pos = (size_t)h & (cap - 1);
+    while (ctrl[pos] != ITPL_HASH_EMPTY) {
+        pos = (pos + 1) & (cap - 1);
+    }
+    ctrl[pos] = itpl_hash_tag(h);
+    return pos;
+}
+
+/**
+ * @def ITPL_HASH_FIND(ctrl, cap, keys, eq, key, h, pos)
+ * @brief Set `pos` to the slot holding an element equal to `key`, with hash `h`, or to the empty slot where it would
+ * be inserted if there is none.
+ *
+ * `keys` is the array of elements stored alongside the control bytes, and `eq` the function to compare them with-
+ * which is only called when the tags match. The table must have an empty slot (see #itpl_hash_fits).
+ */
+#define ITPL_HASH_FIND(ctrl, cap, keys, eq, key, h, pos)                                                               \
+    do {                                                                                                               \
+        uint8_t const itpl_tag = itpl_hash_tag(h);                                                                     \
+        (pos)                  = (size_t)(h) & ((cap) - 1);                                                            \
+        while ((ctrl)[(pos)] != ITPL_HASH_EMPTY && ((ctrl)[(pos)] != itpl_tag || !(eq)((keys)[(pos)], (key)))) {       \
+            (pos) = ((pos) + 1) & ((cap) - 1);                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+#endif /* !LIB_ITPLUS_HASH_H */
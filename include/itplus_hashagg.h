@@ -0,0 +1,402 @@
+/**
+ * @file
+ * @brief Macros for implementing hash aggregation (`group_fold`) using the `HashAgg` table.
+ *
+ * Hash aggregation folds every element of an iterable into the accumulator of its key, the equivalent of SQL's
+ * `GROUP BY` with an aggregate. Unlike `fold`, which has one accumulator for the whole iterable, there is one
+ * accumulator per distinct key, kept in a `HashAgg` table. Unlike `group_by`, the elements do not need to be clustered
+ * by key.
+ *
+ * The table is an open addressing hash table (see itplus_hash.h) storing its keys and accumulators in separate arrays.
+ * It can start off in caller supplied storage, and moves to (and grows on) the heap if it outgrows it. Folding into a
+ * table does not clear it, so the same table can be folded into multiple times. Tables of different partitions of the
+ * input (e.g filled by different threads) can be combined using a merge function.
+ */
+
+#ifndef LIB_ITPLUS_HASHAGG_H
+#define LIB_ITPLUS_HASHAGG_H
+
+#include "itplus_foreach.h"
+#include "itplus_hash.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_pair.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @def HashAgg(K, Acc)
+ * @brief Convenience macro to get the type of the HashAgg table with given key type and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long);
+ * HashAgg(int, long) t; // Declares a variable of type HashAgg(int, long)
+ * @endcode
+ *
+ * @param K The key type. Must be the same type name passed to #DefineHashAgg(K, Acc).
+ * @param Acc The accumulator type. Must be the same type name passed to #DefineHashAgg(K, Acc).
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define HashAgg(K, Acc) ITPL_CONCAT(ITPL_CONCAT(HashAgg_, K), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineHashAgg(K, Acc)
+ * @brief Define a HashAgg table mapping keys of type `K` to accumulators of type `Acc`.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `hash` - The hash function for keys.
+ * * `eq` - The equality function for keys.
+ * * `hint` - (Optional) The expected number of keys. The table is allocated large enough to hold this many keys when
+ *   it first moves to the heap.
+ * * `ctrl`, `keys`, `accs`, `cap` - (Optional) Initial storage for the table. `cap` must be a power of 2, `ctrl` must
+ *   point to `cap` zeroed bytes, `keys` to `cap` keys, and `accs` to `cap` accumulators. #itpl_hash_capfor can be used
+ *   to find a capacity large enough for a given number of keys.
+ *
+ * The rest of the members should be zero initialized. The members `ctrl`, `keys`, `accs`, and `cap` can be used to
+ * look at the table's contents, a slot `i` is occupied if `ctrl[i]` is not #ITPL_HASH_EMPTY.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long); // Defines a HashAgg(int, long) table
+ * @endcode
+ *
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define DefineHashAgg(K, Acc)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        uint64_t (*hash)(K x);                                                                                         \
+        bool (*eq)(K a, K b);                                                                                          \
+        size_t hint;                                                                                                   \
+        uint8_t* ctrl;                                                                                                 \
+        K* keys;                                                                                                       \
+        Acc* accs;                                                                                                     \
+        size_t cap;                                                                                                    \
+        /* Number of keys in the table */                                                                              \
+        size_t len;                                                                                                    \
+        /* Whether `ctrl`, `keys`, and `accs` were allocated by the table */                                           \
+        bool owned;                                                                                                    \
+    } HashAgg(K, Acc)
+
+/**
+ * @def hashagg_free(x)
+ * @brief Free the heap storage of a #HashAgg(K, Acc) (given as a pointer), if it owns any.
+ *
+ * Caller supplied storage is left alone.
+ */
+#define hashagg_free(x)                                                                                                \
+    do {                                                                                                               \
+        if ((x)->owned) {                                                                                              \
+            free((x)->ctrl);                                                                                           \
+            free((x)->keys);                                                                                           \
+            free((x)->accs);                                                                                           \
+            (x)->owned = false;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+/*
+ * Define a function that finds the accumulator of a key in a HashAgg table, inserting the key with accumulator `init`
+ * if it's not in the table yet. Returns NULL if the table needed to grow, but couldn't.
+ */
+#define ITPL_HASHAGG_SLOT_FUNC(K, Acc, FnName)                                                                         \
+    static bool ITPL_CONCAT(FnName, _grow)(HashAgg(K, Acc) * self)                                                     \
+    {                                                                                                                  \
+        size_t const cap    = itpl_hash_growcap(self->cap, self->hint);                                                \
+        uint8_t* const ctrl = calloc(cap, sizeof(*ctrl));                                                              \
+        K* const keys       = malloc(cap * sizeof(*keys));                                                             \
+        Acc* const accs     = malloc(cap * sizeof(*accs));                                                             \
+        if (ctrl == NULL || keys == NULL || accs == NULL) {                                                            \
+            free(ctrl);                                                                                                \
+            free(keys);                                                                                                \
+            free(accs);                                                                                                \
+            return false;                                                                                              \
+        }                                                                                                              \
+        for (size_t i = 0; i < self->cap; i++) {                                                                       \
+            if (self->ctrl[i] != ITPL_HASH_EMPTY) {                                                                    \
+                size_t const pos = itpl_hash_claim(ctrl, cap, self->hash(self->keys[i]));                              \
+                keys[pos]        = self->keys[i];                                                                      \
+                accs[pos]        = self->accs[i];                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (self->owned) {                                                                                             \
+            free(self->ctrl);                                                                                          \
+            free(self->keys);                                                                                          \
+            free(self->accs);                                                                                          \
+        }                                                                                                              \
+        self->ctrl  = ctrl;                                                                                            \
+        self->keys  = keys;                                                                                            \
+        self->accs  = accs;                                                                                            \
+        self->cap   = cap;                                                                                             \
+        self->owned = true;                                                                                            \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+    static Acc* FnName(HashAgg(K, Acc) * self, K key, Acc init)                                                        \
+    {                                                                                                                  \
+        if (self->cap == 0 && !ITPL_CONCAT(FnName, _grow)(self)) {                                                     \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        uint64_t const h = self->hash(key);                                                                            \
+        size_t pos;                                                                                                    \
+        ITPL_HASH_FIND(self->ctrl, self->cap, self->keys, self->eq, key, h, pos);                                      \
+        if (self->ctrl[pos] != ITPL_HASH_EMPTY) {                                                                      \
+            return self->accs + pos;                                                                                   \
+        }                                                                                                              \
+        if (itpl_hash_fits(self->len + 1, self->cap)) {                                                                \
+            self->ctrl[pos] = itpl_hash_tag(h);                                                                        \
+        } else if (ITPL_CONCAT(FnName, _grow)(self)) {                                                                 \
+            pos = itpl_hash_claim(self->ctrl, self->cap, h);                                                           \
+        } else {                                                                                                       \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        self->keys[pos] = key;                                                                                         \
+        self->accs[pos] = init;                                                                                        \
+        ++(self->len);                                                                                                 \
+        return self->accs + pos;                                                                                       \
+    }
+
+/**
+ * @def define_hashagg_fold_func(T, K, Acc, Name)
+ * @brief Define the `group_fold` function, which folds an iterable into a #HashAgg(K, Acc) table.
+ *
+ * The defined function takes in an iterable of type `T`, a table to fold into, a key function of type
+ * `K (*key)(T x)`, a starting value of type `Acc`, and a function of type `Acc (*f)(Acc acc, T x)`. Every element is
+ * folded, using `f`, into the accumulator of its key. The accumulator of a key not yet in the table starts off as
+ * `init`.
+ *
+ * The function returns `true` on success, and `false` if the table needed to grow but the allocation failed. In the
+ * latter case, the table is left valid, with every element up to the failing one folded in.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { int user; int amount; } Order;
+ * DefinePair(int, long);
+ * DefineHashAgg(int, long);
+ *
+ * // The defined function has the signature:-
+ * // `bool order_group_sum(Iterable(Order) it, HashAgg(int, long)* tbl, int (*key)(Order x), long init,
+ * //                       long (*f)(long acc, Order x))`
+ * define_hashagg_fold_func(Order, int, long, order_group_sum)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * static bool int_eq(int a, int b) { return a == b; }
+ * static int order_user(Order x) { return x.user; }
+ * static long add_amount(long acc, Order x) { return acc + x.amount; }
+ * @endcode
+ *
+ * @code
+ * // Total amount spent by each user in `it` (of type `Iterable(Order)`), expecting around 10000 users
+ * HashAgg(int, long) totals = { .hash = int_hash, .eq = int_eq, .hint = 10000 };
+ * if (!order_group_sum(it, &totals, order_user, 0, add_amount)) {
+ *     // Out of memory
+ * }
+ * // Use `totals`, and then free it
+ * hashagg_free(&totals);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, `K`, or `Acc` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_hashagg_fold_func(T, K, Acc, Name)                                                                      \
+    ITPL_HASHAGG_SLOT_FUNC(K, Acc, ITPL_CONCAT(Name, _slot))                                                           \
+    bool Name(Iterable(T) it, HashAgg(K, Acc) * tbl, K (*key)(T x), Acc init, Acc (*f)(Acc acc, T x))                  \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            Acc* const acc = ITPL_CONCAT(Name, _slot)(tbl, key(x), init);                                              \
+            if (acc == NULL) {                                                                                         \
+                return false;                                                                                          \
+            }                                                                                                          \
+            *acc = f(*acc, x);                                                                                         \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def define_hashagg_merge_func(K, Acc, Name)
+ * @brief Define a function to merge one #HashAgg(K, Acc) table into another.
+ *
+ * The defined function takes in a destination table, a source table, and a function of type
+ * `Acc (*merge)(Acc a, Acc b)`, which combines 2 accumulators of the same key. Keys only in the source table are
+ * copied over, with their accumulator as is. The source table is left untouched.
+ *
+ * This is the final step of a partitioned aggregation- each partition of the input is folded into its own table (e.g by
+ * its own thread, with no synchronization), and the tables are then merged together.
+ *
+ * The function returns `true` on success, and `false` if the destination table needed to grow but the allocation
+ * failed.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long);
+ *
+ * // The defined function has the signature:-
+ * // `bool merge_intlong(HashAgg(int, long)* dst, HashAgg(int, long) const* src, long (*merge)(long a, long b))`
+ * define_hashagg_merge_func(int, long, merge_intlong)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static long add(long a, long b) { return a + b; }
+ * @endcode
+ *
+ * @code
+ * // Combine the per partition totals in `parts` (an array of `nparts` tables) into the first table
+ * for (size_t i = 1; i < nparts; i++) {
+ *     merge_intlong(&parts[0], &parts[i], add);
+ *     hashagg_free(&parts[i]);
+ * }
+ * @endcode
+ *
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ * @param Name Name to define the function as.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_hashagg_merge_func(K, Acc, Name)                                                                        \
+    ITPL_HASHAGG_SLOT_FUNC(K, Acc, ITPL_CONCAT(Name, _slot))                                                           \
+    bool Name(HashAgg(K, Acc) * dst, HashAgg(K, Acc) const* src, Acc (*merge)(Acc a, Acc b))                           \
+    {                                                                                                                  \
+        for (size_t i = 0; i < src->cap; i++) {                                                                        \
+            if (src->ctrl[i] == ITPL_HASH_EMPTY) {                                                                     \
+                continue;                                                                                              \
+            }                                                                                                          \
+            size_t const oldlen = dst->len;                                                                            \
+            Acc* const acc      = ITPL_CONCAT(Name, _slot)(dst, src->keys[i], src->accs[i]);                           \
+            if (acc == NULL) {                                                                                         \
+                return false;                                                                                          \
+            }                                                                                                          \
+            if (dst->len == oldlen) {                                                                                  \
+                *acc = merge(*acc, src->accs[i]);                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def IterHashAgg(K, Acc)
+ * @brief Convenience macro to get the type of the IterHashAgg struct with given key type and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long);
+ * IterHashAgg(int, long) i; // Declares a variable of type IterHashAgg(int, long)
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`. Must be the same type name passed to
+ * #DefineIterHashAgg(K, Acc).
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`. Must be the same type name passed to
+ * #DefineIterHashAgg(K, Acc).
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterHashAgg(K, Acc) ITPL_CONCAT(ITPL_CONCAT(IterHashAgg_, K), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineIterHashAgg(K, Acc)
+ * @brief Define an IterHashAgg struct that iterates over the entries of a #HashAgg(K, Acc) table.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long); // Defines an IterHashAgg(int, long) struct
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`.
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** also exist.
+ */
+#define DefineIterHashAgg(K, Acc)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        HashAgg(K, Acc) const* tbl;                                                                                    \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterHashAgg(K, Acc)
+
+/**
+ * @def define_iterhashagg_func(K, Acc, Name)
+ * @brief Define a function to turn an #IterHashAgg(K, Acc) into an #Iterable(T) where `T = Pair(K, Acc)`.
+ *
+ * The defined function takes in a value of type `IterHashAgg(K, Acc)*` and wraps it in an `Iterable(Pair(K, Acc))`,
+ * which yields every key in the table along with its accumulator, in no particular order.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long);
+ *
+ * // The defined function has the signature- `Iterable(Pair(int, long)) wrap_intlonghagg(IterHashAgg(int, long)* x)`
+ * define_iterhashagg_func(int, long, wrap_intlonghagg)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Iterate over the entries of `totals` (of type `HashAgg(int, long)`)
+ * Iterable(Pair(int, long)) entries = wrap_intlonghagg(&(IterHashAgg(int, long)){ .tbl = &totals });
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`.
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`.
+ * @param Name Name to define the function as.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterHashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Acc)`, for the given `K` and `Acc` must exist.
+ * @note The table must not be modified while it's being iterated over.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterhashagg_func(K, Acc, Name)                                                                          \
+    static Maybe(Pair(K, Acc)) ITPL_CONCAT(IterHashAgg(K, Acc), _nxt)(IterHashAgg(K, Acc) * self)                      \
+    {                                                                                                                  \
+        HashAgg(K, Acc) const* const tbl = self->tbl;                                                                  \
+        while (self->i < tbl->cap) {                                                                                   \
+            size_t const i = self->i++;                                                                                \
+            if (tbl->ctrl[i] != ITPL_HASH_EMPTY) {                                                                     \
+                return Just(PairOf(tbl->keys[i], tbl->accs[i], K, Acc), Pair(K, Acc));                                 \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Pair(K, Acc));                                                                                  \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterHashAgg(K, Acc)*, Pair(K, Acc), Name, ITPL_CONCAT(IterHashAgg(K, Acc), _nxt))
+
+#endif /* !LIB_ITPLUS_HASHAGG_H */
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Opt-in instrumentation of the iterplus adapters.
+ *
+ * When `ITPLUS_INSTRUMENT` is defined (before including any iterplus header, and identically in every translation
+ * unit), every adapter defined by a `define_*_func` macro of this library records, in an #ItplStats embedded in its
+ * struct-
+ * * `calls` - The number of times its `next` function was called.
+ * * `yielded` - The number of elements it yielded.
+ * * `cycles` - The time spent in its `next` function, including the time spent in its sources, as measured by
+ *   `ITPLUS_INSTRUMENT_CLOCK()`. This is only recorded if `ITPLUS_INSTRUMENT_CLOCK` is defined, e.g to `__rdtsc` (from
+ *   `<x86intrin.h>`) or a wrapper around `clock_gettime`.
+ *
+ * The stats of an adapter also point to the stats of its sources, so the stats of a whole pipeline form a tree that can
+ * be walked, starting from the outermost iterable, using #itpl_stats_walk or dumped using #itpl_stats_dump. The number
+ * of elements an adapter consumed is the sum of the elements its sources yielded- for filtering adapters, the
+ * difference between that and the number of elements it yielded is the number of elements it filtered out.
+ *
+ * When `ITPLUS_INSTRUMENT` is not defined, the adapter structs have no stats member, and the adapters record nothing.
+ */
+
+#ifndef LIB_ITPLUS_INSTRUMENT_H
+#define LIB_ITPLUS_INSTRUMENT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief The stats recorded by an instrumented adapter.
+ */
+typedef struct itpl_stats
+{
+    /* The type of the adapter */
+    char const* name;
+    uint64_t calls;
+    uint64_t yielded;
+    uint64_t cycles;
+    /* Stats of the sources of the adapter, NULL for sources that are not instrumented */
+    struct itpl_stats const* srcs[2];
+    unsigned nsrcs;
+} ItplStats;
+
+#ifdef ITPLUS_INSTRUMENT
+
+#ifndef ITPLUS_INSTRUMENT_CLOCK
+#define ITPLUS_INSTRUMENT_CLOCK() ((uint64_t)0)
+#endif /* !ITPLUS_INSTRUMENT_CLOCK */
+
+/* Declare the stats member of an adapter struct */
+#define ITPL_STATS_MEMBER ItplStats stats;
+
+/* Record the `idx`th source of an adapter, the first time it is seen */
+#define ITPL_STATS_SRC(self, idx, it)                                                                                  \
+    do {                                                                                                               \
+        if ((self)->stats.nsrcs <= (idx)) {                                                                            \
+            (self)->stats.srcs[idx] = itpl_stats_of(it);                                                               \
+            (self)->stats.nsrcs     = (idx) + 1;                                                                       \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def itpl_stats_of(it)
+ * @brief Get the stats of an iterable (of any type), or `NULL` if it is not an instrumented adapter.
+ */
+#define itpl_stats_of(it) ((it).tc->stats != NULL ? (ItplStats const*)(it).tc->stats((it).self) : NULL)
+
+/**
+ * @brief Call `visit` on the given stats, and the stats of all its (instrumented) sources, depth first.
+ *
+ * `depth` is 0 for the given stats, 1 for its sources and so on. Sources that are not instrumented are visited with
+ * `NULL` stats.
+ */
+static inline void itpl_stats_walk(
+    ItplStats const* stats, unsigned depth, void (*visit)(ItplStats const* stats, unsigned depth, void* ctx), void* ctx)
+{
+    visit(stats, depth, ctx);
+    if (stats == NULL) {
+        return;
+    }
+    for (unsigned i = 0; i < stats->nsrcs; i++) {
+        itpl_stats_walk(stats->srcs[i], depth + 1, visit, ctx);
+    }
+}
+
+static inline void itpl_stats_dump_one(ItplStats const* stats, unsigned depth, void* ctx)
+{
+    FILE* const f = ctx;
+    fprintf(f, "%*s", (int)(depth * 2), "");
+    if (stats == NULL) {
+        fprintf(f, "(not instrumented)\n");
+        return;
+    }
+    fprintf(f, "%s: calls=%llu yielded=%llu", stats->name, (unsigned long long)stats->calls,
+        (unsigned long long)stats->yielded);
+    /* Consumed elements are only known if every source is instrumented */
+    uint64_t consumed = 0;
+    unsigned i        = 0;
+    for (; i < stats->nsrcs && stats->srcs[i] != NULL; i++) {
+        consumed += stats->srcs[i]->yielded;
+    }
+    if (stats->nsrcs > 0 && i == stats->nsrcs) {
+        fprintf(f, " consumed=%llu", (unsigned long long)consumed);
+    }
+    fprintf(f, " cycles=%llu\n", (unsigned long long)stats->cycles);
+}
+
+/**
+ * @brief Print the stats of a pipeline as a tree, one adapter per line, with sources indented under their adapter.
+ */
+static inline void itpl_stats_dump(FILE* f, ItplStats const* stats)
+{
+    itpl_stats_walk(stats, 0, itpl_stats_dump_one, f);
+}
+
+#else
+
+#define ITPL_STATS_MEMBER
+#define ITPL_STATS_SRC(self, idx, it) ((void)0)
+#define itpl_stats_of(it)             ((ItplStats const*)NULL)
+
+#endif /* ITPLUS_INSTRUMENT */
+
+#endif /* !LIB_ITPLUS_INSTRUMENT_H */
@@ -0,0 +1,662 @@
+/**
+ * @file
+ * @brief Utilities for compressing streams of unsigned integers- delta, varint and bit packing codecs.
+ *
+ * * Delta coding- the `IterDeltaEncode` struct yields the difference of each element from the one before it, and
+ *   `IterDeltaDecode` undoes it. On sorted streams (e.g posting lists of ids) the differences are small, which is what
+ *   makes the other two codecs effective. Arithmetic wraps, so any stream round trips.
+ * * Varint coding (LEB128)- 7 bits per byte, the high bit marking that more bytes follow. Small values take 1 byte.
+ *   `define_varintencode_func` writes an iterable into a buffer, and the `IterVarintDecode` struct reads it back.
+ * * Bit packing (frame of reference)- blocks of up to #ITPL_BITPACK_BLOCK values are stored as their minimum, and the
+ *   offset of each value from it, packed into just as many bits as the largest offset needs. Unlike varints, every
+ *   value of a block is stored in the same number of bits, so a block is unpacked in a single tight loop.
+ *   `define_bitpackencode_func` writes an iterable into a buffer, and the `IterBitpackDecode` struct reads it back.
+ *
+ * The element type `T` must be an unsigned integer type, of at most 64 bits. The decoders are lazy sources, so a
+ * compressed stream can feed any pipeline (e.g an intersection or a filter) directly, without being decompressed
+ * upfront.
+ *
+ * Encoded block layout- the number of values (varint), the minimum (varint), the bit width (1 byte), and then the
+ * offsets, packed least significant bit first, padded to a whole byte.
+ */
+
+#ifndef LIB_ITPLUS_INTCODEC_H
+#define LIB_ITPLUS_INTCODEC_H
+
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @def ITPL_BITPACK_BLOCK
+ * @brief The (maximum) number of values in a bit packed block.
+ */
+#define ITPL_BITPACK_BLOCK 128U
+
+/**
+ * @def ITPL_VARINT_MAXLEN
+ * @brief The maximum length of a varint encoded 64 bit integer.
+ */
+#define ITPL_VARINT_MAXLEN 10U
+
+/**
+ * @brief Encode an integer as a varint.
+ *
+ * @param x The integer.
+ * @param out Where to write the varint, must have room for #ITPL_VARINT_MAXLEN bytes.
+ *
+ * @return The length of the varint.
+ */
+static inline size_t itpl_varint_put(uint64_t x, unsigned char* out)
+{
+    size_t n = 0;
+    while (x >= 0x80) {
+        out[n++] = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    out[n++] = (unsigned char)x;
+    return n;
+}
+
+/**
+ * @brief Decode the varint at `*pos`, advancing `*pos` past it.
+ *
+ * @return `false` if the varint is truncated, or too long for 64 bits.
+ */
+static inline bool itpl_varint_get(unsigned char const* buf, size_t len, size_t* pos, uint64_t* x)
+{
+    uint64_t res = 0;
+    for (size_t i = *pos, shift = 0; i < len && shift < 64; i++, shift += 7) {
+        res |= (uint64_t)(buf[i] & 0x7F) << shift;
+        if (buf[i] < 0x80) {
+            *pos = i + 1;
+            *x   = res;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Bit pack a block of values.
+ *
+ * @param vals The values.
+ * @param n The number of values, at most #ITPL_BITPACK_BLOCK.
+ * @param out Where to write the block.
+ * @param cap Room available in `out`.
+ *
+ * @return The length of the block, or `0` if it does not fit in `cap` bytes.
+ */
+static inline size_t itpl_bitpack_put(uint64_t const* vals, size_t n, unsigned char* out, size_t cap)
+{
+    uint64_t min = UINT64_MAX, range = 0;
+    for (size_t i = 0; i < n; i++) {
+        min = vals[i] < min ? vals[i] : min;
+    }
+    for (size_t i = 0; i < n; i++) {
+        range |= vals[i] - min;
+    }
+    unsigned width = 0;
+    while (width < 64 && (range >> width) != 0) {
+        width++;
+    }
+    unsigned char hdr[2 * ITPL_VARINT_MAXLEN + 1];
+    size_t hdrlen   = itpl_varint_put(n, hdr);
+    hdrlen         += itpl_varint_put(min, hdr + hdrlen);
+    hdr[hdrlen++]   = (unsigned char)width;
+    size_t const sz = hdrlen + (n * width + 7) / 8;
+    if (sz > cap) {
+        return 0;
+    }
+    memcpy(out, hdr, hdrlen);
+    unsigned char* const p = out + hdrlen;
+    memset(p, 0, sz - hdrlen);
+    size_t bit = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const v = vals[i] - min;
+        for (unsigned done = 0; done < width;) {
+            unsigned const shift = bit % 8;
+            unsigned const take  = 8 - shift < width - done ? 8 - shift : width - done;
+            p[bit / 8] |= (unsigned char)(((v >> done) & ((1U << take) - 1)) << shift);
+            done += take;
+            bit  += take;
+        }
+    }
+    return sz;
+}
+
+/**
+ * @brief Unpack the bit packed block at `*pos`, advancing `*pos` past it.
+ *
+ * @param buf The buffer.
+ * @param len Length of the buffer.
+ * @param pos Position of the block in the buffer.
+ * @param out Where to write the values, must have room for #ITPL_BITPACK_BLOCK values.
+ *
+ * @return The number of values in the block, or `0` if the block is malformed.
+ */
+static inline size_t itpl_bitpack_get(unsigned char const* buf, size_t len, size_t* pos, uint64_t* out)
+{
+    size_t i = *pos;
+    uint64_t n, min;
+    if (!itpl_varint_get(buf, len, &i, &n) || n == 0 || n > ITPL_BITPACK_BLOCK ||
+        !itpl_varint_get(buf, len, &i, &min) || i == len || buf[i] > 64) {
+        return 0;
+    }
+    unsigned const width = buf[i++];
+    if ((n * width + 7) / 8 > len - i) {
+        return 0;
+    }
+    unsigned char const* const p = buf + i;
+    size_t bit                   = 0;
+    for (size_t j = 0; j < n; j++) {
+        uint64_t v = 0;
+        for (unsigned done = 0; done < width;) {
+            unsigned const shift = bit % 8;
+            unsigned const take  = 8 - shift < width - done ? 8 - shift : width - done;
+            v    |= (uint64_t)((p[bit / 8] >> shift) & ((1U << take) - 1)) << done;
+            done += take;
+            bit  += take;
+        }
+        out[j] = min + v;
+    }
+    *pos = i + (n * width + 7) / 8;
+    return n;
+}
+
+/**
+ * @def IterDeltaEncode(T)
+ * @brief Convenience macro to get the type of the IterDeltaEncode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t);
+ * IterDeltaEncode(uint32_t) i; // Declares a variable of type IterDeltaEncode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield. Must be the same type name
+ * passed to #DefineIterDeltaEncode(T).
+ */
+#define IterDeltaEncode(T) ITPL_CONCAT(IterDeltaEncode_, T)
+
+/**
+ * @def IterDeltaDecode(T)
+ * @brief Convenience macro to get the type of the IterDeltaDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t);
+ * IterDeltaDecode(uint32_t) i; // Declares a variable of type IterDeltaDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield. Must be the same type name
+ * passed to #DefineIterDeltaDecode(T).
+ */
+#define IterDeltaDecode(T) ITPL_CONCAT(IterDeltaDecode_, T)
+
+/**
+ * @def DefineIterDeltaEncode(T)
+ * @brief Define an IterDeltaEncode struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t); // Defines an IterDeltaEncode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield. Must be an unsigned integer
+ * type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDeltaEncode(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T prev;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDeltaEncode(T)
+
+/**
+ * @def DefineIterDeltaDecode(T)
+ * @brief Define an IterDeltaDecode struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `src` - The source iterable, of deltas.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t); // Defines an IterDeltaDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield. Must be an unsigned integer
+ * type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDeltaDecode(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T prev;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDeltaDecode(T)
+
+/**
+ * @def define_iterdeltaencode_func(T, Name)
+ * @brief Define a function to turn an #IterDeltaEncode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDeltaEncode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDeltaEncode(T)*` and wraps it in an `Iterable(T)`. The first
+ * element is yielded as is, and every other element as its difference from the one before it.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterDeltaEncode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32deltaenc(IterDeltaEncode(uint32_t)* x)`
+ * define_iterdeltaencode_func(uint32_t, wrap_u32deltaenc)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Delta encode `ids` (of type `Iterable(uint32_t)`), yields 3, 4, 1, 10 for 3, 7, 8, 18
+ * Iterable(uint32_t) deltas = wrap_u32deltaenc(&(IterDeltaEncode(uint32_t)){ .src = ids });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterDeltaEncode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdeltaencode_func(T, Name)                                                                           \
+    static Maybe(T) ITPL_CONCAT(IterDeltaEncode(T), _nxt)(IterDeltaEncode(T) * self)                                   \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
+        if (is_nothing(res)) {                                                                                         \
+            return res;                                                                                                \
+        }                                                                                                              \
+        T const x  = from_just_(res);                                                                                  \
+        T const d  = (T)(x - self->prev);                                                                              \
+        self->prev = x;                                                                                                \
+        return Just(d, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDeltaEncode(T)*, T, Name, ITPL_CONCAT(IterDeltaEncode(T), _nxt))
+
+/**
+ * @def define_iterdeltadecode_func(T, Name)
+ * @brief Define a function to turn an #IterDeltaDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDeltaDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDeltaDecode(T)*` and wraps it in an `Iterable(T)`. Each element
+ * yielded is the running sum of the deltas so far.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterDeltaDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32deltadec(IterDeltaDecode(uint32_t)* x)`
+ * define_iterdeltadecode_func(uint32_t, wrap_u32deltadec)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Delta decode `deltas` (of type `Iterable(uint32_t)`), yields 3, 7, 8, 18 for 3, 4, 1, 10
+ * Iterable(uint32_t) ids = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = deltas });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterDeltaDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdeltadecode_func(T, Name)                                                                           \
+    static Maybe(T) ITPL_CONCAT(IterDeltaDecode(T), _nxt)(IterDeltaDecode(T) * self)                                   \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
+        if (is_nothing(res)) {                                                                                         \
+            return res;                                                                                                \
+        }                                                                                                              \
+        self->prev = (T)(self->prev + from_just_(res));                                                                \
+        return Just(self->prev, T);                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDeltaDecode(T)*, T, Name, ITPL_CONCAT(IterDeltaDecode(T), _nxt))
+
+/**
+ * @def define_varintencode_func(T, Name)
+ * @brief Define the `varint_encode` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, its capacity, and a pointer to store the encoded
+ * length in. It writes every element of the iterable into the buffer as a varint, stopping early if the buffer runs
+ * out of room.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool varint_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len)`
+ * define_varintencode_func(uint32_t, varint_u32)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * unsigned char buf[4096];
+ * size_t len;
+ * // Varint encode `deltas` (of type `Iterable(uint32_t)`)
+ * if (!varint_u32(deltas, buf, sizeof(buf), &len)) {
+ *     // Handle the buffer being too small
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if the buffer ran out of room, in which case `*len` is the length of the elements that did fit.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_varintencode_func(T, Name)                                                                              \
+    bool Name(Iterable(T) it, unsigned char* out, size_t cap, size_t* len)                                             \
+    {                                                                                                                  \
+        unsigned char tmp[ITPL_VARINT_MAXLEN];                                                                         \
+        *len = 0;                                                                                                      \
+        foreach (T, x, it) {                                                                                           \
+            if (cap - *len >= ITPL_VARINT_MAXLEN) {                                                                    \
+                *len += itpl_varint_put((uint64_t)x, out + *len);                                                      \
+                continue;                                                                                              \
+            }                                                                                                          \
+            size_t const n = itpl_varint_put((uint64_t)x, tmp);                                                        \
+            if (n > cap - *len) {                                                                                      \
+                return false;                                                                                          \
+            }                                                                                                          \
+            memcpy(out + *len, tmp, n);                                                                                \
+            *len += n;                                                                                                 \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def define_bitpackencode_func(T, Name)
+ * @brief Define the `bitpack_encode` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, its capacity, and a pointer to store the encoded
+ * length in. It writes the elements of the iterable into the buffer as bit packed blocks of #ITPL_BITPACK_BLOCK
+ * elements (the last block may be shorter), stopping early if the buffer runs out of room.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool bitpack_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len)`
+ * define_bitpackencode_func(uint32_t, bitpack_u32)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if the buffer ran out of room, in which case `*len` is the length of the blocks that did fit.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_bitpackencode_func(T, Name)                                                                             \
+    bool Name(Iterable(T) it, unsigned char* out, size_t cap, size_t* len)                                             \
+    {                                                                                                                  \
+        uint64_t blk[ITPL_BITPACK_BLOCK];                                                                              \
+        size_t n = 0;                                                                                                  \
+        *len     = 0;                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            blk[n++] = (uint64_t)x;                                                                                    \
+            if (n == ITPL_BITPACK_BLOCK) {                                                                             \
+                size_t const sz = itpl_bitpack_put(blk, n, out + *len, cap - *len);                                    \
+                if (sz == 0) {                                                                                         \
+                    return false;                                                                                      \
+                }                                                                                                      \
+                *len += sz;                                                                                            \
+                n     = 0;                                                                                             \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (n > 0) {                                                                                                   \
+            size_t const sz = itpl_bitpack_put(blk, n, out + *len, cap - *len);                                        \
+            if (sz == 0) {                                                                                             \
+                return false;                                                                                          \
+            }                                                                                                          \
+            *len += sz;                                                                                                \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def IterVarintDecode(T)
+ * @brief Convenience macro to get the type of the IterVarintDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t);
+ * IterVarintDecode(uint32_t) i; // Declares a variable of type IterVarintDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield. Must be the same type name passed to
+ * #DefineIterVarintDecode(T).
+ */
+#define IterVarintDecode(T) ITPL_CONCAT(IterVarintDecode_, T)
+
+/**
+ * @def DefineIterVarintDecode(T)
+ * @brief Define an IterVarintDecode struct that decodes a buffer of varints into `T`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer of varints.
+ *
+ * After iteration, `malformed` tells whether decoding stopped at a truncated varint, or one too large for `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t); // Defines an IterVarintDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield. Must be an unsigned integer type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterVarintDecode(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char const* buf;                                                                                      \
+        size_t len;                                                                                                    \
+        size_t pos;                                                                                                    \
+        bool malformed;                                                                                                \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterVarintDecode(T)
+
+/**
+ * @def define_itervarintdecode_func(T, Name)
+ * @brief Define a function to turn an #IterVarintDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterVarintDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterVarintDecode(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterVarintDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32varint(IterVarintDecode(uint32_t)* x)`
+ * define_itervarintdecode_func(uint32_t, wrap_u32varint)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Decode the ids delta and varint encoded in `buf`, of length `len`
+ * IterVarintDecode(uint32_t) v = {.buf = buf, .len = len};
+ * Iterable(uint32_t) ids       = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = wrap_u32varint(&v) });
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterVarintDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itervarintdecode_func(T, Name)                                                                          \
+    static Maybe(T) ITPL_CONCAT(IterVarintDecode(T), _nxt)(IterVarintDecode(T) * self)                                 \
+    {                                                                                                                  \
+        uint64_t x;                                                                                                    \
+        if (self->malformed || self->pos == self->len) {                                                               \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!itpl_varint_get(self->buf, self->len, &self->pos, &x) || (uint64_t)(T)x != x) {                           \
+            self->malformed = true;                                                                                    \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        return Just((T)x, T);                                                                                          \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterVarintDecode(T)*, T, Name, ITPL_CONCAT(IterVarintDecode(T), _nxt))
+
+/**
+ * @def IterBitpackDecode(T)
+ * @brief Convenience macro to get the type of the IterBitpackDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t);
+ * IterBitpackDecode(uint32_t) i; // Declares a variable of type IterBitpackDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield. Must be the same type name passed to
+ * #DefineIterBitpackDecode(T).
+ */
+#define IterBitpackDecode(T) ITPL_CONCAT(IterBitpackDecode_, T)
+
+/**
+ * @def DefineIterBitpackDecode(T)
+ * @brief Define an IterBitpackDecode struct that decodes a buffer of bit packed blocks into `T`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer of bit packed blocks.
+ *
+ * After iteration, `malformed` tells whether decoding stopped at a malformed block, or one with values too large for
+ * `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t); // Defines an IterBitpackDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield. Must be an unsigned integer type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterBitpackDecode(T)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char const* buf;                                                                                      \
+        size_t len;                                                                                                    \
+        size_t pos;                                                                                                    \
+        /* The current block, and the position in it */                                                                \
+        uint64_t blk[ITPL_BITPACK_BLOCK];                                                                              \
+        size_t blklen;                                                                                                 \
+        size_t blkpos;                                                                                                 \
+        bool malformed;                                                                                                \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterBitpackDecode(T)
+
+/**
+ * @def define_iterbitpackdecode_func(T, Name)
+ * @brief Define a function to turn an #IterBitpackDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterBitpackDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterBitpackDecode(T)*` and wraps it in an `Iterable(T)`. A whole
+ * block is unpacked at once, when its first element is requested.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterBitpackDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32unpack(IterBitpackDecode(uint32_t)* x)`
+ * define_iterbitpackdecode_func(uint32_t, wrap_u32unpack)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Decode the ids delta encoded and bit packed in `buf`, of length `len`
+ * IterBitpackDecode(uint32_t) b = {.buf = buf, .len = len};
+ * Iterable(uint32_t) ids        = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = wrap_u32unpack(&b) });
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterBitpackDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterbitpackdecode_func(T, Name)                                                                         \
+    static Maybe(T) ITPL_CONCAT(IterBitpackDecode(T), _nxt)(IterBitpackDecode(T) * self)                               \
+    {                                                                                                                  \
+        if (self->blkpos == self->blklen) {                                                                            \
+            if (self->malformed || self->pos == self->len) {                                                           \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            self->blkpos = 0;                                                                                          \
+            self->blklen = itpl_bitpack_get(self->buf, self->len, &self->pos, self->blk);                              \
+            if (self->blklen == 0) {                                                                                   \
+                self->malformed = true;                                                                                \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        uint64_t const x = self->blk[(self->blkpos)++];                                                                \
+        if ((uint64_t)(T)x != x) {                                                                                     \
+            self->malformed = true;                                                                                    \
+            self->blkpos    = self->blklen;                                                                            \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        return Just((T)x, T);                                                                                          \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterBitpackDecode(T)*, T, Name, ITPL_CONCAT(IterBitpackDecode(T), _nxt))
+
+#endif /* !LIB_ITPLUS_INTCODEC_H */
@@ -6,6 +6,7 @@
 #ifndef LIB_ITPLUS_ITERATOR_H
 #define LIB_ITPLUS_ITERATOR_H
 
+#include "itplus_instrument.h"
 #include "itplus_macro_utils.h"
 #include "itplus_maybe.h"
 #include "itplus_typeclass.h"
@@ -60,9 +61,15 @@
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note A #Maybe(T) for the given `T` **must** also exist.
  */
+#ifdef ITPLUS_INSTRUMENT
+#define DefineIteratorOf(T)                                                                                            \
+    typedef typeclass(Maybe(T) (*const next)(void* self); ItplStats* (*const stats)(void* self)) Iterator(T);          \
+    typedef typeclass_instance(Iterator(T)) Iterable(T)
+#else
 #define DefineIteratorOf(T)                                                                                            \
     typedef typeclass(Maybe(T) (*const next)(void* self)) Iterator(T);                                                 \
     typedef typeclass_instance(Iterator(T)) Iterable(T)
+#endif /* ITPLUS_INSTRUMENT */
 
 /**
  * @def impl_iterator(IterType, ElmntType, Name, next_f)
@@ -131,4 +138,42 @@
         return (Iterable(ElmntType)){.tc = &tc, .self = x};                                                            \
     }
 
+/**
+ * @def impl_instrumented_iterator(IterType, ElmntType, Name, next_f)
+ * @brief Like #impl_iterator, but records the stats of `IterType` if `ITPLUS_INSTRUMENT` is defined.
+ *
+ * This is used by the adapters defined by this library. `IterType` must be a pointer to a struct declaring
+ * `ITPL_STATS_MEMBER`, and `next_f` should record the sources of the struct using `ITPL_STATS_SRC`. See
+ * itplus_instrument.h.
+ *
+ * @note This should not be delimited by a semicolon.
+ */
+#ifdef ITPLUS_INSTRUMENT
+#define impl_instrumented_iterator(IterType, ElmntType, Name, next_f)                                                  \
+    static inline Maybe(ElmntType) ITPL_CONCAT(next_f, __)(void* self)                                                 \
+    {                                                                                                                  \
+        IterType const x           = self;                                                                             \
+        uint64_t const start       = ITPLUS_INSTRUMENT_CLOCK();                                                        \
+        Maybe(ElmntType) const res = (next_f)(x);                                                                      \
+        x->stats.cycles += ITPLUS_INSTRUMENT_CLOCK() - start;                                                          \
+        ++(x->stats.calls);                                                                                            \
+        x->stats.yielded += is_just(res);                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    static inline ItplStats* ITPL_CONCAT(next_f, _stats)(void* self)                                                   \
+    {                                                                                                                  \
+        IterType const x = self;                                                                                       \
+        return &x->stats;                                                                                              \
+    }                                                                                                                  \
+    Iterable(ElmntType) Name(IterType x)                                                                               \
+    {                                                                                                                  \
+        static Iterator(ElmntType) const tc = {                                                                        \
+            .next = (ITPL_CONCAT(next_f, __)), .stats = (ITPL_CONCAT(next_f, _stats))};                                \
+        x->stats.name = #IterType;                                                                                     \
+        return (Iterable(ElmntType)){.tc = &tc, .self = x};                                                            \
+    }
+#else
+#define impl_instrumented_iterator(IterType, ElmntType, Name, next_f) impl_iterator(IterType, ElmntType, Name, next_f)
+#endif /* ITPLUS_INSTRUMENT */
+
 #endif /* !LIB_ITPLUS_ITERATOR_H */
@@ -0,0 +1,540 @@
+/**
+ * @file
+ * @brief An LZ4 block compressor and decompressor, and macros for implementing streaming compression using the
+ * `IterLz4Compress` and `IterLz4Decompress` structs.
+ *
+ * #itpl_lz4_compress and #itpl_lz4_decompress implement the LZ4 block format- the output of the compressor can be
+ * decompressed by any LZ4 implementation (`LZ4_decompress_safe`), and vice versa. The compressor is a greedy single
+ * pass over a hash table of the last position of every 4 byte sequence, skipping ahead faster through data that does
+ * not compress. The decompressor validates every length and offset, so malformed input is detected, never overrun.
+ *
+ * The IterLz4Compress struct is a struct that compresses a stream of byte chunks (`Slice(char)`s, e.g from a file, or
+ * an #IterArrChunks(T)) into a stream of independently compressed blocks of (at most) `blocksize` bytes each, and
+ * IterLz4Decompress turns such a stream (chunked arbitrarily) back into the blocks it was made of. A chunk holding a
+ * whole block is (de)compressed where it is, otherwise the block is assembled in a buffer first.
+ *
+ * Every block is framed by a 4 byte little endian header- the size of the block's data, with the highest bit set if the
+ * data is stored uncompressed, which it is when compressing does not make it smaller. Since the blocks do not depend
+ * on each other, they can also be compressed in parallel- e.g each thread calling #itpl_lz4_frame on its own blocks.
+ */
+
+#ifndef LIB_ITPLUS_LZ4_H
+#define LIB_ITPLUS_LZ4_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef ITPLUS_LZ4_HASHLOG
+#define ITPLUS_LZ4_HASHLOG 12
+#endif /* !ITPLUS_LZ4_HASHLOG */
+
+/**
+ * @def ITPL_LZ4_BOUND(n)
+ * @brief The maximum size of the LZ4 compressed form of `n` bytes.
+ */
+#define ITPL_LZ4_BOUND(n) ((n) + (n) / 255 + 16)
+
+/**
+ * @def ITPL_LZ4_FRAMEBOUND(n)
+ * @brief The maximum size of a framed block of `n` bytes, as written by #itpl_lz4_frame.
+ */
+#define ITPL_LZ4_FRAMEBOUND(n) ((n) + 4)
+
+#define ITPL_LZ4_STORED 0x80000000U
+
+/* The format requires the last 5 bytes to be literals, and the last match to start at least 12 bytes before the end */
+#define ITPL_LZ4_LASTLITERALS 5U
+#define ITPL_LZ4_MFLIMIT      12U
+
+static inline uint32_t itpl_lz4_read32(unsigned char const* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+/* Write the part of a length beyond the 15 that fits in a token */
+static inline unsigned char* itpl_lz4_putlen(unsigned char* op, size_t n)
+{
+    for (; n >= 255; n -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (unsigned char)n;
+    return op;
+}
+
+/* Write a sequence- a token, literals, and (if `mlen` is not 0) a match. `NULL` if it does not fit */
+static inline unsigned char* itpl_lz4_sequence(unsigned char* op, unsigned char const* oend, unsigned char const* lit,
+    size_t litlen, size_t off, size_t mlen)
+{
+    size_t const need = 1 + litlen + litlen / 255 + 1 + (mlen == 0 ? 0 : 2 + mlen / 255 + 1);
+    if (need > (size_t)(oend - op)) {
+        return NULL;
+    }
+    unsigned char* const token = op++;
+    *token                     = (unsigned char)((litlen >= 15 ? 15 : litlen) << 4);
+    if (litlen >= 15) {
+        op = itpl_lz4_putlen(op, litlen - 15);
+    }
+    memcpy(op, lit, litlen);
+    op += litlen;
+    if (mlen == 0) {
+        return op;
+    }
+    *op++   = (unsigned char)(off & 0xFF);
+    *op++   = (unsigned char)(off >> 8);
+    mlen   -= 4;
+    *token |= (unsigned char)(mlen >= 15 ? 15 : mlen);
+    if (mlen >= 15) {
+        op = itpl_lz4_putlen(op, mlen - 15);
+    }
+    return op;
+}
+
+/**
+ * @brief Compress a block of bytes into the LZ4 block format.
+ *
+ * @param src The bytes to compress. At most `UINT32_MAX` bytes.
+ * @param len The number of bytes.
+ * @param dst Where to write the compressed block.
+ * @param cap Room available in `dst`. `ITPL_LZ4_BOUND(len)` bytes are always enough.
+ *
+ * @return The size of the compressed block, or `0` if it does not fit in `cap` bytes.
+ */
+static inline size_t itpl_lz4_compress(unsigned char const* src, size_t len, unsigned char* dst, size_t cap)
+{
+    uint32_t table[1U << ITPLUS_LZ4_HASHLOG] = {0};
+    unsigned char* op                        = dst;
+    unsigned char const* const oend          = dst + cap;
+
+    size_t anchor = 0, i = 0;
+    while (len >= ITPL_LZ4_MFLIMIT && i <= len - ITPL_LZ4_MFLIMIT) {
+        uint32_t const seq = itpl_lz4_read32(src + i);
+        uint32_t const h   = (seq * 2654435761U) >> (32 - ITPLUS_LZ4_HASHLOG);
+        size_t const cand  = table[h];
+        table[h]           = (uint32_t)i;
+        if (cand >= i || i - cand > 65535 || itpl_lz4_read32(src + cand) != seq) {
+            /* Skip ahead faster the longer it's been since the last match */
+            i += 1 + ((i - anchor) >> 6);
+            continue;
+        }
+        /* Extend the match backwards, into the pending literals, and forwards */
+        size_t start = i, from = cand;
+        while (start > anchor && from > 0 && src[start - 1] == src[from - 1]) {
+            start--;
+            from--;
+        }
+        size_t end = i + 4;
+        while (end < len - ITPL_LZ4_LASTLITERALS && src[end] == src[end - (start - from)]) {
+            end++;
+        }
+        op = itpl_lz4_sequence(op, oend, src + anchor, start - anchor, start - from, end - start);
+        if (op == NULL) {
+            return 0;
+        }
+        anchor = i = end;
+    }
+    op = itpl_lz4_sequence(op, oend, src + anchor, len - anchor, 0, 0);
+    return op == NULL ? 0 : (size_t)(op - dst);
+}
+
+/* Read the part of a length beyond the 15 that fits in a token, `false` if truncated */
+static inline bool itpl_lz4_getlen(unsigned char const* src, size_t len, size_t* ip, size_t* n)
+{
+    unsigned char b;
+    do {
+        if (*ip == len) {
+            return false;
+        }
+        b   = src[(*ip)++];
+        *n += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * @brief Decompress a block in the LZ4 block format.
+ *
+ * @param src The compressed block.
+ * @param len Size of the compressed block.
+ * @param dst Where to write the decompressed bytes.
+ * @param cap Room available in `dst`.
+ *
+ * @return The number of decompressed bytes, or `SIZE_MAX` if the block is malformed, or does not fit in `cap` bytes.
+ */
+static inline size_t itpl_lz4_decompress(unsigned char const* src, size_t len, unsigned char* dst, size_t cap)
+{
+    size_t ip = 0, op = 0;
+    while (ip < len) {
+        unsigned const token = src[ip++];
+        size_t lit           = token >> 4;
+        if ((lit == 15 && !itpl_lz4_getlen(src, len, &ip, &lit)) || lit > len - ip || lit > cap - op) {
+            return SIZE_MAX;
+        }
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == len) {
+            /* The last sequence has no match */
+            return op;
+        }
+        if (len - ip < 2) {
+            return SIZE_MAX;
+        }
+        size_t const off = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        size_t mlen      = token & 15;
+
+        ip += 2;
+        if (off == 0 || off > op || (mlen == 15 && !itpl_lz4_getlen(src, len, &ip, &mlen)) || mlen + 4 > cap - op) {
+            return SIZE_MAX;
+        }
+        mlen += 4;
+        unsigned char* const d       = dst + op;
+        unsigned char const* const s = dst + (op - off);
+        if (off >= mlen) {
+            memcpy(d, s, mlen);
+        } else {
+            /* The match overlaps the bytes it produces */
+            for (size_t k = 0; k < mlen; k++) {
+                d[k] = s[k];
+            }
+        }
+        op += mlen;
+    }
+    return SIZE_MAX;
+}
+
+/**
+ * @brief Compress a block into a framed block- the 4 byte header, followed by the data.
+ *
+ * @param src The bytes to compress, at most `0x7FFFFFFF`.
+ * @param len The number of bytes.
+ * @param out Where to write the framed block, must have room for `ITPL_LZ4_FRAMEBOUND(len)` bytes.
+ *
+ * @return The size of the framed block.
+ */
+static inline size_t itpl_lz4_frame(unsigned char const* src, size_t len, unsigned char* out)
+{
+    /* Only keep the compressed data if it's smaller */
+    size_t n     = len == 0 ? 0 : itpl_lz4_compress(src, len, out + 4, len - 1);
+    uint32_t hdr = (uint32_t)n;
+    if (n == 0) {
+        memcpy(out + 4, src, len);
+        n   = len;
+        hdr = (uint32_t)len | ITPL_LZ4_STORED;
+    }
+    for (size_t k = 0; k < 4; k++) {
+        out[k] = (unsigned char)(hdr >> (8 * k));
+    }
+    return 4 + n;
+}
+
+/**
+ * @brief Get the size of the data of a framed block, and whether it's stored uncompressed, from its header.
+ */
+static inline size_t itpl_lz4_framelen(unsigned char const* hdr, bool* stored)
+{
+    uint32_t const x = (uint32_t)hdr[0] | ((uint32_t)hdr[1] << 8) | ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+    *stored          = (x & ITPL_LZ4_STORED) != 0;
+    return x & ~ITPL_LZ4_STORED;
+}
+
+/**
+ * @brief Get the bytes of a framed block, decompressing them into `out` if they're compressed.
+ *
+ * @param frame The framed block.
+ * @param out Where to decompress the data.
+ * @param cap Room available in `out`, the most bytes a block may hold.
+ * @param len Where to store the number of bytes.
+ *
+ * @return Pointer to the bytes- into `out`, or into the frame itself if the data is stored uncompressed. `NULL` if the
+ * data is malformed, or more than `cap` bytes.
+ */
+static inline unsigned char const* itpl_lz4_unframe(unsigned char const* frame, unsigned char* out, size_t cap,
+    size_t* len)
+{
+    bool stored;
+    size_t const datalen = itpl_lz4_framelen(frame, &stored);
+    if (stored) {
+        *len = datalen;
+        return datalen > cap ? NULL : frame + 4;
+    }
+    *len = itpl_lz4_decompress(frame + 4, datalen, out, cap);
+    return *len == SIZE_MAX ? NULL : out;
+}
+
+/**
+ * @def IterLz4Compress(T)
+ * @brief Convenience macro to get the type of the IterLz4Compress struct with given byte type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char);
+ * IterLz4Compress(char) i; // Declares a variable of type IterLz4Compress(char)
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks this `IterLz4Compress` consumes and yields. Must be the same type name
+ * passed to #DefineIterLz4Compress(T).
+ */
+#define IterLz4Compress(T) ITPL_CONCAT(IterLz4Compress_, T)
+
+/**
+ * @def IterLz4Decompress(T)
+ * @brief Convenience macro to get the type of the IterLz4Decompress struct with given byte type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char);
+ * IterLz4Decompress(char) i; // Declares a variable of type IterLz4Decompress(char)
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks this `IterLz4Decompress` consumes and yields. Must be the same type name
+ * passed to #DefineIterLz4Decompress(T).
+ */
+#define IterLz4Decompress(T) ITPL_CONCAT(IterLz4Decompress_, T)
+
+/**
+ * @def DefineIterLz4Compress(T)
+ * @brief Define an IterLz4Compress struct that works on `Iterable(Slice(T))`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `blocksize` - The number of bytes to compress into each block, at most `0x7FFFFFFF`.
+ * * `in` - The buffer to assemble blocks in, must have room for `blocksize` bytes.
+ * * `out` - The buffer to compress blocks into, must have room for `ITPL_LZ4_FRAMEBOUND(blocksize)` bytes.
+ * * `src` - The source iterable, of chunks of bytes.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char); // Defines an IterLz4Compress(char) struct
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks, `char` or `unsigned char`.
+ *
+ * @note A #Slice(T) and an #Iterator(T), with `T = Slice(T)`, for the given `T` **must** also exist.
+ */
+#define DefineIterLz4Compress(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t blocksize;                                                                                              \
+        unsigned char* in;                                                                                             \
+        unsigned char* out;                                                                                            \
+        size_t inlen;                                                                                                  \
+        /* The rest of the current chunk */                                                                            \
+        Slice(T) chunk;                                                                                                \
+        bool done;                                                                                                     \
+        Iterable(Slice(T)) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterLz4Compress(T)
+
+/**
+ * @def DefineIterLz4Decompress(T)
+ * @brief Define an IterLz4Decompress struct that works on `Iterable(Slice(T))`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `blocksize` - The maximum number of bytes in a block, same as the one the stream was compressed with.
+ * * `in` - The buffer to assemble framed blocks in, must have room for `ITPL_LZ4_FRAMEBOUND(blocksize)` bytes.
+ * * `out` - The buffer to decompress blocks into, must have room for `blocksize` bytes.
+ * * `src` - The source iterable, of chunks of the compressed stream.
+ *
+ * After iteration, `malformed` tells whether decompression stopped at a malformed (or truncated) block.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char); // Defines an IterLz4Decompress(char) struct
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks, `char` or `unsigned char`.
+ *
+ * @note A #Slice(T) and an #Iterator(T), with `T = Slice(T)`, for the given `T` **must** also exist.
+ */
+#define DefineIterLz4Decompress(T)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t blocksize;                                                                                              \
+        unsigned char* in;                                                                                             \
+        unsigned char* out;                                                                                            \
+        size_t inlen;                                                                                                  \
+        /* The rest of the current chunk */                                                                            \
+        Slice(T) chunk;                                                                                                \
+        bool malformed;                                                                                                \
+        Iterable(Slice(T)) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterLz4Decompress(T)
+
+/**
+ * @def define_iterlz4compress_func(T, Name)
+ * @brief Define a function to turn an #IterLz4Compress(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterLz4Compress(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterLz4Compress(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice is a framed block, pointing into the `out` buffer- it is overwritten by the next block.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char);
+ *
+ * // Implement `Iterator` for `IterLz4Compress(char)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_lz4c(IterLz4Compress(char)* x)`
+ * define_iterlz4compress_func(char, wrap_lz4c)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char in[65536], out[ITPL_LZ4_FRAMEBOUND(65536)];
+ * // Compress `chunks` (of type `Iterable(Slice(char))`) in blocks of 64 KiB, and write them to `f`
+ * IterLz4Compress(char) c = {.blocksize = 65536, .in = in, .out = out, .src = chunks};
+ * foreach (Slice(char), blk, wrap_lz4c(&c)) {
+ *     fwrite(blk.ptr, 1, blk.len, f);
+ * }
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterLz4Compress(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterlz4compress_func(T, Name)                                                                           \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterLz4Compress(T), _nxt)(IterLz4Compress(T) * self)                            \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(Slice(T)) const srcit = self->src;                                                                    \
+        size_t const bsz               = self->blocksize;                                                              \
+        while (self->inlen < bsz && !self->done) {                                                                     \
+            if (self->chunk.len == 0) {                                                                                \
+                Maybe(Slice(T)) const res = srcit.tc->next(srcit.self);                                                \
+                self->done                = is_nothing(res);                                                           \
+                self->chunk               = self->done ? self->chunk : from_just_(res);                                \
+                continue;                                                                                              \
+            }                                                                                                          \
+            if (self->inlen == 0 && self->chunk.len >= bsz) {                                                          \
+                /* A whole block in the chunk, compress it where it is */                                              \
+                size_t const n = itpl_lz4_frame((unsigned char const*)self->chunk.ptr, bsz, self->out);                \
+                self->chunk    = SliceOf(self->chunk.ptr + bsz, self->chunk.len - bsz, T);                             \
+                return Just(SliceOf((T const*)self->out, n, T), Slice(T));                                             \
+            }                                                                                                          \
+            size_t const n = self->chunk.len < bsz - self->inlen ? self->chunk.len : bsz - self->inlen;                \
+            memcpy(self->in + self->inlen, self->chunk.ptr, n);                                                        \
+            self->inlen += n;                                                                                          \
+            self->chunk  = SliceOf(self->chunk.ptr + n, self->chunk.len - n, T);                                       \
+        }                                                                                                              \
+        if (self->inlen == 0) {                                                                                        \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        size_t const n = itpl_lz4_frame(self->in, self->inlen, self->out);                                             \
+        self->inlen    = 0;                                                                                            \
+        return Just(SliceOf((T const*)self->out, n, T), Slice(T));                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterLz4Compress(T)*, Slice(T), Name, ITPL_CONCAT(IterLz4Compress(T), _nxt))
+
+/**
+ * @def define_iterlz4decompress_func(T, Name)
+ * @brief Define a function to turn an #IterLz4Decompress(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterLz4Decompress(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterLz4Decompress(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice is a decompressed block, pointing into the `out` buffer (or, for blocks stored uncompressed, the
+ * `in` buffer or the source chunk)- it is only valid until the next block is requested.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char);
+ *
+ * // Implement `Iterator` for `IterLz4Decompress(char)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_lz4d(IterLz4Decompress(char)* x)`
+ * define_iterlz4decompress_func(char, wrap_lz4d)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char in[ITPL_LZ4_FRAMEBOUND(65536)], out[65536];
+ * // Decompress `chunks` (of type `Iterable(Slice(char))`), compressed in blocks of 64 KiB
+ * IterLz4Decompress(char) d = {.blocksize = 65536, .in = in, .out = out, .src = chunks};
+ * Iterable(Slice(char)) raw = wrap_lz4d(&d);
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterLz4Decompress(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterlz4decompress_func(T, Name)                                                                         \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterLz4Decompress(T), _nxt)(IterLz4Decompress(T) * self)                        \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(Slice(T)) const srcit = self->src;                                                                    \
+        unsigned char const* frame     = NULL;                                                                         \
+        size_t datalen                 = 0;                                                                            \
+        bool stored;                                                                                                   \
+        while (frame == NULL) {                                                                                        \
+            if (self->malformed) {                                                                                     \
+                return Nothing(Slice(T));                                                                              \
+            }                                                                                                          \
+            if (self->inlen >= 4) {                                                                                    \
+                datalen = itpl_lz4_framelen(self->in, &stored);                                                        \
+                if (datalen > self->blocksize) {                                                                       \
+                    self->malformed = true;                                                                            \
+                    continue;                                                                                          \
+                }                                                                                                      \
+                if (self->inlen == 4 + datalen) {                                                                      \
+                    frame       = self->in;                                                                            \
+                    self->inlen = 0;                                                                                   \
+                    continue;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->chunk.len == 0) {                                                                                \
+                Maybe(Slice(T)) const res = srcit.tc->next(srcit.self);                                                \
+                if (is_nothing(res)) {                                                                                 \
+                    /* A partial block left over means the stream was truncated */                                     \
+                    self->malformed = self->inlen > 0;                                                                 \
+                    return Nothing(Slice(T));                                                                          \
+                }                                                                                                      \
+                self->chunk = from_just_(res);                                                                         \
+                continue;                                                                                              \
+            }                                                                                                          \
+            unsigned char const* const p = (unsigned char const*)self->chunk.ptr;                                      \
+            if (self->inlen == 0 && self->chunk.len >= 4) {                                                            \
+                datalen = itpl_lz4_framelen(p, &stored);                                                               \
+                if (datalen <= self->blocksize && self->chunk.len - 4 >= datalen) {                                    \
+                    /* A whole block in the chunk, decompress it where it is */                                        \
+                    frame       = p;                                                                                   \
+                    self->chunk = SliceOf(self->chunk.ptr + 4 + datalen, self->chunk.len - 4 - datalen, T);            \
+                    continue;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            size_t const want = self->inlen < 4 ? 4 - self->inlen : 4 + datalen - self->inlen;                         \
+            size_t const n    = self->chunk.len < want ? self->chunk.len : want;                                       \
+            memcpy(self->in + self->inlen, p, n);                                                                      \
+            self->inlen += n;                                                                                          \
+            self->chunk  = SliceOf(self->chunk.ptr + n, self->chunk.len - n, T);                                       \
+        }                                                                                                              \
+        unsigned char const* const blk = itpl_lz4_unframe(frame, self->out, self->blocksize, &datalen);                \
+        if (blk == NULL) {                                                                                             \
+            self->malformed = true;                                                                                    \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        return Just(SliceOf((T const*)blk, datalen, T), Slice(T));                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterLz4Decompress(T)*, Slice(T), Name, ITPL_CONCAT(IterLz4Decompress(T), _nxt))
+
+#endif /* !LIB_ITPLUS_LZ4_H */
@@ -9,4 +9,11 @@
 #define ITPL_CONCAT_(A, B) A##B
 #define ITPL_CONCAT(A, B)  ITPL_CONCAT_(A, B)
 
+/* Hint that the memory at given address will be read soon */
+#if defined(__GNUC__) || defined(__clang__)
+#define ITPL_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define ITPL_PREFETCH(addr) ((void)(addr))
+#endif
+
 #endif /* !LIB_ITPLUS_MACRO_UTILS_H */
@@ -57,6 +57,7 @@
     {                                                                                                                  \
         FnRetType (*f)(ElmntType x);                                                                                   \
         Iterable(ElmntType) src;                                                                                       \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterMap(ElmntType, FnRetType)
 
 /**
@@ -103,10 +104,12 @@
 #define define_itermap_func(ElmntType, FnRetType, Name)                                                                \
     static Maybe(FnRetType) ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt)(IterMap(ElmntType, FnRetType) * self)     \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(ElmntType) const srcit = self->src;                                                                   \
         Maybe(ElmntType) const res      = srcit.tc->next(srcit.self);                                                  \
         return fmap_maybe(res, self->f, FnRetType);                                                                    \
     }                                                                                                                  \
-    impl_iterator(IterMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt))
+    impl_instrumented_iterator(                                                                                        \
+        IterMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt))
 
 #endif /* !LIB_ITPLUS_MAP_H */
@@ -0,0 +1,474 @@
+/**
+ * @file
+ * @brief Macros for implementing a newline delimited JSON record source using the `IterNdjson` struct, and lazy field
+ * accessors.
+ *
+ * An IterNdjson struct is a struct that splits a buffer of NDJSON (one JSON value per line) into its records, yielding
+ * each one as an #ItplJsonRecord- a view of the line in the buffer. JSON strings cannot contain raw newlines, so the
+ * record boundaries are found using `memchr` alone, without looking at the records. Empty lines are skipped.
+ *
+ * Nothing is parsed until it's asked for. For records that are objects, the members at the top level can be looked up
+ * by key using #itpl_json_get, or all indexed at once (to look up many of them) using #itpl_json_index. Either way, a
+ * single pass finds the boundaries of the keys and values at the top level, skipping over nested values without
+ * looking inside them, and no DOM is built. The values are then converted on demand by #itpl_json_as_int,
+ * #itpl_json_as_double, #itpl_json_as_bool and #itpl_json_as_str.
+ *
+ * Keys are compared byte by byte, without decoding escape sequences in them.
+ */
+
+#ifndef LIB_ITPLUS_NDJSON_H
+#define LIB_ITPLUS_NDJSON_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A record (line) of an NDJSON buffer.
+ */
+typedef struct
+{
+    char const* ptr;
+    size_t len;
+} ItplJsonRecord;
+
+/**
+ * @brief A member of a JSON object- views of its key (without the quotes) and its value (as is).
+ */
+typedef struct
+{
+    char const* key;
+    size_t keylen;
+    char const* val;
+    size_t vallen;
+} ItplJsonMember;
+
+static inline size_t itpl_json_ws(char const* s, size_t len, size_t i)
+{
+    while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) {
+        i++;
+    }
+    return i;
+}
+
+/* Skip the string starting at `i`, returning the position after its closing quote, or `SIZE_MAX` */
+static inline size_t itpl_json_skip_str(char const* s, size_t len, size_t i)
+{
+    for (i++; i < len; i++) {
+        if (s[i] == '\\') {
+            i++;
+        } else if (s[i] == '"') {
+            return i + 1;
+        }
+    }
+    return SIZE_MAX;
+}
+
+/* Skip the value starting at `i`, returning the position after it, or `SIZE_MAX` */
+static inline size_t itpl_json_skip_value(char const* s, size_t len, size_t i)
+{
+    if (i == len) {
+        return SIZE_MAX;
+    }
+    if (s[i] == '"') {
+        return itpl_json_skip_str(s, len, i);
+    }
+    if (s[i] == '{' || s[i] == '[') {
+        size_t depth = 0;
+        while (i < len) {
+            char const c = s[i];
+            if (c == '"') {
+                i = itpl_json_skip_str(s, len, i);
+                if (i == SIZE_MAX) {
+                    return SIZE_MAX;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return i + 1;
+            }
+            i++;
+        }
+        return SIZE_MAX;
+    }
+    size_t const start = i;
+    while (i < len && s[i] != ',' && s[i] != '}' && s[i] != ']' && s[i] != ' ' && s[i] != '\t' && s[i] != '\r' &&
+           s[i] != '\n') {
+        i++;
+    }
+    return i > start ? i : SIZE_MAX;
+}
+
+/*
+ * Parse the member of the object in `rec` at `*pos`, which must be 0 for the first member. Returns 1 if a member was
+ * parsed, 0 at the end of the object, and -1 if the record is not a well formed object.
+ */
+static inline int itpl_json_member(ItplJsonRecord rec, size_t* pos, ItplJsonMember* m)
+{
+    char const* const s = rec.ptr;
+    size_t const len    = rec.len;
+    size_t i            = *pos;
+    if (i == 0) {
+        i = itpl_json_ws(s, len, 0);
+        if (i == len || s[i] != '{') {
+            return -1;
+        }
+        i++;
+    }
+    i = itpl_json_ws(s, len, i);
+    if (i < len && s[i] == '}') {
+        return 0;
+    }
+    if (i == len || s[i] != '"') {
+        return -1;
+    }
+    size_t const keyend = itpl_json_skip_str(s, len, i);
+    if (keyend == SIZE_MAX) {
+        return -1;
+    }
+    m->key    = s + i + 1;
+    m->keylen = keyend - i - 2;
+    i         = itpl_json_ws(s, len, keyend);
+    if (i == len || s[i] != ':') {
+        return -1;
+    }
+    i                   = itpl_json_ws(s, len, i + 1);
+    size_t const valend = itpl_json_skip_value(s, len, i);
+    if (valend == SIZE_MAX) {
+        return -1;
+    }
+    m->val    = s + i;
+    m->vallen = valend - i;
+    i         = itpl_json_ws(s, len, valend);
+    if (i < len && s[i] == ',') {
+        *pos = i + 1;
+    } else if (i < len && s[i] == '}') {
+        *pos = i;
+    } else {
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Index the members at the top level of the object in a record.
+ *
+ * @param rec The record.
+ * @param out Where to store the members.
+ * @param cap Maximum number of members to store.
+ *
+ * @return The number of members stored, or `SIZE_MAX` if the record is not a well formed object. Members beyond the
+ * first `cap` are not checked.
+ */
+static inline size_t itpl_json_index(ItplJsonRecord rec, ItplJsonMember* out, size_t cap)
+{
+    size_t pos = 0, n = 0;
+    while (n < cap) {
+        int const res = itpl_json_member(rec, &pos, out + n);
+        if (res < 0) {
+            return SIZE_MAX;
+        }
+        if (res == 0) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Find a member by key in the members indexed by #itpl_json_index.
+ *
+ * @return The member, or `NULL` if there's no member with given key.
+ */
+static inline ItplJsonMember const* itpl_json_find(ItplJsonMember const* members, size_t n, char const* key)
+{
+    size_t const keylen = strlen(key);
+    for (size_t i = 0; i < n; i++) {
+        if (members[i].keylen == keylen && memcmp(members[i].key, key, keylen) == 0) {
+            return members + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Look up a member by key at the top level of the object in a record, scanning only up to that member.
+ *
+ * @return `false` if there's no member with given key, or the record is not a well formed object up to it.
+ */
+static inline bool itpl_json_get(ItplJsonRecord rec, char const* key, ItplJsonMember* out)
+{
+    size_t const keylen = strlen(key);
+    size_t pos          = 0;
+    while (itpl_json_member(rec, &pos, out) > 0) {
+        if (out->keylen == keylen && memcmp(out->key, key, keylen) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Copy a number into a NUL terminated buffer for strtoll/strtod, `false` if it can't be a number */
+static inline bool itpl_json_numbuf(ItplJsonMember const* m, char* buf, size_t size)
+{
+    if (m->vallen == 0 || m->vallen >= size || !(m->val[0] == '-' || (m->val[0] >= '0' && m->val[0] <= '9'))) {
+        return false;
+    }
+    memcpy(buf, m->val, m->vallen);
+    buf[m->vallen] = '\0';
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member to an integer.
+ *
+ * @return `false` if the value is not an integer, or does not fit in a `long long`.
+ */
+static inline bool itpl_json_as_int(ItplJsonMember const* m, long long* out)
+{
+    char buf[32];
+    char* end;
+    if (!itpl_json_numbuf(m, buf, sizeof(buf))) {
+        return false;
+    }
+    errno             = 0;
+    long long const x = strtoll(buf, &end, 10);
+    if (*end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    *out = x;
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member, which must be a number, to a double.
+ *
+ * @note The conversion uses `strtod`, which expects the decimal point of the current locale.
+ */
+static inline bool itpl_json_as_double(ItplJsonMember const* m, double* out)
+{
+    char buf[64];
+    char* end;
+    if (!itpl_json_numbuf(m, buf, sizeof(buf))) {
+        return false;
+    }
+    double const x = strtod(buf, &end);
+    if (*end != '\0') {
+        return false;
+    }
+    *out = x;
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member, which must be `true` or `false`, to a bool.
+ */
+static inline bool itpl_json_as_bool(ItplJsonMember const* m, bool* out)
+{
+    if (m->vallen == 4 && memcmp(m->val, "true", 4) == 0) {
+        *out = true;
+        return true;
+    }
+    if (m->vallen == 5 && memcmp(m->val, "false", 5) == 0) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Get a view of the contents of a string value, without the quotes. Escape sequences are left as is.
+ *
+ * Use #itpl_json_unescape to decode the escape sequences, if the view contains a `\`.
+ */
+static inline bool itpl_json_as_str(ItplJsonMember const* m, char const** ptr, size_t* len)
+{
+    if (m->vallen < 2 || m->val[0] != '"') {
+        return false;
+    }
+    *ptr = m->val + 1;
+    *len = m->vallen - 2;
+    return true;
+}
+
+static inline int itpl_json_hex4(char const* s)
+{
+    int x = 0;
+    for (int i = 0; i < 4; i++) {
+        char const c = s[i];
+        x *= 16;
+        if (c >= '0' && c <= '9') {
+            x += c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            x += c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            x += c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return x;
+}
+
+/**
+ * @brief Decode the escape sequences in the contents of a string, into UTF-8.
+ *
+ * @param s The contents of the string, as obtained from #itpl_json_as_str.
+ * @param len The length of the contents.
+ * @param out Where to write the decoded string, must have room for `len` bytes- decoding never makes it longer.
+ *
+ * @return The length of the decoded string, or `SIZE_MAX` if it contains an invalid escape sequence.
+ */
+static inline size_t itpl_json_unescape(char const* s, size_t len, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] != '\\') {
+            out[n++] = s[i];
+            continue;
+        }
+        if (++i == len) {
+            return SIZE_MAX;
+        }
+        switch (s[i]) {
+        case '"':
+        case '\\':
+        case '/':
+            out[n++] = s[i];
+            continue;
+        case 'b':
+            out[n++] = '\b';
+            continue;
+        case 'f':
+            out[n++] = '\f';
+            continue;
+        case 'n':
+            out[n++] = '\n';
+            continue;
+        case 'r':
+            out[n++] = '\r';
+            continue;
+        case 't':
+            out[n++] = '\t';
+            continue;
+        case 'u':
+            break;
+        default:
+            return SIZE_MAX;
+        }
+        long cp = len - i > 4 ? itpl_json_hex4(s + i + 1) : -1;
+        i += 4;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            /* A high surrogate must be followed by an escaped low surrogate */
+            long const lo = len - i > 6 && s[i + 1] == '\\' && s[i + 2] == 'u' ? itpl_json_hex4(s + i + 3) : -1;
+            if (lo < 0xDC00 || lo > 0xDFFF) {
+                return SIZE_MAX;
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            i += 6;
+        } else if (cp < 0 || (cp >= 0xDC00 && cp <= 0xDFFF)) {
+            return SIZE_MAX;
+        }
+        if (cp < 0x80) {
+            out[n++] = (char)cp;
+        } else if (cp < 0x800) {
+            out[n++] = (char)(0xC0 | (cp >> 6));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out[n++] = (char)(0xE0 | (cp >> 12));
+            out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        } else {
+            out[n++] = (char)(0xF0 | (cp >> 18));
+            out[n++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+            out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief An NDJSON record iterator, yielding `ItplJsonRecord`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to split into records.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    size_t pos;
+    ITPL_STATS_MEMBER
+} IterNdjson;
+
+/**
+ * @def define_iterndjson_func(Name)
+ * @brief Define a function to turn an #IterNdjson into an `Iterable(ItplJsonRecord)`.
+ *
+ * Define the `next` function implementation for the #IterNdjson struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterNdjson*` and wraps it in an `Iterable(ItplJsonRecord)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineMaybe(ItplJsonRecord)
+ * DefineIteratorOf(ItplJsonRecord);
+ *
+ * // Implement `Iterator` for `IterNdjson`
+ * // The defined function has the signature- `Iterable(ItplJsonRecord) wrap_ndjson(IterNdjson* x)`
+ * define_iterndjson_func(wrap_ndjson)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Sum the "bytes" field of the records in `logs` (of type `char const*`), of length `logslen`
+ * long long total = 0;
+ * foreach (ItplJsonRecord, rec, wrap_ndjson(&(IterNdjson){ .buf = logs, .len = logslen })) {
+ *     ItplJsonMember m;
+ *     long long bytes;
+ *     if (itpl_json_get(rec, "bytes", &m) && itpl_json_as_int(&m, &bytes)) {
+ *         total += bytes;
+ *     }
+ * }
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = ItplJsonRecord` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterndjson_func(Name)                                                                                   \
+    static Maybe(ItplJsonRecord) ITPL_CONCAT(Name, _nxt)(IterNdjson * self)                                            \
+    {                                                                                                                  \
+        while (self->pos < self->len) {                                                                                \
+            char const* const start = self->buf + self->pos;                                                           \
+            char const* const nl    = memchr(start, '\n', self->len - self->pos);                                      \
+            size_t len              = nl == NULL ? self->len - self->pos : (size_t)(nl - start);                       \
+            self->pos              += nl == NULL ? len : len + 1;                                                      \
+            if (len > 0 && start[len - 1] == '\r') {                                                                   \
+                len--;                                                                                                 \
+            }                                                                                                          \
+            /* Skip blank lines, including ones with only whitespace */                                                \
+            if (itpl_json_ws(start, len, 0) < len) {                                                                   \
+                return Just(((ItplJsonRecord){.ptr = start, .len = len}), ItplJsonRecord);                             \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(ItplJsonRecord);                                                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterNdjson*, ItplJsonRecord, Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_NDJSON_H */
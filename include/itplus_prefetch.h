@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Macros for implementing software prefetching ahead of a source using the `IterPrefetch` struct.
+ *
+ * An IterPrefetch struct is a struct that yields the same elements as its source iterable, but extracts them `distance`
+ * elements ahead of the one being yielded, into a ring. As each element enters the ring, the memory it references- the
+ * address returned by a function supplied by the caller- is prefetched. By the time the element is yielded, and the
+ * consumer reads through it, the cache line is (hopefully) already on its way- so pointer chasing sources, like
+ * indices or pointers into a large table, no longer stall on a cache miss for every element.
+ *
+ * The distance should cover the memory latency- roughly the latency of a miss divided by the time the consumer spends
+ * on each element. Too short, and the line isn't there in time. Too long, and it may be evicted again before use.
+ */
+
+#ifndef LIB_ITPLUS_PREFETCH_H
+#define LIB_ITPLUS_PREFETCH_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* The largest prefetch distance, i.e the size of the ring */
+#ifndef ITPLUS_PREFETCH_MAX
+#define ITPLUS_PREFETCH_MAX 16
+#endif /* !ITPLUS_PREFETCH_MAX */
+
+/**
+ * @def IterPrefetch(T)
+ * @brief Convenience macro to get the type of the IterPrefetch struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(int);
+ * IterPrefetch(int) i; // Declares a variable of type IterPrefetch(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield. Must be the same type name
+ * passed to #DefineIterPrefetch(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterPrefetch(T) ITPL_CONCAT(IterPrefetch_, T)
+
+/**
+ * @def DefineIterPrefetch(T)
+ * @brief Define an IterPrefetch struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `addr` - The function returning the address an element references.
+ * * `distance` - (Optional) How many elements ahead to prefetch, up to #ITPLUS_PREFETCH_MAX. `0` means the most.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(int); // Defines an IterPrefetch(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterPrefetch(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        void const* (*addr)(T x);                                                                                      \
+        size_t distance;                                                                                               \
+        /* The elements extracted ahead, and the position of the oldest one */                                         \
+        T ring[ITPLUS_PREFETCH_MAX];                                                                                   \
+        size_t head;                                                                                                   \
+        size_t len;                                                                                                    \
+        bool exhausted;                                                                                                \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterPrefetch(T)
+
+/**
+ * @def define_iterprefetch_func(T, Name)
+ * @brief Define a function to turn an #IterPrefetch(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterPrefetch(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterPrefetch(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(uint32_t);
+ *
+ * // Implement `Iterator` for `IterPrefetch(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32prefetch(IterPrefetch(uint32_t)* x)`
+ * define_iterprefetch_func(uint32_t, wrap_u32prefetch)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static void const* row_addr(uint32_t i)
+ * {
+ *     return rows + i;
+ * }
+ * ...
+ * // Prefetch the rows indexed by `idxs` (of type `Iterable(uint32_t)`) 8 indices ahead of their lookup
+ * Iterable(uint32_t) ahead =
+ *     wrap_u32prefetch(&(IterPrefetch(uint32_t)){.addr = row_addr, .distance = 8, .src = idxs});
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to `distance` elements are extracted from the source ahead of the element being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterPrefetch(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterprefetch_func(T, Name)                                                                              \
+    static Maybe(T) ITPL_CONCAT(IterPrefetch(T), _nxt)(IterPrefetch(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        size_t distance         = self->distance;                                                                      \
+        if (distance == 0 || distance > ITPLUS_PREFETCH_MAX) {                                                         \
+            distance = ITPLUS_PREFETCH_MAX;                                                                            \
+        }                                                                                                              \
+        /* Top up the ring- all at once on the first call, then one element per element yielded */                     \
+        while (!self->exhausted && self->len < distance) {                                                             \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                self->exhausted = true;                                                                                \
+                break;                                                                                                 \
+            }                                                                                                          \
+            T const y = from_just_(res);                                                                               \
+            ITPL_PREFETCH(self->addr(y));                                                                              \
+            self->ring[(self->head + self->len) % ITPLUS_PREFETCH_MAX]  = y;                                           \
+            self->len                                                 += 1;                                            \
+        }                                                                                                              \
+        if (self->len == 0) {                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T const x   = self->ring[self->head];                                                                          \
+        self->head  = (self->head + 1) % ITPLUS_PREFETCH_MAX;                                                          \
+        self->len  -= 1;                                                                                               \
+        return Just(x, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterPrefetch(T)*, T, Name, ITPL_CONCAT(IterPrefetch(T), _nxt))
+
+#endif /* !LIB_ITPLUS_PREFETCH_H */
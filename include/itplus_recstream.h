@@ -0,0 +1,509 @@
+/**
+ * @file
+ * @brief Utilities for persisting iterables to a binary record stream, and streaming them back.
+ *
+ * A record stream is a versioned binary format made of a file header, followed by any number of blocks of records.
+ * Records are either all of the same size (e.g `sizeof(T)`, recorded in the file header), or each prefixed by its own
+ * length. Every block starts with a header containing the number of records in it, the size of its payload, and
+ * (optionally) an FNV-1a checksum of its payload.
+ *
+ * Everything is padded to 8 bytes, so as long as the stream itself is read into (or `mmap`-ed to) an 8 byte aligned
+ * address, so is every block and every variable length record. Integers are stored in the native byte order, which is
+ * checked when reading- a stream is meant to be read back on the same kind of machine it was written on.
+ *
+ * Streams are written through an #ItplRecWriter, which buffers records into blocks in a caller supplied buffer and
+ * writes whole blocks to a `FILE*`. They're read from a buffer in memory through an #ItplRecReader, which validates the
+ * headers (and checksums) as it goes, and serves records as pointers into the buffer without copying them.
+ *
+ * Layout-
+ * * File header (24 bytes) - `"ITPLREC"` (8 bytes, with the NUL), version, byte order mark `0x01020304`, record size
+ *   (`0` for variable length records) and flags- each a `uint32_t`.
+ * * Block header (16 bytes) - block magic `0x4B4C4249`, number of records, payload size and checksum (`0` if the
+ *   stream is not checksummed)- each a `uint32_t`.
+ * * Block payload - the records, back to back. Fixed size records are not padded individually, variable length
+ *   records are each prefixed by their length as a `uint32_t` followed by 4 reserved bytes, and padded to 8 bytes.
+ *   The payload as a whole is padded to 8 bytes.
+ */
+
+#ifndef LIB_ITPLUS_RECSTREAM_H
+#define LIB_ITPLUS_RECSTREAM_H
+
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @def ITPL_REC_VERSION
+ * @brief The version of the record stream format written, and the only one read.
+ */
+#define ITPL_REC_VERSION 1U
+
+/**
+ * @def ITPL_REC_CHECKSUM
+ * @brief Flag of a record stream with checksummed blocks.
+ */
+#define ITPL_REC_CHECKSUM 1U
+
+#define ITPL_REC_MAGIC     "ITPLREC"
+#define ITPL_REC_BOM       0x01020304U
+#define ITPL_REC_BLKMAGIC  0x4B4C4249U
+#define ITPL_REC_FILEHDRSZ 24U
+#define ITPL_REC_BLKHDRSZ  16U
+
+/* Round up to a multiple of 8 */
+#define ITPL_REC_PAD(n) (((n) + 7U) & ~(size_t)7U)
+
+/**
+ * @brief Writer of a record stream.
+ *
+ * The members to be filled in by the caller are-
+ * * `f` - The file to write to.
+ * * `buf`, `cap` - The buffer to build blocks in. Its size is the (maximum) size of a block's payload. Records that
+ *   don't fit into it on their own are written as a block of their own.
+ * * `elsize` - The size of every record, or `0` for variable length records.
+ * * `checksum` - (Optional) Whether to checksum the blocks.
+ *
+ * The file header is written along with the first block. `failed` is set once any write fails, after which nothing
+ * else is written.
+ */
+typedef struct
+{
+    FILE* f;
+    unsigned char* buf;
+    size_t cap;
+    uint32_t elsize;
+    bool checksum;
+    size_t len;
+    uint32_t count;
+    bool started;
+    bool failed;
+} ItplRecWriter;
+
+/**
+ * @brief Reader of a record stream in memory.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The stream.
+ *
+ * `corrupt` is set once the stream is found to be malformed (or of a different version or byte order), after which no
+ * more records are read.
+ */
+typedef struct
+{
+    unsigned char const* buf;
+    size_t len;
+    size_t pos;
+    uint32_t elsize;
+    uint32_t flags;
+    /* Records left in the current block, and where it ends */
+    uint32_t left;
+    size_t end;
+    bool corrupt;
+} ItplRecReader;
+
+/**
+ * @brief Continue an FNV-1a hash of some bytes. Start with `2166136261`.
+ */
+static inline uint32_t itpl_rec_fnv1a(uint32_t h, void const* data, size_t len)
+{
+    unsigned char const* const p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    return h;
+}
+
+static inline uint32_t itpl_rec_u32(unsigned char const* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline void itpl_rec_put_u32(unsigned char* p, uint32_t x) { memcpy(p, &x, sizeof(x)); }
+
+static inline bool itpl_rec_write(ItplRecWriter* w, void const* data, size_t len)
+{
+    if (!w->failed && len > 0 && fwrite(data, 1, len, w->f) != len) {
+        w->failed = true;
+    }
+    return !w->failed;
+}
+
+/* Write the file header, if it hasn't been already */
+static inline bool itpl_rec_start(ItplRecWriter* w)
+{
+    if (w->started) {
+        return !w->failed;
+    }
+    unsigned char hdr[ITPL_REC_FILEHDRSZ] = ITPL_REC_MAGIC;
+    itpl_rec_put_u32(hdr + 8, ITPL_REC_VERSION);
+    itpl_rec_put_u32(hdr + 12, ITPL_REC_BOM);
+    itpl_rec_put_u32(hdr + 16, w->elsize);
+    itpl_rec_put_u32(hdr + 20, w->checksum ? ITPL_REC_CHECKSUM : 0);
+    w->started = true;
+    return itpl_rec_write(w, hdr, sizeof(hdr));
+}
+
+/* Write a block made of (up to) two pieces of payload, which are padded to 8 bytes */
+static inline bool itpl_rec_block(ItplRecWriter* w, uint32_t count, void const* a, size_t alen, void const* b,
+    size_t blen)
+{
+    static unsigned char const zeros[8] = {0};
+    size_t const size                   = ITPL_REC_PAD(alen + blen);
+    unsigned char hdr[ITPL_REC_BLKHDRSZ];
+    uint32_t sum = 0;
+    if (w->checksum) {
+        sum = itpl_rec_fnv1a(itpl_rec_fnv1a(2166136261U, a, alen), b, blen);
+        sum = itpl_rec_fnv1a(sum, zeros, size - alen - blen);
+    }
+    itpl_rec_put_u32(hdr, ITPL_REC_BLKMAGIC);
+    itpl_rec_put_u32(hdr + 4, count);
+    itpl_rec_put_u32(hdr + 8, (uint32_t)size);
+    itpl_rec_put_u32(hdr + 12, sum);
+    return itpl_rec_start(w) && itpl_rec_write(w, hdr, sizeof(hdr)) && itpl_rec_write(w, a, alen) &&
+           itpl_rec_write(w, b, blen) && itpl_rec_write(w, zeros, size - alen - blen);
+}
+
+/**
+ * @brief Write the buffered records as a block, and flush the file.
+ *
+ * Also writes the file header if nothing has been written yet, so an empty stream is still a valid one.
+ *
+ * @return `false` if any write has failed.
+ */
+static inline bool itpl_rec_flush(ItplRecWriter* w)
+{
+    if (w->count > 0 && !itpl_rec_block(w, w->count, w->buf, w->len, NULL, 0)) {
+        return false;
+    }
+    w->len   = 0;
+    w->count = 0;
+    if (!itpl_rec_start(w) || fflush(w->f) != 0) {
+        w->failed = true;
+    }
+    return !w->failed;
+}
+
+/**
+ * @brief Add a record to the stream.
+ *
+ * @param w The writer.
+ * @param rec The record.
+ * @param len Length of the record, must be equal to `w->elsize` for streams of fixed size records.
+ *
+ * @return `false` if the record is too large (or of the wrong size), or any write has failed.
+ */
+static inline bool itpl_rec_put(ItplRecWriter* w, void const* rec, size_t len)
+{
+    if ((w->elsize != 0 && len != w->elsize) || len > UINT32_MAX - 16U) {
+        return false;
+    }
+    size_t const need = w->elsize != 0 ? len : 8 + ITPL_REC_PAD(len);
+    if (need > w->cap - w->len && w->count > 0 && !itpl_rec_flush(w)) {
+        return false;
+    }
+    unsigned char prefix[8] = {0};
+    itpl_rec_put_u32(prefix, (uint32_t)len);
+    if (need > w->cap) {
+        /* Too large for the buffer, write it as a block of its own */
+        return w->elsize != 0 ? itpl_rec_block(w, 1, rec, len, NULL, 0)
+                              : itpl_rec_block(w, 1, prefix, sizeof(prefix), rec, len);
+    }
+    if (w->elsize == 0) {
+        memcpy(w->buf + w->len, prefix, sizeof(prefix));
+        memset(w->buf + w->len + 8 + len, 0, need - 8 - len);
+        w->len += 8;
+    }
+    memcpy(w->buf + w->len, rec, len);
+    w->len += w->elsize != 0 ? len : need - 8;
+    ++(w->count);
+    return !w->failed;
+}
+
+/* Enter the next block of the stream, verifying its header */
+static inline bool itpl_rec_enter(ItplRecReader* r)
+{
+    unsigned char const* const hdr = r->buf + r->pos;
+    if (r->len - r->pos < ITPL_REC_BLKHDRSZ || itpl_rec_u32(hdr) != ITPL_REC_BLKMAGIC) {
+        return false;
+    }
+    uint32_t const count = itpl_rec_u32(hdr + 4);
+    uint32_t const size  = itpl_rec_u32(hdr + 8);
+    if (size % 8 != 0 || size > r->len - r->pos - ITPL_REC_BLKHDRSZ ||
+        (r->elsize != 0 && (uint64_t)count * r->elsize > size)) {
+        return false;
+    }
+    if ((r->flags & ITPL_REC_CHECKSUM) != 0 &&
+        itpl_rec_fnv1a(2166136261U, hdr + ITPL_REC_BLKHDRSZ, size) != itpl_rec_u32(hdr + 12)) {
+        return false;
+    }
+    r->pos += ITPL_REC_BLKHDRSZ;
+    r->end  = r->pos + size;
+    r->left = count;
+    if (count == 0) {
+        r->pos = r->end;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the next record of a stream.
+ *
+ * @param r The reader.
+ * @param rec Where to store the pointer to the record, into the stream.
+ * @param len Where to store the length of the record.
+ *
+ * @return `false` if there are no more records, or the stream is malformed- in which case `r->corrupt` is set.
+ */
+static inline bool itpl_rec_next(ItplRecReader* r, unsigned char const** rec, size_t* len)
+{
+    if (r->corrupt) {
+        return false;
+    }
+    if (r->pos == 0) {
+        if (r->len < ITPL_REC_FILEHDRSZ || memcmp(r->buf, ITPL_REC_MAGIC, 8) != 0 ||
+            itpl_rec_u32(r->buf + 8) != ITPL_REC_VERSION || itpl_rec_u32(r->buf + 12) != ITPL_REC_BOM) {
+            r->corrupt = true;
+            return false;
+        }
+        r->elsize = itpl_rec_u32(r->buf + 16);
+        r->flags  = itpl_rec_u32(r->buf + 20);
+        r->pos    = ITPL_REC_FILEHDRSZ;
+    }
+    while (r->left == 0) {
+        if (r->pos == r->len) {
+            return false;
+        }
+        if (!itpl_rec_enter(r)) {
+            r->corrupt = true;
+            return false;
+        }
+    }
+    size_t size = r->elsize;
+    if (size == 0) {
+        if (r->end - r->pos < 8 || itpl_rec_u32(r->buf + r->pos) > r->end - r->pos - 8) {
+            r->corrupt = true;
+            return false;
+        }
+        *len = itpl_rec_u32(r->buf + r->pos);
+        *rec = r->buf + r->pos + 8;
+        size = 8 + *len;
+    } else {
+        *len = size;
+        *rec = r->buf + r->pos;
+    }
+    r->pos = --(r->left) == 0 ? r->end : r->pos + (r->elsize == 0 ? ITPL_REC_PAD(size) : size);
+    return true;
+}
+
+/**
+ * @def define_recwrite_func(T, Name)
+ * @brief Define the `write_to` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, and a writer of a stream of records of size `sizeof(T)`. It
+ * adds every element of the iterable to the stream, and flushes it.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature- `bool write_ints(Iterable(int) it, ItplRecWriter* w)`
+ * define_recwrite_func(int, write_ints)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char blk[65536];
+ * ItplRecWriter w = {.f = f, .buf = blk, .cap = sizeof(blk), .elsize = sizeof(int), .checksum = true};
+ * // Write `it` (of type `Iterable(int)`) to `f` (of type `FILE*`)
+ * if (!write_ints(it, &w)) {
+ *     // Handle the failed write
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if any write has failed.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_recwrite_func(T, Name)                                                                                  \
+    bool Name(Iterable(T) it, ItplRecWriter* w)                                                                        \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            if (!itpl_rec_put(w, &x, sizeof(x))) {                                                                     \
+                return false;                                                                                          \
+            }                                                                                                          \
+        }                                                                                                              \
+        return itpl_rec_flush(w);                                                                                      \
+    }
+
+/**
+ * @def IterRecRead(T)
+ * @brief Convenience macro to get the type of the IterRecRead struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int);
+ * IterRecRead(int) i; // Declares a variable of type IterRecRead(int)
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield. Must be the same type name passed to #DefineIterRecRead(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterRecRead(T) ITPL_CONCAT(IterRecRead_, T)
+
+/**
+ * @def DefineIterRecRead(T)
+ * @brief Define an IterRecRead struct that reads `T`s from a record stream.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `rd` - The reader of the stream, whose records must be of size `sizeof(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int); // Defines an IterRecRead(int) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterRecRead(T)                                                                                           \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        ItplRecReader rd;                                                                                              \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterRecRead(T)
+
+/**
+ * @def define_iterrecread_func(T, Name)
+ * @brief Define a function to turn an #IterRecRead(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterRecRead(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterRecRead(T)*` and wraps it in an `Iterable(T)`. The records are
+ * copied out of the stream as they're yielded, so the stream does not need to be aligned for `T`. A stream of records
+ * of any size other than `sizeof(T)` is treated as corrupt.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int);
+ *
+ * // Implement `Iterator` for `IterRecRead(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intrecread(IterRecRead(int)* x)`
+ * define_iterrecread_func(int, wrap_intrecread)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Read back the ints in `data` (of type `unsigned char const*`), of length `datalen`
+ * IterRecRead(int) r = {.rd = {.buf = data, .len = datalen}};
+ * Iterable(int) it   = wrap_intrecread(&r);
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterRecRead(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterrecread_func(T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(IterRecRead(T), _nxt)(IterRecRead(T) * self)                                           \
+    {                                                                                                                  \
+        unsigned char const* rec;                                                                                      \
+        size_t len;                                                                                                    \
+        if (!itpl_rec_next(&self->rd, &rec, &len)) {                                                                   \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (len != sizeof(T)) {                                                                                        \
+            self->rd.corrupt = true;                                                                                   \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T x;                                                                                                           \
+        memcpy(&x, rec, sizeof(x));                                                                                    \
+        return Just(x, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterRecRead(T)*, T, Name, ITPL_CONCAT(IterRecRead(T), _nxt))
+
+/**
+ * @brief A record stream iterator, yielding each record as a `Slice(char)` into the stream.
+ *
+ * The members to be filled in by the caller are-
+ * * `rd` - The reader of the stream, whose records may be of any size.
+ */
+typedef struct
+{
+    ItplRecReader rd;
+    ITPL_STATS_MEMBER
+} IterRecBytes;
+
+/**
+ * @def define_iterrecbytes_func(Name)
+ * @brief Define a function to turn an #IterRecBytes into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterRecBytes struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterRecBytes*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterRecBytes`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_recbytes(IterRecBytes* x)`
+ * define_iterrecbytes_func(wrap_recbytes)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Read back the records in `data` (of type `unsigned char const*`), of length `datalen`
+ * IterRecBytes r                = {.rd = {.buf = data, .len = datalen}};
+ * Iterable(Slice(char)) records = wrap_recbytes(&r);
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterrecbytes_func(Name)                                                                                 \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterRecBytes * self)                                             \
+    {                                                                                                                  \
+        unsigned char const* rec;                                                                                      \
+        size_t len;                                                                                                    \
+        if (!itpl_rec_next(&self->rd, &rec, &len)) {                                                                   \
+            return Nothing(Slice(char));                                                                               \
+        }                                                                                                              \
+        return Just(SliceOf((char const*)rec, len, char), Slice(char));                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterRecBytes*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_RECSTREAM_H */
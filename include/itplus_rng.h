@@ -0,0 +1,84 @@
+/**
+ * @file
+ * A small, fast, seedable pseudo random number generator for the randomized iterplus utilities.
+ *
+ * The generator is xoshiro256** (https://prng.di.unimi.it/), seeded through splitmix64. It is not cryptographically
+ * secure. The state is a plain struct owned by the caller, so there is no global state, and the same seed always
+ * produces the same sequence.
+ */
+
+#ifndef LIB_ITPLUS_RNG_H
+#define LIB_ITPLUS_RNG_H
+
+#include <stdint.h>
+
+/* State of the xoshiro256** generator, must not be all zero - use `itpl_rng_seed` to create one */
+typedef struct
+{
+    uint64_t s[4];
+} ItplRng;
+
+static inline uint64_t itpl_rng_rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+/**
+ * @brief Create a generator state from a 64 bit seed.
+ */
+static inline ItplRng itpl_rng_seed(uint64_t seed)
+{
+    ItplRng rng;
+    for (int i = 0; i < 4; i++) {
+        /* splitmix64 */
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        rng.s[i]   = z ^ (z >> 31);
+    }
+    return rng;
+}
+
+/**
+ * @brief Generate a uniformly distributed 64 bit integer.
+ */
+static inline uint64_t itpl_rng_next(ItplRng* rng)
+{
+    uint64_t* const s  = rng->s;
+    uint64_t const res = itpl_rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t const t   = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = itpl_rng_rotl(s[3], 45);
+    return res;
+}
+
+/**
+ * @brief Generate a uniformly distributed double in the range (0, 1].
+ */
+static inline double itpl_rng_unit(ItplRng* rng)
+{
+    return (double)((itpl_rng_next(rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Generate a uniformly distributed integer in the range [0, n).
+ *
+ * The range is empty when `n` is 0- in which case 0 is returned, without advancing the generator.
+ */
+static inline uint64_t itpl_rng_below(ItplRng* rng, uint64_t n)
+{
+    if (n == 0) {
+        return 0;
+    }
+    /* Reject the values that would make the lowest residues more likely */
+    uint64_t const threshold = (0 - n) % n;
+    while (1) {
+        uint64_t const x = itpl_rng_next(rng);
+        if (x >= threshold) {
+            return x % n;
+        }
+    }
+}
+
+#endif /* !LIB_ITPLUS_RNG_H */
@@ -0,0 +1,214 @@
+/**
+ * @file
+ * @brief Macros for implementing Bernoulli sampling using the `IterSample` struct, and reservoir sampling.
+ *
+ * An IterSample struct is a struct that keeps each element of its source iterable, independently, with a fixed
+ * probability `p`. Instead of drawing a random number for every element, the number of elements to skip until the
+ * next kept one is drawn directly from the geometric distribution- so the generator is only used once per *kept*
+ * element. Skipped elements are still extracted from the source, but are otherwise untouched.
+ *
+ * Reservoir sampling picks `k` elements uniformly at random from an iterable of unknown length, in one pass. It uses
+ * Algorithm L (Li, 1994), which also draws skip lengths instead of a random number per element.
+ *
+ * Randomness comes from an #ItplRng owned by the caller (see itplus_rng.h).
+ */
+
+#ifndef LIB_ITPLUS_SAMPLE_H
+#define LIB_ITPLUS_SAMPLE_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_rng.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Draw the number of elements to skip before the next success, given the log of the probability of failure */
+static inline size_t itpl_sample_skip(ItplRng* rng, double lnfail)
+{
+    double const skip = floor(log(itpl_rng_unit(rng)) / lnfail);
+    return skip >= (double)SIZE_MAX ? SIZE_MAX : (size_t)skip;
+}
+
+/**
+ * @def IterSample(T)
+ * @brief Convenience macro to get the type of the IterSample struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int);
+ * IterSample(int) i; // Declares a variable of type IterSample(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield. Must be the same type name passed
+ * to #DefineIterSample(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterSample(T) ITPL_CONCAT(IterSample_, T)
+
+/**
+ * @def DefineIterSample(T)
+ * @brief Define an IterSample struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `p` - The probability of keeping each element.
+ * * `rng` - The random number generator state.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int); // Defines an IterSample(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterSample(T)                                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        double p;                                                                                                      \
+        ItplRng rng;                                                                                                   \
+        bool started;                                                                                                  \
+        /* Log of the probability of skipping an element */                                                            \
+        double lnfail;                                                                                                 \
+        /* Number of elements to skip before the next kept one */                                                      \
+        size_t skip;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterSample(T)
+
+/**
+ * @def define_itersample_func(T, Name)
+ * @brief Define a function to turn an #IterSample(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterSample(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterSample(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int);
+ *
+ * // Implement `Iterator` for `IterSample(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intsample(IterSample(int)* x)`
+ * define_itersample_func(int, wrap_intsample)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Keep roughly 1% of the elements in `it` (of type `Iterable(int)`)
+ * Iterable(int) sample = wrap_intsample(&(IterSample(int)){ .p = 0.01, .rng = itpl_rng_seed(42), .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterSample(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersample_func(T, Name)                                                                                \
+    static Maybe(T) ITPL_CONCAT(IterSample(T), _nxt)(IterSample(T) * self)                                             \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!(self->p > 0)) {                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->lnfail  = self->p < 1 ? log1p(-self->p) : -INFINITY;                                                 \
+            self->skip    = itpl_sample_skip(&self->rng, self->lnfail);                                                \
+        }                                                                                                              \
+        for (; self->skip > 0; --(self->skip)) {                                                                       \
+            if (is_nothing(srcit.tc->next(srcit.self))) {                                                              \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_just(res)) {                                                                                            \
+            self->skip = itpl_sample_skip(&self->rng, self->lnfail);                                                   \
+        }                                                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterSample(T)*, T, Name, ITPL_CONCAT(IterSample(T), _nxt))
+
+/**
+ * @def define_iterreservoir_func(T, Name)
+ * @brief Define the reservoir sampling function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, an output buffer of at least `k` elements, `k`, and a random
+ * number generator, and writes `k` elements picked uniformly at random from the iterable (or all of them, if there are
+ * fewer) into the buffer. The number of elements written is returned. The order of the elements in the buffer is
+ * unspecified.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `size_t reservoir_int(Iterable(int) it, int* out, size_t k, ItplRng* rng)`
+ * define_iterreservoir_func(int, reservoir_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Pick 100 random elements from `it` (of type `Iterable(int)`)
+ * int picked[100];
+ * ItplRng rng    = itpl_rng_seed(42);
+ * size_t const n = reservoir_int(it, picked, 100, &rng);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_iterreservoir_func(T, Name)                                                                             \
+    size_t Name(Iterable(T) it, T* out, size_t k, ItplRng* rng)                                                        \
+    {                                                                                                                  \
+        size_t n = 0;                                                                                                  \
+        if (k == 0) {                                                                                                  \
+            return 0;                                                                                                  \
+        }                                                                                                              \
+        for (; n < k; n++) {                                                                                           \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                return n;                                                                                              \
+            }                                                                                                          \
+            out[n] = from_just_(res);                                                                                  \
+        }                                                                                                              \
+        /* `w` is the largest of `k` random numbers in (0, 1], each element is given one and the smallest `k` kept */  \
+        double w = exp(log(itpl_rng_unit(rng)) / (double)k);                                                           \
+        while (1) {                                                                                                    \
+            for (size_t skip = itpl_sample_skip(rng, log1p(-w)); skip > 0; skip--) {                                   \
+                if (is_nothing(it.tc->next(it.self))) {                                                                \
+                    return n;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                return n;                                                                                              \
+            }                                                                                                          \
+            out[itpl_rng_below(rng, k)] = from_just_(res);                                                             \
+            w *= exp(log(itpl_rng_unit(rng)) / (double)k);                                                             \
+        }                                                                                                              \
+    }
+
+#endif /* !LIB_ITPLUS_SAMPLE_H */
@@ -0,0 +1,419 @@
+/**
+ * @file
+ * @brief Macros for implementing semi joins using the `IterSemiJoin` struct, and the key set it probes.
+ *
+ * An IterSemiJoin struct is a struct that yields only the elements of its source iterable whose key is present in a
+ * #ItplKeySet, built beforehand from another iterable. Keys are unsigned 64 bit integers extracted from the elements
+ * by a function supplied by the caller- for other kinds of keys, a hash of the key can be used along with an exact
+ * check by the consumer.
+ *
+ * The set picks its representation when it is built-
+ * * If the keys are dense (their range is small compared to their count), the set is a plain bitmap over that range.
+ *   Probes are exact, and cost a single bit test.
+ * * Otherwise, the set is a split block Bloom filter. Every key sets (and every probe tests) one bit in each of the 8
+ *   words of a single 64 byte block, so a probe touches exactly one cache line. Probes may have false positives, which
+ *   are removed by a binary search over the sorted keys if the set was built with `exact`.
+ *
+ * IterSemiJoin extracts elements from its source in batches of #ITPLUS_SEMIJOIN_BATCH. The cache lines for the whole
+ * batch are prefetched before any of them is tested, so the memory latency of the probes overlaps instead of adding up.
+ */
+
+#ifndef LIB_ITPLUS_SEMIJOIN_H
+#define LIB_ITPLUS_SEMIJOIN_H
+
+#include "itplus_foreach.h"
+#include "itplus_hash.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef ITPLUS_SEMIJOIN_BATCH
+#define ITPLUS_SEMIJOIN_BATCH 32
+#endif /* !ITPLUS_SEMIJOIN_BATCH */
+
+#ifndef ITPLUS_BLOOM_BITS_PER_KEY
+#define ITPLUS_BLOOM_BITS_PER_KEY 16
+#endif /* !ITPLUS_BLOOM_BITS_PER_KEY */
+
+/* Number of 64 bit words in a bloom filter block- one cache line */
+#define ITPL_BLOOM_BLOCK_WORDS 8
+
+/**
+ * @brief A set of 64 bit keys, either a dense bitmap or a blocked Bloom filter.
+ *
+ * Build one using a function defined by #define_semijoin_build_func(T, Name), and free it using #itpl_keyset_free.
+ */
+typedef struct
+{
+    /* The bitmap, or the blocks of the bloom filter */
+    uint64_t* words;
+    /* Bitmap- number of bits in the bitmap. Bloom filter- number of blocks minus 1 (a power of 2 minus 1) */
+    uint64_t mask;
+    /* Bitmap- the smallest key */
+    uint64_t min;
+    /* Bloom filter with exact checks- the sorted keys, with duplicates removed */
+    uint64_t* keys;
+    size_t len;
+    bool dense;
+} ItplKeySet;
+
+/* Pick the bit to set in the `i`th word of a block, using the multipliers of the split block Bloom filter of Parquet */
+static inline uint64_t itpl_bloom_bit(uint32_t upper, unsigned i)
+{
+    static uint32_t const salt[ITPL_BLOOM_BLOCK_WORDS] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    return (uint64_t)1 << ((uint32_t)(upper * salt[i]) >> 26);
+}
+
+/**
+ * @brief Get the block of a bloom filter a key with given hash lives in.
+ */
+static inline uint64_t* itpl_bloom_block(ItplKeySet const* set, uint64_t h)
+{
+    return set->words + (h & set->mask) * ITPL_BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * @brief Get the address of the cache line a probe for given key will touch.
+ */
+static inline void const* itpl_keyset_line(ItplKeySet const* set, uint64_t key)
+{
+    if (set->dense) {
+        uint64_t const bit = key - set->min;
+        return bit < set->mask ? set->words + bit / 64 : set->words;
+    }
+    return itpl_bloom_block(set, itpl_hash_u64(key));
+}
+
+static inline void itpl_bloom_add(ItplKeySet* set, uint64_t h)
+{
+    uint64_t* const block = itpl_bloom_block(set, h);
+    uint32_t const upper  = (uint32_t)(h >> 32);
+    for (unsigned i = 0; i < ITPL_BLOOM_BLOCK_WORDS; i++) {
+        block[i] |= itpl_bloom_bit(upper, i);
+    }
+}
+
+static inline bool itpl_bloom_has(ItplKeySet const* set, uint64_t h)
+{
+    uint64_t const* const block = itpl_bloom_block(set, h);
+    uint32_t const upper        = (uint32_t)(h >> 32);
+    /* No early exit- the 8 independent tests are cheaper than the branches, and can be vectorized */
+    uint64_t missing = 0;
+    for (unsigned i = 0; i < ITPL_BLOOM_BLOCK_WORDS; i++) {
+        missing |= ~block[i] & itpl_bloom_bit(upper, i);
+    }
+    return missing == 0;
+}
+
+static inline int itpl_keyset_cmp(void const* a, void const* b)
+{
+    uint64_t const x = *(uint64_t const*)a;
+    uint64_t const y = *(uint64_t const*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Build a key set from an array of `len` keys, allocated with `malloc`.
+ *
+ * The set takes ownership of the array- it is either kept for exact checks, or freed.
+ *
+ * @return `false` if memory could not be allocated, in which case the array is freed and the set is left empty.
+ */
+static inline bool itpl_keyset_build(ItplKeySet* set, uint64_t* keys, size_t len, bool exact)
+{
+    *set = (ItplKeySet){0};
+    if (len == 0) {
+        free(keys);
+        set->dense = true;
+        return true;
+    }
+    uint64_t min = keys[0], max = keys[0];
+    for (size_t i = 1; i < len; i++) {
+        min = keys[i] < min ? keys[i] : min;
+        max = keys[i] > max ? keys[i] : max;
+    }
+    uint64_t const budget = (uint64_t)len * ITPLUS_BLOOM_BITS_PER_KEY;
+    if (max - min < budget) {
+        /* A bitmap over the range of the keys is no larger than the bloom filter, and exact */
+        set->words = calloc((max - min) / 64 + 1, sizeof(*set->words));
+        if (set->words == NULL) {
+            free(keys);
+            return false;
+        }
+        set->dense = true;
+        set->min   = min;
+        set->mask  = max - min + 1;
+        for (size_t i = 0; i < len; i++) {
+            uint64_t const bit = keys[i] - min;
+            set->words[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+        free(keys);
+        return true;
+    }
+    size_t nblocks = 1;
+    while (nblocks * ITPL_BLOOM_BLOCK_WORDS * 64 < budget) {
+        nblocks *= 2;
+    }
+    set->words = calloc(nblocks * ITPL_BLOOM_BLOCK_WORDS, sizeof(*set->words));
+    if (set->words == NULL) {
+        free(keys);
+        return false;
+    }
+    set->mask = nblocks - 1;
+    for (size_t i = 0; i < len; i++) {
+        itpl_bloom_add(set, itpl_hash_u64(keys[i]));
+    }
+    if (!exact) {
+        free(keys);
+        return true;
+    }
+    qsort(keys, len, sizeof(*keys), itpl_keyset_cmp);
+    size_t uniq = 1;
+    for (size_t i = 1; i < len; i++) {
+        if (keys[i] != keys[uniq - 1]) {
+            keys[uniq++] = keys[i];
+        }
+    }
+    set->keys = keys;
+    set->len  = uniq;
+    return true;
+}
+
+/**
+ * @brief Check whether a key is present in a key set.
+ *
+ * Sets built without `exact` may return `true` for keys that are not present, at a rate of around 0.1% or less with
+ * the default #ITPLUS_BLOOM_BITS_PER_KEY. Keys that are present are always found.
+ */
+static inline bool itpl_keyset_has(ItplKeySet const* set, uint64_t key)
+{
+    if (set->dense) {
+        uint64_t const bit = key - set->min;
+        return bit < set->mask && (set->words[bit / 64] >> (bit % 64) & 1);
+    }
+    if (!itpl_bloom_has(set, itpl_hash_u64(key))) {
+        return false;
+    }
+    if (set->keys == NULL) {
+        return true;
+    }
+    size_t lo = 0, hi = set->len;
+    while (lo < hi) {
+        size_t const mid = lo + (hi - lo) / 2;
+        if (set->keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < set->len && set->keys[lo] == key;
+}
+
+/**
+ * @brief Free the memory held by a key set.
+ */
+static inline void itpl_keyset_free(ItplKeySet* set)
+{
+    free(set->words);
+    free(set->keys);
+    *set = (ItplKeySet){0};
+}
+
+/**
+ * @def define_semijoin_build_func(T, Name)
+ * @brief Define a function to build an #ItplKeySet from the keys of an iterable's elements.
+ *
+ * The defined function takes in an iterable of type `T`, a pointer to the set to build, a key function of type
+ * `uint64_t (*key)(T x)`, and whether probes should be exact. Exact probes keep a sorted copy of the keys around, but
+ * only if the keys are not dense enough for a bitmap- bitmaps are always exact.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { uint32_t id; double score; } Row;
+ *
+ * // The defined function has the signature:-
+ * // `bool build_rowset(Iterable(Row) it, ItplKeySet* set, uint64_t (*key)(Row x), bool exact)`
+ * define_semijoin_build_func(Row, build_rowset)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t row_id(Row x) { return x.id; }
+ * @endcode
+ *
+ * @code
+ * ItplKeySet ids;
+ * // Build a set of the ids of the rows in `it` (of type `Iterable(Row)`)
+ * if (!build_rowset(it, &ids, row_id, true)) {
+ *     // Out of memory
+ * }
+ * ...
+ * itpl_keyset_free(&ids);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note The function returns `false`, and leaves the set empty, if memory could not be allocated.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_semijoin_build_func(T, Name)                                                                            \
+    bool Name(Iterable(T) it, ItplKeySet* set, uint64_t (*key)(T x), bool exact)                                       \
+    {                                                                                                                  \
+        size_t size    = ITPLUS_SEMIJOIN_BATCH;                                                                        \
+        size_t len     = 0;                                                                                            \
+        uint64_t* keys = malloc(size * sizeof(*keys));                                                                 \
+        *set           = (ItplKeySet){0};                                                                              \
+        if (keys == NULL) {                                                                                            \
+            return false;                                                                                              \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (len == size) {                                                                                         \
+                size *= 2;                                                                                             \
+                uint64_t* const temp = realloc(keys, size * sizeof(*keys));                                            \
+                if (temp == NULL) {                                                                                    \
+                    free(keys);                                                                                        \
+                    return false;                                                                                      \
+                }                                                                                                      \
+                keys = temp;                                                                                           \
+            }                                                                                                          \
+            keys[len++] = key(x);                                                                                      \
+        }                                                                                                              \
+        return itpl_keyset_build(set, keys, len, exact);                                                               \
+    }
+
+/**
+ * @def IterSemiJoin(T)
+ * @brief Convenience macro to get the type of the IterSemiJoin struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int);
+ * IterSemiJoin(int) i; // Declares a variable of type IterSemiJoin(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield. Must be the same type name
+ * passed to #DefineIterSemiJoin(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterSemiJoin(T) ITPL_CONCAT(IterSemiJoin_, T)
+
+/**
+ * @def DefineIterSemiJoin(T)
+ * @brief Define an IterSemiJoin struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `set` - The set of keys to keep elements for.
+ * * `key` - The key function.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int); // Defines an IterSemiJoin(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterSemiJoin(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        ItplKeySet const* set;                                                                                         \
+        uint64_t (*key)(T x);                                                                                          \
+        /* The current batch, and the position of the next element to test in it */                                    \
+        T batch[ITPLUS_SEMIJOIN_BATCH];                                                                                \
+        uint64_t keys[ITPLUS_SEMIJOIN_BATCH];                                                                          \
+        size_t pos;                                                                                                    \
+        size_t len;                                                                                                    \
+        bool exhausted;                                                                                                \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterSemiJoin(T)
+
+/**
+ * @def define_itersemijoin_func(T, Name)
+ * @brief Define a function to turn an #IterSemiJoin(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterSemiJoin(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterSemiJoin(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int);
+ *
+ * // Implement `Iterator` for `IterSemiJoin(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intsemijoin(IterSemiJoin(int)* x)`
+ * define_itersemijoin_func(int, wrap_intsemijoin)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Keep the elements of `it` (of type `Iterable(Row)`) whose id is in `ids` (of type `ItplKeySet`)
+ * Iterable(Row) joined = wrap_rowsemijoin(&(IterSemiJoin(Row)){ .set = &ids, .key = row_id, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to #ITPLUS_SEMIJOIN_BATCH elements are extracted from the source ahead of the element being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterSemiJoin(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersemijoin_func(T, Name)                                                                              \
+    static Maybe(T) ITPL_CONCAT(IterSemiJoin(T), _nxt)(IterSemiJoin(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        while (1) {                                                                                                    \
+            while (self->pos < self->len) {                                                                            \
+                size_t const i = self->pos++;                                                                          \
+                if (itpl_keyset_has(self->set, self->keys[i])) {                                                       \
+                    return Just(self->batch[i], T);                                                                    \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->exhausted) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            /* Extract the next batch, and prefetch the lines all of its probes will touch */                          \
+            self->pos = 0;                                                                                             \
+            self->len = 0;                                                                                             \
+            while (self->len < ITPLUS_SEMIJOIN_BATCH) {                                                                \
+                Maybe(T) const res = srcit.tc->next(srcit.self);                                                       \
+                if (is_nothing(res)) {                                                                                 \
+                    self->exhausted = true;                                                                            \
+                    break;                                                                                             \
+                }                                                                                                      \
+                T const x              = from_just_(res);                                                              \
+                self->batch[self->len] = x;                                                                            \
+                self->keys[self->len]  = self->key(x);                                                                 \
+                ITPL_PREFETCH(itpl_keyset_line(self->set, self->keys[self->len]));                                     \
+                ++(self->len);                                                                                         \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterSemiJoin(T)*, T, Name, ITPL_CONCAT(IterSemiJoin(T), _nxt))
+
+#endif /* !LIB_ITPLUS_SEMIJOIN_H */
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief Macros for implementing the `shard` abstraction using the `IterShard` struct.
+ *
+ * An IterShard struct is a struct that splits the elements of an iterator between `n` workers, and only yields the
+ * share of one of them- shard `k` yields the elements at the indices `k`, `k + n`, `k + 2n` and so on. Every element
+ * goes to exactly one of the `n` shards, so each worker can fold its own shard, and the partial results be combined.
+ *
+ * Each shard still walks the whole source, skipping the elements that aren't its own- which is cheap when the elements
+ * are light handles (e.g paths to files), and the work is in what is done with them.
+ */
+
+#ifndef LIB_ITPLUS_SHARD_H
+#define LIB_ITPLUS_SHARD_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stddef.h>
+
+/**
+ * @def IterShard(T)
+ * @brief Convenience macro to get the type of the IterShard struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int);
+ * IterShard(int) i; // Declares a variable of type IterShard(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield. Must be the same type name passed
+ * to #DefineIterShard(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterShard(T) ITPL_CONCAT(IterShard_, T)
+
+/**
+ * @def DefineIterShard(T)
+ * @brief Define an IterShard struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int); // Defines an IterShard(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterShard(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t n;                                                                                                      \
+        size_t k;                                                                                                      \
+        size_t i;                                                                                                      \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterShard(T)
+
+/**
+ * @def define_itershard_func(T, Name)
+ * @brief Define a function to turn an #IterShard(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterShard(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterShard(T)*` and wraps it in an `Iterable(T)`. The number of
+ * shards, `n`, must be at least 1, and the shard to yield, `k`, less than `n`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int);
+ *
+ * // Implement `Iterator` for `IterShard(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intshard(IterShard(int)* x)`
+ * define_itershard_func(int, wrap_intshard)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // The share of worker number 2, out of 4, of `it` (of type `Iterable(int)`)
+ * Iterable(int) mine = wrap_intshard(&(IterShard(int)){.n = 4, .k = 2, .src = it});
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterShard(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itershard_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterShard(T), _nxt)(IterShard(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        for (Maybe(T) res = srcit.tc->next(srcit.self); is_just(res); res = srcit.tc->next(srcit.self)) {              \
+            size_t const i = self->i;                                                                                  \
+            self->i        = i + 1 == self->n ? 0 : i + 1;                                                             \
+            if (i == self->k) {                                                                                        \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterShard(T)*, T, Name, ITPL_CONCAT(IterShard(T), _nxt))
+
+#endif /* !LIB_ITPLUS_SHARD_H */
@@ -0,0 +1,420 @@
+/**
+ * @file
+ * @brief Streaming sketches, and macros for implementing terminals that feed iterables into them.
+ *
+ * Sketches summarize an arbitrarily long stream in a small, fixed amount of memory, answering queries approximately.
+ * Both sketches here are plain structs with no pointers, owned by the caller- they can be merged (so separate
+ * partitions of the input can be summarized separately, e.g by separate threads) and serialized to bytes.
+ *
+ * * #ItplHll is a HyperLogLog sketch, estimating the number of distinct elements. It uses `2^ITPLUS_HLL_PRECISION`
+ *   one byte registers (4 KiB by default), with a relative standard error of about
+ *   `1.04 / sqrt(2^ITPLUS_HLL_PRECISION)` (1.6% by default).
+ * * #ItplQSketch is a quantile sketch, estimating the value at a given rank. It is a stack of compactors, in the style
+ *   of KLL- each level holds up to `ITPLUS_QSKETCH_K` values, each representing `2^level` original values. When a
+ *   level fills up, it is sorted, and every other value is promoted to the next level.
+ */
+
+#ifndef LIB_ITPLUS_SKETCH_H
+#define LIB_ITPLUS_SKETCH_H
+
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef ITPLUS_HLL_PRECISION
+#define ITPLUS_HLL_PRECISION 12
+#endif /* !ITPLUS_HLL_PRECISION */
+
+#ifndef ITPLUS_QSKETCH_K
+#define ITPLUS_QSKETCH_K 64
+#endif /* !ITPLUS_QSKETCH_K */
+
+#ifndef ITPLUS_QSKETCH_LEVELS
+#define ITPLUS_QSKETCH_LEVELS 32
+#endif /* !ITPLUS_QSKETCH_LEVELS */
+
+/**
+ * @def ITPL_HLL_SERIALIZED_SIZE
+ * @brief The number of bytes a serialized #ItplHll takes.
+ */
+#define ITPL_HLL_SERIALIZED_SIZE (1 + (1 << ITPLUS_HLL_PRECISION))
+
+/* HyperLogLog sketch, must be zero initialized */
+typedef struct
+{
+    uint8_t reg[1 << ITPLUS_HLL_PRECISION];
+} ItplHll;
+
+/* Quantile sketch, must be zero initialized */
+typedef struct
+{
+    double items[ITPLUS_QSKETCH_LEVELS][ITPLUS_QSKETCH_K];
+    uint32_t len[ITPLUS_QSKETCH_LEVELS];
+    /* Total number of values added */
+    uint64_t n;
+    /* Alternates which half of a level is promoted */
+    uint64_t coin;
+} ItplQSketch;
+
+/**
+ * @brief Add an element, given its 64 bit hash, to a HyperLogLog sketch.
+ *
+ * The hash should be of good quality in all bits- e.g run integers through #itpl_hash_u64 (see itplus_hash.h).
+ */
+static inline void itpl_hll_add(ItplHll* hll, uint64_t h)
+{
+    uint8_t const maxrank = 64 - ITPLUS_HLL_PRECISION + 1;
+    uint8_t rank          = 1;
+    uint64_t w            = h << ITPLUS_HLL_PRECISION;
+    while (rank < maxrank && !(w & (UINT64_C(1) << 63))) {
+        w <<= 1;
+        rank++;
+    }
+    size_t const idx = (size_t)(h >> (64 - ITPLUS_HLL_PRECISION));
+    if (hll->reg[idx] < rank) {
+        hll->reg[idx] = rank;
+    }
+}
+
+/**
+ * @brief Estimate the number of distinct elements added to a HyperLogLog sketch.
+ */
+static inline double itpl_hll_count(ItplHll const* hll)
+{
+    double const m = (double)(1 << ITPLUS_HLL_PRECISION);
+    double sum     = 0;
+    size_t zeros   = 0;
+    for (size_t i = 0; i < (1 << ITPLUS_HLL_PRECISION); i++) {
+        sum += ldexp(1.0, -hll->reg[i]);
+        zeros += hll->reg[i] == 0;
+    }
+    double const est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    /* Fall back to linear counting for small cardinalities */
+    return est <= 2.5 * m && zeros > 0 ? m * log(m / (double)zeros) : est;
+}
+
+/**
+ * @brief Merge HyperLogLog sketch `src` into `dst`.
+ *
+ * The result is the same as if every element added to `src` had been added to `dst`.
+ */
+static inline void itpl_hll_merge(ItplHll* dst, ItplHll const* src)
+{
+    /* Simple enough for compilers to vectorize */
+    for (size_t i = 0; i < (1 << ITPLUS_HLL_PRECISION); i++) {
+        dst->reg[i] = dst->reg[i] < src->reg[i] ? src->reg[i] : dst->reg[i];
+    }
+}
+
+/**
+ * @brief Serialize a HyperLogLog sketch into #ITPL_HLL_SERIALIZED_SIZE bytes.
+ */
+static inline void itpl_hll_serialize(ItplHll const* hll, unsigned char* out)
+{
+    out[0] = ITPLUS_HLL_PRECISION;
+    memcpy(out + 1, hll->reg, sizeof(hll->reg));
+}
+
+/**
+ * @brief Deserialize a HyperLogLog sketch from `len` bytes.
+ *
+ * @return `false` if the bytes are not a sketch serialized with the same precision.
+ */
+static inline bool itpl_hll_deserialize(ItplHll* hll, unsigned char const* in, size_t len)
+{
+    if (len != ITPL_HLL_SERIALIZED_SIZE || in[0] != ITPLUS_HLL_PRECISION) {
+        return false;
+    }
+    memcpy(hll->reg, in + 1, sizeof(hll->reg));
+    return true;
+}
+
+static inline void itpl_qsketch_push(ItplQSketch* s, size_t level, double x);
+
+/* Insertion sort, levels are short */
+static inline void itpl_qsketch_sort(double* items, uint32_t len)
+{
+    for (uint32_t i = 1; i < len; i++) {
+        double const x = items[i];
+        uint32_t j     = i;
+        for (; j > 0 && items[j - 1] > x; j--) {
+            items[j] = items[j - 1];
+        }
+        items[j] = x;
+    }
+}
+
+/* Sort a level, and promote every other value (starting at an alternating offset) to the next level */
+static inline void itpl_qsketch_compact(ItplQSketch* s, size_t level)
+{
+    double* const items = s->items[level];
+    uint32_t const len  = s->len[level];
+    itpl_qsketch_sort(items, len);
+    s->len[level] = 0;
+    if (level + 1 == ITPLUS_QSKETCH_LEVELS) {
+        /* Out of levels, halve the top level in place (its weights are no longer exact) */
+        for (uint32_t i = (uint32_t)(s->coin++ & 1); i < len; i += 2) {
+            items[s->len[level]++] = items[i];
+        }
+        return;
+    }
+    for (uint32_t i = (uint32_t)(s->coin++ & 1); i < len; i += 2) {
+        itpl_qsketch_push(s, level + 1, items[i]);
+    }
+}
+
+static inline void itpl_qsketch_push(ItplQSketch* s, size_t level, double x)
+{
+    if (s->len[level] == ITPLUS_QSKETCH_K) {
+        itpl_qsketch_compact(s, level);
+    }
+    s->items[level][s->len[level]++] = x;
+}
+
+/**
+ * @brief Add a value to a quantile sketch.
+ */
+static inline void itpl_qsketch_add(ItplQSketch* s, double x)
+{
+    itpl_qsketch_push(s, 0, x);
+    s->n++;
+}
+
+/**
+ * @brief Merge quantile sketch `src` into `dst`.
+ */
+static inline void itpl_qsketch_merge(ItplQSketch* dst, ItplQSketch const* src)
+{
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < src->len[level]; i++) {
+            itpl_qsketch_push(dst, level, src->items[level][i]);
+        }
+    }
+    dst->n += src->n;
+}
+
+/**
+ * @brief Estimate the value at quantile `q` (from 0 to 1) of the values added to a quantile sketch.
+ *
+ * Returns NaN if the sketch is empty. The sketch is not changed, but its levels are reordered.
+ */
+static inline double itpl_qsketch_quantile(ItplQSketch* s, double q)
+{
+    size_t pos[ITPLUS_QSKETCH_LEVELS] = {0};
+    uint64_t total                    = 0;
+    /* Sort every level, and walk all of them in merged order, accumulating the weights */
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        itpl_qsketch_sort(s->items[level], s->len[level]);
+        total += (uint64_t)s->len[level] << level;
+    }
+    if (total == 0) {
+        return NAN;
+    }
+    double const target = q * (double)total;
+    double res          = NAN;
+    uint64_t seen       = 0;
+    while (1) {
+        size_t minlevel = ITPLUS_QSKETCH_LEVELS;
+        for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+            if (pos[level] == s->len[level]) {
+                continue;
+            }
+            if (minlevel == ITPLUS_QSKETCH_LEVELS || s->items[level][pos[level]] < s->items[minlevel][pos[minlevel]]) {
+                minlevel = level;
+            }
+        }
+        if (minlevel == ITPLUS_QSKETCH_LEVELS) {
+            return res;
+        }
+        res = s->items[minlevel][pos[minlevel]++];
+        seen += UINT64_C(1) << minlevel;
+        if ((double)seen >= target) {
+            return res;
+        }
+    }
+}
+
+/**
+ * @brief Get the number of bytes a quantile sketch serializes into.
+ */
+static inline size_t itpl_qsketch_serialized_size(ItplQSketch const* s)
+{
+    size_t size = 8 + 4 * ITPLUS_QSKETCH_LEVELS;
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        size += 8 * (size_t)s->len[level];
+    }
+    return size;
+}
+
+static inline unsigned char* itpl_sketch_put_u64(unsigned char* out, uint64_t x, int nbytes)
+{
+    for (int i = 0; i < nbytes; i++) {
+        *out++ = (unsigned char)(x >> (8 * i));
+    }
+    return out;
+}
+
+static inline unsigned char const* itpl_sketch_get_u64(unsigned char const* in, uint64_t* x, int nbytes)
+{
+    *x = 0;
+    for (int i = 0; i < nbytes; i++) {
+        *x |= (uint64_t)*in++ << (8 * i);
+    }
+    return in;
+}
+
+/**
+ * @brief Serialize a quantile sketch into #itpl_qsketch_serialized_size bytes.
+ *
+ * The format is little endian- the count of values, followed by the length of every level, followed by the values of
+ * every level as IEEE 754 doubles.
+ */
+static inline void itpl_qsketch_serialize(ItplQSketch const* s, unsigned char* out)
+{
+    out = itpl_sketch_put_u64(out, s->n, 8);
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        out = itpl_sketch_put_u64(out, s->len[level], 4);
+    }
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < s->len[level]; i++) {
+            uint64_t bits;
+            memcpy(&bits, &s->items[level][i], sizeof(bits));
+            out = itpl_sketch_put_u64(out, bits, 8);
+        }
+    }
+}
+
+/**
+ * @brief Deserialize a quantile sketch from `len` bytes.
+ *
+ * @return `false` if the bytes are not a quantile sketch serialized with the same parameters.
+ */
+static inline bool itpl_qsketch_deserialize(ItplQSketch* s, unsigned char const* in, size_t len)
+{
+    unsigned char const* const end = in + len;
+    uint64_t x                     = 0;
+    if (len < 8 + 4 * ITPLUS_QSKETCH_LEVELS) {
+        return false;
+    }
+    memset(s, 0, sizeof(*s));
+    in   = itpl_sketch_get_u64(in, &x, 8);
+    s->n = x;
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        in = itpl_sketch_get_u64(in, &x, 4);
+        if (x > ITPLUS_QSKETCH_K) {
+            return false;
+        }
+        s->len[level] = (uint32_t)x;
+    }
+    if (itpl_qsketch_serialized_size(s) != len) {
+        return false;
+    }
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < s->len[level]; i++) {
+            in = itpl_sketch_get_u64(in, &x, 8);
+            memcpy(&s->items[level][i], &x, sizeof(x));
+        }
+    }
+    return in == end;
+}
+
+/**
+ * @def define_itercountdistinct_func(T, Name)
+ * @brief Define the `count_distinct` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a HyperLogLog sketch, and a hash function of type
+ * `uint64_t (*hash)(T x)`. It adds every element of the iterable to the sketch, and returns the estimated number of
+ * distinct elements added to the sketch so far.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `double count_distinct_int(Iterable(int) it, ItplHll* hll, uint64_t (*hash)(int x))`
+ * define_itercountdistinct_func(int, count_distinct_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * @endcode
+ *
+ * @code
+ * // Estimate the number of distinct elements in `it` (of type `Iterable(int)`)
+ * ItplHll hll    = { 0 };
+ * double const n = count_distinct_int(it, &hll, int_hash);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_itercountdistinct_func(T, Name)                                                                         \
+    double Name(Iterable(T) it, ItplHll* hll, uint64_t (*hash)(T x))                                                   \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            itpl_hll_add(hll, hash(x));                                                                                \
+        }                                                                                                              \
+        return itpl_hll_count(hll);                                                                                    \
+    }
+
+/**
+ * @def define_iterqsketch_func(T, Name)
+ * @brief Define a function to feed an iterable into a quantile sketch.
+ *
+ * The defined function takes in an iterable of type `T`, a quantile sketch, and a function of type
+ * `double (*val)(T x)`, which gives the value of an element. It adds the value of every element of the iterable to the
+ * sketch. The sketch can then be queried with #itpl_qsketch_quantile.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { int id; double latency; } Request;
+ *
+ * // The defined function has the signature:-
+ * // `void sketch_requests(Iterable(Request) it, ItplQSketch* s, double (*val)(Request x))`
+ * define_iterqsketch_func(Request, sketch_requests)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static double req_latency(Request x) { return x.latency; }
+ * @endcode
+ *
+ * @code
+ * // Estimate the 99th percentile latency of the requests in `it` (of type `Iterable(Request)`)
+ * static ItplQSketch s;
+ * sketch_requests(it, &s, req_latency);
+ * double const p99 = itpl_qsketch_quantile(&s, 0.99);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_iterqsketch_func(T, Name)                                                                               \
+    void Name(Iterable(T) it, ItplQSketch* s, double (*val)(T x))                                                      \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            itpl_qsketch_add(s, val(x));                                                                               \
+        }                                                                                                              \
+    }
+
+#endif /* !LIB_ITPLUS_SKETCH_H */
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * Utilities to define and use a Slice type. A read only view into a contiguous run of elements.
+ *
+ * https://doc.rust-lang.org/std/primitive.slice.html
+ */
+
+#ifndef LIB_ITPLUS_SLICE_H
+#define LIB_ITPLUS_SLICE_H
+
+#include "itplus_macro_utils.h"
+
+#include <stddef.h>
+
+/**
+ * @def Slice(T)
+ * @brief Convenience macro to get the type of the Slice defined with a certain type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int);
+ * Slice(int) const x = {0}; // Uses the slice type defined in the previous line
+ * @endcode
+ *
+ * @param T The type of the elements this `Slice` views. Must be the same type name passed to #DefineSlice(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define Slice(T) ITPL_CONCAT(Slice_, T)
+
+/**
+ * @def DefineSlice(T)
+ * @brief Define a Slice<T> type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int); // Defines a Slice(int) type
+ * @endcode
+ *
+ * @param T The type of the elements this `Slice` views.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define DefineSlice(T)                                                                                                 \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T const* ptr;                                                                                                  \
+        size_t len;                                                                                                    \
+    } Slice(T)
+
+/**
+ * @def SliceOf(p, n, T)
+ * @brief Wrap a pointer and a length into a #Slice(T).
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int);
+ * int arr[] = {1, 2, 3};
+ * Slice(int) const x = SliceOf(arr, 3, int); // Initializes a Slice(int) viewing all of `arr`
+ * @endcode
+ *
+ * @param p Pointer to the first element of the slice.
+ * @param n The number of elements in the slice.
+ * @param T The type of the elements.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note A #Slice(T) for given `T` must exist.
+ * @note No implicit cloning is done. The slice is only valid as long as the memory it points to is.
+ */
+#define SliceOf(p, n, T) ((Slice(T)){.ptr = (p), .len = (n)})
+
+#endif /* !LIB_ITPLUS_SLICE_H */
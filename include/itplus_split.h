@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief Macros for implementing a string splitting iterable using the `IterSplit` struct.
+ *
+ * An IterSplit struct is a struct that splits a buffer of bytes by a delimiter, and yields the pieces in between as
+ * `Slice(char)`s pointing into the buffer- nothing is copied, and the buffer does not need to be NUL terminated. The
+ * delimiter can be-
+ * * A single byte- searched for using `memchr`.
+ * * A multi byte string- candidates are found using `memchr` on its first byte, and confirmed using `memcmp`.
+ * * Any byte of a set of bytes (#ItplByteSet)- a 256 bit bitmap, so testing each byte is a single lookup.
+ *
+ * Like Python's `str.split(sep)`, a buffer with `n` delimiters yields `n + 1` pieces, some of which may be empty. With
+ * `skip_empty`, empty pieces are skipped instead- which, along with #itpl_byteset_whitespace, makes IterSplit a
+ * whitespace tokenizer (like Python's `str.split()`).
+ */
+
+#ifndef LIB_ITPLUS_SPLIT_H
+#define LIB_ITPLUS_SPLIT_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief A set of bytes.
+ */
+typedef struct
+{
+    uint64_t bits[4];
+} ItplByteSet;
+
+/**
+ * @brief Create the set of the bytes in a NUL terminated string.
+ */
+static inline ItplByteSet itpl_byteset_of(char const* bytes)
+{
+    ItplByteSet set = {{0}};
+    for (; *bytes != '\0'; bytes++) {
+        unsigned char const b = (unsigned char)*bytes;
+        set.bits[b / 64] |= (uint64_t)1 << (b % 64);
+    }
+    return set;
+}
+
+/**
+ * @brief Create the set of ASCII whitespace bytes- space, `\t`, `\n`, `\v`, `\f` and `\r`.
+ */
+static inline ItplByteSet itpl_byteset_whitespace(void) { return itpl_byteset_of(" \t\n\v\f\r"); }
+
+static inline bool itpl_byteset_has(ItplByteSet const* set, unsigned char b)
+{
+    return (set->bits[b / 64] >> (b % 64)) & 1;
+}
+
+/**
+ * @brief A string splitting iterator, yielding `Slice(char)`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to split.
+ * * `delim`, `delimlen` - The delimiter to split by, if splitting by a single or multi byte delimiter.
+ * * `set` - The set of bytes to split by, if splitting by any byte of a set. Takes precedence over `delim`.
+ * * `skip_empty` - (Optional) Whether to skip empty pieces.
+ *
+ * If there is neither a `set` nor a delimiter, the whole buffer is yielded as one piece.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    char const* delim;
+    size_t delimlen;
+    ItplByteSet const* set;
+    bool skip_empty;
+    size_t pos;
+    bool done;
+    ITPL_STATS_MEMBER
+} IterSplit;
+
+/**
+ * @brief Find the end of the piece starting at `self->pos`, and advance `self->pos` past the delimiter that follows it.
+ *
+ * @return The end of the piece. Sets `self->done` if the piece is the last one.
+ */
+static inline size_t itpl_split_piece(IterSplit* self)
+{
+    char const* const buf = self->buf;
+    size_t const start    = self->pos;
+    size_t end            = self->len;
+    size_t skip           = 0;
+    if (self->set != NULL) {
+        end = start;
+        while (end < self->len && !itpl_byteset_has(self->set, (unsigned char)buf[end])) {
+            end++;
+        }
+        skip = 1;
+    } else if (self->delimlen > 0) {
+        char const first = self->delim[0];
+        size_t i         = start;
+        while (self->len - i >= self->delimlen) {
+            char const* const p = memchr(buf + i, first, self->len - i - self->delimlen + 1);
+            if (p == NULL) {
+                break;
+            }
+            i = (size_t)(p - buf);
+            if (memcmp(p + 1, self->delim + 1, self->delimlen - 1) == 0) {
+                end = i;
+                break;
+            }
+            i++;
+        }
+        skip = self->delimlen;
+    }
+    if (end >= self->len) {
+        self->done = true;
+        return self->len;
+    }
+    self->pos = end + skip;
+    return end;
+}
+
+/**
+ * @def define_itersplit_func(Name)
+ * @brief Define a function to turn an #IterSplit into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterSplit struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterSplit*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterSplit`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_split(IterSplit* x)`
+ * define_itersplit_func(wrap_split)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * char const csv[] = "a,b,,c";
+ * // Yields "a", "b", "", "c"
+ * Iterable(Slice(char)) fields = wrap_split(&(IterSplit){ .buf = csv, .len = sizeof(csv) - 1, .delim = ",",
+ *     .delimlen = 1 });
+ * @endcode
+ *
+ * @code
+ * // Yields the words of `text` (of type `char const*`)
+ * ItplByteSet const ws = itpl_byteset_whitespace();
+ * Iterable(Slice(char)) words = wrap_split(&(IterSplit){ .buf = text, .len = strlen(text), .set = &ws,
+ *     .skip_empty = true });
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersplit_func(Name)                                                                                    \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterSplit * self)                                                \
+    {                                                                                                                  \
+        while (!self->done) {                                                                                          \
+            size_t const start = self->pos;                                                                            \
+            size_t const end   = itpl_split_piece(self);                                                               \
+            if (!self->skip_empty || end > start) {                                                                    \
+                return Just(SliceOf(self->buf + start, end - start, char), Slice(char));                               \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Slice(char));                                                                                   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterSplit*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_SPLIT_H */
@@ -56,6 +56,7 @@
         size_t i;                                                                                                      \
         size_t limit;                                                                                                  \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterTake(T)
 
 /**
@@ -95,6 +96,7 @@
 #define define_itertake_func(T, Name)                                                                                  \
     static Maybe(T) ITPL_CONCAT(IterTake(T), _nxt)(IterTake(T) * self)                                                 \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         if (self->i < self->limit) {                                                                                   \
             ++(self->i);                                                                                               \
             Iterable(T) const srcit = self->src;                                                                       \
@@ -102,6 +104,6 @@
         }                                                                                                              \
         return Nothing(T);                                                                                             \
     }                                                                                                                  \
-    impl_iterator(IterTake(T)*, T, Name, ITPL_CONCAT(IterTake(T), _nxt))
+    impl_instrumented_iterator(IterTake(T)*, T, Name, ITPL_CONCAT(IterTake(T), _nxt))
 
 #endif /* !LIB_ITPLUS_TAKE_H */
@@ -54,6 +54,7 @@
         bool (*pred)(T x);                                                                                             \
         bool done;                                                                                                     \
         Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterTakeWhile(T)
 
 /**
@@ -97,6 +98,7 @@
 #define define_itertakewhile_func(T, Name)                                                                             \
     static Maybe(T) ITPL_CONCAT(IterTakeWhile(T), _nxt)(IterTakeWhile(T) * self)                                       \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         if (self->done) {                                                                                              \
             return Nothing(T);                                                                                         \
         }                                                                                                              \
@@ -108,6 +110,6 @@
         }                                                                                                              \
         return res;                                                                                                    \
     }                                                                                                                  \
-    impl_iterator(IterTakeWhile(T)*, T, Name, ITPL_CONCAT(IterTakeWhile(T), _nxt))
+    impl_instrumented_iterator(IterTakeWhile(T)*, T, Name, ITPL_CONCAT(IterTakeWhile(T), _nxt))
 
 #endif /* !LIB_ITPLUS_TAKEWHILE_H */
@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief Macros for implementing the `top_k` abstraction.
+ *
+ * https://docs.rs/itertools/0.10.1/itertools/trait.Itertools.html#method.k_smallest
+ * `top_k` finds the `k` greatest elements of an iterable, according to a comparison function, without collecting the
+ * whole iterable. The elements found so far are kept in a 4-ary min heap of at most `k` elements, in a buffer supplied
+ * by the caller - the smallest of them sits at the root and is the only one new elements are compared with. This makes
+ * the whole operation O(n log k) time and O(k) memory. 4-ary heaps are half as deep as binary heaps, and the children
+ * of a node are adjacent in memory, so sifting touches fewer cache lines.
+ */
+
+#ifndef LIB_ITPLUS_TOPK_H
+#define LIB_ITPLUS_TOPK_H
+
+#include "itplus_foreach.h"
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+
+#include <stddef.h>
+
+/* Define a function that sifts `x` down a 4-ary min heap of `n` elements, starting from index `i` */
+#define ITPL_TOPK_SIFT_FUNC(T, FnName)                                                                                 \
+    static void FnName(T* heap, size_t n, size_t i, T x, int (*cmp)(T a, T b))                                         \
+    {                                                                                                                  \
+        while (1) {                                                                                                    \
+            size_t const fstchild = 4 * i + 1;                                                                         \
+            if (fstchild >= n) {                                                                                       \
+                break;                                                                                                 \
+            }                                                                                                          \
+            size_t const lastchild = fstchild + 4 < n ? fstchild + 4 : n;                                              \
+            size_t minchild        = fstchild;                                                                         \
+            for (size_t c = fstchild + 1; c < lastchild; c++) {                                                        \
+                minchild = cmp(heap[c], heap[minchild]) < 0 ? c : minchild;                                            \
+            }                                                                                                          \
+            if (cmp(heap[minchild], x) >= 0) {                                                                         \
+                break;                                                                                                 \
+            }                                                                                                          \
+            heap[i] = heap[minchild];                                                                                  \
+            i       = minchild;                                                                                        \
+        }                                                                                                              \
+        heap[i] = x;                                                                                                   \
+    }
+
+/**
+ * @def define_itertopk_func(T, Name)
+ * @brief Define the `top_k` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, an output buffer of at least `k` elements, `k`, and a
+ * comparison function of type `int (*cmp)(T a, T b)`. `cmp` must return a negative value if `a` is less than `b`, a
+ * positive value if `a` is greater than `b`, and 0 otherwise - the same contract as `qsort` comparators, but taking
+ * the elements by value.
+ *
+ * The `k` greatest elements of the iterable (or all of them, if there are fewer) are written to the output buffer, in
+ * descending order, and their count is returned. Among equal elements, which ones are kept is unspecified.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `size_t top_k_int(Iterable(int) it, int* out, size_t k, int (*cmp)(int a, int b))`
+ * define_itertopk_func(int, top_k_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static int cmp_int(int a, int b) { return (a > b) - (a < b); }
+ * @endcode
+ *
+ * @code
+ * // Find the 100 greatest elements in `it` (of type `Iterable(int)`)
+ * int best[100];
+ * size_t const n = top_k_int(it, best, 100, cmp_int);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note To find the `k` smallest elements instead, flip the comparison function.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_itertopk_func(T, Name)                                                                                  \
+    ITPL_TOPK_SIFT_FUNC(T, ITPL_CONCAT(Name, _sift))                                                                   \
+    size_t Name(Iterable(T) it, T* out, size_t k, int (*cmp)(T a, T b))                                                \
+    {                                                                                                                  \
+        size_t n = 0;                                                                                                  \
+        if (k == 0) {                                                                                                  \
+            return 0;                                                                                                  \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (n < k) {                                                                                               \
+                /* Sift up */                                                                                          \
+                size_t i = n++;                                                                                        \
+                while (i > 0 && cmp(x, out[(i - 1) / 4]) < 0) {                                                        \
+                    out[i] = out[(i - 1) / 4];                                                                         \
+                    i      = (i - 1) / 4;                                                                              \
+                }                                                                                                      \
+                out[i] = x;                                                                                            \
+            } else if (cmp(x, out[0]) > 0) {                                                                           \
+                /* Greater than the smallest element kept so far, replace it */                                        \
+                ITPL_CONCAT(Name, _sift)(out, n, 0, x, cmp);                                                           \
+            }                                                                                                          \
+        }                                                                                                              \
+        /* Heapsort - repeatedly move the smallest remaining element to the back */                                    \
+        for (size_t len = n; len > 1; len--) {                                                                         \
+            T const min = out[0];                                                                                      \
+            ITPL_CONCAT(Name, _sift)(out, len - 1, 0, out[len - 1], cmp);                                              \
+            out[len - 1] = min;                                                                                        \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
+
+/**
+ * @def define_topk_merge_func(T, Name)
+ * @brief Define a function to merge 2 results of a `top_k` function.
+ *
+ * The defined function takes in 2 arrays sorted in descending order (as produced by `top_k`)- `dst` of length
+ * `dstlen`, and `src` of length `srclen`, along with `k` and a comparison function. The greatest `k` elements of both
+ * arrays are written into `dst`, in descending order, and their count is returned. `dst` must have room for at least
+ * `k` elements.
+ *
+ * This is the final step of a partitioned `top_k`- the top `k` of each partition of the input is found separately
+ * (e.g by its own thread), and the results are then merged together.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `size_t merge_top_k_int(int* dst, size_t dstlen, int const* src, size_t srclen, size_t k,
+ * //                         int (*cmp)(int a, int b))`
+ * define_topk_merge_func(int, merge_top_k_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Combine the top 100 of 2 partitions, `part1` and `part2` (of type `Iterable(int)`)
+ * int best[100], best2[100];
+ * size_t n        = top_k_int(part1, best, 100, cmp_int);
+ * size_t const n2 = top_k_int(part2, best2, 100, cmp_int);
+ * n               = merge_top_k_int(best, n, best2, n2, 100, cmp_int);
+ * @endcode
+ *
+ * @param T The type of the elements being merged.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_topk_merge_func(T, Name)                                                                                \
+    size_t Name(T* dst, size_t dstlen, T const* src, size_t srclen, size_t k, int (*cmp)(T a, T b))                    \
+    {                                                                                                                  \
+        /* Find out how many elements of each array make it into the result */                                         \
+        size_t a = 0, b = 0;                                                                                           \
+        while (a + b < k && (a < dstlen || b < srclen)) {                                                              \
+            if (b == srclen || (a < dstlen && cmp(dst[a], src[b]) >= 0)) {                                             \
+                a++;                                                                                                   \
+            } else {                                                                                                   \
+                b++;                                                                                                   \
+            }                                                                                                          \
+        }                                                                                                              \
+        /* Merge from the back, so the elements of `dst` are never overwritten before they're read */                  \
+        size_t const n = a + b;                                                                                        \
+        for (size_t w = n; b > 0; w--) {                                                                               \
+            if (a > 0 && cmp(dst[a - 1], src[b - 1]) < 0) {                                                            \
+                dst[w - 1] = dst[--a];                                                                                 \
+            } else {                                                                                                   \
+                dst[w - 1] = src[--b];                                                                                 \
+            }                                                                                                          \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
+
+#endif /* !LIB_ITPLUS_TOPK_H */
@@ -0,0 +1,268 @@
+/**
+ * @file
+ * @brief Macros for implementing pipeline tracing using the `IterTrace` struct, and a Chrome trace exporter.
+ *
+ * An IterTrace struct is a struct that yields the elements of its source iterable unchanged, and records a span for
+ * every batch of elements that passes through it- the stage name, the thread, the start and end time, and the number
+ * of elements. A span starts when the first element of a batch is requested, and ends when the last one is yielded (or
+ * the source is exhausted), so it covers the time spent both in the stages upstream and downstream of it.
+ *
+ * Spans are recorded into an #ItplTraceBuf, owned by the caller. A buffer must only be written to by one thread- give
+ * each thread its own buffer (and id), and no synchronization is needed at all. Once the buffer is full, further spans
+ * are counted as dropped instead of recorded.
+ *
+ * The buffers can be exported to the Chrome `trace_event` JSON format using #itpl_trace_write_json, and opened in
+ * `chrome://tracing` or https://ui.perfetto.dev to see the stages of all threads in a timeline.
+ *
+ * Time is measured by `ITPLUS_TRACE_CLOCK()`, in nanoseconds. If it is not defined, `clock_gettime(CLOCK_MONOTONIC)`
+ * is used where POSIX timers are available, `timespec_get` where C11 is, and `clock` otherwise. Note that `clock`
+ * measures the processor time of the whole process, not wall time- time spent blocked (e.g on I/O) doesn't show up, and
+ * the time of other threads does. Define `ITPLUS_TRACE_CLOCK` if neither of the others is available.
+ */
+
+#ifndef LIB_ITPLUS_TRACE_H
+#define LIB_ITPLUS_TRACE_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#ifndef ITPLUS_TRACE_BATCH
+#define ITPLUS_TRACE_BATCH 1024
+#endif /* !ITPLUS_TRACE_BATCH */
+
+#ifndef ITPLUS_TRACE_CLOCK
+#define ITPLUS_TRACE_CLOCK() itpl_trace_now()
+#endif /* !ITPLUS_TRACE_CLOCK */
+
+/**
+ * @brief Get the current time, in nanoseconds, from an unspecified starting point.
+ */
+static inline uint64_t itpl_trace_now(void)
+{
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0 && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#else
+    /* Processor time, not wall time */
+    return (uint64_t)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+
+/**
+ * @brief A span recorded by an IterTrace.
+ */
+typedef struct
+{
+    char const* name;
+    uint64_t start;
+    uint64_t end;
+    size_t count;
+} ItplTraceEvent;
+
+/**
+ * @brief A buffer of spans, written to by a single thread.
+ *
+ * The members to be filled in by the caller are-
+ * * `events`, `cap` - The storage for the spans.
+ * * `tid` - The id of the thread writing to this buffer, as shown in the exported trace.
+ */
+typedef struct
+{
+    ItplTraceEvent* events;
+    size_t cap;
+    size_t len;
+    uint32_t tid;
+    /* Number of spans that did not fit into the buffer */
+    size_t dropped;
+} ItplTraceBuf;
+
+/**
+ * @brief Record a span into a trace buffer.
+ */
+static inline void itpl_trace_record(ItplTraceBuf* buf, char const* name, uint64_t start, uint64_t end, size_t count)
+{
+    if (buf->len == buf->cap) {
+        ++(buf->dropped);
+        return;
+    }
+    buf->events[buf->len++] = (ItplTraceEvent){.name = name, .start = start, .end = end, .count = count};
+}
+
+static inline void itpl_trace_write_str(FILE* f, char const* s)
+{
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        unsigned char const c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/**
+ * @brief Write the spans of given trace buffers as a Chrome `trace_event` JSON object.
+ *
+ * Timestamps are relative to the earliest span across all buffers.
+ *
+ * @return `false` if writing to the file failed.
+ */
+static inline bool itpl_trace_write_json(FILE* f, ItplTraceBuf const* bufs, size_t nbufs)
+{
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < nbufs; i++) {
+        for (size_t j = 0; j < bufs[i].len; j++) {
+            origin = bufs[i].events[j].start < origin ? bufs[i].events[j].start : origin;
+        }
+    }
+    bool first = true;
+    fputs("{\"traceEvents\":[", f);
+    for (size_t i = 0; i < nbufs; i++) {
+        for (size_t j = 0; j < bufs[i].len; j++) {
+            ItplTraceEvent const* const e = bufs[i].events + j;
+            fputs(first ? "\n" : ",\n", f);
+            first = false;
+            fputs("{\"name\":", f);
+            itpl_trace_write_str(f, e->name);
+            /* Chrome expects microseconds */
+            fprintf(f, ",\"cat\":\"iterplus\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f",
+                (unsigned long)bufs[i].tid, (double)(e->start - origin) / 1000, (double)(e->end - e->start) / 1000);
+            fprintf(f, ",\"args\":{\"count\":%lu}}", (unsigned long)e->count);
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", f);
+    return !ferror(f);
+}
+
+/**
+ * @def IterTrace(T)
+ * @brief Convenience macro to get the type of the IterTrace struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTrace(int);
+ * IterTrace(int) i; // Declares a variable of type IterTrace(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield. Must be the same type name passed
+ * to #DefineIterTrace(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterTrace(T) ITPL_CONCAT(IterTrace_, T)
+
+/**
+ * @def DefineIterTrace(T)
+ * @brief Define an IterTrace struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `name` - The name of the stage, shown in the exported trace. Must outlive the buffer.
+ * * `buf` - The trace buffer to record spans into.
+ * * `batch` - (Optional) The number of elements per span. Defaults to #ITPLUS_TRACE_BATCH.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTrace(int); // Defines an IterTrace(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterTrace(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        char const* name;                                                                                              \
+        ItplTraceBuf* buf;                                                                                             \
+        size_t batch;                                                                                                  \
+        /* Start of the current span, and the number of elements yielded in it so far */                               \
+        uint64_t start;                                                                                                \
+        size_t count;                                                                                                  \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterTrace(T)
+
+/**
+ * @def define_itertrace_func(T, Name)
+ * @brief Define a function to turn an #IterTrace(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterTrace(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterTrace(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTrace(int);
+ *
+ * // Implement `Iterator` for `IterTrace(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_inttrace(IterTrace(int)* x)`
+ * define_itertrace_func(int, wrap_inttrace)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static ItplTraceEvent events[4096];
+ * ItplTraceBuf buf = {.events = events, .cap = 4096, .tid = 1};
+ * // Record a span for every 1024 elements of `it` (of type `Iterable(int)`)
+ * Iterable(int) traced = wrap_inttrace(&(IterTrace(int)){ .name = "parse", .buf = &buf, .src = it });
+ * ...
+ * itpl_trace_write_json(f, &buf, 1);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterTrace(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itertrace_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterTrace(T), _nxt)(IterTrace(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        size_t const batch      = self->batch == 0 ? ITPLUS_TRACE_BATCH : self->batch;                                 \
+        if (self->count == 0) {                                                                                        \
+            self->start = ITPLUS_TRACE_CLOCK();                                                                        \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_just(res)) {                                                                                            \
+            ++(self->count);                                                                                           \
+        }                                                                                                              \
+        if (self->count > 0 && (self->count == batch || is_nothing(res))) {                                            \
+            itpl_trace_record(self->buf, self->name, self->start, ITPLUS_TRACE_CLOCK(), self->count);                  \
+            self->count = 0;                                                                                           \
+        }                                                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterTrace(T)*, T, Name, ITPL_CONCAT(IterTrace(T), _nxt))
+
+#endif /* !LIB_ITPLUS_TRACE_H */
@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @brief Macros for implementing a UTF-8 decoding iterable using the `IterUtf8` struct, and a batched decoder.
+ *
+ * An IterUtf8 struct is a struct that decodes a buffer of UTF-8 encoded bytes into the code points it encodes,
+ * yielding one `uint32_t` per code point. The input is fully validated- overlong encodings, surrogates, code points
+ * above U+10FFFF, stray continuation bytes and truncated sequences are all invalid. Depending on the mode, each maximal
+ * invalid subpart (the same rule the WHATWG encoding standard uses) is either replaced with U+FFFD, or stops the
+ * iteration. Either way, the iterator remembers that it saw invalid input.
+ *
+ * #itpl_utf8_decode decodes into a caller supplied array of code points instead, many at a time. Runs of ASCII bytes,
+ * which are the bulk of most text, are checked 8 bytes at a time and widened without going through the decoder.
+ *
+ * Neither allocates.
+ */
+
+#ifndef LIB_ITPLUS_UTF8_H
+#define LIB_ITPLUS_UTF8_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @def ITPL_UTF8_REPLACEMENT
+ * @brief The code point invalid sequences are replaced with (U+FFFD).
+ */
+#define ITPL_UTF8_REPLACEMENT 0xFFFDU
+
+/**
+ * @brief What to do on invalid UTF-8.
+ */
+typedef enum
+{
+    /* Replace every maximal invalid subpart with U+FFFD */
+    ITPL_UTF8_REPLACE,
+    /* Stop at the first invalid sequence */
+    ITPL_UTF8_STOP
+} ItplUtf8Mode;
+
+/**
+ * @brief Get the number of leading ASCII bytes in a buffer, checking 8 bytes at a time.
+ */
+static inline size_t itpl_utf8_ascii_run(unsigned char const* s, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) {
+            break;
+        }
+    }
+    while (i < len && s[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Decode the code point at the start of a (non empty) buffer.
+ *
+ * @param s The buffer.
+ * @param len Length of the buffer, must not be 0.
+ * @param cp Where to store the code point.
+ *
+ * @return The number of bytes decoded. If the bytes are not valid UTF-8, this is the length of the maximal invalid
+ * subpart (at least 1), and `*cp` is set to `UINT32_MAX`.
+ */
+static inline size_t itpl_utf8_decode_one(unsigned char const* s, size_t len, uint32_t* cp)
+{
+    unsigned char const b = s[0];
+    size_t n;
+    /* The range of the second byte is narrowed to exclude overlongs, surrogates and values above U+10FFFF */
+    unsigned char lo = 0x80, hi = 0xBF;
+    uint32_t c;
+    if (b < 0x80) {
+        *cp = b;
+        return 1;
+    } else if (b >= 0xC2 && b <= 0xDF) {
+        n = 2;
+        c = b & 0x1F;
+    } else if (b >= 0xE0 && b <= 0xEF) {
+        n  = 3;
+        c  = b & 0x0F;
+        lo = b == 0xE0 ? 0xA0 : 0x80;
+        hi = b == 0xED ? 0x9F : 0xBF;
+    } else if (b >= 0xF0 && b <= 0xF4) {
+        n  = 4;
+        c  = b & 0x07;
+        lo = b == 0xF0 ? 0x90 : 0x80;
+        hi = b == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        *cp = UINT32_MAX;
+        return 1;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if (i == len || s[i] < lo || s[i] > hi) {
+            *cp = UINT32_MAX;
+            return i;
+        }
+        c  = (c << 6) | (s[i] & 0x3F);
+        lo = 0x80;
+        hi = 0xBF;
+    }
+    *cp = c;
+    return n;
+}
+
+/**
+ * @brief Decode a UTF-8 buffer into an array of code points.
+ *
+ * Decoding starts at `*pos`, and continues until the end of the buffer, until `cap` code points have been written, or-
+ * in #ITPL_UTF8_STOP mode- until an invalid sequence. `*pos` is advanced past everything decoded, so it points to the
+ * invalid sequence in the last case, and the function can be called again (with the same `pos`) to continue decoding.
+ *
+ * @param s The buffer.
+ * @param len Length of the buffer.
+ * @param pos Position in the buffer to start decoding from, updated to where decoding stopped.
+ * @param out Where to write the code points.
+ * @param cap Maximum number of code points to write.
+ * @param mode What to do on invalid sequences.
+ * @param invalid Set to `true` if an invalid sequence was encountered, left untouched otherwise.
+ *
+ * @return The number of code points written.
+ */
+static inline size_t itpl_utf8_decode(unsigned char const* s, size_t len, size_t* pos, uint32_t* out, size_t cap,
+    ItplUtf8Mode mode, bool* invalid)
+{
+    size_t i = *pos, n = 0;
+    while (i < len && n < cap) {
+        /* Widen a run of ASCII bytes directly */
+        size_t const run = itpl_utf8_ascii_run(s + i, (len - i) < (cap - n) ? (len - i) : (cap - n));
+        for (size_t j = 0; j < run; j++) {
+            out[n + j] = s[i + j];
+        }
+        i += run;
+        n += run;
+        if (i == len || n == cap) {
+            break;
+        }
+        uint32_t cp;
+        size_t const used = itpl_utf8_decode_one(s + i, len - i, &cp);
+        if (cp == UINT32_MAX) {
+            *invalid = true;
+            if (mode == ITPL_UTF8_STOP) {
+                break;
+            }
+            cp = ITPL_UTF8_REPLACEMENT;
+        }
+        out[n++] = cp;
+        i += used;
+    }
+    *pos = i;
+    return n;
+}
+
+/**
+ * @brief A UTF-8 decoding iterator, yielding one code point at a time.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to decode.
+ * * `mode` - (Optional) What to do on invalid sequences. Defaults to replacing them.
+ *
+ * After iteration, `invalid` tells whether any invalid sequence was encountered. In #ITPL_UTF8_STOP mode, `pos` is
+ * the position of the invalid sequence the iteration stopped at.
+ */
+typedef struct
+{
+    unsigned char const* buf;
+    size_t len;
+    size_t pos;
+    ItplUtf8Mode mode;
+    bool invalid;
+    ITPL_STATS_MEMBER
+} IterUtf8;
+
+/**
+ * @def define_iterutf8_func(Name)
+ * @brief Define a function to turn an #IterUtf8 into an `Iterable(uint32_t)`.
+ *
+ * Define the `next` function implementation for the #IterUtf8 struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterUtf8*` and wraps it in an `Iterable(uint32_t)`.
+ *
+ * # Example
+ *
+ * @code
+ * // Implement `Iterator` for `IterUtf8`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_utf8(IterUtf8* x)`
+ * define_iterutf8_func(wrap_utf8)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * char const text[] = "na\xC3\xAFve";
+ * IterUtf8 u        = {.buf = (unsigned char const*)text, .len = sizeof(text) - 1};
+ * // Yields 'n', 'a', U+00EF, 'v', 'e'
+ * Iterable(uint32_t) cps = wrap_utf8(&u);
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = uint32_t` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterutf8_func(Name)                                                                                     \
+    static Maybe(uint32_t) ITPL_CONCAT(Name, _nxt)(IterUtf8 * self)                                                    \
+    {                                                                                                                  \
+        if (self->pos == self->len) {                                                                                  \
+            return Nothing(uint32_t);                                                                                  \
+        }                                                                                                              \
+        unsigned char const b = self->buf[self->pos];                                                                  \
+        if (b < 0x80) {                                                                                                \
+            ++(self->pos);                                                                                             \
+            return Just((uint32_t)b, uint32_t);                                                                        \
+        }                                                                                                              \
+        uint32_t cp;                                                                                                   \
+        size_t const used = itpl_utf8_decode_one(self->buf + self->pos, self->len - self->pos, &cp);                   \
+        if (cp == UINT32_MAX) {                                                                                        \
+            self->invalid = true;                                                                                      \
+            if (self->mode == ITPL_UTF8_STOP) {                                                                        \
+                return Nothing(uint32_t);                                                                              \
+            }                                                                                                          \
+            cp = ITPL_UTF8_REPLACEMENT;                                                                                \
+        }                                                                                                              \
+        self->pos += used;                                                                                             \
+        return Just(cp, uint32_t);                                                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterUtf8*, uint32_t, Name, ITPL_CONCAT(Name, _nxt))
+
+#endif /* !LIB_ITPLUS_UTF8_H */
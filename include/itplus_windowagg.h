@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Macros for implementing a sliding window aggregation using the `IterWindowAgg` struct.
+ *
+ * An IterWindowAgg struct is a struct that folds every window of a fixed size over its source iterable, and yields
+ * the folded value of each window. The windows are the same ones #IterWindows(T) would yield, but the aggregate of
+ * each window is maintained incrementally instead of being recomputed from scratch.
+ *
+ * Two strategies are used, based on the functions present in the struct-
+ * * If an inverse function (`inv`) is given, the aggregate is updated by folding in the new element and "subtracting"
+ *   the evicted one (e.g sum, xor). This is O(1) per element.
+ * * Otherwise, the two stack method is used, which only requires the operation to be associative (e.g min, max). The
+ *   window is split into a front part, for which the aggregate of every suffix is stored, and a back part, for which
+ *   only a running aggregate is stored. Evicting pops from the front, and when the front runs out, the whole window
+ *   is moved to it. This is O(1) amortized per element.
+ */
+
+#ifndef LIB_ITPLUS_WINDOWAGG_H
+#define LIB_ITPLUS_WINDOWAGG_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+
+#include <stddef.h>
+
+/**
+ * @def IterWindowAgg(ElmntType, Acc)
+ * @brief Convenience macro to get the type of the IterWindowAgg struct with given element type and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindowAgg(int, long);
+ * IterWindowAgg(int, long) i; // Declares a variable of type IterWindowAgg(int, long)
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield. Must be the same type
+ * name passed to #DefineIterWindowAgg(ElmntType, Acc).
+ * @param Acc The accumulator type of the aggregation. Must be the same type name passed to
+ * #DefineIterWindowAgg(ElmntType, Acc).
+ *
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
+ */
+#define IterWindowAgg(ElmntType, Acc) ITPL_CONCAT(ITPL_CONCAT(IterWindowAgg_, ElmntType), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineIterWindowAgg(ElmntType, Acc)
+ * @brief Define an IterWindowAgg struct that aggregates windows of an `Iterable(ElmntType)` into `Acc` values.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `size` - The window size.
+ * * `init` - The identity value of the aggregation (e.g `0` for sum, the largest value for min).
+ * * `f` - The accumulating function, same as the one used with `fold`.
+ * * `inv` - The inverse of `f`, removes an element's contribution from an accumulator. May be `NULL`.
+ * * `merge` - Combines 2 accumulators, `merge(a, b)` must be the aggregate of `a`'s elements followed by `b`'s. Only
+ *   required if `inv` is `NULL`.
+ * * `buf` - Ring buffer of at least `size` elements.
+ * * `aggs` - Buffer of at least `size` accumulators. Only required if `inv` is `NULL`.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindowAgg(int, long); // Defines an IterWindowAgg(int, long) struct
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield.
+ * @param Acc The accumulator type of the aggregation.
+ *
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
+ * @note An #Iterator(T) for given `ElmntType`, and `Acc` **must** also exist.
+ */
+#define DefineIterWindowAgg(ElmntType, Acc)                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t size;                                                                                                   \
+        Acc init;                                                                                                      \
+        Acc (*f)(Acc acc, ElmntType x);                                                                                \
+        Acc (*inv)(Acc acc, ElmntType x);                                                                              \
+        Acc (*merge)(Acc a, Acc b);                                                                                    \
+        ElmntType* buf;                                                                                                \
+        Acc* aggs;                                                                                                     \
+        size_t filled;                                                                                                 \
+        size_t head;                                                                                                   \
+        /* Number of elements in the front stack (two stack method only) */                                            \
+        size_t flen;                                                                                                   \
+        /* The running aggregate (or the aggregate of the back stack) */                                               \
+        Acc acc;                                                                                                       \
+        Iterable(ElmntType) src;                                                                                       \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterWindowAgg(ElmntType, Acc)
+
+/**
+ * @def define_iterwindowagg_func(ElmntType, Acc, Name)
+ * @brief Define a function to turn an #IterWindowAgg(ElmntType, Acc) into an #Iterable(Acc).
+ *
+ * Define the `next` function implementation for the #IterWindowAgg(ElmntType, Acc) struct, and use it to implement
+ * the Iterator typeclass, for given `ElmntType` and `Acc`.
+ *
+ * The defined function takes in a value of type `IterWindowAgg(ElmntType, Acc)*` and wraps it in an `Iterable(Acc)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindowAgg(int, long);
+ *
+ * // Implement `Iterator` for `IterWindowAgg(int, long)`
+ * // The defined function has the signature- `Iterable(long) wrap_intlongwagg(IterWindowAgg(int, long)* x)`
+ * define_iterwindowagg_func(int, long, wrap_intlongwagg)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static long add(long acc, int x) { return acc + x; }
+ * static long sub(long acc, int x) { return acc - x; }
+ * static long max(long acc, int x) { return x > acc ? x : acc; }
+ * static long max2(long a, long b) { return a > b ? a : b; }
+ * @endcode
+ *
+ * @code
+ * int ring[16];
+ * long aggs[16];
+ * // Rolling sum over windows of 16 elements in `it` (of type `Iterable(int)`)
+ * Iterable(long) sums = wrap_intlongwagg(&(IterWindowAgg(int, long)){
+ *     .size = 16, .init = 0, .f = add, .inv = sub, .buf = ring, .src = it });
+ * // Rolling max over windows of 16 elements in `it` (of type `Iterable(int)`)
+ * Iterable(long) maxs = wrap_intlongwagg(&(IterWindowAgg(int, long)){
+ *     .size = 16, .init = LONG_MIN, .f = max, .merge = max2, .buf = ring, .aggs = aggs, .src = it });
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield.
+ * @param Acc The accumulator type of the aggregation.
+ * @param Name Name to define the function as.
+ *
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
+ * @note An #IterWindowAgg(ElmntType, Acc) for the given `ElmntType` and `Acc` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterwindowagg_func(ElmntType, Acc, Name)                                                                \
+    static Maybe(Acc) ITPL_CONCAT(IterWindowAgg(ElmntType, Acc), _nxt)(IterWindowAgg(ElmntType, Acc) * self)           \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(ElmntType) const srcit = self->src;                                                                   \
+        if (self->size == 0) {                                                                                         \
+            return Nothing(Acc);                                                                                       \
+        }                                                                                                              \
+        if (self->filled < self->size) {                                                                               \
+            if (self->filled == 0) {                                                                                   \
+                self->acc = self->init;                                                                                \
+            }                                                                                                          \
+            while (self->filled < self->size) {                                                                        \
+                Maybe(ElmntType) const res = srcit.tc->next(srcit.self);                                               \
+                if (is_nothing(res)) {                                                                                 \
+                    return Nothing(Acc);                                                                               \
+                }                                                                                                      \
+                self->buf[self->filled++] = from_just_(res);                                                           \
+                self->acc                 = self->f(self->acc, from_just_(res));                                       \
+            }                                                                                                          \
+            return Just(self->acc, Acc);                                                                               \
+        }                                                                                                              \
+        Maybe(ElmntType) const res = srcit.tc->next(srcit.self);                                                       \
+        if (is_nothing(res)) {                                                                                         \
+            return Nothing(Acc);                                                                                       \
+        }                                                                                                              \
+        size_t const oldest = self->head;                                                                              \
+        self->head          = self->head + 1 == self->size ? 0 : self->head + 1;                                       \
+        if (self->inv != NULL) {                                                                                       \
+            self->acc         = self->f(self->inv(self->acc, self->buf[oldest]), from_just_(res));                     \
+            self->buf[oldest] = from_just_(res);                                                                       \
+            return Just(self->acc, Acc);                                                                               \
+        }                                                                                                              \
+        if (self->flen == 0) {                                                                                         \
+            /* Front stack ran out - move the whole window over, storing the aggregate of every suffix */              \
+            size_t pos      = oldest == 0 ? self->size - 1 : oldest - 1;                                               \
+            self->aggs[pos] = self->f(self->init, self->buf[pos]);                                                     \
+            for (size_t i = 1; i < self->size; i++) {                                                                  \
+                size_t const nxtpos = pos;                                                                             \
+                pos                 = pos == 0 ? self->size - 1 : pos - 1;                                             \
+                self->aggs[pos]     = self->merge(self->f(self->init, self->buf[pos]), self->aggs[nxtpos]);            \
+            }                                                                                                          \
+            self->flen = self->size;                                                                                   \
+            self->acc  = self->init;                                                                                   \
+        }                                                                                                              \
+        /* Pop the oldest element off the front stack, push the new one onto the back stack */                         \
+        --(self->flen);                                                                                                \
+        self->buf[oldest] = from_just_(res);                                                                           \
+        self->acc         = self->f(self->acc, from_just_(res));                                                       \
+        return Just(self->flen == 0 ? self->acc : self->merge(self->aggs[self->head], self->acc), Acc);                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterWindowAgg(ElmntType, Acc)*, Acc, Name, ITPL_CONCAT(IterWindowAgg(ElmntType, Acc), _nxt))
+
+#endif /* !LIB_ITPLUS_WINDOWAGG_H */
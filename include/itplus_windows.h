@@ -0,0 +1,222 @@
+/**
+ * @file
+ * @brief Macros for implementing the `windows` abstraction using the `IterWindows` and `IterArrWindows` structs.
+ *
+ * https://doc.rust-lang.org/std/primitive.slice.html#method.windows
+ * An IterWindows struct is a struct that yields a #Slice(T) view of every contiguous window of a fixed size over its
+ * source iterable. The windows overlap, each one is the previous window shifted by one element. If the source yields
+ * fewer elements than the window size, no windows are yielded.
+ *
+ * `IterWindows` keeps the current window in a ring buffer supplied by the caller. Every element is written to the
+ * ring twice, once at its slot and once at its slot + `size`, so the current window is always contiguous in memory
+ * and can be viewed without being copied out. When the elements already live in an array, `IterArrWindows` should be
+ * used instead - it yields views directly into the array.
+ */
+
+#ifndef LIB_ITPLUS_WINDOWS_H
+#define LIB_ITPLUS_WINDOWS_H
+
+#include "itplus_iterator.h"
+#include "itplus_macro_utils.h"
+#include "itplus_maybe.h"
+#include "itplus_slice.h"
+
+#include <stddef.h>
+
+/**
+ * @def IterWindows(T)
+ * @brief Convenience macro to get the type of the IterWindows struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindows(int);
+ * IterWindows(int) i; // Declares a variable of type IterWindows(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield. Must be the same type name passed
+ * to #DefineIterWindows(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterWindows(T) ITPL_CONCAT(IterWindows_, T)
+
+/**
+ * @def DefineIterWindows(T)
+ * @brief Define an IterWindows struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindows(int); // Defines an IterWindows(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterWindows(T)                                                                                           \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t size;                                                                                                   \
+        /* Ring buffer of at least `2 * size` elements */                                                              \
+        T* buf;                                                                                                        \
+        size_t filled;                                                                                                 \
+        size_t head;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterWindows(T)
+
+/**
+ * @def define_iterwindows_func(T, Name)
+ * @brief Define a function to turn an #IterWindows(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterWindows(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterWindows(T)*` and wraps it in an `Iterable(Slice(T))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterWindows(int);
+ *
+ * // Implement `Iterator` for `IterWindows(int)`
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intwindows(IterWindows(int)* x)`
+ * define_iterwindows_func(int, wrap_intwindows)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // View every window of 8 consecutive elements in `it` (of type `Iterable(int)`)
+ * int ring[2 * 8];
+ * Iterable(Slice(int)) wins = wrap_intwindows(&(IterWindows(int)){ .size = 8, .buf = ring, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterWindows(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note A yielded slice points into `buf` and is only valid until the next element is extracted.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterwindows_func(T, Name)                                                                               \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterWindows(T), _nxt)(IterWindows(T) * self)                                    \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (self->size == 0) {                                                                                         \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        while (self->filled < self->size) {                                                                            \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(Slice(T));                                                                              \
+            }                                                                                                          \
+            self->buf[self->filled] = self->buf[self->filled + self->size] = from_just_(res);                          \
+            ++(self->filled);                                                                                          \
+            if (self->filled == self->size) {                                                                          \
+                return Just(SliceOf(self->buf, self->size, T), Slice(T));                                              \
+            }                                                                                                          \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_nothing(res)) {                                                                                         \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        /* Overwrite the oldest element, the window now starts right after it */                                       \
+        self->buf[self->head] = self->buf[self->head + self->size] = from_just_(res);                                  \
+        self->head = self->head + 1 == self->size ? 0 : self->head + 1;                                                \
+        return Just(SliceOf(self->buf + self->head, self->size, T), Slice(T));                                         \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterWindows(T)*, Slice(T), Name, ITPL_CONCAT(IterWindows(T), _nxt))
+
+/**
+ * @def IterArrWindows(T)
+ * @brief Convenience macro to get the type of the IterArrWindows struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrWindows(int);
+ * IterArrWindows(int) i; // Declares a variable of type IterArrWindows(int)
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`. Must be the same type name passed
+ * to #DefineIterArrWindows(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterArrWindows(T) ITPL_CONCAT(IterArrWindows_, T)
+
+/**
+ * @def DefineIterArrWindows(T)
+ * @brief Define an IterArrWindows struct that works on arrays of `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrWindows(int); // Defines an IterArrWindows(int) struct
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define DefineIterArrWindows(T)                                                                                        \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        size_t size;                                                                                                   \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrWindows(T)
+
+/**
+ * @def define_iterarrwindows_func(T, Name)
+ * @brief Define a function to turn an #IterArrWindows(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * The defined function takes in a value of type `IterArrWindows(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice points directly into the source array.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrWindows(int);
+ *
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intarrwindows(IterArrWindows(int)* x)`
+ * define_iterarrwindows_func(int, wrap_intarrwindows)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // View every window of 8 consecutive elements in `arr` (an array of `arrlen` ints)
+ * Iterable(Slice(int)) wins = wrap_intarrwindows(&(IterArrWindows(int)){ .size = 8, .len = arrlen, .arr = arr });
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterArrWindows(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterarrwindows_func(T, Name)                                                                            \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterArrWindows(T), _nxt)(IterArrWindows(T) * self)                              \
+    {                                                                                                                  \
+        if (self->size == 0 || self->size > self->len || self->i > self->len - self->size) {                           \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        return Just(SliceOf(self->arr + self->i++, self->size, T), Slice(T));                                          \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterArrWindows(T)*, Slice(T), Name, ITPL_CONCAT(IterArrWindows(T), _nxt))
+
+#endif /* !LIB_ITPLUS_WINDOWS_H */
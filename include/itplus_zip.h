@@ -58,6 +58,7 @@
     {                                                                                                                  \
         Iterable(T) asrc;                                                                                              \
         Iterable(U) bsrc;                                                                                              \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterZip(T, U)
 
 /**
@@ -99,6 +100,8 @@
 #define define_iterzip_func(T, U, Name)                                                                                \
     static Maybe(Pair(T, U)) ITPL_CONCAT(IterZip(T, U), _nxt)(IterZip(T, U) * self)                                    \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->asrc);                                                                           \
+        ITPL_STATS_SRC(self, 1, self->bsrc);                                                                           \
         Iterable(T) const asrcit = self->asrc;                                                                         \
         Iterable(U) const bsrcit = self->bsrc;                                                                         \
         Maybe(T) const ares      = asrcit.tc->next(asrcit.self);                                                       \
@@ -111,6 +114,6 @@
         }                                                                                                              \
         return Just(PairOf(from_just_(ares), from_just_(bres), T, U), Pair(T, U));                                     \
     }                                                                                                                  \
-    impl_iterator(IterZip(T, U)*, Pair(T, U), Name, ITPL_CONCAT(IterZip(T, U), _nxt))
+    impl_instrumented_iterator(IterZip(T, U)*, Pair(T, U), Name, ITPL_CONCAT(IterZip(T, U), _nxt))
 
 #endif /* !LIB_ITPLUS_ZIP_H */
@@ -31,14 +31,27 @@
 #ifndef LIB_ITPLUS_H
 #define LIB_ITPLUS_H
 
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #define ITPL_CONCAT_(A, B) A##B
 #define ITPL_CONCAT(A, B)  ITPL_CONCAT_(A, B)
 
+/* Hint that the memory at given address will be read soon */
+#if defined(__GNUC__) || defined(__clang__)
+#define ITPL_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define ITPL_PREFETCH(addr) ((void)(addr))
+#endif
+
 /**
  * @def typeclass(funcs)
  * @brief Define a typeclass with the given functions.
@@ -234,6 +247,101 @@ typedef enum
  */
 #define fmap_maybe(x, fn, R) is_nothing(x) ? Nothing(R) : Just(fn(from_just_(x)), R)
 
+/**
+ * @brief The stats recorded by an instrumented adapter.
+ */
+typedef struct itpl_stats
+{
+    /* The type of the adapter */
+    char const* name;
+    uint64_t calls;
+    uint64_t yielded;
+    uint64_t cycles;
+    /* Stats of the sources of the adapter, NULL for sources that are not instrumented */
+    struct itpl_stats const* srcs[2];
+    unsigned nsrcs;
+} ItplStats;
+
+#ifdef ITPLUS_INSTRUMENT
+
+#ifndef ITPLUS_INSTRUMENT_CLOCK
+#define ITPLUS_INSTRUMENT_CLOCK() ((uint64_t)0)
+#endif /* !ITPLUS_INSTRUMENT_CLOCK */
+
+/* Declare the stats member of an adapter struct */
+#define ITPL_STATS_MEMBER ItplStats stats;
+
+/* Record the `idx`th source of an adapter, the first time it is seen */
+#define ITPL_STATS_SRC(self, idx, it)                                                                                  \
+    do {                                                                                                               \
+        if ((self)->stats.nsrcs <= (idx)) {                                                                            \
+            (self)->stats.srcs[idx] = itpl_stats_of(it);                                                               \
+            (self)->stats.nsrcs     = (idx) + 1;                                                                       \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def itpl_stats_of(it)
+ * @brief Get the stats of an iterable (of any type), or `NULL` if it is not an instrumented adapter.
+ */
+#define itpl_stats_of(it) ((it).tc->stats != NULL ? (ItplStats const*)(it).tc->stats((it).self) : NULL)
+
+/**
+ * @brief Call `visit` on the given stats, and the stats of all its (instrumented) sources, depth first.
+ *
+ * `depth` is 0 for the given stats, 1 for its sources and so on. Sources that are not instrumented are visited with
+ * `NULL` stats.
+ */
+static inline void itpl_stats_walk(
+    ItplStats const* stats, unsigned depth, void (*visit)(ItplStats const* stats, unsigned depth, void* ctx), void* ctx)
+{
+    visit(stats, depth, ctx);
+    if (stats == NULL) {
+        return;
+    }
+    for (unsigned i = 0; i < stats->nsrcs; i++) {
+        itpl_stats_walk(stats->srcs[i], depth + 1, visit, ctx);
+    }
+}
+
+static inline void itpl_stats_dump_one(ItplStats const* stats, unsigned depth, void* ctx)
+{
+    FILE* const f = ctx;
+    fprintf(f, "%*s", (int)(depth * 2), "");
+    if (stats == NULL) {
+        fprintf(f, "(not instrumented)\n");
+        return;
+    }
+    fprintf(f, "%s: calls=%llu yielded=%llu", stats->name, (unsigned long long)stats->calls,
+        (unsigned long long)stats->yielded);
+    /* Consumed elements are only known if every source is instrumented */
+    uint64_t consumed = 0;
+    unsigned i        = 0;
+    for (; i < stats->nsrcs && stats->srcs[i] != NULL; i++) {
+        consumed += stats->srcs[i]->yielded;
+    }
+    if (stats->nsrcs > 0 && i == stats->nsrcs) {
+        fprintf(f, " consumed=%llu", (unsigned long long)consumed);
+    }
+    fprintf(f, " cycles=%llu\n", (unsigned long long)stats->cycles);
+}
+
+/**
+ * @brief Print the stats of a pipeline as a tree, one adapter per line, with sources indented under their adapter.
+ */
+static inline void itpl_stats_dump(FILE* f, ItplStats const* stats)
+{
+    itpl_stats_walk(stats, 0, itpl_stats_dump_one, f);
+}
+
+#else
+
+#define ITPL_STATS_MEMBER
+#define ITPL_STATS_SRC(self, idx, it) ((void)0)
+#define itpl_stats_of(it)             ((ItplStats const*)NULL)
+
+#endif /* ITPLUS_INSTRUMENT */
+
 /**
  * @def Iterator(T)
  * @brief Convenience macro to get the type of the Iterator (typeclass) with given element type.
@@ -284,9 +392,15 @@ typedef enum
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note A #Maybe(T) for the given `T` **must** also exist.
  */
+#ifdef ITPLUS_INSTRUMENT
+#define DefineIteratorOf(T)                                                                                            \
+    typedef typeclass(Maybe(T) (*const next)(void* self); ItplStats* (*const stats)(void* self)) Iterator(T);          \
+    typedef typeclass_instance(Iterator(T)) Iterable(T)
+#else
 #define DefineIteratorOf(T)                                                                                            \
     typedef typeclass(Maybe(T) (*const next)(void* self)) Iterator(T);                                                 \
     typedef typeclass_instance(Iterator(T)) Iterable(T)
+#endif /* ITPLUS_INSTRUMENT */
 
 /**
  * @def impl_iterator(IterType, ElmntType, Name, next_f)
@@ -351,6 +465,44 @@ typedef enum
         return (Iterable(ElmntType)){.tc = &tc, .self = x};                                                            \
     }
 
+/**
+ * @def impl_instrumented_iterator(IterType, ElmntType, Name, next_f)
+ * @brief Like #impl_iterator, but records the stats of `IterType` if `ITPLUS_INSTRUMENT` is defined.
+ *
+ * This is used by the adapters defined by this library. `IterType` must be a pointer to a struct declaring
+ * `ITPL_STATS_MEMBER`, and `next_f` should record the sources of the struct using `ITPL_STATS_SRC`. See
+ * itplus_instrument.h.
+ *
+ * @note This should not be delimited by a semicolon.
+ */
+#ifdef ITPLUS_INSTRUMENT
+#define impl_instrumented_iterator(IterType, ElmntType, Name, next_f)                                                  \
+    static inline Maybe(ElmntType) ITPL_CONCAT(next_f, __)(void* self)                                                 \
+    {                                                                                                                  \
+        IterType const x           = self;                                                                             \
+        uint64_t const start       = ITPLUS_INSTRUMENT_CLOCK();                                                        \
+        Maybe(ElmntType) const res = (next_f)(x);                                                                      \
+        x->stats.cycles += ITPLUS_INSTRUMENT_CLOCK() - start;                                                          \
+        ++(x->stats.calls);                                                                                            \
+        x->stats.yielded += is_just(res);                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    static inline ItplStats* ITPL_CONCAT(next_f, _stats)(void* self)                                                   \
+    {                                                                                                                  \
+        IterType const x = self;                                                                                       \
+        return &x->stats;                                                                                              \
+    }                                                                                                                  \
+    Iterable(ElmntType) Name(IterType x)                                                                               \
+    {                                                                                                                  \
+        static Iterator(ElmntType) const tc = {                                                                        \
+            .next = (ITPL_CONCAT(next_f, __)), .stats = (ITPL_CONCAT(next_f, _stats))};                                \
+        x->stats.name = #IterType;                                                                                     \
+        return (Iterable(ElmntType)){.tc = &tc, .self = x};                                                            \
+    }
+#else
+#define impl_instrumented_iterator(IterType, ElmntType, Name, next_f) impl_iterator(IterType, ElmntType, Name, next_f)
+#endif /* ITPLUS_INSTRUMENT */
+
 /**
  * @def Pair(T, U)
  * @brief Convenience macro to get the type of the Pair defined with certain types.
@@ -447,6 +599,259 @@ typedef enum
     for (T x          = from_just_(UNIQVAR(res)); is_just(UNIQVAR(res));                                               \
          UNIQVAR(res) = (it).tc->next((it).self), x = from_just_(UNIQVAR(res)))
 
+/**
+ * @def Slice(T)
+ * @brief Convenience macro to get the type of the Slice defined with a certain type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int);
+ * Slice(int) const x = {0}; // Uses the slice type defined in the previous line
+ * @endcode
+ *
+ * @param T The type of the elements this `Slice` views. Must be the same type name passed to #DefineSlice(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define Slice(T) ITPL_CONCAT(Slice_, T)
+
+/**
+ * @def DefineSlice(T)
+ * @brief Define a Slice<T> type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int); // Defines a Slice(int) type
+ * @endcode
+ *
+ * @param T The type of the elements this `Slice` views.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define DefineSlice(T)                                                                                                 \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T const* ptr;                                                                                                  \
+        size_t len;                                                                                                    \
+    } Slice(T)
+
+/**
+ * @def SliceOf(p, n, T)
+ * @brief Wrap a pointer and a length into a #Slice(T).
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(int);
+ * int arr[] = {1, 2, 3};
+ * Slice(int) const x = SliceOf(arr, 3, int); // Initializes a Slice(int) viewing all of `arr`
+ * @endcode
+ *
+ * @param p Pointer to the first element of the slice.
+ * @param n The number of elements in the slice.
+ * @param T The type of the elements.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note A #Slice(T) for given `T` must exist.
+ * @note No implicit cloning is done. The slice is only valid as long as the memory it points to is.
+ */
+#define SliceOf(p, n, T) ((Slice(T)){.ptr = (p), .len = (n)})
+
+/**
+ * @brief A slot for a block read.
+ *
+ * `buf` is filled in by the caller, and must have room for a block. `user` is free for the backend to use, e.g for its
+ * own per read state.
+ */
+typedef struct
+{
+    unsigned char* buf;
+    uint64_t off;
+    size_t len;
+    bool failed;
+    void* user;
+} ItplReadSlot;
+
+/**
+ * @brief A backend to issue block reads through.
+ */
+typedef struct
+{
+    /* Start reading up to `cap` bytes at `slot->off` into `slot->buf`, `false` if the read could not be started */
+    bool (*submit)(void* ctx, ItplReadSlot* slot, size_t cap);
+    /* Wait for the read of `slot` to complete, setting `slot->len` and `slot->failed` */
+    void (*wait)(void* ctx, ItplReadSlot* slot);
+    void* ctx;
+} ItplReadBackend;
+
+static inline bool itpl_stdio_submit(void* ctx, ItplReadSlot* slot, size_t cap)
+{
+    FILE* const f  = ctx;
+    long const pos = ftell(f);
+    /* Reads are submitted in file order, so the file is only out of place for the first one */
+    if (pos >= 0 && (uint64_t)pos != slot->off) {
+        if (slot->off > LONG_MAX || fseek(f, (long)slot->off, SEEK_SET) != 0) {
+            return false;
+        }
+    }
+    slot->len    = fread(slot->buf, 1, cap, f);
+    slot->failed = ferror(f) != 0;
+    return true;
+}
+
+static inline void itpl_stdio_wait(void* ctx, ItplReadSlot* slot)
+{
+    (void)ctx;
+    (void)slot;
+}
+
+/**
+ * @def itpl_stdio_backend(f)
+ * @brief Get a synchronous #ItplReadBackend reading from a `FILE*`.
+ *
+ * The file is positioned at the offset of each read, if it isn't there already. A stream that can't be positioned
+ * (e.g a pipe) is read from wherever it is, so the offset to start reading from must be its current position.
+ */
+#define itpl_stdio_backend(f) ((ItplReadBackend){.submit = itpl_stdio_submit, .wait = itpl_stdio_wait, .ctx = (f)})
+
+/**
+ * @brief A file block iterator, yielding `Slice(char)`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `backend` - The backend to read through.
+ * * `slots`, `depth` - The ring of slots to read into, each with a buffer of `blocksize` bytes.
+ * * `blocksize` - The size of each block.
+ * * `off` - (Optional) The offset to start reading from, `0` by default.
+ *
+ * After iteration, `failed` tells whether a read failed.
+ */
+typedef struct
+{
+    ItplReadBackend backend;
+    ItplReadSlot* slots;
+    size_t depth;
+    size_t blocksize;
+    uint64_t off;
+    /* The next slot to yield, and the number of slots with a read in flight */
+    size_t head;
+    size_t inflight;
+    bool started;
+    bool eof;
+    bool failed;
+    ITPL_STATS_MEMBER
+} IterFileBlocks;
+
+/* Submit a read for the next block into given slot */
+static inline void itpl_blockread_submit(IterFileBlocks* self, size_t i)
+{
+    if (self->eof || self->failed) {
+        return;
+    }
+    ItplReadSlot* const slot = self->slots + i;
+    slot->off                = self->off;
+    slot->len                = 0;
+    slot->failed             = false;
+    if (!self->backend.submit(self->backend.ctx, slot, self->blocksize)) {
+        self->failed = true;
+        return;
+    }
+    self->off += self->blocksize;
+    ++(self->inflight);
+}
+
+/**
+ * @brief Get the next block read, keeping all the slots busy.
+ *
+ * @return The slot holding the block, or `NULL` if there are no more blocks, or a read failed. No reads are in flight
+ * once this returns `NULL`.
+ */
+static inline ItplReadSlot* itpl_blockread_next(IterFileBlocks* self)
+{
+    if (!self->started) {
+        self->started = true;
+        for (size_t i = 0; i < self->depth; i++) {
+            itpl_blockread_submit(self, i);
+        }
+    } else if (self->depth > 0) {
+        /* The slot yielded last is free again */
+        itpl_blockread_submit(self, (self->head + self->depth - 1) % self->depth);
+    }
+    /* A read that could not be submitted only stops further submissions- the ones before it are still yielded */
+    if (self->inflight == 0) {
+        return NULL;
+    }
+    ItplReadSlot* const slot = self->slots + self->head;
+    self->backend.wait(self->backend.ctx, slot);
+    --(self->inflight);
+    self->head = (self->head + 1) % self->depth;
+    if (slot->failed) {
+        self->failed = true;
+        /* Wait for the rest of the reads, so none is still writing into a slot once iteration stops */
+        for (; self->inflight > 0; --(self->inflight)) {
+            self->backend.wait(self->backend.ctx, self->slots + self->head);
+            self->head = (self->head + 1) % self->depth;
+        }
+        return NULL;
+    }
+    if (slot->len < self->blocksize) {
+        /* End of the file- the reads already in flight past it will come back empty */
+        self->eof = true;
+    }
+    return slot;
+}
+
+/**
+ * @def define_iterfileblocks_func(Name)
+ * @brief Define a function to turn an #IterFileBlocks into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterFileBlocks struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterFileBlocks*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterFileBlocks`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_fileblocks(IterFileBlocks* x)`
+ * define_iterfileblocks_func(wrap_fileblocks)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char bufs[4][1 << 20];
+ * ItplReadSlot slots[4] = {{.buf = bufs[0]}, {.buf = bufs[1]}, {.buf = bufs[2]}, {.buf = bufs[3]}};
+ * // Read `f` (of type `FILE*`) in blocks of 1 MiB
+ * setvbuf(f, NULL, _IONBF, 0);
+ * IterFileBlocks fb            = {.backend = itpl_stdio_backend(f), .slots = slots, .depth = 4, .blocksize = 1 << 20};
+ * Iterable(Slice(char)) blocks = wrap_fileblocks(&fb);
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfileblocks_func(Name)                                                                               \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterFileBlocks * self)                                           \
+    {                                                                                                                  \
+        ItplReadSlot* slot;                                                                                            \
+        while ((slot = itpl_blockread_next(self)) != NULL) {                                                           \
+            if (slot->len > 0) {                                                                                       \
+                return Just(SliceOf((char const*)slot->buf, slot->len, char), Slice(char));                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Slice(char));                                                                                   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterFileBlocks*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
+
 /**
  * @def IterChain(T)
  * @brief Convenience macro to get the type of the IterChain struct with given element type.
@@ -485,6 +890,7 @@ typedef enum
     {                                                                                                                  \
         Iterable(T) curr;                                                                                              \
         Iterable(T) nxt;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterChain(T)
 
 /**
@@ -524,6 +930,8 @@ typedef enum
 #define define_iterchain_func(T, Name)                                                                                 \
     static Maybe(T) ITPL_CONCAT(IterChain(T), _nxt)(IterChain(T) * self)                                               \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->curr);                                                                           \
+        ITPL_STATS_SRC(self, 1, self->nxt);                                                                            \
         Iterable(T) const srcit = self->curr;                                                                          \
         Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
         if (is_just(res)) {                                                                                            \
@@ -533,916 +941,8119 @@ typedef enum
         Iterable(T) re_srcit = self->curr;                                                                             \
         return re_srcit.tc->next(re_srcit.self);                                                                       \
     }                                                                                                                  \
-    impl_iterator(IterChain(T)*, T, Name, ITPL_CONCAT(IterChain(T), _nxt))
-
-#ifndef ITPLUS_COLLECT_BUFSZ
-#define ITPLUS_COLLECT_BUFSZ 64
-#endif /* !ITPLUS_COLLECT_BUFSZ */
-
-/**
- * @def define_itercollect_func(T, Name)
- * @brief Define the `collect` function for an iterable.
- *
- * The defined function takes in an iterable of type `T`, and turns it into an array. Each element of said array
- * is of type `T`.
- *
- * This defined function will consume the given iterable.
- *
- * # Example
- *
- * @code
- * // Defines a function with the signature- `int* collect_int(Iterable(int) x, size_t* len)`
- * define_itercollect_func(int, collect_int)
- * @endcode
- *
- * Usage of the defined function-
- *
- * @code
- * size_t arrlen = 0;
- * // Collect `it` (of type `Iterable(int)`) into an array
- * int* intarr = collect_int(it, &arrlen);
- * @endcode
- *
- * @param T The type of value the `Iterable`, for which this is being implemented, yields.
- * @param Name Name to define the function as.
- *
- * @note The returned array must be freed.
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
- * @note An #Iterator(T) for the given `T` **must** also exist.
- */
-#define define_itercollect_func(T, Name)                                                                               \
-    T* Name(Iterable(T) it, size_t* len)                                                                               \
-    {                                                                                                                  \
-        size_t size = ITPLUS_COLLECT_BUFSZ;                                                                            \
-        *len        = 0;                                                                                               \
-        T* arr      = malloc(size * sizeof(*arr));                                                                     \
-        if (arr == NULL) {                                                                                             \
-            return NULL;                                                                                               \
-        }                                                                                                              \
-        foreach (T, x, it) {                                                                                           \
-            if (*len == size) {                                                                                        \
-                T* temp = realloc(arr, (size *= 2) * sizeof(*arr));                                                    \
-                if (temp == NULL) {                                                                                    \
-                    free(arr);                                                                                         \
-                    return NULL;                                                                                       \
-                }                                                                                                      \
-                arr = temp;                                                                                            \
-            }                                                                                                          \
-            arr[(*len)++] = x;                                                                                         \
-        }                                                                                                              \
-        return arr;                                                                                                    \
-    }
+    impl_instrumented_iterator(IterChain(T)*, T, Name, ITPL_CONCAT(IterChain(T), _nxt))
 
 /**
- * @def IterDrop(T)
- * @brief Convenience macro to get the type of the IterDrop struct with given element type.
+ * @def IterChunks(T)
+ * @brief Convenience macro to get the type of the IterChunks struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterDrop(int);
- * IterDrop(int) i; // Declares a variable of type IterDrop(int)
+ * DefineIterChunks(int);
+ * IterChunks(int) i; // Declares a variable of type IterChunks(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield. Must be the same type name passed to
- * #DefineIterDrop(T).
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield. Must be the same type name passed
+ * to #DefineIterChunks(T).
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  */
-#define IterDrop(T) ITPL_CONCAT(IterDrop_, T)
+#define IterChunks(T) ITPL_CONCAT(IterChunks_, T)
 
 /**
- * @def DefineIterDrop(T)
- * @brief Define an IterDrop struct that works on `Iterable(T)`s.
+ * @def DefineIterChunks(T)
+ * @brief Define an IterChunks struct that works on `Iterable(T)`s.
  *
  * # Example
  *
  * @code
- * DefineIterDrop(int); // Defines an IterDrop(int) struct
+ * DefineIterChunks(int); // Defines an IterChunks(int) struct
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterDrop(T)                                                                                              \
+#define DefineIterChunks(T)                                                                                            \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        size_t i;                                                                                                      \
-        size_t limit;                                                                                                  \
+        size_t size;                                                                                                   \
+        /* Buffer of at least `size` elements, reused for every chunk */                                               \
+        T* buf;                                                                                                        \
         Iterable(T) src;                                                                                               \
-    } IterDrop(T)
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterChunks(T)
 
 /**
- * @def define_iterdrop_func(T, Name)
- * @brief Define a function to turn an #IterDrop(T) into an #Iterable(T).
+ * @def define_iterchunks_func(T, Name)
+ * @brief Define a function to turn an #IterChunks(T) into an #Iterable(T) where `T = Slice(T)`.
  *
- * Define the `next` function implementation for the #IterDrop(T) struct, and use it to implement the Iterator
+ * Define the `next` function implementation for the #IterChunks(T) struct, and use it to implement the Iterator
  * typeclass, for given `T`.
  *
- * The defined function takes in a value of type `IterDrop(T)*` and wraps it in an `Iterable(T)`.
+ * The defined function takes in a value of type `IterChunks(T)*` and wraps it in an `Iterable(Slice(T))`.
  *
  * # Example
  *
  * @code
- * DefineIterDrop(int);
+ * DefineIterChunks(int);
  *
- * // Implement `Iterator` for `IterDrop(int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrdrp(IterDrop(int)* x)`
- * define_iterdrop_func(int, wrap_intitrdrp)
+ * // Implement `Iterator` for `IterChunks(int)`
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intchunks(IterChunks(int)* x)`
+ * define_iterchunks_func(int, wrap_intchunks)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * // Drop (skip) the first 10 elements from `it` (of type `Iterable(int)`) and create a new iterable
- * Iterable(int) after10 = wrap_intitrdrp(&(IterDrop(int)){ .limit = 10, .src = it });
+ * // Group `it` (of type `Iterable(int)`) into chunks of 64 elements
+ * int buf[64];
+ * Iterable(Slice(int)) blocks = wrap_intchunks(&(IterChunks(int)){ .size = 64, .buf = buf, .src = it });
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterChunks` will yield.
  * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
  * alphanumerics.
- * @note An #IterDrop(T) for the given `T` **must** exist.
+ * @note An #IterChunks(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note A yielded slice points into `buf` and is only valid until the next element is extracted.
  * @note This should not be delimited by a semicolon.
  */
-#define define_iterdrop_func(T, Name)                                                                                  \
-    static Maybe(T) ITPL_CONCAT(IterDrop(T), _nxt)(IterDrop(T) * self)                                                 \
+#define define_iterchunks_func(T, Name)                                                                                \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterChunks(T), _nxt)(IterChunks(T) * self)                                      \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(T) const srcit = self->src;                                                                           \
-        foreach (T, x, srcit) {                                                                                        \
-            if (self->i >= self->limit) {                                                                              \
-                return Just(x, T);                                                                                     \
+        size_t n                = 0;                                                                                   \
+        while (n < self->size) {                                                                                       \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                break;                                                                                                 \
             }                                                                                                          \
-            ++(self->i);                                                                                               \
+            self->buf[n++] = from_just_(res);                                                                          \
         }                                                                                                              \
-        return Nothing(T);                                                                                             \
+        return n == 0 ? Nothing(Slice(T)) : Just(SliceOf(self->buf, n, T), Slice(T));                                  \
     }                                                                                                                  \
-    impl_iterator(IterDrop(T)*, T, Name, ITPL_CONCAT(IterDrop(T), _nxt))
+    impl_instrumented_iterator(IterChunks(T)*, Slice(T), Name, ITPL_CONCAT(IterChunks(T), _nxt))
 
 /**
- * @def IterDropWhile(T)
- * @brief Convenience macro to get the type of the IterDropWhile struct with given element type.
+ * @def IterArrChunks(T)
+ * @brief Convenience macro to get the type of the IterArrChunks struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterDropWhile(int);
- * IterDropWhile(int) i; // Declares a variable of type IterDropWhile(int)
+ * DefineIterArrChunks(int);
+ * IterArrChunks(int) i; // Declares a variable of type IterArrChunks(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield. Must be the same type name
- * passed to #DefineIterDropWhile(T).
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`. Must be the same type name passed to
+ * #DefineIterArrChunks(T).
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  */
-#define IterDropWhile(T) ITPL_CONCAT(IterDropWhile_, T)
+#define IterArrChunks(T) ITPL_CONCAT(IterArrChunks_, T)
 
 /**
- * @def DefineIterDropWhile(T)
- * @brief Define an IterDropWhile struct that works on `Iterable(T)`s.
+ * @def DefineIterArrChunks(T)
+ * @brief Define an IterArrChunks struct that works on arrays of `T`.
  *
  * # Example
  *
  * @code
- * DefineIterDropWhile(int); // Defines an IterDropWhile(int) struct
+ * DefineIterArrChunks(int); // Defines an IterArrChunks(int) struct
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield.
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
- * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterDropWhile(T)                                                                                         \
+#define DefineIterArrChunks(T)                                                                                         \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        bool (*pred)(T x);                                                                                             \
-        bool done;                                                                                                     \
-        Iterable(T) src;                                                                                               \
-    } IterDropWhile(T)
+        size_t i;                                                                                                      \
+        size_t size;                                                                                                   \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrChunks(T)
 
 /**
- * @def define_iterdropwhile_func(T, Name)
+ * @def define_iterarrchunks_func(T, Name)
+ * @brief Define a function to turn an #IterArrChunks(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * The defined function takes in a value of type `IterArrChunks(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice points directly into the source array.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrChunks(int);
+ *
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intarrchunks(IterArrChunks(int)* x)`
+ * define_iterarrchunks_func(int, wrap_intarrchunks)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Split `arr` (an array of `arrlen` ints) into chunks of 64 elements
+ * Iterable(Slice(int)) blocks = wrap_intarrchunks(&(IterArrChunks(int)){ .size = 64, .len = arrlen, .arr = arr });
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrChunks`.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterArrChunks(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterarrchunks_func(T, Name)                                                                             \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterArrChunks(T), _nxt)(IterArrChunks(T) * self)                                \
+    {                                                                                                                  \
+        if (self->size == 0 || self->i >= self->len) {                                                                 \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        size_t const n   = self->len - self->i < self->size ? self->len - self->i : self->size;                        \
+        T const* const p = self->arr + self->i;                                                                        \
+        self->i += n;                                                                                                  \
+        return Just(SliceOf(p, n, T), Slice(T));                                                                       \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterArrChunks(T)*, Slice(T), Name, ITPL_CONCAT(IterArrChunks(T), _nxt))
+
+#ifndef ITPLUS_COLLECT_BUFSZ
+#define ITPLUS_COLLECT_BUFSZ 64
+#endif /* !ITPLUS_COLLECT_BUFSZ */
+
+/**
+ * @def define_itercollect_func(T, Name)
+ * @brief Define the `collect` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, and turns it into an array. Each element of said array
+ * is of type `T`.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature- `int* collect_int(Iterable(int) x, size_t* len)`
+ * define_itercollect_func(int, collect_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * size_t arrlen = 0;
+ * // Collect `it` (of type `Iterable(int)`) into an array
+ * int* intarr = collect_int(it, &arrlen);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note The returned array must be freed.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_itercollect_func(T, Name)                                                                               \
+    T* Name(Iterable(T) it, size_t* len)                                                                               \
+    {                                                                                                                  \
+        size_t size = ITPLUS_COLLECT_BUFSZ;                                                                            \
+        *len        = 0;                                                                                               \
+        T* arr      = malloc(size * sizeof(*arr));                                                                     \
+        if (arr == NULL) {                                                                                             \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (*len == size) {                                                                                        \
+                T* temp = realloc(arr, (size *= 2) * sizeof(*arr));                                                    \
+                if (temp == NULL) {                                                                                    \
+                    free(arr);                                                                                         \
+                    return NULL;                                                                                       \
+                }                                                                                                      \
+                arr = temp;                                                                                            \
+            }                                                                                                          \
+            arr[(*len)++] = x;                                                                                         \
+        }                                                                                                              \
+        return arr;                                                                                                    \
+    }
+
+/**
+ * @brief Count the occurrences of every value of every digit of given keys, in one pass.
+ */
+static inline void itpl_radix_count(uint64_t const* keys, size_t n, size_t counts[8][256])
+{
+    memset(counts, 0, 8 * sizeof(*counts));
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const k = keys[i];
+        for (unsigned d = 0; d < 8; d++) {
+            ++(counts[d][(k >> (d * 8)) & 0xFF]);
+        }
+    }
+}
+
+/**
+ * @brief Turn the counts of a digit's values into the offsets their elements start at.
+ *
+ * @return `false` if every one of the `n` keys has the same value for this digit, in which case the pass can be
+ * skipped, and the counts are left as is.
+ */
+static inline bool itpl_radix_offsets(size_t counts[256], size_t n)
+{
+    size_t sum = 0;
+    for (unsigned v = 0; v < 256; v++) {
+        if (counts[v] == n) {
+            return false;
+        }
+    }
+    for (unsigned v = 0; v < 256; v++) {
+        size_t const c = counts[v];
+        counts[v]      = sum;
+        sum += c;
+    }
+    return true;
+}
+
+/**
+ * @def define_itercollectsorted_func(T, Name)
+ * @brief Define the `collect_sorted` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, and a key function of type `uint64_t (*key)(T x)`, and turns
+ * the iterable into an array sorted by the key, in ascending order. Elements with equal keys stay in the order they
+ * were yielded in.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { uint32_t id; double score; } Row;
+ *
+ * // The defined function has the signature:-
+ * // `Row* collect_sorted_row(Iterable(Row) x, size_t* len, uint64_t (*key)(Row x))`
+ * define_itercollectsorted_func(Row, collect_sorted_row)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t row_id(Row x) { return x.id; }
+ * @endcode
+ *
+ * @code
+ * size_t arrlen = 0;
+ * // Collect `it` (of type `Iterable(Row)`) into an array sorted by id
+ * Row* rows = collect_sorted_row(it, &arrlen, row_id);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note The returned array must be freed.
+ * @note Apart from the returned array, the sort needs memory for another array of the same length, and 2 arrays of
+ * keys, all of which are freed before returning.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_itercollectsorted_func(T, Name)                                                                         \
+    T* Name(Iterable(T) it, size_t* len, uint64_t (*key)(T x))                                                         \
+    {                                                                                                                  \
+        size_t size    = ITPLUS_COLLECT_BUFSZ;                                                                         \
+        *len           = 0;                                                                                            \
+        T* arr         = malloc(size * sizeof(*arr));                                                                  \
+        uint64_t* keys = malloc(size * sizeof(*keys));                                                                 \
+        if (arr == NULL || keys == NULL) {                                                                             \
+            free(arr);                                                                                                 \
+            free(keys);                                                                                                \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (*len == size) {                                                                                        \
+                size *= 2;                                                                                             \
+                T* const temp = realloc(arr, size * sizeof(*arr));                                                     \
+                if (temp == NULL) {                                                                                    \
+                    free(arr);                                                                                         \
+                    free(keys);                                                                                        \
+                    return NULL;                                                                                       \
+                }                                                                                                      \
+                arr                      = temp;                                                                       \
+                uint64_t* const tempkeys = realloc(keys, size * sizeof(*keys));                                        \
+                if (tempkeys == NULL) {                                                                                \
+                    free(arr);                                                                                         \
+                    free(keys);                                                                                        \
+                    return NULL;                                                                                       \
+                }                                                                                                      \
+                keys = tempkeys;                                                                                       \
+            }                                                                                                          \
+            arr[*len]      = x;                                                                                        \
+            keys[(*len)++] = key(x);                                                                                   \
+        }                                                                                                              \
+        if (*len > 1) {                                                                                                \
+            size_t counts[8][256];                                                                                     \
+            size_t const n    = *len;                                                                                  \
+            T* altarr         = malloc(n * sizeof(*altarr));                                                           \
+            uint64_t* altkeys = malloc(n * sizeof(*altkeys));                                                          \
+            if (altarr == NULL || altkeys == NULL) {                                                                   \
+                free(altarr);                                                                                          \
+                free(altkeys);                                                                                         \
+                free(arr);                                                                                             \
+                free(keys);                                                                                            \
+                return NULL;                                                                                           \
+            }                                                                                                          \
+            itpl_radix_count(keys, n, counts);                                                                         \
+            for (unsigned d = 0; d < 8; d++) {                                                                         \
+                if (!itpl_radix_offsets(counts[d], n)) {                                                               \
+                    continue;                                                                                          \
+                }                                                                                                      \
+                for (size_t i = 0; i < n; i++) {                                                                       \
+                    size_t const pos = counts[d][(keys[i] >> (d * 8)) & 0xFF]++;                                       \
+                    altarr[pos]      = arr[i];                                                                         \
+                    altkeys[pos]     = keys[i];                                                                        \
+                }                                                                                                      \
+                T* const temp            = arr;                                                                        \
+                uint64_t* const tempkeys = keys;                                                                       \
+                arr                      = altarr;                                                                     \
+                keys                     = altkeys;                                                                    \
+                altarr                   = temp;                                                                       \
+                altkeys                  = tempkeys;                                                                   \
+            }                                                                                                          \
+            free(altarr);                                                                                              \
+            free(altkeys);                                                                                             \
+        }                                                                                                              \
+        free(keys);                                                                                                    \
+        return arr;                                                                                                    \
+    }
+
+/**
+ * @brief A view of a field of a CSV record.
+ */
+typedef struct
+{
+    char const* ptr;
+    size_t len;
+    /* Whether the field was quoted, in which case it may contain doubled quotes */
+    bool quoted;
+} ItplCsvField;
+
+/**
+ * @brief A record of a CSV buffer.
+ *
+ * `fields` holds the first `len` fields. `nfields` is the actual number of fields in the record, which is larger than
+ * `len` if the field array was too small to hold all of them.
+ */
+typedef struct
+{
+    ItplCsvField const* fields;
+    size_t len;
+    size_t nfields;
+} ItplCsvRecord;
+
+/**
+ * @brief A CSV record iterator, yielding `ItplCsvRecord`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to parse.
+ * * `fields`, `cap` - The array to store the fields of each record in.
+ * * `delim` - (Optional) The field delimiter. Defaults to `,`.
+ *
+ * After iteration, `malformed` tells whether any malformed input was encountered.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    ItplCsvField* fields;
+    size_t cap;
+    char delim;
+    size_t pos;
+    bool malformed;
+    ITPL_STATS_MEMBER
+} IterCsv;
+
+/* Check whether any byte of `x` is equal to the byte repeated in `pattern` */
+static inline bool itpl_csv_hasbyte(uint64_t x, uint64_t pattern)
+{
+    uint64_t const v = x ^ pattern;
+    return ((v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL) != 0;
+}
+
+/**
+ * @brief Find the first delimiter, `\n` or `\r` in a buffer, or the end of the buffer.
+ */
+static inline size_t itpl_csv_scan(char const* s, size_t len, char delim)
+{
+    uint64_t const ones = 0x0101010101010101ULL;
+    uint64_t const d    = ones * (unsigned char)delim;
+    uint64_t const lf   = ones * '\n';
+    uint64_t const cr   = ones * '\r';
+    size_t i            = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (itpl_csv_hasbyte(word, d) || itpl_csv_hasbyte(word, lf) || itpl_csv_hasbyte(word, cr)) {
+            break;
+        }
+    }
+    while (i < len && s[i] != delim && s[i] != '\n' && s[i] != '\r') {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Parse the field starting at `self->pos`, advancing `self->pos` to the byte that ends it.
+ */
+static inline ItplCsvField itpl_csv_field(IterCsv* self, char delim)
+{
+    char const* const buf = self->buf;
+    size_t const len      = self->len;
+    size_t i              = self->pos;
+    if (i == len || buf[i] != '"') {
+        size_t const n = itpl_csv_scan(buf + i, len - i, delim);
+        self->pos      = i + n;
+        return (ItplCsvField){.ptr = buf + i, .len = n, .quoted = false};
+    }
+    size_t const start = ++i;
+    while (1) {
+        char const* const q = memchr(buf + i, '"', len - i);
+        if (q == NULL) {
+            /* Unterminated quote, the field extends to the end */
+            self->malformed = true;
+            self->pos       = len;
+            return (ItplCsvField){.ptr = buf + start, .len = len - start, .quoted = true};
+        }
+        i = (size_t)(q - buf) + 1;
+        if (i < len && buf[i] == '"') {
+            /* Doubled quote */
+            i++;
+            continue;
+        }
+        ItplCsvField const field = {.ptr = buf + start, .len = i - 1 - start, .quoted = true};
+        if (i < len && buf[i] != delim && buf[i] != '\n' && buf[i] != '\r') {
+            /* Skip whatever follows the closing quote */
+            self->malformed = true;
+            i += itpl_csv_scan(buf + i, len - i, delim);
+        }
+        self->pos = i;
+        return field;
+    }
+}
+
+/**
+ * @brief Parse the next record into `self->fields`.
+ *
+ * @return `false` if there are no more records.
+ */
+static inline bool itpl_csv_record(IterCsv* self, ItplCsvRecord* rec)
+{
+    char const delim = self->delim == '\0' ? ',' : self->delim;
+    /* Skip empty lines */
+    while (self->pos < self->len && (self->buf[self->pos] == '\n' || self->buf[self->pos] == '\r')) {
+        ++(self->pos);
+    }
+    if (self->pos == self->len) {
+        return false;
+    }
+    rec->fields  = self->fields;
+    rec->len     = 0;
+    rec->nfields = 0;
+    while (1) {
+        ItplCsvField const field = itpl_csv_field(self, delim);
+        if (rec->nfields++ < self->cap) {
+            self->fields[rec->len++] = field;
+        }
+        if (self->pos == self->len) {
+            return true;
+        }
+        char const c = self->buf[(self->pos)++];
+        if (c == '\r' && self->pos < self->len && self->buf[self->pos] == '\n') {
+            ++(self->pos);
+        }
+        if (c != delim) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Copy a field, undoubling the quotes of quoted fields.
+ *
+ * @param field The field to copy.
+ * @param out Where to copy it to, must have room for `field.len` bytes.
+ *
+ * @return The length of the copy.
+ */
+static inline size_t itpl_csv_unquote(ItplCsvField field, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < field.len; i++) {
+        out[n++] = field.ptr[i];
+        if (field.quoted && field.ptr[i] == '"' && i + 1 < field.len && field.ptr[i + 1] == '"') {
+            i++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @def define_itercsv_func(Name)
+ * @brief Define a function to turn an #IterCsv into an `Iterable(ItplCsvRecord)`.
+ *
+ * Define the `next` function implementation for the #IterCsv struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterCsv*` and wraps it in an `Iterable(ItplCsvRecord)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineMaybe(ItplCsvRecord)
+ * DefineIteratorOf(ItplCsvRecord);
+ *
+ * // Implement `Iterator` for `IterCsv`
+ * // The defined function has the signature- `Iterable(ItplCsvRecord) wrap_csv(IterCsv* x)`
+ * define_itercsv_func(wrap_csv)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * ItplCsvField fields[16];
+ * // Parse the CSV data in `data` (of type `char const*`), of length `datalen`
+ * Iterable(ItplCsvRecord) records = wrap_csv(&(IterCsv){ .buf = data, .len = datalen, .fields = fields, .cap = 16 });
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = ItplCsvRecord` **must** exist.
+ * @note The fields of a record are overwritten by the next record, copy them out of the record if they're needed after.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itercsv_func(Name)                                                                                      \
+    static Maybe(ItplCsvRecord) ITPL_CONCAT(Name, _nxt)(IterCsv * self)                                                \
+    {                                                                                                                  \
+        ItplCsvRecord rec;                                                                                             \
+        if (!itpl_csv_record(self, &rec)) {                                                                            \
+            return Nothing(ItplCsvRecord);                                                                             \
+        }                                                                                                              \
+        return Just(rec, ItplCsvRecord);                                                                               \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterCsv*, ItplCsvRecord, Name, ITPL_CONCAT(Name, _nxt))
+
+#ifndef ITPLUS_HASH_MINCAP
+#define ITPLUS_HASH_MINCAP 16
+#endif /* !ITPLUS_HASH_MINCAP */
+
+/**
+ * @def ITPL_HASH_EMPTY
+ * @brief The control byte of an empty slot.
+ */
+#define ITPL_HASH_EMPTY 0
+
+/**
+ * @brief Mix the bits of a 64 bit integer. Serves as a good hash function for integer keys.
+ *
+ * This is the finalizer of splitmix64.
+ */
+static inline uint64_t itpl_hash_u64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @brief Hash an arbitrary sequence of bytes (FNV-1a, with the result mixed through #itpl_hash_u64).
+ */
+static inline uint64_t itpl_hash_bytes(void const* p, size_t n)
+{
+    unsigned char const* b = p;
+    uint64_t h             = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+    return itpl_hash_u64(h);
+}
+
+/**
+ * @brief Get the control byte for a full slot holding an element with given hash.
+ */
+static inline uint8_t itpl_hash_tag(uint64_t h) { return (uint8_t)(0x80 | (h >> 57)); }
+
+/**
+ * @brief Check whether a table of given capacity can hold `len` elements without exceeding its maximum load.
+ *
+ * At least one slot is always left empty, even in tables too small for 7/8ths to leave any, so that probing for a
+ * missing element terminates.
+ */
+static inline int itpl_hash_fits(size_t len, size_t cap) { return len < cap && len <= cap - cap / 8; }
+
+/**
+ * @brief Get the smallest table capacity that can hold `n` elements.
+ */
+static inline size_t itpl_hash_capfor(size_t n)
+{
+    size_t cap = ITPLUS_HASH_MINCAP;
+    while (!itpl_hash_fits(n, cap)) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+/**
+ * @brief Get the capacity to grow a table of given capacity to- double, or large enough for `hint` elements if the
+ * table has no storage yet.
+ */
+static inline size_t itpl_hash_growcap(size_t cap, size_t hint) { return cap == 0 ? itpl_hash_capfor(hint) : cap * 2; }
+
+/**
+ * @brief Find the first empty slot in the probe sequence of given hash, and mark it full.
+ *
+ * This inserts an element known not to be in the table, e.g when moving elements into a grown table- the caller then
+ * stores the element itself at the returned position. The table must have an empty slot (see #itpl_hash_fits).
+ */
+static inline size_t itpl_hash_claim(uint8_t* ctrl, size_t cap, uint64_t h)
+{
+    size_t pos = (size_t)h & (cap - 1);
+    while (ctrl[pos] != ITPL_HASH_EMPTY) {
+        pos = (pos + 1) & (cap - 1);
+    }
+    ctrl[pos] = itpl_hash_tag(h);
+    return pos;
+}
+
+/**
+ * @def ITPL_HASH_FIND(ctrl, cap, keys, eq, key, h, pos)
+ * @brief Set `pos` to the slot holding an element equal to `key`, with hash `h`, or to the empty slot where it would
+ * be inserted if there is none.
+ *
+ * `keys` is the array of elements stored alongside the control bytes, and `eq` the function to compare them with-
+ * which is only called when the tags match. The table must have an empty slot (see #itpl_hash_fits).
+ */
+#define ITPL_HASH_FIND(ctrl, cap, keys, eq, key, h, pos)                                                               \
+    do {                                                                                                               \
+        uint8_t const itpl_tag = itpl_hash_tag(h);                                                                     \
+        (pos)                  = (size_t)(h) & ((cap) - 1);                                                            \
+        while ((ctrl)[(pos)] != ITPL_HASH_EMPTY && ((ctrl)[(pos)] != itpl_tag || !(eq)((keys)[(pos)], (key)))) {       \
+            (pos) = ((pos) + 1) & ((cap) - 1);                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def IterDistinct(T)
+ * @brief Convenience macro to get the type of the IterDistinct struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int);
+ * IterDistinct(int) i; // Declares a variable of type IterDistinct(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield. Must be the same type name
+ * passed to #DefineIterDistinct(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDistinct(T) ITPL_CONCAT(IterDistinct_, T)
+
+/**
+ * @def DefineIterDistinct(T)
+ * @brief Define an IterDistinct struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `hash` - The hash function. Only the first occurrence of elements with equal hashes *and* equal values is yielded.
+ * * `eq` - The equality function.
+ * * `ctrl`, `slots`, `cap` - (Optional) Initial storage for the set. `cap` must be a power of 2, `ctrl` must point to
+ *   `cap` zeroed bytes, and `slots` to `cap` elements. If the set outgrows this storage (or none is given), it is moved
+ *   to (and grown on) the heap.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int); // Defines an IterDistinct(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDistinct(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        uint64_t (*hash)(T x);                                                                                         \
+        bool (*eq)(T a, T b);                                                                                          \
+        uint8_t* ctrl;                                                                                                 \
+        T* slots;                                                                                                      \
+        size_t cap;                                                                                                    \
+        size_t len;                                                                                                    \
+        /* Whether `ctrl` and `slots` were allocated by the iterator */                                                \
+        bool owned;                                                                                                    \
+        /* Set if the set could not be grown, iteration stops early */                                                 \
+        bool failed;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDistinct(T)
+
+/**
+ * @def iterdistinct_free(x)
+ * @brief Free the heap storage of an #IterDistinct(T) (given as a pointer), if it owns any.
+ *
+ * Caller supplied storage is left alone.
+ */
+#define iterdistinct_free(x)                                                                                           \
+    do {                                                                                                               \
+        if ((x)->owned) {                                                                                              \
+            free((x)->ctrl);                                                                                           \
+            free((x)->slots);                                                                                          \
+            (x)->owned = false;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def define_iterdistinct_func(T, Name)
+ * @brief Define a function to turn an #IterDistinct(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDistinct(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDistinct(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDistinct(int);
+ *
+ * // Implement `Iterator` for `IterDistinct(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intdistinct(IterDistinct(int)* x)`
+ * define_iterdistinct_func(int, wrap_intdistinct)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * static bool int_eq(int a, int b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Yield each distinct element of `it` (of type `Iterable(int)`) once, starting off with a set of 1024 slots
+ * uint8_t ctrl[1024] = { 0 };
+ * int slots[1024];
+ * IterDistinct(int) d = { .hash = int_hash, .eq = int_eq, .ctrl = ctrl, .slots = slots, .cap = 1024, .src = it };
+ * Iterable(int) uniq  = wrap_intdistinct(&d);
+ * // Use `uniq`, and then free the set
+ * iterdistinct_free(&d);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDistinct` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDistinct(T) for the given `T` **must** exist.
+ * @note If the set needs to grow and the allocation fails, iteration stops and the `failed` member is set.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdistinct_func(T, Name)                                                                              \
+    static bool ITPL_CONCAT(IterDistinct(T), _grow)(IterDistinct(T) * self)                                            \
+    {                                                                                                                  \
+        size_t const cap    = itpl_hash_growcap(self->cap, 0);                                                         \
+        uint8_t* const ctrl = calloc(cap, sizeof(*ctrl));                                                              \
+        T* const slots      = malloc(cap * sizeof(*slots));                                                            \
+        if (ctrl == NULL || slots == NULL) {                                                                           \
+            free(ctrl);                                                                                                \
+            free(slots);                                                                                               \
+            return false;                                                                                              \
+        }                                                                                                              \
+        for (size_t i = 0; i < self->cap; i++) {                                                                       \
+            if (self->ctrl[i] != ITPL_HASH_EMPTY) {                                                                    \
+                slots[itpl_hash_claim(ctrl, cap, self->hash(self->slots[i]))] = self->slots[i];                        \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (self->owned) {                                                                                             \
+            free(self->ctrl);                                                                                          \
+            free(self->slots);                                                                                         \
+        }                                                                                                              \
+        self->ctrl  = ctrl;                                                                                            \
+        self->slots = slots;                                                                                           \
+        self->cap   = cap;                                                                                             \
+        self->owned = true;                                                                                            \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterDistinct(T), _nxt)(IterDistinct(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (self->failed || (self->cap == 0 && !ITPL_CONCAT(IterDistinct(T), _grow)(self))) {                          \
+            self->failed = true;                                                                                       \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        while (1) {                                                                                                    \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            T const x        = from_just_(res);                                                                        \
+            uint64_t const h = self->hash(x);                                                                          \
+            size_t pos;                                                                                                \
+            ITPL_HASH_FIND(self->ctrl, self->cap, self->slots, self->eq, x, h, pos);                                   \
+            if (self->ctrl[pos] != ITPL_HASH_EMPTY) {                                                                  \
+                continue;                                                                                              \
+            }                                                                                                          \
+            if (itpl_hash_fits(self->len + 1, self->cap)) {                                                            \
+                self->ctrl[pos] = itpl_hash_tag(h);                                                                    \
+            } else if (ITPL_CONCAT(IterDistinct(T), _grow)(self)) {                                                    \
+                pos = itpl_hash_claim(self->ctrl, self->cap, h);                                                       \
+            } else {                                                                                                   \
+                self->failed = true;                                                                                   \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            self->slots[pos] = x;                                                                                      \
+            ++(self->len);                                                                                             \
+            return Just(x, T);                                                                                         \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDistinct(T)*, T, Name, ITPL_CONCAT(IterDistinct(T), _nxt))
+
+/**
+ * @def IterDedup(T)
+ * @brief Convenience macro to get the type of the IterDedup struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int);
+ * IterDedup(int) i; // Declares a variable of type IterDedup(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield. Must be the same type name passed
+ * to #DefineIterDedup(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDedup(T) ITPL_CONCAT(IterDedup_, T)
+
+/**
+ * @def DefineIterDedup(T)
+ * @brief Define an IterDedup struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int); // Defines an IterDedup(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDedup(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        bool (*eq)(T a, T b);                                                                                          \
+        bool started;                                                                                                  \
+        T last;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDedup(T)
+
+/**
+ * @def define_iterdedup_func(T, Name)
+ * @brief Define a function to turn an #IterDedup(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDedup(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDedup(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDedup(int);
+ *
+ * // Implement `Iterator` for `IterDedup(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intdedup(IterDedup(int)* x)`
+ * define_iterdedup_func(int, wrap_intdedup)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static bool int_eq(int a, int b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Collapse runs of equal elements in `it` (of type `Iterable(int)`)
+ * Iterable(int) runs = wrap_intdedup(&(IterDedup(int)){ .eq = int_eq, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDedup` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDedup(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdedup_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterDedup(T), _nxt)(IterDedup(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        while (1) {                                                                                                    \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            if (!self->started || !self->eq(self->last, from_just_(res))) {                                            \
+                self->started = true;                                                                                  \
+                self->last    = from_just_(res);                                                                       \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDedup(T)*, T, Name, ITPL_CONCAT(IterDedup(T), _nxt))
+
+/**
+ * @def IterDrop(T)
+ * @brief Convenience macro to get the type of the IterDrop struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDrop(int);
+ * IterDrop(int) i; // Declares a variable of type IterDrop(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield. Must be the same type name passed to
+ * #DefineIterDrop(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDrop(T) ITPL_CONCAT(IterDrop_, T)
+
+/**
+ * @def DefineIterDrop(T)
+ * @brief Define an IterDrop struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDrop(int); // Defines an IterDrop(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDrop(T)                                                                                              \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        size_t limit;                                                                                                  \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDrop(T)
+
+/**
+ * @def define_iterdrop_func(T, Name)
+ * @brief Define a function to turn an #IterDrop(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDrop(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDrop(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDrop(int);
+ *
+ * // Implement `Iterator` for `IterDrop(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrdrp(IterDrop(int)* x)`
+ * define_iterdrop_func(int, wrap_intitrdrp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Drop (skip) the first 10 elements from `it` (of type `Iterable(int)`) and create a new iterable
+ * Iterable(int) after10 = wrap_intitrdrp(&(IterDrop(int)){ .limit = 10, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDrop` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDrop(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdrop_func(T, Name)                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterDrop(T), _nxt)(IterDrop(T) * self)                                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        foreach (T, x, srcit) {                                                                                        \
+            if (self->i >= self->limit) {                                                                              \
+                return Just(x, T);                                                                                     \
+            }                                                                                                          \
+            ++(self->i);                                                                                               \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDrop(T)*, T, Name, ITPL_CONCAT(IterDrop(T), _nxt))
+
+/**
+ * @def IterDropWhile(T)
+ * @brief Convenience macro to get the type of the IterDropWhile struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDropWhile(int);
+ * IterDropWhile(int) i; // Declares a variable of type IterDropWhile(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield. Must be the same type name
+ * passed to #DefineIterDropWhile(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterDropWhile(T) ITPL_CONCAT(IterDropWhile_, T)
+
+/**
+ * @def DefineIterDropWhile(T)
+ * @brief Define an IterDropWhile struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDropWhile(int); // Defines an IterDropWhile(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDropWhile(T)                                                                                         \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        bool (*pred)(T x);                                                                                             \
+        bool done;                                                                                                     \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDropWhile(T)
+
+/**
+ * @def define_iterdropwhile_func(T, Name)
  * @brief Define a function to turn an #IterDropWhile(T) into an #Iterable(T).
  *
- * Define the `next` function implementation for the #IterDropWhile(T) struct, and use it to implement the Iterator
- * typeclass, for given `T`.
+ * Define the `next` function implementation for the #IterDropWhile(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDropWhile(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDropWhile(int);
+ *
+ * // Implement `Iterator` for `IterDropWhile(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrdrpwhl(IterDropWhile(int)* x)`
+ * define_iterdropwhile_func(int, wrap_intitrdrpwhl)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static bool is_even(int x) { return x % 2 == 0; }
+ * @endcode
+ *
+ * @code
+ * // Drop (skip) elements from `it` (of type `Iterable(int)`), while they satisfy `is_even`, and create a new iterable
+ * Iterable(int) after_evens = wrap_intitrdrpwhl(&(IterDropWhile(int)){ .pred = is_even, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterDropWhile(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdropwhile_func(T, Name)                                                                             \
+    static Maybe(T) ITPL_CONCAT(IterDropWhile(T), _nxt)(IterDropWhile(T) * self)                                       \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        if (self->done) {                                                                                              \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        Iterable(T) const srcit = self->src;                                                                           \
+        foreach (T, x, srcit) {                                                                                        \
+            if (!self->pred(x)) {                                                                                      \
+                self->done = true;                                                                                     \
+                return Just(x, T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDropWhile(T)*, T, Name, ITPL_CONCAT(IterDropWhile(T), _nxt))
+
+/**
+ * @def IterEnumr(T, U)
+ * @brief Convenience macro to get the type of the IterEnumr struct with given element types.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterEnumr(int);
+ * IterEnumr(int) i; // Declares a variable of type IterEnumr(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterEnumr` will yield. Must be the same type name
+ * passed to #DefineIterEnumr(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterEnumr(T) ITPL_CONCAT(IterEnumr_, T)
+
+/**
+ * @def DefineIterEnumr(T)
+ * @brief Define an IterEnumr struct that works with on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterEnumr(int); // Defines an IterEnumr(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterEnumr` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterEnumr(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterEnumr(T)
+
+/**
+ * @def define_iterenumr_func(T, Name)
+ * @brief Define a function to turn an #IterEnumr(T) into an #Iterable(T) where `T = Pair(size_t, T)`.
+ *
+ * Define the `next` function implementation for the #IterEnumr(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterEnumr(T)*` and wraps it in an `Iterable(Pair(size_t, T))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterEnumr(int);
+ *
+ * // Implement `Iterator` for `IterEnumr(int)`
+ * // The defined function has the signature- `Iterable(Pair(size_t, int)) wrap_intenumr(IterEnumr(int)* x)`
+ * define_iterenumr_func(int, wrap_intenumr)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Enumerate `it` (of type `Iterable(int)`) to create a new iterable
+ * Iterable(Pair(size_t, int)) enumerated = wrap_intenumr(&(IterEnumr(int)){ .src = it });
+ * @endcode
+ *
+ * @param T The type of value the first `Iterable` wrapped in this `IterEnumr` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterEnumr(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(size_t, T)`, for the given `T`.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterenumr_func(T, Name)                                                                                 \
+    static Maybe(Pair(size_t, T)) ITPL_CONCAT(IterEnumr(T), _nxt)(IterEnumr(T) * self)                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
+        return is_just(res) ? Just(PairOf(self->i++, from_just_(res), size_t, T), Pair(size_t, T))                     \
+                            : Nothing(Pair(size_t, T));                                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterEnumr(T)*, Pair(size_t, T), Name, ITPL_CONCAT(IterEnumr(T), _nxt))
+
+#ifndef ITPLUS_EXTSORT_FANIN
+#define ITPLUS_EXTSORT_FANIN 64
+#endif /* !ITPLUS_EXTSORT_FANIN */
+
+/* A sorted run spilled to a temporary file, along with its block of the merge buffer */
+typedef struct
+{
+    FILE* f;
+    /* Id used in the file's name, `0` for anonymous files created with `tmpfile` */
+    unsigned long id;
+    unsigned char* blk;
+    size_t pos;
+    size_t len;
+} ItplExtRun;
+
+/* State of an external sort, independent of the element type */
+typedef struct
+{
+    size_t elsz;
+    int (*cmp)(void const* a, void const* b);
+    unsigned char* buf;
+    size_t cap;
+    char const* tmpdir;
+    ItplExtRun* runs;
+    size_t nruns;
+    size_t runcap;
+    /* Min heap of the indices of runs that still have elements, ordered by their head element */
+    size_t* heap;
+    size_t hlen;
+    /* Number of elements in the block of each run */
+    size_t blklen;
+    unsigned long nextid;
+    /* Position and length of the sorted elements, when everything fit in memory */
+    size_t mempos;
+    size_t memlen;
+    bool started;
+    bool inmem;
+    bool failed;
+} ItplExtSort;
+
+static inline void itpl_extsort_path(ItplExtSort const* s, unsigned long id, char* path, size_t n)
+{
+    snprintf(path, n, "%s/itplus-%p-%lu.run", s->tmpdir, (void const*)s, id);
+}
+
+/* Create a temporary file, in `tmpdir` if one was given */
+static inline FILE* itpl_extsort_open(ItplExtSort* s, unsigned long* id)
+{
+    char path[FILENAME_MAX];
+    if (s->tmpdir == NULL) {
+        *id = 0;
+        return tmpfile();
+    }
+    while (1) {
+        *id = ++(s->nextid);
+        itpl_extsort_path(s, *id, path, sizeof(path));
+        FILE* const existing = fopen(path, "rb");
+        if (existing == NULL) {
+            break;
+        }
+        fclose(existing);
+    }
+    return fopen(path, "w+b");
+}
+
+static inline void itpl_extsort_close(ItplExtSort const* s, ItplExtRun const* run)
+{
+    char path[FILENAME_MAX];
+    fclose(run->f);
+    if (run->id != 0) {
+        itpl_extsort_path(s, run->id, path, sizeof(path));
+        remove(path);
+    }
+}
+
+static inline bool itpl_extsort_addrun(ItplExtSort* s, FILE* f, unsigned long id)
+{
+    if (s->nruns == s->runcap) {
+        size_t const runcap    = s->runcap == 0 ? 8 : s->runcap * 2;
+        ItplExtRun* const temp = realloc(s->runs, runcap * sizeof(*temp));
+        if (temp == NULL) {
+            return false;
+        }
+        s->runs   = temp;
+        s->runcap = runcap;
+    }
+    s->runs[s->nruns++] = (ItplExtRun){.f = f, .id = id};
+    return true;
+}
+
+/* Spill the first `n` (sorted) elements of the buffer into a new run */
+static inline bool itpl_extsort_spill(ItplExtSort* s, size_t n)
+{
+    unsigned long id = 0;
+    FILE* const f    = itpl_extsort_open(s, &id);
+    if (f == NULL) {
+        return false;
+    }
+    if (fwrite(s->buf, s->elsz, n, f) != n || fflush(f) != 0 || !itpl_extsort_addrun(s, f, id)) {
+        itpl_extsort_close(s, &(ItplExtRun){.f = f, .id = id});
+        return false;
+    }
+    return true;
+}
+
+static inline bool itpl_extsort_less(ItplExtSort const* s, size_t a, size_t b)
+{
+    ItplExtRun const* const ra = s->runs + a;
+    ItplExtRun const* const rb = s->runs + b;
+    return s->cmp(ra->blk + ra->pos * s->elsz, rb->blk + rb->pos * s->elsz) < 0;
+}
+
+static inline void itpl_extsort_siftdown(ItplExtSort* s, size_t i)
+{
+    size_t* const heap = s->heap;
+    while (1) {
+        size_t const l = 2 * i + 1;
+        if (l >= s->hlen) {
+            break;
+        }
+        size_t const c = l + 1 < s->hlen && itpl_extsort_less(s, heap[l + 1], heap[l]) ? l + 1 : l;
+        if (!itpl_extsort_less(s, heap[c], heap[i])) {
+            break;
+        }
+        size_t const temp = heap[i];
+        heap[i]           = heap[c];
+        heap[c]           = temp;
+        i                 = c;
+    }
+}
+
+/* Refill the block of a run from its file, returns `false` if the run is exhausted */
+static inline bool itpl_extsort_fill(ItplExtSort* s, ItplExtRun* run)
+{
+    run->pos = 0;
+    run->len = fread(run->blk, s->elsz, s->blklen, run->f);
+    if (ferror(run->f)) {
+        s->failed = true;
+    }
+    return run->len > 0;
+}
+
+/* Start merging the first `k` runs */
+static inline void itpl_extsort_merge_open(ItplExtSort* s, size_t k)
+{
+    s->blklen = s->cap / k;
+    s->hlen   = 0;
+    for (size_t i = 0; i < k; i++) {
+        ItplExtRun* const run = s->runs + i;
+        run->blk              = s->buf + i * s->blklen * s->elsz;
+        rewind(run->f);
+        if (itpl_extsort_fill(s, run)) {
+            s->heap[s->hlen++] = i;
+        }
+    }
+    for (size_t i = s->hlen / 2; i-- > 0;) {
+        itpl_extsort_siftdown(s, i);
+    }
+}
+
+/* Get the smallest element among the runs being merged, `NULL` if they're all exhausted */
+static inline void const* itpl_extsort_merge_peek(ItplExtSort const* s)
+{
+    if (s->hlen == 0) {
+        return NULL;
+    }
+    ItplExtRun const* const run = s->runs + s->heap[0];
+    return run->blk + run->pos * s->elsz;
+}
+
+/* Move past the smallest element among the runs being merged */
+static inline void itpl_extsort_merge_pop(ItplExtSort* s)
+{
+    ItplExtRun* const run = s->runs + s->heap[0];
+    if (++(run->pos) == run->len && !itpl_extsort_fill(s, run)) {
+        s->heap[0] = s->heap[--(s->hlen)];
+    }
+    itpl_extsort_siftdown(s, 0);
+}
+
+/* Merge runs together until there are few enough to merge at once, and start merging them */
+static inline bool itpl_extsort_prepare(ItplExtSort* s)
+{
+    size_t const fanin = s->cap < ITPLUS_EXTSORT_FANIN ? s->cap : ITPLUS_EXTSORT_FANIN;
+    if (fanin < 2 || (s->heap = malloc(fanin * sizeof(*(s->heap)))) == NULL) {
+        return false;
+    }
+    while (s->nruns > fanin) {
+        unsigned long id = 0;
+        FILE* const f    = itpl_extsort_open(s, &id);
+        if (f == NULL) {
+            return false;
+        }
+        itpl_extsort_merge_open(s, fanin);
+        for (void const* x = itpl_extsort_merge_peek(s); x != NULL; x = itpl_extsort_merge_peek(s)) {
+            if (fwrite(x, s->elsz, 1, f) != 1) {
+                s->failed = true;
+                break;
+            }
+            itpl_extsort_merge_pop(s);
+        }
+        if (s->failed || fflush(f) != 0) {
+            itpl_extsort_close(s, &(ItplExtRun){.f = f, .id = id});
+            return false;
+        }
+        for (size_t i = 0; i < fanin; i++) {
+            itpl_extsort_close(s, s->runs + i);
+        }
+        s->nruns -= fanin;
+        memmove(s->runs, s->runs + fanin, s->nruns * sizeof(*(s->runs)));
+        /* Can't fail, there's room for at least `fanin` runs */
+        itpl_extsort_addrun(s, f, id);
+    }
+    itpl_extsort_merge_open(s, s->nruns);
+    return !s->failed;
+}
+
+/* Close (and remove) all temporary files, and free the bookkeeping memory */
+static inline void itpl_extsort_free(ItplExtSort* s)
+{
+    for (size_t i = 0; i < s->nruns; i++) {
+        itpl_extsort_close(s, s->runs + i);
+    }
+    free(s->runs);
+    free(s->heap);
+    s->runs   = NULL;
+    s->heap   = NULL;
+    s->nruns  = 0;
+    s->runcap = 0;
+    s->hlen   = 0;
+}
+
+/**
+ * @def IterExternalSort(T)
+ * @brief Convenience macro to get the type of the IterExternalSort struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int);
+ * IterExternalSort(int) i; // Declares a variable of type IterExternalSort(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield. Must be the same type name
+ * passed to #DefineIterExternalSort(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterExternalSort(T) ITPL_CONCAT(IterExternalSort_, T)
+
+/**
+ * @def DefineIterExternalSort(T)
+ * @brief Define an IterExternalSort struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `cmp` - The comparison function, same as the one `qsort` takes.
+ * * `buf` - The buffer to sort runs in, and to merge them from. This is the memory limit of the sort.
+ * * `cap` - The number of elements `buf` can hold. Must be at least 2, the fewest runs that can be merged at once.
+ * * `tmpdir` - (Optional) The directory to create temporary files in. If `NULL`, `tmpfile` is used.
+ * * `src` - The source iterable.
+ *
+ * The `state` member must be zero initialized.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int); // Defines an IterExternalSort(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterExternalSort(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        int (*cmp)(void const* a, void const* b);                                                                      \
+        T* buf;                                                                                                        \
+        size_t cap;                                                                                                    \
+        char const* tmpdir;                                                                                            \
+        ItplExtSort state;                                                                                             \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterExternalSort(T)
+
+/**
+ * @def iterextsort_free(x)
+ * @brief Remove the temporary files of an #IterExternalSort(T) (given as a pointer), and free its bookkeeping memory.
+ *
+ * This happens automatically once the sorted elements are exhausted, it only needs to be called if the iteration is
+ * abandoned before that.
+ */
+#define iterextsort_free(x) itpl_extsort_free(&(x)->state)
+
+/**
+ * @def define_iterextsort_func(T, Name)
+ * @brief Define a function to turn an #IterExternalSort(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterExternalSort(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterExternalSort(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterExternalSort(int);
+ *
+ * // Implement `Iterator` for `IterExternalSort(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intextsort(IterExternalSort(int)* x)`
+ * define_iterextsort_func(int, wrap_intextsort)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static int cmp_int(void const* a, void const* b)
+ * {
+ *     int const x = *(int const*)a, y = *(int const*)b;
+ *     return (x > y) - (x < y);
+ * }
+ * @endcode
+ *
+ * @code
+ * // Sort `it` (of type `Iterable(int)`) using at most 1 GiB of memory for the elements
+ * size_t const cap = (1UL << 30) / sizeof(int);
+ * int* const buf   = malloc(cap * sizeof(*buf));
+ * Iterable(int) sorted = wrap_intextsort(
+ *     &(IterExternalSort(int)){ .cmp = cmp_int, .buf = buf, .cap = cap, .tmpdir = "/scratch", .src = it });
+ * // Use `sorted`, and then free the buffer
+ * free(buf);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterExternalSort` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterExternalSort(T) for the given `T` **must** exist.
+ * @note The whole source is consumed when the first element is extracted.
+ * @note If `cap` is less than 2, or a temporary file can't be created or written, or memory can't be allocated,
+ * iteration stops and the `failed` member of `state` is set.
+ * @note Elements are spilled as raw bytes, so types that own memory through pointers are spilled as the pointers.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterextsort_func(T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(IterExternalSort(T), _nxt)(IterExternalSort(T) * self)                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        ItplExtSort* const s = &self->state;                                                                           \
+        if (s->failed) {                                                                                               \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!s->started && self->cap < 2) {                                                                            \
+            s->failed = true;                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!s->started) {                                                                                             \
+            Iterable(T) const srcit = self->src;                                                                       \
+            bool done               = false;                                                                           \
+            s->started              = true;                                                                            \
+            s->elsz                 = sizeof(T);                                                                       \
+            s->cmp                  = self->cmp;                                                                       \
+            s->buf                  = (unsigned char*)self->buf;                                                       \
+            s->cap                  = self->cap;                                                                       \
+            s->tmpdir               = self->tmpdir;                                                                    \
+            /* Consume the source in sorted runs */                                                                    \
+            while (!done) {                                                                                            \
+                size_t n = 0;                                                                                          \
+                while (n < self->cap) {                                                                                \
+                    Maybe(T) const res = srcit.tc->next(srcit.self);                                                   \
+                    if (is_nothing(res)) {                                                                             \
+                        done = true;                                                                                   \
+                        break;                                                                                         \
+                    }                                                                                                  \
+                    self->buf[n++] = from_just_(res);                                                                  \
+                }                                                                                                      \
+                qsort(self->buf, n, sizeof(T), self->cmp);                                                             \
+                if (done && s->nruns == 0) {                                                                           \
+                    s->inmem  = true;                                                                                  \
+                    s->memlen = n;                                                                                     \
+                } else if (n > 0 && !itpl_extsort_spill(s, n)) {                                                       \
+                    s->failed = true;                                                                                  \
+                    itpl_extsort_free(s);                                                                              \
+                    return Nothing(T);                                                                                 \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (!s->inmem && !itpl_extsort_prepare(s)) {                                                               \
+                s->failed = true;                                                                                      \
+                itpl_extsort_free(s);                                                                                  \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (s->inmem) {                                                                                                \
+            return s->mempos < s->memlen ? Just(self->buf[s->mempos++], T) : Nothing(T);                               \
+        }                                                                                                              \
+        void const* const x = itpl_extsort_merge_peek(s);                                                              \
+        if (x == NULL || s->failed) {                                                                                  \
+            itpl_extsort_free(s);                                                                                      \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T res;                                                                                                         \
+        memcpy(&res, x, sizeof(res));                                                                                  \
+        itpl_extsort_merge_pop(s);                                                                                     \
+        return Just(res, T);                                                                                           \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterExternalSort(T)*, T, Name, ITPL_CONCAT(IterExternalSort(T), _nxt))
+
+/* Match `c` against the bracket expression at `*pat` (at its `[`), and move `*pat` past it */
+static inline bool itpl_glob_class(char const** pat, char c)
+{
+    char const* p  = *pat + 1;
+    bool const neg = *p == '!' || *p == '^';
+    if (neg) {
+        p++;
+    }
+    char const* const first = p;
+    bool found              = false;
+    /* A `]` right after the `[` (or its negation) is part of the set */
+    while (*p != '\0' && (*p != ']' || p == first)) {
+        unsigned char const lo = (unsigned char)*p;
+        unsigned char hi       = lo;
+        if (p[1] == '-' && p[2] != ']' && p[2] != '\0') {
+            hi  = (unsigned char)p[2];
+            p  += 2;
+        }
+        if ((unsigned char)c >= lo && (unsigned char)c <= hi) {
+            found = true;
+        }
+        p++;
+    }
+    if (*p == '\0') {
+        /* No closing `]`- the `[` is an ordinary character */
+        *pat += 1;
+        return c == '[';
+    }
+    *pat = p + 1;
+    return found != neg;
+}
+
+/**
+ * @brief Check whether a string matches a glob pattern.
+ *
+ * `*` matches any run of characters (including `/`), `?` matches any one character, and `[...]` matches any one of the
+ * characters, or ranges of characters (`a-z`), in it- or any one that isn't, when it starts with `!` or `^`. Every
+ * other character matches itself.
+ *
+ * @param pat The pattern.
+ * @param s The string to match.
+ *
+ * @return Whether `s` matches `pat`.
+ */
+static inline bool itpl_glob_match(char const* pat, char const* s)
+{
+    /* Where to resume from, if the rest fails to match after the last `*` */
+    char const* star = NULL;
+    char const* back = NULL;
+    while (*s != '\0') {
+        if (*pat == '*') {
+            star = ++pat;
+            back = s;
+            continue;
+        }
+        char const* p = pat;
+        bool matched;
+        if (*p == '[') {
+            matched = itpl_glob_class(&p, *s);
+        } else {
+            matched = *p != '\0' && (*p == '?' || *p == *s);
+            p++;
+        }
+        if (matched) {
+            pat = p;
+            s++;
+        } else if (star != NULL) {
+            /* Let the last `*` swallow one more character */
+            pat = star;
+            s   = ++back;
+        } else {
+            return false;
+        }
+    }
+    while (*pat == '*') {
+        pat++;
+    }
+    return *pat == '\0';
+}
+
+/**
+ * @brief Get the file name part of a path, i.e the part after its last separator.
+ */
+static inline char const* itpl_path_base(char const* path)
+{
+    char const* base = path;
+    for (char const* p = path; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+/**
+ * @def IterGlob(T)
+ * @brief Convenience macro to get the type of the IterGlob struct with given path type.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string);
+ * IterGlob(string) i; // Declares a variable of type IterGlob(string)
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield, a typedef of `char const*` (or
+ * `char*`). Must be the same type name passed to #DefineIterGlob(T).
+ */
+#define IterGlob(T) ITPL_CONCAT(IterGlob_, T)
+
+/**
+ * @def DefineIterGlob(T)
+ * @brief Define an IterGlob struct that works on `Iterable(T)`s of paths.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string); // Defines an IterGlob(string) struct
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGlob(T)                                                                                              \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        char const* pattern;                                                                                           \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGlob(T)
+
+/**
+ * @def define_iterglob_func(T, Name)
+ * @brief Define a function to turn an #IterGlob(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterGlob(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterGlob(T)*` and wraps it in an `Iterable(T)`, yielding the paths
+ * that match `pattern`. A pattern without a `/` is matched against the file name part of each path only (e.g `*.log`),
+ * and one with a `/` against the whole path (e.g `logs/2024-*.log`).
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterGlob(string);
+ *
+ * // Implement `Iterator` for `IterGlob(string)`
+ * // The defined function has the signature- `Iterable(string) wrap_glob(IterGlob(string)* x)`
+ * define_iterglob_func(string, wrap_glob)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Only the log files, out of `paths` (of type `Iterable(string)`)
+ * Iterable(string) logs = wrap_glob(&(IterGlob(string)){.pattern = "*.log", .src = paths});
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterGlob` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterGlob(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterglob_func(T, Name)                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterGlob(T), _nxt)(IterGlob(T) * self)                                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        bool const whole        = strchr(self->pattern, '/') != NULL;                                                  \
+        Iterable(T) const srcit = self->src;                                                                           \
+        for (Maybe(T) res = srcit.tc->next(srcit.self); is_just(res); res = srcit.tc->next(srcit.self)) {              \
+            char const* const path = from_just_(res);                                                                  \
+            if (itpl_glob_match(self->pattern, whole ? path : itpl_path_base(path))) {                                 \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGlob(T)*, T, Name, ITPL_CONCAT(IterGlob(T), _nxt))
+
+/**
+ * @def IterFileContents(T)
+ * @brief Convenience macro to get the type of the IterFileContents struct with given path type.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string);
+ * IterFileContents(string) i; // Declares a variable of type IterFileContents(string)
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield, a typedef of
+ * `char const*` (or `char*`). Must be the same type name passed to #DefineIterFileContents(T).
+ */
+#define IterFileContents(T) ITPL_CONCAT(IterFileContents_, T)
+
+/**
+ * @def DefineIterFileContents(T)
+ * @brief Define an IterFileContents struct that works on `Iterable(T)`s of paths.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `cap` - The buffer to read the blocks into, and its size.
+ * * `ahead`, `depth` - The ring of paths looked ahead, with room for at least 1 path.
+ * * `prefetch`, `ctx` - (Optional) The hook called with each path as it enters the ring, and its first argument.
+ * * `src` - The paths of the files to read.
+ *
+ * While iterating, `path` is the path of the file the last block came from. After iteration, `failed` tells whether a
+ * file could not be opened, or read. If iteration is stopped early, the file being read, `f`, is left open.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string); // Defines an IterFileContents(string) struct
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterFileContents(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char* buf;                                                                                            \
+        size_t cap;                                                                                                    \
+        T* ahead;                                                                                                      \
+        size_t depth;                                                                                                  \
+        void (*prefetch)(void* ctx, char const* path);                                                                 \
+        void* ctx;                                                                                                     \
+        FILE* f;                                                                                                       \
+        T path;                                                                                                        \
+        /* The first path in the ring, and the number of paths in it */                                                \
+        size_t head;                                                                                                   \
+        size_t count;                                                                                                  \
+        bool done;                                                                                                     \
+        bool failed;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterFileContents(T)
+
+/**
+ * @def define_iterfilecontents_func(T, Name)
+ * @brief Define a function to turn an #IterFileContents(T) into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterFileContents(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterFileContents(T)*` and wraps it in an `Iterable(Slice(char))`. A
+ * yielded block stays valid until the next one is requested. The paths must stay valid until their file has been read.
+ * Empty files yield no blocks.
+ *
+ * # Example
+ *
+ * @code
+ * typedef char const* string;
+ * DefineIterFileContents(string);
+ *
+ * // Implement `Iterator` for `IterFileContents(string)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_contents(IterFileContents(string)* x)`
+ * define_iterfilecontents_func(string, wrap_contents)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char buf[1 << 16];
+ * string ahead[4];
+ * // Read all the files in `logs` (of type `Iterable(string)`), asking for each to be prefetched 3 files ahead
+ * IterFileContents(string) fc = {
+ *     .buf = buf, .cap = sizeof(buf), .ahead = ahead, .depth = 4, .prefetch = willneed, .src = logs};
+ * foreach (Slice(char), blk, wrap_contents(&fc)) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @param T The type of the paths the `Iterable` wrapped in this `IterFileContents` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterFileContents(T) for the given `T` **must** exist.
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfilecontents_func(T, Name)                                                                          \
+    static Maybe(Slice(char)) ITPL_CONCAT(IterFileContents(T), _nxt)(IterFileContents(T) * self)                       \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        while (!self->failed) {                                                                                        \
+            if (self->f != NULL) {                                                                                     \
+                size_t const n = fread(self->buf, 1, self->cap, self->f);                                              \
+                if (n > 0) {                                                                                           \
+                    return Just(SliceOf((char const*)self->buf, n, char), Slice(char));                                \
+                }                                                                                                      \
+                self->failed = ferror(self->f) != 0;                                                                   \
+                fclose(self->f);                                                                                       \
+                self->f = NULL;                                                                                        \
+                continue;                                                                                              \
+            }                                                                                                          \
+            /* Top up the ring of paths looked ahead */                                                                \
+            Iterable(T) const srcit = self->src;                                                                       \
+            while (!self->done && self->count < self->depth) {                                                         \
+                Maybe(T) const res = srcit.tc->next(srcit.self);                                                       \
+                if (is_nothing(res)) {                                                                                 \
+                    self->done = true;                                                                                 \
+                    break;                                                                                             \
+                }                                                                                                      \
+                self->ahead[(self->head + self->count) % self->depth]  = from_just_(res);                              \
+                self->count                                           += 1;                                            \
+                if (self->prefetch != NULL) {                                                                          \
+                    self->prefetch(self->ctx, from_just_(res));                                                        \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->count == 0) {                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            self->path   = self->ahead[self->head];                                                                    \
+            self->head   = (self->head + 1) % self->depth;                                                             \
+            self->count -= 1;                                                                                          \
+            self->f      = fopen(self->path, "rb");                                                                    \
+            if (self->f == NULL) {                                                                                     \
+                self->failed = true;                                                                                   \
+            } else {                                                                                                   \
+                /* The blocks are read straight into `buf`, rather than through the stdio buffer */                    \
+                setvbuf(self->f, NULL, _IONBF, 0);                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Slice(char));                                                                                   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterFileContents(T)*, Slice(char), Name, ITPL_CONCAT(IterFileContents(T), _nxt))
+
+/**
+ * @def IterFilt(T)
+ * @brief Convenience macro to get the type of the IterFilt struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFilt(int);
+ * IterFilt(int) i; // Declares a variable of type IterFilt(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield. Must be the same type name passed to
+ * #DefineIterFilt(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterFilt(T) ITPL_CONCAT(IterFilt_, T)
+
+/**
+ * @def DefineIterFilt(T)
+ * @brief Define an IterFilt struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFilt(int); // Defines an IterFilt(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterFilt(T)                                                                                              \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        bool (*pred)(T x);                                                                                             \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterFilt(T)
+
+/**
+ * @def define_iterfilt_func(T, Name)
+ * @brief Define a function to turn an #IterFilt(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterFilt(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterFilt(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFilt(int);
+ *
+ * // Implement `Iterator` for `IterFilt(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrfilt(IterFilt(int)* x)`
+ * define_iterfilt_func(int, wrap_intitrfilt)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static bool is_even(int x) { return x % 2 == 0; }
+ * @endcode
+ *
+ * @code
+ * // Filter `it` (of type `Iterable(int)`) by `is_even`
+ * Iterable(int) evens = wrap_intitrfilt(&(IterFilt(int)){ .pred = is_even, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterFilt(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfilt_func(T, Name)                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterFilt(T), _nxt)(IterFilt(T) * self)                                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        foreach (T, el, srcit) {                                                                                       \
+            if (self->pred(el)) {                                                                                      \
+                return Just(el, T);                                                                                    \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterFilt(T)*, T, Name, ITPL_CONCAT(IterFilt(T), _nxt))
+
+/**
+ * @def IterFiltMap(ElmntType, FnRetType)
+ * @brief Convenience macro to get the type of the IterFiltMap struct with given element type and function raw return
+ * type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFiltMap(int, int);
+ * IterFiltMap(int, int) i; // Declares a variable of type IterFiltMap(int, int)
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name
+ * passed to #DefineIterFiltMap(ElmntType, FnRetType).
+ * @param FnRetType The type of value the function contained within an `IterFiltMap` struct will return. Must be the
+ * same type name passed to #DefineIterFiltMap(ElmntType, FnRetType).
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics.
+ */
+#define IterFiltMap(ElmntType, FnRetType) ITPL_CONCAT(ITPL_CONCAT(IterFiltMap_, ElmntType), ITPL_CONCAT(_, FnRetType))
+
+/**
+ * @def DefineIterFiltMap(ElmntType, FnRetType)
+ * @brief Define an IterFiltMap struct that maps a function of type `FnRetType (*)(ElmntType)` over an
+ * `Iterable(ElmntType)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFiltMap(int, int); // Defines an IterFiltMap(int, int) struct
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterFiltMap` will yield.
+ * @param FnRetType The **raw** type of value the function contained within an `IterFiltMap` struct will return. A
+ * #Maybe(T) for given `FnRetType` must exist.
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics.
+ * @note An #Iterator(T) for given `ElmntType`, and `FnRetType` **must** also exist.
+ * @note A filter-map function returns a #Maybe(T), where `T` is `FnRetType`, also referred to as the "raw" return type.
+ */
+#define DefineIterFiltMap(ElmntType, FnRetType)                                                                        \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        Maybe(FnRetType) (*f)(ElmntType x);                                                                            \
+        Iterable(ElmntType) src;                                                                                       \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterFiltMap(ElmntType, FnRetType)
+
+/**
+ * @def define_iterfiltmap_func(ElmntType, FnRetType, Name)
+ * @brief Define a function to turn an #IterFiltMap(ElmntType, FnRetType) into an #Iterable(FnRetType).
+ *
+ * Define the `next` function implementation for the #IterFiltMap(ElmntType, FnRetType) struct, and use it to implement
+ * the Iterator typeclass, for given `ElmntType` and `FnRetType`.
+ *
+ * The defined function takes in a value of type `IterFiltMap(ElmntType, FnRetType)*` and wraps it in an
+ * `Iterable(FnRetType)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterFiltMap(int);
+ *
+ * // Implement `Iterator` for `IterFiltMap(int, int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrfiltmp(IterFiltMap(int, int)* x)`
+ * define_iterfiltmap_func(int, int, wrap_intitrfiltmp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Filter evens and then increment the even numbers
+ * static Maybe(int) is_even_incr(int x) { return x % 2 == 0 ? Just(x + 1, int) : Nothing(int); }
+ * @endcode
+ *
+ * @code
+ * // Filter Map `it` (of type `Iterable(int)`) by `is_even_incr`
+ * Iterable(int) incr_evens = wrap_intitrfiltmp(&(IterFiltMap(int, int)){ .f = is_even_incr, .src = it });
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterFiltMap` will yield.
+ * @param FnRetType The **raw** type of value the function contained within an `IterFiltMap` struct will return.
+ * @param Name Name to define the function as.
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics..
+ * @note An #IterFiltMap(ElmntType, FnRetType) for the given `ElmntType` and `FnRetType` **must** exist.
+ * @note A filter-map function returns a #Maybe(T), where `T` is `FnRetType`, also referred to as the "raw" return type.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterfiltmap_func(ElmntType, FnRetType, Name)                                                            \
+    static Maybe(FnRetType)                                                                                            \
+        ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt)(IterFiltMap(ElmntType, FnRetType) * self)                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(ElmntType) const srcit = self->src;                                                                   \
+        foreach (ElmntType, el, srcit) {                                                                               \
+            Maybe(FnRetType) const mapped = self->f(el);                                                               \
+            if (is_just(mapped)) {                                                                                     \
+                return mapped;                                                                                         \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(FnRetType);                                                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterFiltMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt))
+
+/**
+ * @def define_iterfold_func(T, Acc, Name)
+ * @brief Define the `fold` function for an iterable and an accumulator type.
+ *
+ * The defined fold function takes in an iterable of type `T`, a function of type `Acc (*const f)(Acc acc, T x)`, and
+ * a starting value of type `Acc`, and folds the iterable to a singular value of type `Acc`, by repeatedly applying `f`
+ * onto it.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct boxint { int x; } BoxInt;
+ *
+ * // The defined function has the signature:-
+ * // `BoxInt int_boxint_fold(Iterable(int), BoxInt init, BoxInt (*f)(BoxInt acc, int x))`
+ * define_iterfold_func(int, boxint, int_boxint_fold)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Add 2 ints within 2 BoxInts
+ * static BoxInt boxed_add(BoxInt a, BoxInt b) { return (BoxInt){ .x = a.x + b.x }; }
+ * @endcode
+ *
+ * @code
+ * // Fold `it` with `boxed_add`
+ * BoxInt boxed_sum = int_boxint_fold(it, (BoxInt){0}, boxed_add);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Acc The accumulator type the fold function being defined should work on.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_iterfold_func(T, Acc, Name)                                                                             \
+    Acc Name(Iterable(T) it, Acc init, Acc (*f)(Acc acc, T x))                                                         \
+    {                                                                                                                  \
+        Acc acc = init;                                                                                                \
+        foreach (T, x, it) {                                                                                           \
+            acc = f(acc, x);                                                                                           \
+        }                                                                                                              \
+        return acc;                                                                                                    \
+    }
+
+#ifndef ITPLUS_GATHER_BATCH
+#define ITPLUS_GATHER_BATCH 32
+#endif /* !ITPLUS_GATHER_BATCH */
+
+/**
+ * @def IterGather(T)
+ * @brief Convenience macro to get the type of the IterGather struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(int);
+ * IterGather(int) i; // Declares a variable of type IterGather(int)
+ * @endcode
+ *
+ * @param T The type of the values in the column. Must be the same type name passed to #DefineIterGather(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterGather(T) ITPL_CONCAT(IterGather_, T)
+
+/**
+ * @def DefineIterGather(T)
+ * @brief Define an IterGather struct that gathers values of type `T` at the indices yielded by an
+ * `Iterable(uint32_t)`.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `col`, `len` - The column, and its length.
+ * * `src` - The source iterable of indices.
+ *
+ * After iteration, `failed` tells whether an index was out of the column's range- the iteration stops at that index.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(int); // Defines an IterGather(int) struct
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for `T = uint32_t` **must** also exist.
+ */
+#define DefineIterGather(T)                                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T const* col;                                                                                                  \
+        size_t len;                                                                                                    \
+        /* The values of the current batch, and the position of the next one to yield */                               \
+        T batch[ITPLUS_GATHER_BATCH];                                                                                  \
+        size_t pos;                                                                                                    \
+        size_t n;                                                                                                      \
+        bool exhausted;                                                                                                \
+        bool failed;                                                                                                   \
+        Iterable(uint32_t) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGather(T)
+
+/**
+ * @def ITPL_GATHER_IDXS(src, idxs, n, col, len, exhausted, failed)
+ * @brief Extract the next batch of indices from `src` into `idxs` (and their count into `n`), prefetching the rows of
+ * `col` they point to. Sets `exhausted` once the source is exhausted, and `failed` as well if an index was out of the
+ * range of the column.
+ */
+#define ITPL_GATHER_IDXS(src, idxs, n, col, len, exhausted, failed)                                                    \
+    do {                                                                                                               \
+        (n) = 0;                                                                                                       \
+        while ((n) < ITPLUS_GATHER_BATCH) {                                                                            \
+            Maybe(uint32_t) const itpl_res = (src).tc->next((src).self);                                               \
+            if (is_nothing(itpl_res)) {                                                                                \
+                (exhausted) = true;                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            uint32_t const itpl_idx = from_just_(itpl_res);                                                            \
+            if (itpl_idx >= (len)) {                                                                                   \
+                (exhausted) = true;                                                                                    \
+                (failed)    = true;                                                                                    \
+                break;                                                                                                 \
+            }                                                                                                          \
+            ITPL_PREFETCH((col) + itpl_idx);                                                                           \
+            (idxs)[(n)++] = itpl_idx;                                                                                  \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def define_itergather_func(T, Name)
+ * @brief Define a function to turn an #IterGather(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterGather(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterGather(T)*` and wraps it in an `Iterable(T)`, yielding the values
+ * of the column at the indices yielded by its source, in the same order.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGather(double);
+ *
+ * // Implement `Iterator` for `IterGather(double)`
+ * // The defined function has the signature- `Iterable(double) wrap_dblgather(IterGather(double)* x)`
+ * define_itergather_func(double, wrap_dblgather)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // The prices (of type `double const*`, with `nrows` rows) at the rows in `rows` (of type `Iterable(uint32_t)`)
+ * Iterable(double) sel = wrap_dblgather(&(IterGather(double)){.col = prices, .len = nrows, .src = rows});
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to #ITPLUS_GATHER_BATCH indices are extracted from the source ahead of the value being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGather(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergather_func(T, Name)                                                                                \
+    static Maybe(T) ITPL_CONCAT(IterGather(T), _nxt)(IterGather(T) * self)                                             \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        if (self->pos == self->n) {                                                                                    \
+            if (self->exhausted) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            uint32_t idxs[ITPLUS_GATHER_BATCH];                                                                        \
+            size_t n;                                                                                                  \
+            ITPL_GATHER_IDXS(self->src, idxs, n, self->col, self->len, self->exhausted, self->failed);                 \
+            T const* const col = self->col;                                                                            \
+            for (size_t k = 0; k < n; k++) {                                                                           \
+                self->batch[k] = col[idxs[k]];                                                                         \
+            }                                                                                                          \
+            self->pos = 0;                                                                                             \
+            self->n   = n;                                                                                             \
+            if (n == 0) {                                                                                              \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Just(self->batch[self->pos++], T);                                                                      \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGather(T)*, T, Name, ITPL_CONCAT(IterGather(T), _nxt))
+
+/**
+ * @def define_scatterinto_func(T, Name)
+ * @brief Define the `scatter_into` function for an iterable.
+ *
+ * The defined function takes in an iterable of row indices, an iterable of type `T`, a column, and its length. It
+ * writes each element of the iterable into the column, at the row given by the matching index- until either
+ * iterable is exhausted. It returns `false` if an index was out of the column's range, in which case the elements
+ * from that index onwards are not written.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool scatter_dbl(Iterable(uint32_t) idxs, Iterable(double) it, double* col, size_t len)`
+ * define_scatterinto_func(double, scatter_dbl)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Write the new prices `it` (of type `Iterable(double)`) at the rows in `rows` (of type `Iterable(uint32_t)`)
+ * bool const ok = scatter_dbl(rows, it, prices, nrows);
+ * @endcode
+ *
+ * @param T The type of the values in the column.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T`, and for `T = uint32_t`, **must** exist.
+ */
+#define define_scatterinto_func(T, Name)                                                                               \
+    bool Name(Iterable(uint32_t) idxs, Iterable(T) it, T* col, size_t len)                                             \
+    {                                                                                                                  \
+        bool exhausted = false;                                                                                        \
+        bool failed    = false;                                                                                        \
+        while (!exhausted) {                                                                                           \
+            uint32_t batch[ITPLUS_GATHER_BATCH];                                                                       \
+            size_t n;                                                                                                  \
+            ITPL_GATHER_IDXS(idxs, batch, n, col, len, exhausted, failed);                                             \
+            for (size_t k = 0; k < n; k++) {                                                                           \
+                Maybe(T) const res = it.tc->next(it.self);                                                             \
+                if (is_nothing(res)) {                                                                                 \
+                    return true;                                                                                       \
+                }                                                                                                      \
+                col[batch[k]] = from_just_(res);                                                                       \
+            }                                                                                                          \
+        }                                                                                                              \
+        return !failed;                                                                                                \
+    }
+
+/**
+ * @def ITPL_GEN_MEMBER
+ * @brief The members of a generator's struct used to resume it. Must be the last member of the struct.
+ *
+ * @note This should not be delimited by a semicolon.
+ */
+#define ITPL_GEN_MEMBER                                                                                                \
+    int itpl_line;                                                                                                     \
+    ITPL_STATS_MEMBER
+
+/**
+ * @def ITPL_GENERATOR(GenType, T, Name)
+ * @brief Start the definition of a generator, and use it to implement the Iterator typeclass.
+ *
+ * Declares the `next` function for `GenType`, implements Iterator for it, and begins its definition- to be followed
+ * by its body. The struct is available in the body as `self`.
+ *
+ * The defined function takes in a value of type `GenType*` and wraps it in an `Iterable(T)`. The struct must be zero
+ * initialized (apart from the members the generator takes as parameters) before its first call.
+ *
+ * @param GenType The type of the generator's struct, which must end with #ITPL_GEN_MEMBER.
+ * @param T The type of value the generator yields.
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for the given `T` **must** exist.
+ */
+#define ITPL_GENERATOR(GenType, T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(Name, _nxt)(GenType * self);                                                           \
+    impl_instrumented_iterator(GenType*, T, Name, ITPL_CONCAT(Name, _nxt))                                             \
+    static Maybe(T) ITPL_CONCAT(Name, _nxt)(GenType * self)
+
+/**
+ * @def ITPL_GEN_BEGIN(self)
+ * @brief Begin the body of a generator.
+ *
+ * @param self Pointer to the generator's struct.
+ */
+#define ITPL_GEN_BEGIN(self)                                                                                           \
+    switch ((self)->itpl_line) {                                                                                       \
+    case 0:
+
+/**
+ * @def ITPL_YIELD(self, T, x)
+ * @brief Yield an element from a generator, resuming right after this on the next call.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param T The type of value the generator yields.
+ * @param x The element to yield.
+ */
+#define ITPL_YIELD(self, T, x)                                                                                         \
+    do {                                                                                                               \
+        (self)->itpl_line = __LINE__;                                                                                  \
+        return Just(x, T);                                                                                             \
+    case __LINE__:;                                                                                                    \
+    } while (0)
+
+/**
+ * @def ITPL_GEN_END(self, T)
+ * @brief End the body of a generator. The generator yields nothing once this is reached.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param T The type of value the generator yields.
+ */
+#define ITPL_GEN_END(self, T)                                                                                          \
+    }                                                                                                                  \
+    (self)->itpl_line = -1;                                                                                            \
+    return Nothing(T)
+
+/**
+ * @def ITPL_FILL_BEGIN(self, cap)
+ * @brief Begin the body of a generator that fills a buffer.
+ *
+ * A filling generator is a function with the signature `size_t Name(GenType* self, T* out, size_t cap)`, that writes
+ * up to `cap` elements into `out` per call, and returns the number of elements written- `0` once it has finished. It
+ * only suspends when the buffer is full, so it costs one call per buffer rather than one per element. A call with a
+ * `cap` of `0` returns `0` right away, without resuming the generator.
+ *
+ * # Example
+ *
+ * @code
+ * size_t fill_pairs(Pairs* self, uint32_t* out, size_t cap)
+ * {
+ *     ITPL_FILL_BEGIN(self, cap);
+ *     for (self->i = 0; self->i < self->n; self->i++) {
+ *         for (self->j = 0; self->j < self->i; self->j++) {
+ *             ITPL_YIELD_INTO(self, out, cap, self->i * 100 + self->j);
+ *         }
+ *     }
+ *     ITPL_FILL_END(self);
+ * }
+ * @endcode
+ *
+ * @param self Pointer to the generator's struct, which must end with #ITPL_GEN_MEMBER.
+ * @param cap The capacity of the buffer.
+ */
+#define ITPL_FILL_BEGIN(self, cap)                                                                                     \
+    size_t itpl_filled = 0;                                                                                            \
+    if ((cap) == 0) {                                                                                                  \
+        return 0;                                                                                                      \
+    }                                                                                                                  \
+    switch ((self)->itpl_line) {                                                                                       \
+    case 0:
+
+/**
+ * @def ITPL_YIELD_INTO(self, out, cap, x)
+ * @brief Write an element into the buffer of a filling generator, suspending once the buffer is full.
+ *
+ * @param self Pointer to the generator's struct.
+ * @param out The buffer.
+ * @param cap The capacity of the buffer.
+ * @param x The element to write.
+ */
+#define ITPL_YIELD_INTO(self, out, cap, x)                                                                             \
+    do {                                                                                                               \
+        (out)[itpl_filled++] = (x);                                                                                    \
+        if (itpl_filled == (cap)) {                                                                                    \
+            (self)->itpl_line = __LINE__;                                                                              \
+            return itpl_filled;                                                                                        \
+        case __LINE__:;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @def ITPL_FILL_END(self)
+ * @brief End the body of a filling generator, returning the elements written to the buffer so far.
+ *
+ * @param self Pointer to the generator's struct.
+ */
+#define ITPL_FILL_END(self)                                                                                            \
+    }                                                                                                                  \
+    (self)->itpl_line = -1;                                                                                            \
+    return itpl_filled
+
+/**
+ * @def define_iterfill_func(T, Name)
+ * @brief Define the `fill` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, and its capacity. It writes the next elements of
+ * the iterable into the buffer until it's full, or the iterable is exhausted, and returns the number of elements
+ * written. It can be called repeatedly, to process an iterable one buffer at a time.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature- `size_t fill_int(Iterable(int) it, int* out, size_t cap)`
+ * define_iterfill_func(int, fill_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * int buf[256];
+ * size_t n;
+ * // Process `it` (of type `Iterable(int)`) 256 elements at a time
+ * while ((n = fill_int(it, buf, 256)) > 0) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_iterfill_func(T, Name)                                                                                  \
+    size_t Name(Iterable(T) it, T* out, size_t cap)                                                                    \
+    {                                                                                                                  \
+        size_t n = 0;                                                                                                  \
+        while (n < cap) {                                                                                              \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                break;                                                                                                 \
+            }                                                                                                          \
+            out[n++] = from_just_(res);                                                                                \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
+
+/**
+ * @def IterGroupBy(T, K)
+ * @brief Convenience macro to get the type of the IterGroupBy struct with given element type and key type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char);
+ * IterGroupBy(int, char) i; // Declares a variable of type IterGroupBy(int, char)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield. Must be the same type name
+ * passed to #DefineIterGroupBy(T, K).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to #DefineIterGroupBy(T, K).
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterGroupBy(T, K) ITPL_CONCAT(ITPL_CONCAT(IterGroupBy_, T), ITPL_CONCAT(_, K))
+
+/**
+ * @def DefineIterGroupBy(T, K)
+ * @brief Define an IterGroupBy struct that groups the elements of an `Iterable(T)` by keys of type `K`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char); // Defines an IterGroupBy(int, char) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield.
+ * @param K The type of the key elements are grouped by.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGroupBy(T, K)                                                                                        \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        bool started;                                                                                                  \
+        /* First element of the next group, already pulled out of the source */                                        \
+        Maybe(T) pending;                                                                                              \
+        K pendkey;                                                                                                     \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGroupBy(T, K)
+
+/**
+ * @def define_itergroupby_func(T, K, Name)
+ * @brief Define a function to turn an #IterGroupBy(T, K) into an #Iterable(T) where `T = Pair(K, size_t)`.
+ *
+ * Define the `next` function implementation for the #IterGroupBy(T, K) struct, and use it to implement the Iterator
+ * typeclass, for given `T` and `K`.
+ *
+ * The defined function takes in a value of type `IterGroupBy(T, K)*` and wraps it in an `Iterable(Pair(K, size_t))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupBy(int, char);
+ *
+ * // Implement `Iterator` for `IterGroupBy(int, char)`
+ * // The defined function has the signature- `Iterable(Pair(char, size_t)) wrap_intchrgrp(IterGroupBy(int, char)* x)`
+ * define_itergroupby_func(int, char, wrap_intchrgrp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static char bucket(int x) { return x / 100; }
+ * static bool chr_eq(char a, char b) { return a == b; }
+ * @endcode
+ *
+ * @code
+ * // Count the runs of elements within the same bucket of 100 in `it` (of type `Iterable(int)`)
+ * Iterable(Pair(char, size_t)) runs = wrap_intchrgrp(&(IterGroupBy(int, char)){
+ *     .key = bucket, .eq = chr_eq, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupBy` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGroupBy(T, K) for the given `T` and `K` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, size_t)`, for the given `K` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergroupby_func(T, K, Name)                                                                            \
+    static Maybe(Pair(K, size_t)) ITPL_CONCAT(IterGroupBy(T, K), _nxt)(IterGroupBy(T, K) * self)                       \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->pending = srcit.tc->next(srcit.self);                                                                \
+            if (is_just(self->pending)) {                                                                              \
+                self->pendkey = self->key(from_just_(self->pending));                                                  \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (is_nothing(self->pending)) {                                                                               \
+            return Nothing(Pair(K, size_t));                                                                           \
+        }                                                                                                              \
+        K const grpkey = self->pendkey;                                                                                \
+        size_t count   = 1;                                                                                            \
+        foreach (T, x, srcit) {                                                                                        \
+            K const k = self->key(x);                                                                                  \
+            if (!self->eq(grpkey, k)) {                                                                                \
+                self->pending = Just(x, T);                                                                            \
+                self->pendkey = k;                                                                                     \
+                return Just(PairOf(grpkey, count, K, size_t), Pair(K, size_t));                                        \
+            }                                                                                                          \
+            ++count;                                                                                                   \
+        }                                                                                                              \
+        self->pending = Nothing(T);                                                                                    \
+        return Just(PairOf(grpkey, count, K, size_t), Pair(K, size_t));                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterGroupBy(T, K)*, Pair(K, size_t), Name, ITPL_CONCAT(IterGroupBy(T, K), _nxt))
+
+/**
+ * @def IterGroupFold(T, K, Acc)
+ * @brief Convenience macro to get the type of the IterGroupFold struct with given element, key, and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long);
+ * IterGroupFold(int, char, long) i; // Declares a variable of type IterGroupFold(int, char, long)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield. Must be the same type name
+ * passed to #DefineIterGroupFold(T, K, Acc).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to
+ * #DefineIterGroupFold(T, K, Acc).
+ * @param Acc The accumulator type each group is folded into. Must be the same type name passed to
+ * #DefineIterGroupFold(T, K, Acc).
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterGroupFold(T, K, Acc)                                                                                       \
+    ITPL_CONCAT(ITPL_CONCAT(ITPL_CONCAT(IterGroupFold_, T), ITPL_CONCAT(_, K)), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineIterGroupFold(T, K, Acc)
+ * @brief Define an IterGroupFold struct that groups the elements of an `Iterable(T)` by keys of type `K`, and folds
+ * each group into an `Acc`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long); // Defines an IterGroupFold(int, char, long) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Acc The accumulator type each group is folded into.
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterGroupFold(T, K, Acc)                                                                                 \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        Acc init;                                                                                                      \
+        Acc (*f)(Acc acc, T x);                                                                                        \
+        bool started;                                                                                                  \
+        /* First element of the next group, already pulled out of the source */                                        \
+        Maybe(T) pending;                                                                                              \
+        K pendkey;                                                                                                     \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterGroupFold(T, K, Acc)
+
+/**
+ * @def define_itergroupfold_func(T, K, Acc, Name)
+ * @brief Define a function to turn an #IterGroupFold(T, K, Acc) into an #Iterable(T) where `T = Pair(K, Acc)`.
+ *
+ * Define the `next` function implementation for the #IterGroupFold(T, K, Acc) struct, and use it to implement the
+ * Iterator typeclass, for given `T`, `K`, and `Acc`.
+ *
+ * The defined function takes in a value of type `IterGroupFold(T, K, Acc)*` and wraps it in an
+ * `Iterable(Pair(K, Acc))`. Each group is folded by starting with `init` and repeatedly applying `f`, exactly like
+ * #define_iterfold_func(T, Acc, Name).
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterGroupFold(int, char, long);
+ *
+ * // Implement `Iterator` for `IterGroupFold(int, char, long)`
+ * // The defined function has the signature-
+ * // `Iterable(Pair(char, long)) wrap_grpsum(IterGroupFold(int, char, long)* x)`
+ * define_itergroupfold_func(int, char, long, wrap_grpsum)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static char bucket(int x) { return x / 100; }
+ * static bool chr_eq(char a, char b) { return a == b; }
+ * static long add(long acc, int x) { return acc + x; }
+ * @endcode
+ *
+ * @code
+ * // Sum up each run of elements within the same bucket of 100 in `it` (of type `Iterable(int)`)
+ * Iterable(Pair(char, long)) sums = wrap_grpsum(&(IterGroupFold(int, char, long)){
+ *     .key = bucket, .eq = chr_eq, .init = 0, .f = add, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterGroupFold` will yield.
+ * @param K The type of the key elements are grouped by.
+ * @param Acc The accumulator type each group is folded into.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, `K`, or `Acc`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterGroupFold(T, K, Acc) for the given `T`, `K`, and `Acc` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Acc)`, for the given `K` and `Acc` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itergroupfold_func(T, K, Acc, Name)                                                                     \
+    static Maybe(Pair(K, Acc)) ITPL_CONCAT(IterGroupFold(T, K, Acc), _nxt)(IterGroupFold(T, K, Acc) * self)            \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->pending = srcit.tc->next(srcit.self);                                                                \
+            if (is_just(self->pending)) {                                                                              \
+                self->pendkey = self->key(from_just_(self->pending));                                                  \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (is_nothing(self->pending)) {                                                                               \
+            return Nothing(Pair(K, Acc));                                                                              \
+        }                                                                                                              \
+        K const grpkey = self->pendkey;                                                                                \
+        Acc acc        = self->f(self->init, from_just_(self->pending));                                               \
+        foreach (T, x, srcit) {                                                                                        \
+            K const k = self->key(x);                                                                                  \
+            if (!self->eq(grpkey, k)) {                                                                                \
+                self->pending = Just(x, T);                                                                            \
+                self->pendkey = k;                                                                                     \
+                return Just(PairOf(grpkey, acc, K, Acc), Pair(K, Acc));                                                \
+            }                                                                                                          \
+            acc = self->f(acc, x);                                                                                     \
+        }                                                                                                              \
+        self->pending = Nothing(T);                                                                                    \
+        return Just(PairOf(grpkey, acc, K, Acc), Pair(K, Acc));                                                        \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterGroupFold(T, K, Acc)*, Pair(K, Acc), Name, ITPL_CONCAT(IterGroupFold(T, K, Acc), _nxt))
+
+/**
+ * @def IterArrGroupBy(T, K)
+ * @brief Convenience macro to get the type of the IterArrGroupBy struct with given element type and key type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char);
+ * IterArrGroupBy(int, char) i; // Declares a variable of type IterArrGroupBy(int, char)
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`. Must be the same type name passed
+ * to #DefineIterArrGroupBy(T, K).
+ * @param K The type of the key elements are grouped by. Must be the same type name passed to
+ * #DefineIterArrGroupBy(T, K).
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterArrGroupBy(T, K) ITPL_CONCAT(ITPL_CONCAT(IterArrGroupBy_, T), ITPL_CONCAT(_, K))
+
+/**
+ * @def DefineIterArrGroupBy(T, K)
+ * @brief Define an IterArrGroupBy struct that groups the elements of an array of `T` by keys of type `K`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char); // Defines an IterArrGroupBy(int, char) struct
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`.
+ * @param K The type of the key elements are grouped by.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define DefineIterArrGroupBy(T, K)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        K (*key)(T x);                                                                                                 \
+        bool (*eq)(K a, K b);                                                                                          \
+        size_t i;                                                                                                      \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrGroupBy(T, K)
+
+/**
+ * @def define_iterarrgroupby_func(T, K, Name)
+ * @brief Define a function to turn an #IterArrGroupBy(T, K) into an #Iterable(T) where `T = Pair(K, Slice(T))`.
+ *
+ * The defined function takes in a value of type `IterArrGroupBy(T, K)*` and wraps it in an
+ * `Iterable(Pair(K, Slice(T)))`. Each yielded slice points directly into the source array.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterArrGroupBy(int, char);
+ *
+ * // The defined function has the signature-
+ * // `Iterable(Pair(char, Slice(int))) wrap_intchrarrgrp(IterArrGroupBy(int, char)* x)`
+ * define_iterarrgroupby_func(int, char, wrap_intchrarrgrp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // View the runs of elements within the same bucket of 100 in `arr` (an array of `arrlen` ints)
+ * Iterable(Pair(char, Slice(int))) runs = wrap_intchrarrgrp(&(IterArrGroupBy(int, char)){
+ *     .key = bucket, .eq = chr_eq, .len = arrlen, .arr = arr });
+ * @endcode
+ *
+ * @param T The type of the elements in the array wrapped in this `IterArrGroupBy`.
+ * @param K The type of the key elements are grouped by.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, or `K`, is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterArrGroupBy(T, K) for the given `T` and `K` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Slice(T))`, for the given `T` and `K` must exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterarrgroupby_func(T, K, Name)                                                                         \
+    static Maybe(Pair(K, Slice(T))) ITPL_CONCAT(IterArrGroupBy(T, K), _nxt)(IterArrGroupBy(T, K) * self)               \
+    {                                                                                                                  \
+        if (self->i >= self->len) {                                                                                    \
+            return Nothing(Pair(K, Slice(T)));                                                                         \
+        }                                                                                                              \
+        size_t const start = self->i;                                                                                  \
+        K const grpkey     = self->key(self->arr[self->i++]);                                                          \
+        while (self->i < self->len && self->eq(grpkey, self->key(self->arr[self->i]))) {                               \
+            ++(self->i);                                                                                               \
+        }                                                                                                              \
+        return Just(PairOf(grpkey, SliceOf(self->arr + start, self->i - start, T), K, Slice(T)), Pair(K, Slice(T)));   \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterArrGroupBy(T, K)*, Pair(K, Slice(T)), Name, ITPL_CONCAT(IterArrGroupBy(T, K), _nxt))
+
+/**
+ * @def HashAgg(K, Acc)
+ * @brief Convenience macro to get the type of the HashAgg table with given key type and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long);
+ * HashAgg(int, long) t; // Declares a variable of type HashAgg(int, long)
+ * @endcode
+ *
+ * @param K The key type. Must be the same type name passed to #DefineHashAgg(K, Acc).
+ * @param Acc The accumulator type. Must be the same type name passed to #DefineHashAgg(K, Acc).
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define HashAgg(K, Acc) ITPL_CONCAT(ITPL_CONCAT(HashAgg_, K), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineHashAgg(K, Acc)
+ * @brief Define a HashAgg table mapping keys of type `K` to accumulators of type `Acc`.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `hash` - The hash function for keys.
+ * * `eq` - The equality function for keys.
+ * * `hint` - (Optional) The expected number of keys. The table is allocated large enough to hold this many keys when
+ *   it first moves to the heap.
+ * * `ctrl`, `keys`, `accs`, `cap` - (Optional) Initial storage for the table. `cap` must be a power of 2, `ctrl` must
+ *   point to `cap` zeroed bytes, `keys` to `cap` keys, and `accs` to `cap` accumulators. #itpl_hash_capfor can be used
+ *   to find a capacity large enough for a given number of keys.
+ *
+ * The rest of the members should be zero initialized. The members `ctrl`, `keys`, `accs`, and `cap` can be used to
+ * look at the table's contents, a slot `i` is occupied if `ctrl[i]` is not #ITPL_HASH_EMPTY.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long); // Defines a HashAgg(int, long) table
+ * @endcode
+ *
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define DefineHashAgg(K, Acc)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        uint64_t (*hash)(K x);                                                                                         \
+        bool (*eq)(K a, K b);                                                                                          \
+        size_t hint;                                                                                                   \
+        uint8_t* ctrl;                                                                                                 \
+        K* keys;                                                                                                       \
+        Acc* accs;                                                                                                     \
+        size_t cap;                                                                                                    \
+        /* Number of keys in the table */                                                                              \
+        size_t len;                                                                                                    \
+        /* Whether `ctrl`, `keys`, and `accs` were allocated by the table */                                           \
+        bool owned;                                                                                                    \
+    } HashAgg(K, Acc)
+
+/**
+ * @def hashagg_free(x)
+ * @brief Free the heap storage of a #HashAgg(K, Acc) (given as a pointer), if it owns any.
+ *
+ * Caller supplied storage is left alone.
+ */
+#define hashagg_free(x)                                                                                                \
+    do {                                                                                                               \
+        if ((x)->owned) {                                                                                              \
+            free((x)->ctrl);                                                                                           \
+            free((x)->keys);                                                                                           \
+            free((x)->accs);                                                                                           \
+            (x)->owned = false;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+/*
+ * Define a function that finds the accumulator of a key in a HashAgg table, inserting the key with accumulator `init`
+ * if it's not in the table yet. Returns NULL if the table needed to grow, but couldn't.
+ */
+#define ITPL_HASHAGG_SLOT_FUNC(K, Acc, FnName)                                                                         \
+    static bool ITPL_CONCAT(FnName, _grow)(HashAgg(K, Acc) * self)                                                     \
+    {                                                                                                                  \
+        size_t const cap    = itpl_hash_growcap(self->cap, self->hint);                                                \
+        uint8_t* const ctrl = calloc(cap, sizeof(*ctrl));                                                              \
+        K* const keys       = malloc(cap * sizeof(*keys));                                                             \
+        Acc* const accs     = malloc(cap * sizeof(*accs));                                                             \
+        if (ctrl == NULL || keys == NULL || accs == NULL) {                                                            \
+            free(ctrl);                                                                                                \
+            free(keys);                                                                                                \
+            free(accs);                                                                                                \
+            return false;                                                                                              \
+        }                                                                                                              \
+        for (size_t i = 0; i < self->cap; i++) {                                                                       \
+            if (self->ctrl[i] != ITPL_HASH_EMPTY) {                                                                    \
+                size_t const pos = itpl_hash_claim(ctrl, cap, self->hash(self->keys[i]));                              \
+                keys[pos]        = self->keys[i];                                                                      \
+                accs[pos]        = self->accs[i];                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (self->owned) {                                                                                             \
+            free(self->ctrl);                                                                                          \
+            free(self->keys);                                                                                          \
+            free(self->accs);                                                                                          \
+        }                                                                                                              \
+        self->ctrl  = ctrl;                                                                                            \
+        self->keys  = keys;                                                                                            \
+        self->accs  = accs;                                                                                            \
+        self->cap   = cap;                                                                                             \
+        self->owned = true;                                                                                            \
+        return true;                                                                                                   \
+    }                                                                                                                  \
+    static Acc* FnName(HashAgg(K, Acc) * self, K key, Acc init)                                                        \
+    {                                                                                                                  \
+        if (self->cap == 0 && !ITPL_CONCAT(FnName, _grow)(self)) {                                                     \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        uint64_t const h = self->hash(key);                                                                            \
+        size_t pos;                                                                                                    \
+        ITPL_HASH_FIND(self->ctrl, self->cap, self->keys, self->eq, key, h, pos);                                      \
+        if (self->ctrl[pos] != ITPL_HASH_EMPTY) {                                                                      \
+            return self->accs + pos;                                                                                   \
+        }                                                                                                              \
+        if (itpl_hash_fits(self->len + 1, self->cap)) {                                                                \
+            self->ctrl[pos] = itpl_hash_tag(h);                                                                        \
+        } else if (ITPL_CONCAT(FnName, _grow)(self)) {                                                                 \
+            pos = itpl_hash_claim(self->ctrl, self->cap, h);                                                           \
+        } else {                                                                                                       \
+            return NULL;                                                                                               \
+        }                                                                                                              \
+        self->keys[pos] = key;                                                                                         \
+        self->accs[pos] = init;                                                                                        \
+        ++(self->len);                                                                                                 \
+        return self->accs + pos;                                                                                       \
+    }
+
+/**
+ * @def define_hashagg_fold_func(T, K, Acc, Name)
+ * @brief Define the `group_fold` function, which folds an iterable into a #HashAgg(K, Acc) table.
+ *
+ * The defined function takes in an iterable of type `T`, a table to fold into, a key function of type
+ * `K (*key)(T x)`, a starting value of type `Acc`, and a function of type `Acc (*f)(Acc acc, T x)`. Every element is
+ * folded, using `f`, into the accumulator of its key. The accumulator of a key not yet in the table starts off as
+ * `init`.
+ *
+ * The function returns `true` on success, and `false` if the table needed to grow but the allocation failed. In the
+ * latter case, the table is left valid, with every element up to the failing one folded in.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { int user; int amount; } Order;
+ * DefinePair(int, long);
+ * DefineHashAgg(int, long);
+ *
+ * // The defined function has the signature:-
+ * // `bool order_group_sum(Iterable(Order) it, HashAgg(int, long)* tbl, int (*key)(Order x), long init,
+ * //                       long (*f)(long acc, Order x))`
+ * define_hashagg_fold_func(Order, int, long, order_group_sum)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * static bool int_eq(int a, int b) { return a == b; }
+ * static int order_user(Order x) { return x.user; }
+ * static long add_amount(long acc, Order x) { return acc + x.amount; }
+ * @endcode
+ *
+ * @code
+ * // Total amount spent by each user in `it` (of type `Iterable(Order)`), expecting around 10000 users
+ * HashAgg(int, long) totals = { .hash = int_hash, .eq = int_eq, .hint = 10000 };
+ * if (!order_group_sum(it, &totals, order_user, 0, add_amount)) {
+ *     // Out of memory
+ * }
+ * // Use `totals`, and then free it
+ * hashagg_free(&totals);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T`, `K`, or `Acc` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_hashagg_fold_func(T, K, Acc, Name)                                                                      \
+    ITPL_HASHAGG_SLOT_FUNC(K, Acc, ITPL_CONCAT(Name, _slot))                                                           \
+    bool Name(Iterable(T) it, HashAgg(K, Acc) * tbl, K (*key)(T x), Acc init, Acc (*f)(Acc acc, T x))                  \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            Acc* const acc = ITPL_CONCAT(Name, _slot)(tbl, key(x), init);                                              \
+            if (acc == NULL) {                                                                                         \
+                return false;                                                                                          \
+            }                                                                                                          \
+            *acc = f(*acc, x);                                                                                         \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def define_hashagg_merge_func(K, Acc, Name)
+ * @brief Define a function to merge one #HashAgg(K, Acc) table into another.
+ *
+ * The defined function takes in a destination table, a source table, and a function of type
+ * `Acc (*merge)(Acc a, Acc b)`, which combines 2 accumulators of the same key. Keys only in the source table are
+ * copied over, with their accumulator as is. The source table is left untouched.
+ *
+ * This is the final step of a partitioned aggregation- each partition of the input is folded into its own table (e.g by
+ * its own thread, with no synchronization), and the tables are then merged together.
+ *
+ * The function returns `true` on success, and `false` if the destination table needed to grow but the allocation
+ * failed.
+ *
+ * # Example
+ *
+ * @code
+ * DefineHashAgg(int, long);
+ *
+ * // The defined function has the signature:-
+ * // `bool merge_intlong(HashAgg(int, long)* dst, HashAgg(int, long) const* src, long (*merge)(long a, long b))`
+ * define_hashagg_merge_func(int, long, merge_intlong)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static long add(long a, long b) { return a + b; }
+ * @endcode
+ *
+ * @code
+ * // Combine the per partition totals in `parts` (an array of `nparts` tables) into the first table
+ * for (size_t i = 1; i < nparts; i++) {
+ *     merge_intlong(&parts[0], &parts[i], add);
+ *     hashagg_free(&parts[i]);
+ * }
+ * @endcode
+ *
+ * @param K The key type.
+ * @param Acc The accumulator type.
+ * @param Name Name to define the function as.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_hashagg_merge_func(K, Acc, Name)                                                                        \
+    ITPL_HASHAGG_SLOT_FUNC(K, Acc, ITPL_CONCAT(Name, _slot))                                                           \
+    bool Name(HashAgg(K, Acc) * dst, HashAgg(K, Acc) const* src, Acc (*merge)(Acc a, Acc b))                           \
+    {                                                                                                                  \
+        for (size_t i = 0; i < src->cap; i++) {                                                                        \
+            if (src->ctrl[i] == ITPL_HASH_EMPTY) {                                                                     \
+                continue;                                                                                              \
+            }                                                                                                          \
+            size_t const oldlen = dst->len;                                                                            \
+            Acc* const acc      = ITPL_CONCAT(Name, _slot)(dst, src->keys[i], src->accs[i]);                           \
+            if (acc == NULL) {                                                                                         \
+                return false;                                                                                          \
+            }                                                                                                          \
+            if (dst->len == oldlen) {                                                                                  \
+                *acc = merge(*acc, src->accs[i]);                                                                      \
+            }                                                                                                          \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def IterHashAgg(K, Acc)
+ * @brief Convenience macro to get the type of the IterHashAgg struct with given key type and accumulator type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long);
+ * IterHashAgg(int, long) i; // Declares a variable of type IterHashAgg(int, long)
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`. Must be the same type name passed to
+ * #DefineIterHashAgg(K, Acc).
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`. Must be the same type name passed to
+ * #DefineIterHashAgg(K, Acc).
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ */
+#define IterHashAgg(K, Acc) ITPL_CONCAT(ITPL_CONCAT(IterHashAgg_, K), ITPL_CONCAT(_, Acc))
+
+/**
+ * @def DefineIterHashAgg(K, Acc)
+ * @brief Define an IterHashAgg struct that iterates over the entries of a #HashAgg(K, Acc) table.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long); // Defines an IterHashAgg(int, long) struct
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`.
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note A #HashAgg(K, Acc) for the given `K` and `Acc` **must** also exist.
+ */
+#define DefineIterHashAgg(K, Acc)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        HashAgg(K, Acc) const* tbl;                                                                                    \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterHashAgg(K, Acc)
+
+/**
+ * @def define_iterhashagg_func(K, Acc, Name)
+ * @brief Define a function to turn an #IterHashAgg(K, Acc) into an #Iterable(T) where `T = Pair(K, Acc)`.
+ *
+ * The defined function takes in a value of type `IterHashAgg(K, Acc)*` and wraps it in an `Iterable(Pair(K, Acc))`,
+ * which yields every key in the table along with its accumulator, in no particular order.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterHashAgg(int, long);
+ *
+ * // The defined function has the signature- `Iterable(Pair(int, long)) wrap_intlonghagg(IterHashAgg(int, long)* x)`
+ * define_iterhashagg_func(int, long, wrap_intlonghagg)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Iterate over the entries of `totals` (of type `HashAgg(int, long)`)
+ * Iterable(Pair(int, long)) entries = wrap_intlonghagg(&(IterHashAgg(int, long)){ .tbl = &totals });
+ * @endcode
+ *
+ * @param K The key type of the table wrapped in this `IterHashAgg`.
+ * @param Acc The accumulator type of the table wrapped in this `IterHashAgg`.
+ * @param Name Name to define the function as.
+ *
+ * @note If `K` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterHashAgg(K, Acc) for the given `K` and `Acc` **must** exist.
+ * @note An #Iterator(T), with `T = Pair(K, Acc)`, for the given `K` and `Acc` must exist.
+ * @note The table must not be modified while it's being iterated over.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterhashagg_func(K, Acc, Name)                                                                          \
+    static Maybe(Pair(K, Acc)) ITPL_CONCAT(IterHashAgg(K, Acc), _nxt)(IterHashAgg(K, Acc) * self)                      \
+    {                                                                                                                  \
+        HashAgg(K, Acc) const* const tbl = self->tbl;                                                                  \
+        while (self->i < tbl->cap) {                                                                                   \
+            size_t const i = self->i++;                                                                                \
+            if (tbl->ctrl[i] != ITPL_HASH_EMPTY) {                                                                     \
+                return Just(PairOf(tbl->keys[i], tbl->accs[i], K, Acc), Pair(K, Acc));                                 \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(Pair(K, Acc));                                                                                  \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterHashAgg(K, Acc)*, Pair(K, Acc), Name, ITPL_CONCAT(IterHashAgg(K, Acc), _nxt))
+
+/**
+ * @def ITPL_BITPACK_BLOCK
+ * @brief The (maximum) number of values in a bit packed block.
+ */
+#define ITPL_BITPACK_BLOCK 128U
+
+/**
+ * @def ITPL_VARINT_MAXLEN
+ * @brief The maximum length of a varint encoded 64 bit integer.
+ */
+#define ITPL_VARINT_MAXLEN 10U
+
+/**
+ * @brief Encode an integer as a varint.
+ *
+ * @param x The integer.
+ * @param out Where to write the varint, must have room for #ITPL_VARINT_MAXLEN bytes.
+ *
+ * @return The length of the varint.
+ */
+static inline size_t itpl_varint_put(uint64_t x, unsigned char* out)
+{
+    size_t n = 0;
+    while (x >= 0x80) {
+        out[n++] = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    out[n++] = (unsigned char)x;
+    return n;
+}
+
+/**
+ * @brief Decode the varint at `*pos`, advancing `*pos` past it.
+ *
+ * @return `false` if the varint is truncated, or too long for 64 bits.
+ */
+static inline bool itpl_varint_get(unsigned char const* buf, size_t len, size_t* pos, uint64_t* x)
+{
+    uint64_t res = 0;
+    for (size_t i = *pos, shift = 0; i < len && shift < 64; i++, shift += 7) {
+        res |= (uint64_t)(buf[i] & 0x7F) << shift;
+        if (buf[i] < 0x80) {
+            *pos = i + 1;
+            *x   = res;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Bit pack a block of values.
+ *
+ * @param vals The values.
+ * @param n The number of values, at most #ITPL_BITPACK_BLOCK.
+ * @param out Where to write the block.
+ * @param cap Room available in `out`.
+ *
+ * @return The length of the block, or `0` if it does not fit in `cap` bytes.
+ */
+static inline size_t itpl_bitpack_put(uint64_t const* vals, size_t n, unsigned char* out, size_t cap)
+{
+    uint64_t min = UINT64_MAX, range = 0;
+    for (size_t i = 0; i < n; i++) {
+        min = vals[i] < min ? vals[i] : min;
+    }
+    for (size_t i = 0; i < n; i++) {
+        range |= vals[i] - min;
+    }
+    unsigned width = 0;
+    while (width < 64 && (range >> width) != 0) {
+        width++;
+    }
+    unsigned char hdr[2 * ITPL_VARINT_MAXLEN + 1];
+    size_t hdrlen   = itpl_varint_put(n, hdr);
+    hdrlen         += itpl_varint_put(min, hdr + hdrlen);
+    hdr[hdrlen++]   = (unsigned char)width;
+    size_t const sz = hdrlen + (n * width + 7) / 8;
+    if (sz > cap) {
+        return 0;
+    }
+    memcpy(out, hdr, hdrlen);
+    unsigned char* const p = out + hdrlen;
+    memset(p, 0, sz - hdrlen);
+    size_t bit = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t const v = vals[i] - min;
+        for (unsigned done = 0; done < width;) {
+            unsigned const shift = bit % 8;
+            unsigned const take  = 8 - shift < width - done ? 8 - shift : width - done;
+            p[bit / 8] |= (unsigned char)(((v >> done) & ((1U << take) - 1)) << shift);
+            done += take;
+            bit  += take;
+        }
+    }
+    return sz;
+}
+
+/**
+ * @brief Unpack the bit packed block at `*pos`, advancing `*pos` past it.
+ *
+ * @param buf The buffer.
+ * @param len Length of the buffer.
+ * @param pos Position of the block in the buffer.
+ * @param out Where to write the values, must have room for #ITPL_BITPACK_BLOCK values.
+ *
+ * @return The number of values in the block, or `0` if the block is malformed.
+ */
+static inline size_t itpl_bitpack_get(unsigned char const* buf, size_t len, size_t* pos, uint64_t* out)
+{
+    size_t i = *pos;
+    uint64_t n, min;
+    if (!itpl_varint_get(buf, len, &i, &n) || n == 0 || n > ITPL_BITPACK_BLOCK ||
+        !itpl_varint_get(buf, len, &i, &min) || i == len || buf[i] > 64) {
+        return 0;
+    }
+    unsigned const width = buf[i++];
+    if ((n * width + 7) / 8 > len - i) {
+        return 0;
+    }
+    unsigned char const* const p = buf + i;
+    size_t bit                   = 0;
+    for (size_t j = 0; j < n; j++) {
+        uint64_t v = 0;
+        for (unsigned done = 0; done < width;) {
+            unsigned const shift = bit % 8;
+            unsigned const take  = 8 - shift < width - done ? 8 - shift : width - done;
+            v    |= (uint64_t)((p[bit / 8] >> shift) & ((1U << take) - 1)) << done;
+            done += take;
+            bit  += take;
+        }
+        out[j] = min + v;
+    }
+    *pos = i + (n * width + 7) / 8;
+    return n;
+}
+
+/**
+ * @def IterDeltaEncode(T)
+ * @brief Convenience macro to get the type of the IterDeltaEncode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t);
+ * IterDeltaEncode(uint32_t) i; // Declares a variable of type IterDeltaEncode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield. Must be the same type name
+ * passed to #DefineIterDeltaEncode(T).
+ */
+#define IterDeltaEncode(T) ITPL_CONCAT(IterDeltaEncode_, T)
+
+/**
+ * @def IterDeltaDecode(T)
+ * @brief Convenience macro to get the type of the IterDeltaDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t);
+ * IterDeltaDecode(uint32_t) i; // Declares a variable of type IterDeltaDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield. Must be the same type name
+ * passed to #DefineIterDeltaDecode(T).
+ */
+#define IterDeltaDecode(T) ITPL_CONCAT(IterDeltaDecode_, T)
+
+/**
+ * @def DefineIterDeltaEncode(T)
+ * @brief Define an IterDeltaEncode struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t); // Defines an IterDeltaEncode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield. Must be an unsigned integer
+ * type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDeltaEncode(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T prev;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDeltaEncode(T)
+
+/**
+ * @def DefineIterDeltaDecode(T)
+ * @brief Define an IterDeltaDecode struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `src` - The source iterable, of deltas.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t); // Defines an IterDeltaDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield. Must be an unsigned integer
+ * type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterDeltaDecode(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        T prev;                                                                                                        \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterDeltaDecode(T)
+
+/**
+ * @def define_iterdeltaencode_func(T, Name)
+ * @brief Define a function to turn an #IterDeltaEncode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDeltaEncode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDeltaEncode(T)*` and wraps it in an `Iterable(T)`. The first
+ * element is yielded as is, and every other element as its difference from the one before it.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaEncode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterDeltaEncode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32deltaenc(IterDeltaEncode(uint32_t)* x)`
+ * define_iterdeltaencode_func(uint32_t, wrap_u32deltaenc)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Delta encode `ids` (of type `Iterable(uint32_t)`), yields 3, 4, 1, 10 for 3, 7, 8, 18
+ * Iterable(uint32_t) deltas = wrap_u32deltaenc(&(IterDeltaEncode(uint32_t)){ .src = ids });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaEncode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterDeltaEncode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdeltaencode_func(T, Name)                                                                           \
+    static Maybe(T) ITPL_CONCAT(IterDeltaEncode(T), _nxt)(IterDeltaEncode(T) * self)                                   \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
+        if (is_nothing(res)) {                                                                                         \
+            return res;                                                                                                \
+        }                                                                                                              \
+        T const x  = from_just_(res);                                                                                  \
+        T const d  = (T)(x - self->prev);                                                                              \
+        self->prev = x;                                                                                                \
+        return Just(d, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDeltaEncode(T)*, T, Name, ITPL_CONCAT(IterDeltaEncode(T), _nxt))
+
+/**
+ * @def define_iterdeltadecode_func(T, Name)
+ * @brief Define a function to turn an #IterDeltaDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterDeltaDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterDeltaDecode(T)*` and wraps it in an `Iterable(T)`. Each element
+ * yielded is the running sum of the deltas so far.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterDeltaDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterDeltaDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32deltadec(IterDeltaDecode(uint32_t)* x)`
+ * define_iterdeltadecode_func(uint32_t, wrap_u32deltadec)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Delta decode `deltas` (of type `Iterable(uint32_t)`), yields 3, 7, 8, 18 for 3, 4, 1, 10
+ * Iterable(uint32_t) ids = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = deltas });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterDeltaDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterDeltaDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterdeltadecode_func(T, Name)                                                                           \
+    static Maybe(T) ITPL_CONCAT(IterDeltaDecode(T), _nxt)(IterDeltaDecode(T) * self)                                   \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
+        if (is_nothing(res)) {                                                                                         \
+            return res;                                                                                                \
+        }                                                                                                              \
+        self->prev = (T)(self->prev + from_just_(res));                                                                \
+        return Just(self->prev, T);                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterDeltaDecode(T)*, T, Name, ITPL_CONCAT(IterDeltaDecode(T), _nxt))
+
+/**
+ * @def define_varintencode_func(T, Name)
+ * @brief Define the `varint_encode` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, its capacity, and a pointer to store the encoded
+ * length in. It writes every element of the iterable into the buffer as a varint, stopping early if the buffer runs
+ * out of room.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool varint_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len)`
+ * define_varintencode_func(uint32_t, varint_u32)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * unsigned char buf[4096];
+ * size_t len;
+ * // Varint encode `deltas` (of type `Iterable(uint32_t)`)
+ * if (!varint_u32(deltas, buf, sizeof(buf), &len)) {
+ *     // Handle the buffer being too small
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if the buffer ran out of room, in which case `*len` is the length of the elements that did fit.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_varintencode_func(T, Name)                                                                              \
+    bool Name(Iterable(T) it, unsigned char* out, size_t cap, size_t* len)                                             \
+    {                                                                                                                  \
+        unsigned char tmp[ITPL_VARINT_MAXLEN];                                                                         \
+        *len = 0;                                                                                                      \
+        foreach (T, x, it) {                                                                                           \
+            if (cap - *len >= ITPL_VARINT_MAXLEN) {                                                                    \
+                *len += itpl_varint_put((uint64_t)x, out + *len);                                                      \
+                continue;                                                                                              \
+            }                                                                                                          \
+            size_t const n = itpl_varint_put((uint64_t)x, tmp);                                                        \
+            if (n > cap - *len) {                                                                                      \
+                return false;                                                                                          \
+            }                                                                                                          \
+            memcpy(out + *len, tmp, n);                                                                                \
+            *len += n;                                                                                                 \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def define_bitpackencode_func(T, Name)
+ * @brief Define the `bitpack_encode` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a buffer, its capacity, and a pointer to store the encoded
+ * length in. It writes the elements of the iterable into the buffer as bit packed blocks of #ITPL_BITPACK_BLOCK
+ * elements (the last block may be shorter), stopping early if the buffer runs out of room.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature-
+ * // `bool bitpack_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len)`
+ * define_bitpackencode_func(uint32_t, bitpack_u32)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if the buffer ran out of room, in which case `*len` is the length of the blocks that did fit.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_bitpackencode_func(T, Name)                                                                             \
+    bool Name(Iterable(T) it, unsigned char* out, size_t cap, size_t* len)                                             \
+    {                                                                                                                  \
+        uint64_t blk[ITPL_BITPACK_BLOCK];                                                                              \
+        size_t n = 0;                                                                                                  \
+        *len     = 0;                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            blk[n++] = (uint64_t)x;                                                                                    \
+            if (n == ITPL_BITPACK_BLOCK) {                                                                             \
+                size_t const sz = itpl_bitpack_put(blk, n, out + *len, cap - *len);                                    \
+                if (sz == 0) {                                                                                         \
+                    return false;                                                                                      \
+                }                                                                                                      \
+                *len += sz;                                                                                            \
+                n     = 0;                                                                                             \
+            }                                                                                                          \
+        }                                                                                                              \
+        if (n > 0) {                                                                                                   \
+            size_t const sz = itpl_bitpack_put(blk, n, out + *len, cap - *len);                                        \
+            if (sz == 0) {                                                                                             \
+                return false;                                                                                          \
+            }                                                                                                          \
+            *len += sz;                                                                                                \
+        }                                                                                                              \
+        return true;                                                                                                   \
+    }
+
+/**
+ * @def IterVarintDecode(T)
+ * @brief Convenience macro to get the type of the IterVarintDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t);
+ * IterVarintDecode(uint32_t) i; // Declares a variable of type IterVarintDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield. Must be the same type name passed to
+ * #DefineIterVarintDecode(T).
+ */
+#define IterVarintDecode(T) ITPL_CONCAT(IterVarintDecode_, T)
+
+/**
+ * @def DefineIterVarintDecode(T)
+ * @brief Define an IterVarintDecode struct that decodes a buffer of varints into `T`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer of varints.
+ *
+ * After iteration, `malformed` tells whether decoding stopped at a truncated varint, or one too large for `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t); // Defines an IterVarintDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield. Must be an unsigned integer type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterVarintDecode(T)                                                                                      \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char const* buf;                                                                                      \
+        size_t len;                                                                                                    \
+        size_t pos;                                                                                                    \
+        bool malformed;                                                                                                \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterVarintDecode(T)
+
+/**
+ * @def define_itervarintdecode_func(T, Name)
+ * @brief Define a function to turn an #IterVarintDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterVarintDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterVarintDecode(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterVarintDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterVarintDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32varint(IterVarintDecode(uint32_t)* x)`
+ * define_itervarintdecode_func(uint32_t, wrap_u32varint)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Decode the ids delta and varint encoded in `buf`, of length `len`
+ * IterVarintDecode(uint32_t) v = {.buf = buf, .len = len};
+ * Iterable(uint32_t) ids       = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = wrap_u32varint(&v) });
+ * @endcode
+ *
+ * @param T The type of value this `IterVarintDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterVarintDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itervarintdecode_func(T, Name)                                                                          \
+    static Maybe(T) ITPL_CONCAT(IterVarintDecode(T), _nxt)(IterVarintDecode(T) * self)                                 \
+    {                                                                                                                  \
+        uint64_t x;                                                                                                    \
+        if (self->malformed || self->pos == self->len) {                                                               \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!itpl_varint_get(self->buf, self->len, &self->pos, &x) || (uint64_t)(T)x != x) {                           \
+            self->malformed = true;                                                                                    \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        return Just((T)x, T);                                                                                          \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterVarintDecode(T)*, T, Name, ITPL_CONCAT(IterVarintDecode(T), _nxt))
+
+/**
+ * @def IterBitpackDecode(T)
+ * @brief Convenience macro to get the type of the IterBitpackDecode struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t);
+ * IterBitpackDecode(uint32_t) i; // Declares a variable of type IterBitpackDecode(uint32_t)
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield. Must be the same type name passed to
+ * #DefineIterBitpackDecode(T).
+ */
+#define IterBitpackDecode(T) ITPL_CONCAT(IterBitpackDecode_, T)
+
+/**
+ * @def DefineIterBitpackDecode(T)
+ * @brief Define an IterBitpackDecode struct that decodes a buffer of bit packed blocks into `T`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer of bit packed blocks.
+ *
+ * After iteration, `malformed` tells whether decoding stopped at a malformed block, or one with values too large for
+ * `T`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t); // Defines an IterBitpackDecode(uint32_t) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield. Must be an unsigned integer type.
+ *
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterBitpackDecode(T)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        unsigned char const* buf;                                                                                      \
+        size_t len;                                                                                                    \
+        size_t pos;                                                                                                    \
+        /* The current block, and the position in it */                                                                \
+        uint64_t blk[ITPL_BITPACK_BLOCK];                                                                              \
+        size_t blklen;                                                                                                 \
+        size_t blkpos;                                                                                                 \
+        bool malformed;                                                                                                \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterBitpackDecode(T)
+
+/**
+ * @def define_iterbitpackdecode_func(T, Name)
+ * @brief Define a function to turn an #IterBitpackDecode(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterBitpackDecode(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterBitpackDecode(T)*` and wraps it in an `Iterable(T)`. A whole
+ * block is unpacked at once, when its first element is requested.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterBitpackDecode(uint32_t);
+ *
+ * // Implement `Iterator` for `IterBitpackDecode(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32unpack(IterBitpackDecode(uint32_t)* x)`
+ * define_iterbitpackdecode_func(uint32_t, wrap_u32unpack)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Decode the ids delta encoded and bit packed in `buf`, of length `len`
+ * IterBitpackDecode(uint32_t) b = {.buf = buf, .len = len};
+ * Iterable(uint32_t) ids        = wrap_u32deltadec(&(IterDeltaDecode(uint32_t)){ .src = wrap_u32unpack(&b) });
+ * @endcode
+ *
+ * @param T The type of value this `IterBitpackDecode` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterBitpackDecode(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterbitpackdecode_func(T, Name)                                                                         \
+    static Maybe(T) ITPL_CONCAT(IterBitpackDecode(T), _nxt)(IterBitpackDecode(T) * self)                               \
+    {                                                                                                                  \
+        if (self->blkpos == self->blklen) {                                                                            \
+            if (self->malformed || self->pos == self->len) {                                                           \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            self->blkpos = 0;                                                                                          \
+            self->blklen = itpl_bitpack_get(self->buf, self->len, &self->pos, self->blk);                              \
+            if (self->blklen == 0) {                                                                                   \
+                self->malformed = true;                                                                                \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        uint64_t const x = self->blk[(self->blkpos)++];                                                                \
+        if ((uint64_t)(T)x != x) {                                                                                     \
+            self->malformed = true;                                                                                    \
+            self->blkpos    = self->blklen;                                                                            \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        return Just((T)x, T);                                                                                          \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterBitpackDecode(T)*, T, Name, ITPL_CONCAT(IterBitpackDecode(T), _nxt))
+
+#ifndef ITPLUS_LZ4_HASHLOG
+#define ITPLUS_LZ4_HASHLOG 12
+#endif /* !ITPLUS_LZ4_HASHLOG */
+
+/**
+ * @def ITPL_LZ4_BOUND(n)
+ * @brief The maximum size of the LZ4 compressed form of `n` bytes.
+ */
+#define ITPL_LZ4_BOUND(n) ((n) + (n) / 255 + 16)
+
+/**
+ * @def ITPL_LZ4_FRAMEBOUND(n)
+ * @brief The maximum size of a framed block of `n` bytes, as written by #itpl_lz4_frame.
+ */
+#define ITPL_LZ4_FRAMEBOUND(n) ((n) + 4)
+
+#define ITPL_LZ4_STORED 0x80000000U
+
+/* The format requires the last 5 bytes to be literals, and the last match to start at least 12 bytes before the end */
+#define ITPL_LZ4_LASTLITERALS 5U
+#define ITPL_LZ4_MFLIMIT      12U
+
+static inline uint32_t itpl_lz4_read32(unsigned char const* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+/* Write the part of a length beyond the 15 that fits in a token */
+static inline unsigned char* itpl_lz4_putlen(unsigned char* op, size_t n)
+{
+    for (; n >= 255; n -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (unsigned char)n;
+    return op;
+}
+
+/* Write a sequence- a token, literals, and (if `mlen` is not 0) a match. `NULL` if it does not fit */
+static inline unsigned char* itpl_lz4_sequence(unsigned char* op, unsigned char const* oend, unsigned char const* lit,
+    size_t litlen, size_t off, size_t mlen)
+{
+    size_t const need = 1 + litlen + litlen / 255 + 1 + (mlen == 0 ? 0 : 2 + mlen / 255 + 1);
+    if (need > (size_t)(oend - op)) {
+        return NULL;
+    }
+    unsigned char* const token = op++;
+    *token                     = (unsigned char)((litlen >= 15 ? 15 : litlen) << 4);
+    if (litlen >= 15) {
+        op = itpl_lz4_putlen(op, litlen - 15);
+    }
+    memcpy(op, lit, litlen);
+    op += litlen;
+    if (mlen == 0) {
+        return op;
+    }
+    *op++   = (unsigned char)(off & 0xFF);
+    *op++   = (unsigned char)(off >> 8);
+    mlen   -= 4;
+    *token |= (unsigned char)(mlen >= 15 ? 15 : mlen);
+    if (mlen >= 15) {
+        op = itpl_lz4_putlen(op, mlen - 15);
+    }
+    return op;
+}
+
+/**
+ * @brief Compress a block of bytes into the LZ4 block format.
+ *
+ * @param src The bytes to compress. At most `UINT32_MAX` bytes.
+ * @param len The number of bytes.
+ * @param dst Where to write the compressed block.
+ * @param cap Room available in `dst`. `ITPL_LZ4_BOUND(len)` bytes are always enough.
+ *
+ * @return The size of the compressed block, or `0` if it does not fit in `cap` bytes.
+ */
+static inline size_t itpl_lz4_compress(unsigned char const* src, size_t len, unsigned char* dst, size_t cap)
+{
+    uint32_t table[1U << ITPLUS_LZ4_HASHLOG] = {0};
+    unsigned char* op                        = dst;
+    unsigned char const* const oend          = dst + cap;
+
+    size_t anchor = 0, i = 0;
+    while (len >= ITPL_LZ4_MFLIMIT && i <= len - ITPL_LZ4_MFLIMIT) {
+        uint32_t const seq = itpl_lz4_read32(src + i);
+        uint32_t const h   = (seq * 2654435761U) >> (32 - ITPLUS_LZ4_HASHLOG);
+        size_t const cand  = table[h];
+        table[h]           = (uint32_t)i;
+        if (cand >= i || i - cand > 65535 || itpl_lz4_read32(src + cand) != seq) {
+            /* Skip ahead faster the longer it's been since the last match */
+            i += 1 + ((i - anchor) >> 6);
+            continue;
+        }
+        /* Extend the match backwards, into the pending literals, and forwards */
+        size_t start = i, from = cand;
+        while (start > anchor && from > 0 && src[start - 1] == src[from - 1]) {
+            start--;
+            from--;
+        }
+        size_t end = i + 4;
+        while (end < len - ITPL_LZ4_LASTLITERALS && src[end] == src[end - (start - from)]) {
+            end++;
+        }
+        op = itpl_lz4_sequence(op, oend, src + anchor, start - anchor, start - from, end - start);
+        if (op == NULL) {
+            return 0;
+        }
+        anchor = i = end;
+    }
+    op = itpl_lz4_sequence(op, oend, src + anchor, len - anchor, 0, 0);
+    return op == NULL ? 0 : (size_t)(op - dst);
+}
+
+/* Read the part of a length beyond the 15 that fits in a token, `false` if truncated */
+static inline bool itpl_lz4_getlen(unsigned char const* src, size_t len, size_t* ip, size_t* n)
+{
+    unsigned char b;
+    do {
+        if (*ip == len) {
+            return false;
+        }
+        b   = src[(*ip)++];
+        *n += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * @brief Decompress a block in the LZ4 block format.
+ *
+ * @param src The compressed block.
+ * @param len Size of the compressed block.
+ * @param dst Where to write the decompressed bytes.
+ * @param cap Room available in `dst`.
+ *
+ * @return The number of decompressed bytes, or `SIZE_MAX` if the block is malformed, or does not fit in `cap` bytes.
+ */
+static inline size_t itpl_lz4_decompress(unsigned char const* src, size_t len, unsigned char* dst, size_t cap)
+{
+    size_t ip = 0, op = 0;
+    while (ip < len) {
+        unsigned const token = src[ip++];
+        size_t lit           = token >> 4;
+        if ((lit == 15 && !itpl_lz4_getlen(src, len, &ip, &lit)) || lit > len - ip || lit > cap - op) {
+            return SIZE_MAX;
+        }
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == len) {
+            /* The last sequence has no match */
+            return op;
+        }
+        if (len - ip < 2) {
+            return SIZE_MAX;
+        }
+        size_t const off = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        size_t mlen      = token & 15;
+
+        ip += 2;
+        if (off == 0 || off > op || (mlen == 15 && !itpl_lz4_getlen(src, len, &ip, &mlen)) || mlen + 4 > cap - op) {
+            return SIZE_MAX;
+        }
+        mlen += 4;
+        unsigned char* const d       = dst + op;
+        unsigned char const* const s = dst + (op - off);
+        if (off >= mlen) {
+            memcpy(d, s, mlen);
+        } else {
+            /* The match overlaps the bytes it produces */
+            for (size_t k = 0; k < mlen; k++) {
+                d[k] = s[k];
+            }
+        }
+        op += mlen;
+    }
+    return SIZE_MAX;
+}
+
+/**
+ * @brief Compress a block into a framed block- the 4 byte header, followed by the data.
+ *
+ * @param src The bytes to compress, at most `0x7FFFFFFF`.
+ * @param len The number of bytes.
+ * @param out Where to write the framed block, must have room for `ITPL_LZ4_FRAMEBOUND(len)` bytes.
+ *
+ * @return The size of the framed block.
+ */
+static inline size_t itpl_lz4_frame(unsigned char const* src, size_t len, unsigned char* out)
+{
+    /* Only keep the compressed data if it's smaller */
+    size_t n     = len == 0 ? 0 : itpl_lz4_compress(src, len, out + 4, len - 1);
+    uint32_t hdr = (uint32_t)n;
+    if (n == 0) {
+        memcpy(out + 4, src, len);
+        n   = len;
+        hdr = (uint32_t)len | ITPL_LZ4_STORED;
+    }
+    for (size_t k = 0; k < 4; k++) {
+        out[k] = (unsigned char)(hdr >> (8 * k));
+    }
+    return 4 + n;
+}
+
+/**
+ * @brief Get the size of the data of a framed block, and whether it's stored uncompressed, from its header.
+ */
+static inline size_t itpl_lz4_framelen(unsigned char const* hdr, bool* stored)
+{
+    uint32_t const x = (uint32_t)hdr[0] | ((uint32_t)hdr[1] << 8) | ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+    *stored          = (x & ITPL_LZ4_STORED) != 0;
+    return x & ~ITPL_LZ4_STORED;
+}
+
+/**
+ * @brief Get the bytes of a framed block, decompressing them into `out` if they're compressed.
+ *
+ * @param frame The framed block.
+ * @param out Where to decompress the data.
+ * @param cap Room available in `out`, the most bytes a block may hold.
+ * @param len Where to store the number of bytes.
+ *
+ * @return Pointer to the bytes- into `out`, or into the frame itself if the data is stored uncompressed. `NULL` if the
+ * data is malformed, or more than `cap` bytes.
+ */
+static inline unsigned char const* itpl_lz4_unframe(unsigned char const* frame, unsigned char* out, size_t cap,
+    size_t* len)
+{
+    bool stored;
+    size_t const datalen = itpl_lz4_framelen(frame, &stored);
+    if (stored) {
+        *len = datalen;
+        return datalen > cap ? NULL : frame + 4;
+    }
+    *len = itpl_lz4_decompress(frame + 4, datalen, out, cap);
+    return *len == SIZE_MAX ? NULL : out;
+}
+
+/**
+ * @def IterLz4Compress(T)
+ * @brief Convenience macro to get the type of the IterLz4Compress struct with given byte type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char);
+ * IterLz4Compress(char) i; // Declares a variable of type IterLz4Compress(char)
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks this `IterLz4Compress` consumes and yields. Must be the same type name
+ * passed to #DefineIterLz4Compress(T).
+ */
+#define IterLz4Compress(T) ITPL_CONCAT(IterLz4Compress_, T)
+
+/**
+ * @def IterLz4Decompress(T)
+ * @brief Convenience macro to get the type of the IterLz4Decompress struct with given byte type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char);
+ * IterLz4Decompress(char) i; // Declares a variable of type IterLz4Decompress(char)
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks this `IterLz4Decompress` consumes and yields. Must be the same type name
+ * passed to #DefineIterLz4Decompress(T).
+ */
+#define IterLz4Decompress(T) ITPL_CONCAT(IterLz4Decompress_, T)
+
+/**
+ * @def DefineIterLz4Compress(T)
+ * @brief Define an IterLz4Compress struct that works on `Iterable(Slice(T))`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `blocksize` - The number of bytes to compress into each block, at most `0x7FFFFFFF`.
+ * * `in` - The buffer to assemble blocks in, must have room for `blocksize` bytes.
+ * * `out` - The buffer to compress blocks into, must have room for `ITPL_LZ4_FRAMEBOUND(blocksize)` bytes.
+ * * `src` - The source iterable, of chunks of bytes.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char); // Defines an IterLz4Compress(char) struct
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks, `char` or `unsigned char`.
+ *
+ * @note A #Slice(T) and an #Iterator(T), with `T = Slice(T)`, for the given `T` **must** also exist.
+ */
+#define DefineIterLz4Compress(T)                                                                                       \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t blocksize;                                                                                              \
+        unsigned char* in;                                                                                             \
+        unsigned char* out;                                                                                            \
+        size_t inlen;                                                                                                  \
+        /* The rest of the current chunk */                                                                            \
+        Slice(T) chunk;                                                                                                \
+        bool done;                                                                                                     \
+        Iterable(Slice(T)) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterLz4Compress(T)
+
+/**
+ * @def DefineIterLz4Decompress(T)
+ * @brief Define an IterLz4Decompress struct that works on `Iterable(Slice(T))`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `blocksize` - The maximum number of bytes in a block, same as the one the stream was compressed with.
+ * * `in` - The buffer to assemble framed blocks in, must have room for `ITPL_LZ4_FRAMEBOUND(blocksize)` bytes.
+ * * `out` - The buffer to decompress blocks into, must have room for `blocksize` bytes.
+ * * `src` - The source iterable, of chunks of the compressed stream.
+ *
+ * After iteration, `malformed` tells whether decompression stopped at a malformed (or truncated) block.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char); // Defines an IterLz4Decompress(char) struct
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks, `char` or `unsigned char`.
+ *
+ * @note A #Slice(T) and an #Iterator(T), with `T = Slice(T)`, for the given `T` **must** also exist.
+ */
+#define DefineIterLz4Decompress(T)                                                                                     \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t blocksize;                                                                                              \
+        unsigned char* in;                                                                                             \
+        unsigned char* out;                                                                                            \
+        size_t inlen;                                                                                                  \
+        /* The rest of the current chunk */                                                                            \
+        Slice(T) chunk;                                                                                                \
+        bool malformed;                                                                                                \
+        Iterable(Slice(T)) src;                                                                                        \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterLz4Decompress(T)
+
+/**
+ * @def define_iterlz4compress_func(T, Name)
+ * @brief Define a function to turn an #IterLz4Compress(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterLz4Compress(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterLz4Compress(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice is a framed block, pointing into the `out` buffer- it is overwritten by the next block.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Compress(char);
+ *
+ * // Implement `Iterator` for `IterLz4Compress(char)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_lz4c(IterLz4Compress(char)* x)`
+ * define_iterlz4compress_func(char, wrap_lz4c)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char in[65536], out[ITPL_LZ4_FRAMEBOUND(65536)];
+ * // Compress `chunks` (of type `Iterable(Slice(char))`) in blocks of 64 KiB, and write them to `f`
+ * IterLz4Compress(char) c = {.blocksize = 65536, .in = in, .out = out, .src = chunks};
+ * foreach (Slice(char), blk, wrap_lz4c(&c)) {
+ *     fwrite(blk.ptr, 1, blk.len, f);
+ * }
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterLz4Compress(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterlz4compress_func(T, Name)                                                                           \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterLz4Compress(T), _nxt)(IterLz4Compress(T) * self)                            \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(Slice(T)) const srcit = self->src;                                                                    \
+        size_t const bsz               = self->blocksize;                                                              \
+        while (self->inlen < bsz && !self->done) {                                                                     \
+            if (self->chunk.len == 0) {                                                                                \
+                Maybe(Slice(T)) const res = srcit.tc->next(srcit.self);                                                \
+                self->done                = is_nothing(res);                                                           \
+                self->chunk               = self->done ? self->chunk : from_just_(res);                                \
+                continue;                                                                                              \
+            }                                                                                                          \
+            if (self->inlen == 0 && self->chunk.len >= bsz) {                                                          \
+                /* A whole block in the chunk, compress it where it is */                                              \
+                size_t const n = itpl_lz4_frame((unsigned char const*)self->chunk.ptr, bsz, self->out);                \
+                self->chunk    = SliceOf(self->chunk.ptr + bsz, self->chunk.len - bsz, T);                             \
+                return Just(SliceOf((T const*)self->out, n, T), Slice(T));                                             \
+            }                                                                                                          \
+            size_t const n = self->chunk.len < bsz - self->inlen ? self->chunk.len : bsz - self->inlen;                \
+            memcpy(self->in + self->inlen, self->chunk.ptr, n);                                                        \
+            self->inlen += n;                                                                                          \
+            self->chunk  = SliceOf(self->chunk.ptr + n, self->chunk.len - n, T);                                       \
+        }                                                                                                              \
+        if (self->inlen == 0) {                                                                                        \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        size_t const n = itpl_lz4_frame(self->in, self->inlen, self->out);                                             \
+        self->inlen    = 0;                                                                                            \
+        return Just(SliceOf((T const*)self->out, n, T), Slice(T));                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterLz4Compress(T)*, Slice(T), Name, ITPL_CONCAT(IterLz4Compress(T), _nxt))
+
+/**
+ * @def define_iterlz4decompress_func(T, Name)
+ * @brief Define a function to turn an #IterLz4Decompress(T) into an #Iterable(T) where `T = Slice(T)`.
+ *
+ * Define the `next` function implementation for the #IterLz4Decompress(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterLz4Decompress(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice is a decompressed block, pointing into the `out` buffer (or, for blocks stored uncompressed, the
+ * `in` buffer or the source chunk)- it is only valid until the next block is requested.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterLz4Decompress(char);
+ *
+ * // Implement `Iterator` for `IterLz4Decompress(char)`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_lz4d(IterLz4Decompress(char)* x)`
+ * define_iterlz4decompress_func(char, wrap_lz4d)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char in[ITPL_LZ4_FRAMEBOUND(65536)], out[65536];
+ * // Decompress `chunks` (of type `Iterable(Slice(char))`), compressed in blocks of 64 KiB
+ * IterLz4Decompress(char) d = {.blocksize = 65536, .in = in, .out = out, .src = chunks};
+ * Iterable(Slice(char)) raw = wrap_lz4d(&d);
+ * @endcode
+ *
+ * @param T The type of the bytes in the chunks.
+ * @param Name Name to define the function as.
+ *
+ * @note An #IterLz4Decompress(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterlz4decompress_func(T, Name)                                                                         \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterLz4Decompress(T), _nxt)(IterLz4Decompress(T) * self)                        \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(Slice(T)) const srcit = self->src;                                                                    \
+        unsigned char const* frame     = NULL;                                                                         \
+        size_t datalen                 = 0;                                                                            \
+        bool stored;                                                                                                   \
+        while (frame == NULL) {                                                                                        \
+            if (self->malformed) {                                                                                     \
+                return Nothing(Slice(T));                                                                              \
+            }                                                                                                          \
+            if (self->inlen >= 4) {                                                                                    \
+                datalen = itpl_lz4_framelen(self->in, &stored);                                                        \
+                if (datalen > self->blocksize) {                                                                       \
+                    self->malformed = true;                                                                            \
+                    continue;                                                                                          \
+                }                                                                                                      \
+                if (self->inlen == 4 + datalen) {                                                                      \
+                    frame       = self->in;                                                                            \
+                    self->inlen = 0;                                                                                   \
+                    continue;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->chunk.len == 0) {                                                                                \
+                Maybe(Slice(T)) const res = srcit.tc->next(srcit.self);                                                \
+                if (is_nothing(res)) {                                                                                 \
+                    /* A partial block left over means the stream was truncated */                                     \
+                    self->malformed = self->inlen > 0;                                                                 \
+                    return Nothing(Slice(T));                                                                          \
+                }                                                                                                      \
+                self->chunk = from_just_(res);                                                                         \
+                continue;                                                                                              \
+            }                                                                                                          \
+            unsigned char const* const p = (unsigned char const*)self->chunk.ptr;                                      \
+            if (self->inlen == 0 && self->chunk.len >= 4) {                                                            \
+                datalen = itpl_lz4_framelen(p, &stored);                                                               \
+                if (datalen <= self->blocksize && self->chunk.len - 4 >= datalen) {                                    \
+                    /* A whole block in the chunk, decompress it where it is */                                        \
+                    frame       = p;                                                                                   \
+                    self->chunk = SliceOf(self->chunk.ptr + 4 + datalen, self->chunk.len - 4 - datalen, T);            \
+                    continue;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            size_t const want = self->inlen < 4 ? 4 - self->inlen : 4 + datalen - self->inlen;                         \
+            size_t const n    = self->chunk.len < want ? self->chunk.len : want;                                       \
+            memcpy(self->in + self->inlen, p, n);                                                                      \
+            self->inlen += n;                                                                                          \
+            self->chunk  = SliceOf(self->chunk.ptr + n, self->chunk.len - n, T);                                       \
+        }                                                                                                              \
+        unsigned char const* const blk = itpl_lz4_unframe(frame, self->out, self->blocksize, &datalen);                \
+        if (blk == NULL) {                                                                                             \
+            self->malformed = true;                                                                                    \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        return Just(SliceOf((T const*)blk, datalen, T), Slice(T));                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterLz4Decompress(T)*, Slice(T), Name, ITPL_CONCAT(IterLz4Decompress(T), _nxt))
+
+/**
+ * @def IterMap(ElmntType, FnRetType)
+ * @brief Convenience macro to get the type of the IterMap struct with given element type and function return type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterMap(int, int);
+ * IterMap(int, int) i; // Declares a variable of type IterMap(int, int)
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name
+ * passed to #DefineIterMap(ElmntType, FnRetType).
+ * @param FnRetType The type of value the function contained within an `IterMap` struct will return. Must be the same
+ * type name passed to #DefineIterMap(ElmntType, FnRetType).
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics.
+ */
+#define IterMap(ElmntType, FnRetType) ITPL_CONCAT(ITPL_CONCAT(IterMap_, ElmntType), ITPL_CONCAT(_, FnRetType))
+
+/**
+ * @def DefineIterMap(ElmntType, FnRetType)
+ * @brief Define an IterMap struct that maps a function of type `FnRetType (*)(ElmntType)` over an
+ * `Iterable(ElmntType)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterMap(int, int); // Defines an IterMap(int, int) struct
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterMap` will yield.
+ * @param FnRetType The type of value the function contained within an `IterMap` struct will return.
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics.
+ * @note An #Iterator(T) for given `ElmntType`, and `FnRetType` **must** also exist.
+ */
+#define DefineIterMap(ElmntType, FnRetType)                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        FnRetType (*f)(ElmntType x);                                                                                   \
+        Iterable(ElmntType) src;                                                                                       \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterMap(ElmntType, FnRetType)
+
+/**
+ * @def define_itermap_func(ElmntType, FnRetType, Name)
+ * @brief Define a function to turn an #IterMap(ElmntType, FnRetType) into an #Iterable(FnRetType).
+ *
+ * Define the `next` function implementation for the #IterMap(ElmntType, FnRetType) struct, and use it to implement the
+ * Iterator typeclass, for given `ElmntType` and `FnRetType`.
+ *
+ * The defined function takes in a value of type `IterMap(ElmntType, FnRetType)*` and wraps it in an
+ * `Iterable(FnRetType)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterMap(int);
+ *
+ * // Implement `Iterator` for `IterMap(int, int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrmp(IterMap(int, int)* x)`
+ * define_itermap_func(int, int, wrap_intitrmp)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Decrement an int
+ * static int decr(int a) { return a - 1; }
+ * @endcode
+ *
+ * @code
+ * // Map `decr` over `it` (of type `Iterable(int)`)
+ * Iterable(int) decr_it = wrap_intitrmp(&(IterMap(int, int)){ .f = decr, .src = it });
+ * @endcode
+ *
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterMap` will yield.
+ * @param FnRetType The type of value the function contained within an `IterMap` struct will return.
+ * @param Name Name to define the function as.
+ *
+ * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
+ * `*`. Only alphanumerics..
+ * @note An #IterMap(ElmntType, FnRetType) for the given `ElmntType` and `FnRetType` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itermap_func(ElmntType, FnRetType, Name)                                                                \
+    static Maybe(FnRetType) ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt)(IterMap(ElmntType, FnRetType) * self)     \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(ElmntType) const srcit = self->src;                                                                   \
+        Maybe(ElmntType) const res      = srcit.tc->next(srcit.self);                                                  \
+        return fmap_maybe(res, self->f, FnRetType);                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt))
+
+/**
+ * @brief A record (line) of an NDJSON buffer.
+ */
+typedef struct
+{
+    char const* ptr;
+    size_t len;
+} ItplJsonRecord;
+
+/**
+ * @brief A member of a JSON object- views of its key (without the quotes) and its value (as is).
+ */
+typedef struct
+{
+    char const* key;
+    size_t keylen;
+    char const* val;
+    size_t vallen;
+} ItplJsonMember;
+
+static inline size_t itpl_json_ws(char const* s, size_t len, size_t i)
+{
+    while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) {
+        i++;
+    }
+    return i;
+}
+
+/* Skip the string starting at `i`, returning the position after its closing quote, or `SIZE_MAX` */
+static inline size_t itpl_json_skip_str(char const* s, size_t len, size_t i)
+{
+    for (i++; i < len; i++) {
+        if (s[i] == '\\') {
+            i++;
+        } else if (s[i] == '"') {
+            return i + 1;
+        }
+    }
+    return SIZE_MAX;
+}
+
+/* Skip the value starting at `i`, returning the position after it, or `SIZE_MAX` */
+static inline size_t itpl_json_skip_value(char const* s, size_t len, size_t i)
+{
+    if (i == len) {
+        return SIZE_MAX;
+    }
+    if (s[i] == '"') {
+        return itpl_json_skip_str(s, len, i);
+    }
+    if (s[i] == '{' || s[i] == '[') {
+        size_t depth = 0;
+        while (i < len) {
+            char const c = s[i];
+            if (c == '"') {
+                i = itpl_json_skip_str(s, len, i);
+                if (i == SIZE_MAX) {
+                    return SIZE_MAX;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return i + 1;
+            }
+            i++;
+        }
+        return SIZE_MAX;
+    }
+    size_t const start = i;
+    while (i < len && s[i] != ',' && s[i] != '}' && s[i] != ']' && s[i] != ' ' && s[i] != '\t' && s[i] != '\r' &&
+           s[i] != '\n') {
+        i++;
+    }
+    return i > start ? i : SIZE_MAX;
+}
+
+/*
+ * Parse the member of the object in `rec` at `*pos`, which must be 0 for the first member. Returns 1 if a member was
+ * parsed, 0 at the end of the object, and -1 if the record is not a well formed object.
+ */
+static inline int itpl_json_member(ItplJsonRecord rec, size_t* pos, ItplJsonMember* m)
+{
+    char const* const s = rec.ptr;
+    size_t const len    = rec.len;
+    size_t i            = *pos;
+    if (i == 0) {
+        i = itpl_json_ws(s, len, 0);
+        if (i == len || s[i] != '{') {
+            return -1;
+        }
+        i++;
+    }
+    i = itpl_json_ws(s, len, i);
+    if (i < len && s[i] == '}') {
+        return 0;
+    }
+    if (i == len || s[i] != '"') {
+        return -1;
+    }
+    size_t const keyend = itpl_json_skip_str(s, len, i);
+    if (keyend == SIZE_MAX) {
+        return -1;
+    }
+    m->key    = s + i + 1;
+    m->keylen = keyend - i - 2;
+    i         = itpl_json_ws(s, len, keyend);
+    if (i == len || s[i] != ':') {
+        return -1;
+    }
+    i                   = itpl_json_ws(s, len, i + 1);
+    size_t const valend = itpl_json_skip_value(s, len, i);
+    if (valend == SIZE_MAX) {
+        return -1;
+    }
+    m->val    = s + i;
+    m->vallen = valend - i;
+    i         = itpl_json_ws(s, len, valend);
+    if (i < len && s[i] == ',') {
+        *pos = i + 1;
+    } else if (i < len && s[i] == '}') {
+        *pos = i;
+    } else {
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Index the members at the top level of the object in a record.
+ *
+ * @param rec The record.
+ * @param out Where to store the members.
+ * @param cap Maximum number of members to store.
+ *
+ * @return The number of members stored, or `SIZE_MAX` if the record is not a well formed object. Members beyond the
+ * first `cap` are not checked.
+ */
+static inline size_t itpl_json_index(ItplJsonRecord rec, ItplJsonMember* out, size_t cap)
+{
+    size_t pos = 0, n = 0;
+    while (n < cap) {
+        int const res = itpl_json_member(rec, &pos, out + n);
+        if (res < 0) {
+            return SIZE_MAX;
+        }
+        if (res == 0) {
+            break;
+        }
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Find a member by key in the members indexed by #itpl_json_index.
+ *
+ * @return The member, or `NULL` if there's no member with given key.
+ */
+static inline ItplJsonMember const* itpl_json_find(ItplJsonMember const* members, size_t n, char const* key)
+{
+    size_t const keylen = strlen(key);
+    for (size_t i = 0; i < n; i++) {
+        if (members[i].keylen == keylen && memcmp(members[i].key, key, keylen) == 0) {
+            return members + i;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Look up a member by key at the top level of the object in a record, scanning only up to that member.
+ *
+ * @return `false` if there's no member with given key, or the record is not a well formed object up to it.
+ */
+static inline bool itpl_json_get(ItplJsonRecord rec, char const* key, ItplJsonMember* out)
+{
+    size_t const keylen = strlen(key);
+    size_t pos          = 0;
+    while (itpl_json_member(rec, &pos, out) > 0) {
+        if (out->keylen == keylen && memcmp(out->key, key, keylen) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Copy a number into a NUL terminated buffer for strtoll/strtod, `false` if it can't be a number */
+static inline bool itpl_json_numbuf(ItplJsonMember const* m, char* buf, size_t size)
+{
+    if (m->vallen == 0 || m->vallen >= size || !(m->val[0] == '-' || (m->val[0] >= '0' && m->val[0] <= '9'))) {
+        return false;
+    }
+    memcpy(buf, m->val, m->vallen);
+    buf[m->vallen] = '\0';
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member to an integer.
+ *
+ * @return `false` if the value is not an integer, or does not fit in a `long long`.
+ */
+static inline bool itpl_json_as_int(ItplJsonMember const* m, long long* out)
+{
+    char buf[32];
+    char* end;
+    if (!itpl_json_numbuf(m, buf, sizeof(buf))) {
+        return false;
+    }
+    errno             = 0;
+    long long const x = strtoll(buf, &end, 10);
+    if (*end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    *out = x;
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member, which must be a number, to a double.
+ *
+ * @note The conversion uses `strtod`, which expects the decimal point of the current locale.
+ */
+static inline bool itpl_json_as_double(ItplJsonMember const* m, double* out)
+{
+    char buf[64];
+    char* end;
+    if (!itpl_json_numbuf(m, buf, sizeof(buf))) {
+        return false;
+    }
+    double const x = strtod(buf, &end);
+    if (*end != '\0') {
+        return false;
+    }
+    *out = x;
+    return true;
+}
+
+/**
+ * @brief Convert the value of a member, which must be `true` or `false`, to a bool.
+ */
+static inline bool itpl_json_as_bool(ItplJsonMember const* m, bool* out)
+{
+    if (m->vallen == 4 && memcmp(m->val, "true", 4) == 0) {
+        *out = true;
+        return true;
+    }
+    if (m->vallen == 5 && memcmp(m->val, "false", 5) == 0) {
+        *out = false;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Get a view of the contents of a string value, without the quotes. Escape sequences are left as is.
+ *
+ * Use #itpl_json_unescape to decode the escape sequences, if the view contains a `\`.
+ */
+static inline bool itpl_json_as_str(ItplJsonMember const* m, char const** ptr, size_t* len)
+{
+    if (m->vallen < 2 || m->val[0] != '"') {
+        return false;
+    }
+    *ptr = m->val + 1;
+    *len = m->vallen - 2;
+    return true;
+}
+
+static inline int itpl_json_hex4(char const* s)
+{
+    int x = 0;
+    for (int i = 0; i < 4; i++) {
+        char const c = s[i];
+        x *= 16;
+        if (c >= '0' && c <= '9') {
+            x += c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            x += c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            x += c - 'A' + 10;
+        } else {
+            return -1;
+        }
+    }
+    return x;
+}
+
+/**
+ * @brief Decode the escape sequences in the contents of a string, into UTF-8.
+ *
+ * @param s The contents of the string, as obtained from #itpl_json_as_str.
+ * @param len The length of the contents.
+ * @param out Where to write the decoded string, must have room for `len` bytes- decoding never makes it longer.
+ *
+ * @return The length of the decoded string, or `SIZE_MAX` if it contains an invalid escape sequence.
+ */
+static inline size_t itpl_json_unescape(char const* s, size_t len, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] != '\\') {
+            out[n++] = s[i];
+            continue;
+        }
+        if (++i == len) {
+            return SIZE_MAX;
+        }
+        switch (s[i]) {
+        case '"':
+        case '\\':
+        case '/':
+            out[n++] = s[i];
+            continue;
+        case 'b':
+            out[n++] = '\b';
+            continue;
+        case 'f':
+            out[n++] = '\f';
+            continue;
+        case 'n':
+            out[n++] = '\n';
+            continue;
+        case 'r':
+            out[n++] = '\r';
+            continue;
+        case 't':
+            out[n++] = '\t';
+            continue;
+        case 'u':
+            break;
+        default:
+            return SIZE_MAX;
+        }
+        long cp = len - i > 4 ? itpl_json_hex4(s + i + 1) : -1;
+        i += 4;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            /* A high surrogate must be followed by an escaped low surrogate */
+            long const lo = len - i > 6 && s[i + 1] == '\\' && s[i + 2] == 'u' ? itpl_json_hex4(s + i + 3) : -1;
+            if (lo < 0xDC00 || lo > 0xDFFF) {
+                return SIZE_MAX;
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            i += 6;
+        } else if (cp < 0 || (cp >= 0xDC00 && cp <= 0xDFFF)) {
+            return SIZE_MAX;
+        }
+        if (cp < 0x80) {
+            out[n++] = (char)cp;
+        } else if (cp < 0x800) {
+            out[n++] = (char)(0xC0 | (cp >> 6));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out[n++] = (char)(0xE0 | (cp >> 12));
+            out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        } else {
+            out[n++] = (char)(0xF0 | (cp >> 18));
+            out[n++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+            out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (cp & 0x3F));
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief An NDJSON record iterator, yielding `ItplJsonRecord`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to split into records.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    size_t pos;
+    ITPL_STATS_MEMBER
+} IterNdjson;
+
+/**
+ * @def define_iterndjson_func(Name)
+ * @brief Define a function to turn an #IterNdjson into an `Iterable(ItplJsonRecord)`.
+ *
+ * Define the `next` function implementation for the #IterNdjson struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterNdjson*` and wraps it in an `Iterable(ItplJsonRecord)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineMaybe(ItplJsonRecord)
+ * DefineIteratorOf(ItplJsonRecord);
+ *
+ * // Implement `Iterator` for `IterNdjson`
+ * // The defined function has the signature- `Iterable(ItplJsonRecord) wrap_ndjson(IterNdjson* x)`
+ * define_iterndjson_func(wrap_ndjson)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Sum the "bytes" field of the records in `logs` (of type `char const*`), of length `logslen`
+ * long long total = 0;
+ * foreach (ItplJsonRecord, rec, wrap_ndjson(&(IterNdjson){ .buf = logs, .len = logslen })) {
+ *     ItplJsonMember m;
+ *     long long bytes;
+ *     if (itpl_json_get(rec, "bytes", &m) && itpl_json_as_int(&m, &bytes)) {
+ *         total += bytes;
+ *     }
+ * }
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = ItplJsonRecord` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterndjson_func(Name)                                                                                   \
+    static Maybe(ItplJsonRecord) ITPL_CONCAT(Name, _nxt)(IterNdjson * self)                                            \
+    {                                                                                                                  \
+        while (self->pos < self->len) {                                                                                \
+            char const* const start = self->buf + self->pos;                                                           \
+            char const* const nl    = memchr(start, '\n', self->len - self->pos);                                      \
+            size_t len              = nl == NULL ? self->len - self->pos : (size_t)(nl - start);                       \
+            self->pos              += nl == NULL ? len : len + 1;                                                      \
+            if (len > 0 && start[len - 1] == '\r') {                                                                   \
+                len--;                                                                                                 \
+            }                                                                                                          \
+            /* Skip blank lines, including ones with only whitespace */                                                \
+            if (itpl_json_ws(start, len, 0) < len) {                                                                   \
+                return Just(((ItplJsonRecord){.ptr = start, .len = len}), ItplJsonRecord);                             \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(ItplJsonRecord);                                                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterNdjson*, ItplJsonRecord, Name, ITPL_CONCAT(Name, _nxt))
+
+/* The largest prefetch distance, i.e the size of the ring */
+#ifndef ITPLUS_PREFETCH_MAX
+#define ITPLUS_PREFETCH_MAX 16
+#endif /* !ITPLUS_PREFETCH_MAX */
+
+/**
+ * @def IterPrefetch(T)
+ * @brief Convenience macro to get the type of the IterPrefetch struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(int);
+ * IterPrefetch(int) i; // Declares a variable of type IterPrefetch(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield. Must be the same type name
+ * passed to #DefineIterPrefetch(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterPrefetch(T) ITPL_CONCAT(IterPrefetch_, T)
+
+/**
+ * @def DefineIterPrefetch(T)
+ * @brief Define an IterPrefetch struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `addr` - The function returning the address an element references.
+ * * `distance` - (Optional) How many elements ahead to prefetch, up to #ITPLUS_PREFETCH_MAX. `0` means the most.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(int); // Defines an IterPrefetch(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterPrefetch(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        void const* (*addr)(T x);                                                                                      \
+        size_t distance;                                                                                               \
+        /* The elements extracted ahead, and the position of the oldest one */                                         \
+        T ring[ITPLUS_PREFETCH_MAX];                                                                                   \
+        size_t head;                                                                                                   \
+        size_t len;                                                                                                    \
+        bool exhausted;                                                                                                \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterPrefetch(T)
+
+/**
+ * @def define_iterprefetch_func(T, Name)
+ * @brief Define a function to turn an #IterPrefetch(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterPrefetch(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterPrefetch(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterPrefetch(uint32_t);
+ *
+ * // Implement `Iterator` for `IterPrefetch(uint32_t)`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_u32prefetch(IterPrefetch(uint32_t)* x)`
+ * define_iterprefetch_func(uint32_t, wrap_u32prefetch)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static void const* row_addr(uint32_t i)
+ * {
+ *     return rows + i;
+ * }
+ * ...
+ * // Prefetch the rows indexed by `idxs` (of type `Iterable(uint32_t)`) 8 indices ahead of their lookup
+ * Iterable(uint32_t) ahead =
+ *     wrap_u32prefetch(&(IterPrefetch(uint32_t)){.addr = row_addr, .distance = 8, .src = idxs});
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterPrefetch` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to `distance` elements are extracted from the source ahead of the element being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterPrefetch(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterprefetch_func(T, Name)                                                                              \
+    static Maybe(T) ITPL_CONCAT(IterPrefetch(T), _nxt)(IterPrefetch(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        size_t distance         = self->distance;                                                                      \
+        if (distance == 0 || distance > ITPLUS_PREFETCH_MAX) {                                                         \
+            distance = ITPLUS_PREFETCH_MAX;                                                                            \
+        }                                                                                                              \
+        /* Top up the ring- all at once on the first call, then one element per element yielded */                     \
+        while (!self->exhausted && self->len < distance) {                                                             \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                self->exhausted = true;                                                                                \
+                break;                                                                                                 \
+            }                                                                                                          \
+            T const y = from_just_(res);                                                                               \
+            ITPL_PREFETCH(self->addr(y));                                                                              \
+            self->ring[(self->head + self->len) % ITPLUS_PREFETCH_MAX]  = y;                                           \
+            self->len                                                 += 1;                                            \
+        }                                                                                                              \
+        if (self->len == 0) {                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T const x   = self->ring[self->head];                                                                          \
+        self->head  = (self->head + 1) % ITPLUS_PREFETCH_MAX;                                                          \
+        self->len  -= 1;                                                                                               \
+        return Just(x, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterPrefetch(T)*, T, Name, ITPL_CONCAT(IterPrefetch(T), _nxt))
+
+/**
+ * @def ITPL_REC_VERSION
+ * @brief The version of the record stream format written, and the only one read.
+ */
+#define ITPL_REC_VERSION 1U
+
+/**
+ * @def ITPL_REC_CHECKSUM
+ * @brief Flag of a record stream with checksummed blocks.
+ */
+#define ITPL_REC_CHECKSUM 1U
+
+#define ITPL_REC_MAGIC     "ITPLREC"
+#define ITPL_REC_BOM       0x01020304U
+#define ITPL_REC_BLKMAGIC  0x4B4C4249U
+#define ITPL_REC_FILEHDRSZ 24U
+#define ITPL_REC_BLKHDRSZ  16U
+
+/* Round up to a multiple of 8 */
+#define ITPL_REC_PAD(n) (((n) + 7U) & ~(size_t)7U)
+
+/**
+ * @brief Writer of a record stream.
+ *
+ * The members to be filled in by the caller are-
+ * * `f` - The file to write to.
+ * * `buf`, `cap` - The buffer to build blocks in. Its size is the (maximum) size of a block's payload. Records that
+ *   don't fit into it on their own are written as a block of their own.
+ * * `elsize` - The size of every record, or `0` for variable length records.
+ * * `checksum` - (Optional) Whether to checksum the blocks.
+ *
+ * The file header is written along with the first block. `failed` is set once any write fails, after which nothing
+ * else is written.
+ */
+typedef struct
+{
+    FILE* f;
+    unsigned char* buf;
+    size_t cap;
+    uint32_t elsize;
+    bool checksum;
+    size_t len;
+    uint32_t count;
+    bool started;
+    bool failed;
+} ItplRecWriter;
+
+/**
+ * @brief Reader of a record stream in memory.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The stream.
+ *
+ * `corrupt` is set once the stream is found to be malformed (or of a different version or byte order), after which no
+ * more records are read.
+ */
+typedef struct
+{
+    unsigned char const* buf;
+    size_t len;
+    size_t pos;
+    uint32_t elsize;
+    uint32_t flags;
+    /* Records left in the current block, and where it ends */
+    uint32_t left;
+    size_t end;
+    bool corrupt;
+} ItplRecReader;
+
+/**
+ * @brief Continue an FNV-1a hash of some bytes. Start with `2166136261`.
+ */
+static inline uint32_t itpl_rec_fnv1a(uint32_t h, void const* data, size_t len)
+{
+    unsigned char const* const p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619U;
+    }
+    return h;
+}
+
+static inline uint32_t itpl_rec_u32(unsigned char const* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline void itpl_rec_put_u32(unsigned char* p, uint32_t x) { memcpy(p, &x, sizeof(x)); }
+
+static inline bool itpl_rec_write(ItplRecWriter* w, void const* data, size_t len)
+{
+    if (!w->failed && len > 0 && fwrite(data, 1, len, w->f) != len) {
+        w->failed = true;
+    }
+    return !w->failed;
+}
+
+/* Write the file header, if it hasn't been already */
+static inline bool itpl_rec_start(ItplRecWriter* w)
+{
+    if (w->started) {
+        return !w->failed;
+    }
+    unsigned char hdr[ITPL_REC_FILEHDRSZ] = ITPL_REC_MAGIC;
+    itpl_rec_put_u32(hdr + 8, ITPL_REC_VERSION);
+    itpl_rec_put_u32(hdr + 12, ITPL_REC_BOM);
+    itpl_rec_put_u32(hdr + 16, w->elsize);
+    itpl_rec_put_u32(hdr + 20, w->checksum ? ITPL_REC_CHECKSUM : 0);
+    w->started = true;
+    return itpl_rec_write(w, hdr, sizeof(hdr));
+}
+
+/* Write a block made of (up to) two pieces of payload, which are padded to 8 bytes */
+static inline bool itpl_rec_block(ItplRecWriter* w, uint32_t count, void const* a, size_t alen, void const* b,
+    size_t blen)
+{
+    static unsigned char const zeros[8] = {0};
+    size_t const size                   = ITPL_REC_PAD(alen + blen);
+    unsigned char hdr[ITPL_REC_BLKHDRSZ];
+    uint32_t sum = 0;
+    if (w->checksum) {
+        sum = itpl_rec_fnv1a(itpl_rec_fnv1a(2166136261U, a, alen), b, blen);
+        sum = itpl_rec_fnv1a(sum, zeros, size - alen - blen);
+    }
+    itpl_rec_put_u32(hdr, ITPL_REC_BLKMAGIC);
+    itpl_rec_put_u32(hdr + 4, count);
+    itpl_rec_put_u32(hdr + 8, (uint32_t)size);
+    itpl_rec_put_u32(hdr + 12, sum);
+    return itpl_rec_start(w) && itpl_rec_write(w, hdr, sizeof(hdr)) && itpl_rec_write(w, a, alen) &&
+           itpl_rec_write(w, b, blen) && itpl_rec_write(w, zeros, size - alen - blen);
+}
+
+/**
+ * @brief Write the buffered records as a block, and flush the file.
+ *
+ * Also writes the file header if nothing has been written yet, so an empty stream is still a valid one.
+ *
+ * @return `false` if any write has failed.
+ */
+static inline bool itpl_rec_flush(ItplRecWriter* w)
+{
+    if (w->count > 0 && !itpl_rec_block(w, w->count, w->buf, w->len, NULL, 0)) {
+        return false;
+    }
+    w->len   = 0;
+    w->count = 0;
+    if (!itpl_rec_start(w) || fflush(w->f) != 0) {
+        w->failed = true;
+    }
+    return !w->failed;
+}
+
+/**
+ * @brief Add a record to the stream.
+ *
+ * @param w The writer.
+ * @param rec The record.
+ * @param len Length of the record, must be equal to `w->elsize` for streams of fixed size records.
+ *
+ * @return `false` if the record is too large (or of the wrong size), or any write has failed.
+ */
+static inline bool itpl_rec_put(ItplRecWriter* w, void const* rec, size_t len)
+{
+    if ((w->elsize != 0 && len != w->elsize) || len > UINT32_MAX - 16U) {
+        return false;
+    }
+    size_t const need = w->elsize != 0 ? len : 8 + ITPL_REC_PAD(len);
+    if (need > w->cap - w->len && w->count > 0 && !itpl_rec_flush(w)) {
+        return false;
+    }
+    unsigned char prefix[8] = {0};
+    itpl_rec_put_u32(prefix, (uint32_t)len);
+    if (need > w->cap) {
+        /* Too large for the buffer, write it as a block of its own */
+        return w->elsize != 0 ? itpl_rec_block(w, 1, rec, len, NULL, 0)
+                              : itpl_rec_block(w, 1, prefix, sizeof(prefix), rec, len);
+    }
+    if (w->elsize == 0) {
+        memcpy(w->buf + w->len, prefix, sizeof(prefix));
+        memset(w->buf + w->len + 8 + len, 0, need - 8 - len);
+        w->len += 8;
+    }
+    memcpy(w->buf + w->len, rec, len);
+    w->len += w->elsize != 0 ? len : need - 8;
+    ++(w->count);
+    return !w->failed;
+}
+
+/* Enter the next block of the stream, verifying its header */
+static inline bool itpl_rec_enter(ItplRecReader* r)
+{
+    unsigned char const* const hdr = r->buf + r->pos;
+    if (r->len - r->pos < ITPL_REC_BLKHDRSZ || itpl_rec_u32(hdr) != ITPL_REC_BLKMAGIC) {
+        return false;
+    }
+    uint32_t const count = itpl_rec_u32(hdr + 4);
+    uint32_t const size  = itpl_rec_u32(hdr + 8);
+    if (size % 8 != 0 || size > r->len - r->pos - ITPL_REC_BLKHDRSZ ||
+        (r->elsize != 0 && (uint64_t)count * r->elsize > size)) {
+        return false;
+    }
+    if ((r->flags & ITPL_REC_CHECKSUM) != 0 &&
+        itpl_rec_fnv1a(2166136261U, hdr + ITPL_REC_BLKHDRSZ, size) != itpl_rec_u32(hdr + 12)) {
+        return false;
+    }
+    r->pos += ITPL_REC_BLKHDRSZ;
+    r->end  = r->pos + size;
+    r->left = count;
+    if (count == 0) {
+        r->pos = r->end;
+    }
+    return true;
+}
+
+/**
+ * @brief Read the next record of a stream.
+ *
+ * @param r The reader.
+ * @param rec Where to store the pointer to the record, into the stream.
+ * @param len Where to store the length of the record.
+ *
+ * @return `false` if there are no more records, or the stream is malformed- in which case `r->corrupt` is set.
+ */
+static inline bool itpl_rec_next(ItplRecReader* r, unsigned char const** rec, size_t* len)
+{
+    if (r->corrupt) {
+        return false;
+    }
+    if (r->pos == 0) {
+        if (r->len < ITPL_REC_FILEHDRSZ || memcmp(r->buf, ITPL_REC_MAGIC, 8) != 0 ||
+            itpl_rec_u32(r->buf + 8) != ITPL_REC_VERSION || itpl_rec_u32(r->buf + 12) != ITPL_REC_BOM) {
+            r->corrupt = true;
+            return false;
+        }
+        r->elsize = itpl_rec_u32(r->buf + 16);
+        r->flags  = itpl_rec_u32(r->buf + 20);
+        r->pos    = ITPL_REC_FILEHDRSZ;
+    }
+    while (r->left == 0) {
+        if (r->pos == r->len) {
+            return false;
+        }
+        if (!itpl_rec_enter(r)) {
+            r->corrupt = true;
+            return false;
+        }
+    }
+    size_t size = r->elsize;
+    if (size == 0) {
+        if (r->end - r->pos < 8 || itpl_rec_u32(r->buf + r->pos) > r->end - r->pos - 8) {
+            r->corrupt = true;
+            return false;
+        }
+        *len = itpl_rec_u32(r->buf + r->pos);
+        *rec = r->buf + r->pos + 8;
+        size = 8 + *len;
+    } else {
+        *len = size;
+        *rec = r->buf + r->pos;
+    }
+    r->pos = --(r->left) == 0 ? r->end : r->pos + (r->elsize == 0 ? ITPL_REC_PAD(size) : size);
+    return true;
+}
+
+/**
+ * @def define_recwrite_func(T, Name)
+ * @brief Define the `write_to` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, and a writer of a stream of records of size `sizeof(T)`. It
+ * adds every element of the iterable to the stream, and flushes it.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // Defines a function with the signature- `bool write_ints(Iterable(int) it, ItplRecWriter* w)`
+ * define_recwrite_func(int, write_ints)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static unsigned char blk[65536];
+ * ItplRecWriter w = {.f = f, .buf = blk, .cap = sizeof(blk), .elsize = sizeof(int), .checksum = true};
+ * // Write `it` (of type `Iterable(int)`) to `f` (of type `FILE*`)
+ * if (!write_ints(it, &w)) {
+ *     // Handle the failed write
+ * }
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @return `false` if any write has failed.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define define_recwrite_func(T, Name)                                                                                  \
+    bool Name(Iterable(T) it, ItplRecWriter* w)                                                                        \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            if (!itpl_rec_put(w, &x, sizeof(x))) {                                                                     \
+                return false;                                                                                          \
+            }                                                                                                          \
+        }                                                                                                              \
+        return itpl_rec_flush(w);                                                                                      \
+    }
+
+/**
+ * @def IterRecRead(T)
+ * @brief Convenience macro to get the type of the IterRecRead struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int);
+ * IterRecRead(int) i; // Declares a variable of type IterRecRead(int)
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield. Must be the same type name passed to #DefineIterRecRead(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterRecRead(T) ITPL_CONCAT(IterRecRead_, T)
+
+/**
+ * @def DefineIterRecRead(T)
+ * @brief Define an IterRecRead struct that reads `T`s from a record stream.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `rd` - The reader of the stream, whose records must be of size `sizeof(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int); // Defines an IterRecRead(int) struct
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterRecRead(T)                                                                                           \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        ItplRecReader rd;                                                                                              \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterRecRead(T)
+
+/**
+ * @def define_iterrecread_func(T, Name)
+ * @brief Define a function to turn an #IterRecRead(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterRecRead(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterRecRead(T)*` and wraps it in an `Iterable(T)`. The records are
+ * copied out of the stream as they're yielded, so the stream does not need to be aligned for `T`. A stream of records
+ * of any size other than `sizeof(T)` is treated as corrupt.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterRecRead(int);
+ *
+ * // Implement `Iterator` for `IterRecRead(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intrecread(IterRecRead(int)* x)`
+ * define_iterrecread_func(int, wrap_intrecread)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Read back the ints in `data` (of type `unsigned char const*`), of length `datalen`
+ * IterRecRead(int) r = {.rd = {.buf = data, .len = datalen}};
+ * Iterable(int) it   = wrap_intrecread(&r);
+ * @endcode
+ *
+ * @param T The type of value this `IterRecRead` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterRecRead(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterrecread_func(T, Name)                                                                               \
+    static Maybe(T) ITPL_CONCAT(IterRecRead(T), _nxt)(IterRecRead(T) * self)                                           \
+    {                                                                                                                  \
+        unsigned char const* rec;                                                                                      \
+        size_t len;                                                                                                    \
+        if (!itpl_rec_next(&self->rd, &rec, &len)) {                                                                   \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (len != sizeof(T)) {                                                                                        \
+            self->rd.corrupt = true;                                                                                   \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T x;                                                                                                           \
+        memcpy(&x, rec, sizeof(x));                                                                                    \
+        return Just(x, T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterRecRead(T)*, T, Name, ITPL_CONCAT(IterRecRead(T), _nxt))
+
+/**
+ * @brief A record stream iterator, yielding each record as a `Slice(char)` into the stream.
+ *
+ * The members to be filled in by the caller are-
+ * * `rd` - The reader of the stream, whose records may be of any size.
+ */
+typedef struct
+{
+    ItplRecReader rd;
+    ITPL_STATS_MEMBER
+} IterRecBytes;
+
+/**
+ * @def define_iterrecbytes_func(Name)
+ * @brief Define a function to turn an #IterRecBytes into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterRecBytes struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterRecBytes*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterRecBytes`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_recbytes(IterRecBytes* x)`
+ * define_iterrecbytes_func(wrap_recbytes)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Read back the records in `data` (of type `unsigned char const*`), of length `datalen`
+ * IterRecBytes r                = {.rd = {.buf = data, .len = datalen}};
+ * Iterable(Slice(char)) records = wrap_recbytes(&r);
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_iterrecbytes_func(Name)                                                                                 \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterRecBytes * self)                                             \
+    {                                                                                                                  \
+        unsigned char const* rec;                                                                                      \
+        size_t len;                                                                                                    \
+        if (!itpl_rec_next(&self->rd, &rec, &len)) {                                                                   \
+            return Nothing(Slice(char));                                                                               \
+        }                                                                                                              \
+        return Just(SliceOf((char const*)rec, len, char), Slice(char));                                                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterRecBytes*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
+
+/**
+ * @def define_iterreduce_func(T, Name)
+ * @brief Define the `reduce` function for an iterable.
+ *
+ * The defined reduce function takes in an iterable of type `T`, and a function of type `T (*const f)(T acc, T x)`, and
+ * reduces the iterable to a singular value of type `T`, by repeatedly applying `f` onto it.
+ *
+ * If the given iterable was empty, `Nothing` is returned. Otherwise, a `Just` value is returned.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `Maybe(int) int_reduce(Iterable(int), int (*f)(int acc, int x))`
+ * define_iterreduce_func(int, int_reduce)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Add 2 ints
+ * static int add(int a, int b) { return a + b; }
+ * @endcode
+ *
+ * @code
+ * // Reduce `it` (of type `Iterable(int)`) with `add`
+ * Maybe(int) maybe_sum = int_reduce(it, add);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_iterreduce_func(T, Name)                                                                                \
+    Maybe(T) Name(Iterable(T) it, T (*f)(T acc, T x))                                                                  \
+    {                                                                                                                  \
+        Maybe(T) const res = it.tc->next(it.self);                                                                     \
+        if (is_nothing(res)) {                                                                                         \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        T acc = from_just_(res);                                                                                       \
+        foreach (T, x, it) {                                                                                           \
+            acc = f(acc, x);                                                                                           \
+        }                                                                                                              \
+        return Just(acc, T);                                                                                           \
+    }
+
+/* State of the xoshiro256** generator, must not be all zero - use `itpl_rng_seed` to create one */
+typedef struct
+{
+    uint64_t s[4];
+} ItplRng;
+
+static inline uint64_t itpl_rng_rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+/**
+ * @brief Create a generator state from a 64 bit seed.
+ */
+static inline ItplRng itpl_rng_seed(uint64_t seed)
+{
+    ItplRng rng;
+    for (int i = 0; i < 4; i++) {
+        /* splitmix64 */
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        rng.s[i]   = z ^ (z >> 31);
+    }
+    return rng;
+}
+
+/**
+ * @brief Generate a uniformly distributed 64 bit integer.
+ */
+static inline uint64_t itpl_rng_next(ItplRng* rng)
+{
+    uint64_t* const s  = rng->s;
+    uint64_t const res = itpl_rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t const t   = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = itpl_rng_rotl(s[3], 45);
+    return res;
+}
+
+/**
+ * @brief Generate a uniformly distributed double in the range (0, 1].
+ */
+static inline double itpl_rng_unit(ItplRng* rng)
+{
+    return (double)((itpl_rng_next(rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Generate a uniformly distributed integer in the range [0, n).
+ *
+ * The range is empty when `n` is 0- in which case 0 is returned, without advancing the generator.
+ */
+static inline uint64_t itpl_rng_below(ItplRng* rng, uint64_t n)
+{
+    if (n == 0) {
+        return 0;
+    }
+    /* Reject the values that would make the lowest residues more likely */
+    uint64_t const threshold = (0 - n) % n;
+    while (1) {
+        uint64_t const x = itpl_rng_next(rng);
+        if (x >= threshold) {
+            return x % n;
+        }
+    }
+}
+
+/* Draw the number of elements to skip before the next success, given the log of the probability of failure */
+static inline size_t itpl_sample_skip(ItplRng* rng, double lnfail)
+{
+    double const skip = floor(log(itpl_rng_unit(rng)) / lnfail);
+    return skip >= (double)SIZE_MAX ? SIZE_MAX : (size_t)skip;
+}
+
+/**
+ * @def IterSample(T)
+ * @brief Convenience macro to get the type of the IterSample struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int);
+ * IterSample(int) i; // Declares a variable of type IterSample(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield. Must be the same type name passed
+ * to #DefineIterSample(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterSample(T) ITPL_CONCAT(IterSample_, T)
+
+/**
+ * @def DefineIterSample(T)
+ * @brief Define an IterSample struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `p` - The probability of keeping each element.
+ * * `rng` - The random number generator state.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int); // Defines an IterSample(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterSample(T)                                                                                            \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        double p;                                                                                                      \
+        ItplRng rng;                                                                                                   \
+        bool started;                                                                                                  \
+        /* Log of the probability of skipping an element */                                                            \
+        double lnfail;                                                                                                 \
+        /* Number of elements to skip before the next kept one */                                                      \
+        size_t skip;                                                                                                   \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterSample(T)
+
+/**
+ * @def define_itersample_func(T, Name)
+ * @brief Define a function to turn an #IterSample(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterSample(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterSample(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSample(int);
+ *
+ * // Implement `Iterator` for `IterSample(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intsample(IterSample(int)* x)`
+ * define_itersample_func(int, wrap_intsample)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Keep roughly 1% of the elements in `it` (of type `Iterable(int)`)
+ * Iterable(int) sample = wrap_intsample(&(IterSample(int)){ .p = 0.01, .rng = itpl_rng_seed(42), .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSample` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterSample(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersample_func(T, Name)                                                                                \
+    static Maybe(T) ITPL_CONCAT(IterSample(T), _nxt)(IterSample(T) * self)                                             \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (!(self->p > 0)) {                                                                                          \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        if (!self->started) {                                                                                          \
+            self->started = true;                                                                                      \
+            self->lnfail  = self->p < 1 ? log1p(-self->p) : -INFINITY;                                                 \
+            self->skip    = itpl_sample_skip(&self->rng, self->lnfail);                                                \
+        }                                                                                                              \
+        for (; self->skip > 0; --(self->skip)) {                                                                       \
+            if (is_nothing(srcit.tc->next(srcit.self))) {                                                              \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_just(res)) {                                                                                            \
+            self->skip = itpl_sample_skip(&self->rng, self->lnfail);                                                   \
+        }                                                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterSample(T)*, T, Name, ITPL_CONCAT(IterSample(T), _nxt))
+
+/**
+ * @def define_iterreservoir_func(T, Name)
+ * @brief Define the reservoir sampling function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, an output buffer of at least `k` elements, `k`, and a random
+ * number generator, and writes `k` elements picked uniformly at random from the iterable (or all of them, if there are
+ * fewer) into the buffer. The number of elements written is returned. The order of the elements in the buffer is
+ * unspecified.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * // The defined function has the signature:-
+ * // `size_t reservoir_int(Iterable(int) it, int* out, size_t k, ItplRng* rng)`
+ * define_iterreservoir_func(int, reservoir_int)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Pick 100 random elements from `it` (of type `Iterable(int)`)
+ * int picked[100];
+ * ItplRng rng    = itpl_rng_seed(42);
+ * size_t const n = reservoir_int(it, picked, 100, &rng);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_iterreservoir_func(T, Name)                                                                             \
+    size_t Name(Iterable(T) it, T* out, size_t k, ItplRng* rng)                                                        \
+    {                                                                                                                  \
+        size_t n = 0;                                                                                                  \
+        if (k == 0) {                                                                                                  \
+            return 0;                                                                                                  \
+        }                                                                                                              \
+        for (; n < k; n++) {                                                                                           \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                return n;                                                                                              \
+            }                                                                                                          \
+            out[n] = from_just_(res);                                                                                  \
+        }                                                                                                              \
+        /* `w` is the largest of `k` random numbers in (0, 1], each element is given one and the smallest `k` kept */  \
+        double w = exp(log(itpl_rng_unit(rng)) / (double)k);                                                           \
+        while (1) {                                                                                                    \
+            for (size_t skip = itpl_sample_skip(rng, log1p(-w)); skip > 0; skip--) {                                   \
+                if (is_nothing(it.tc->next(it.self))) {                                                                \
+                    return n;                                                                                          \
+                }                                                                                                      \
+            }                                                                                                          \
+            Maybe(T) const res = it.tc->next(it.self);                                                                 \
+            if (is_nothing(res)) {                                                                                     \
+                return n;                                                                                              \
+            }                                                                                                          \
+            out[itpl_rng_below(rng, k)] = from_just_(res);                                                             \
+            w *= exp(log(itpl_rng_unit(rng)) / (double)k);                                                             \
+        }                                                                                                              \
+    }
+
+#ifndef ITPLUS_SEMIJOIN_BATCH
+#define ITPLUS_SEMIJOIN_BATCH 32
+#endif /* !ITPLUS_SEMIJOIN_BATCH */
+
+#ifndef ITPLUS_BLOOM_BITS_PER_KEY
+#define ITPLUS_BLOOM_BITS_PER_KEY 16
+#endif /* !ITPLUS_BLOOM_BITS_PER_KEY */
+
+/* Number of 64 bit words in a bloom filter block- one cache line */
+#define ITPL_BLOOM_BLOCK_WORDS 8
+
+/**
+ * @brief A set of 64 bit keys, either a dense bitmap or a blocked Bloom filter.
+ *
+ * Build one using a function defined by #define_semijoin_build_func(T, Name), and free it using #itpl_keyset_free.
+ */
+typedef struct
+{
+    /* The bitmap, or the blocks of the bloom filter */
+    uint64_t* words;
+    /* Bitmap- number of bits in the bitmap. Bloom filter- number of blocks minus 1 (a power of 2 minus 1) */
+    uint64_t mask;
+    /* Bitmap- the smallest key */
+    uint64_t min;
+    /* Bloom filter with exact checks- the sorted keys, with duplicates removed */
+    uint64_t* keys;
+    size_t len;
+    bool dense;
+} ItplKeySet;
+
+/* Pick the bit to set in the `i`th word of a block, using the multipliers of the split block Bloom filter of Parquet */
+static inline uint64_t itpl_bloom_bit(uint32_t upper, unsigned i)
+{
+    static uint32_t const salt[ITPL_BLOOM_BLOCK_WORDS] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    return (uint64_t)1 << ((uint32_t)(upper * salt[i]) >> 26);
+}
+
+/**
+ * @brief Get the block of a bloom filter a key with given hash lives in.
+ */
+static inline uint64_t* itpl_bloom_block(ItplKeySet const* set, uint64_t h)
+{
+    return set->words + (h & set->mask) * ITPL_BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * @brief Get the address of the cache line a probe for given key will touch.
+ */
+static inline void const* itpl_keyset_line(ItplKeySet const* set, uint64_t key)
+{
+    if (set->dense) {
+        uint64_t const bit = key - set->min;
+        return bit < set->mask ? set->words + bit / 64 : set->words;
+    }
+    return itpl_bloom_block(set, itpl_hash_u64(key));
+}
+
+static inline void itpl_bloom_add(ItplKeySet* set, uint64_t h)
+{
+    uint64_t* const block = itpl_bloom_block(set, h);
+    uint32_t const upper  = (uint32_t)(h >> 32);
+    for (unsigned i = 0; i < ITPL_BLOOM_BLOCK_WORDS; i++) {
+        block[i] |= itpl_bloom_bit(upper, i);
+    }
+}
+
+static inline bool itpl_bloom_has(ItplKeySet const* set, uint64_t h)
+{
+    uint64_t const* const block = itpl_bloom_block(set, h);
+    uint32_t const upper        = (uint32_t)(h >> 32);
+    /* No early exit- the 8 independent tests are cheaper than the branches, and can be vectorized */
+    uint64_t missing = 0;
+    for (unsigned i = 0; i < ITPL_BLOOM_BLOCK_WORDS; i++) {
+        missing |= ~block[i] & itpl_bloom_bit(upper, i);
+    }
+    return missing == 0;
+}
+
+static inline int itpl_keyset_cmp(void const* a, void const* b)
+{
+    uint64_t const x = *(uint64_t const*)a;
+    uint64_t const y = *(uint64_t const*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Build a key set from an array of `len` keys, allocated with `malloc`.
+ *
+ * The set takes ownership of the array- it is either kept for exact checks, or freed.
+ *
+ * @return `false` if memory could not be allocated, in which case the array is freed and the set is left empty.
+ */
+static inline bool itpl_keyset_build(ItplKeySet* set, uint64_t* keys, size_t len, bool exact)
+{
+    *set = (ItplKeySet){0};
+    if (len == 0) {
+        free(keys);
+        set->dense = true;
+        return true;
+    }
+    uint64_t min = keys[0], max = keys[0];
+    for (size_t i = 1; i < len; i++) {
+        min = keys[i] < min ? keys[i] : min;
+        max = keys[i] > max ? keys[i] : max;
+    }
+    uint64_t const budget = (uint64_t)len * ITPLUS_BLOOM_BITS_PER_KEY;
+    if (max - min < budget) {
+        /* A bitmap over the range of the keys is no larger than the bloom filter, and exact */
+        set->words = calloc((max - min) / 64 + 1, sizeof(*set->words));
+        if (set->words == NULL) {
+            free(keys);
+            return false;
+        }
+        set->dense = true;
+        set->min   = min;
+        set->mask  = max - min + 1;
+        for (size_t i = 0; i < len; i++) {
+            uint64_t const bit = keys[i] - min;
+            set->words[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+        free(keys);
+        return true;
+    }
+    size_t nblocks = 1;
+    while (nblocks * ITPL_BLOOM_BLOCK_WORDS * 64 < budget) {
+        nblocks *= 2;
+    }
+    set->words = calloc(nblocks * ITPL_BLOOM_BLOCK_WORDS, sizeof(*set->words));
+    if (set->words == NULL) {
+        free(keys);
+        return false;
+    }
+    set->mask = nblocks - 1;
+    for (size_t i = 0; i < len; i++) {
+        itpl_bloom_add(set, itpl_hash_u64(keys[i]));
+    }
+    if (!exact) {
+        free(keys);
+        return true;
+    }
+    qsort(keys, len, sizeof(*keys), itpl_keyset_cmp);
+    size_t uniq = 1;
+    for (size_t i = 1; i < len; i++) {
+        if (keys[i] != keys[uniq - 1]) {
+            keys[uniq++] = keys[i];
+        }
+    }
+    set->keys = keys;
+    set->len  = uniq;
+    return true;
+}
+
+/**
+ * @brief Check whether a key is present in a key set.
+ *
+ * Sets built without `exact` may return `true` for keys that are not present, at a rate of around 0.1% or less with
+ * the default #ITPLUS_BLOOM_BITS_PER_KEY. Keys that are present are always found.
+ */
+static inline bool itpl_keyset_has(ItplKeySet const* set, uint64_t key)
+{
+    if (set->dense) {
+        uint64_t const bit = key - set->min;
+        return bit < set->mask && (set->words[bit / 64] >> (bit % 64) & 1);
+    }
+    if (!itpl_bloom_has(set, itpl_hash_u64(key))) {
+        return false;
+    }
+    if (set->keys == NULL) {
+        return true;
+    }
+    size_t lo = 0, hi = set->len;
+    while (lo < hi) {
+        size_t const mid = lo + (hi - lo) / 2;
+        if (set->keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < set->len && set->keys[lo] == key;
+}
+
+/**
+ * @brief Free the memory held by a key set.
+ */
+static inline void itpl_keyset_free(ItplKeySet* set)
+{
+    free(set->words);
+    free(set->keys);
+    *set = (ItplKeySet){0};
+}
+
+/**
+ * @def define_semijoin_build_func(T, Name)
+ * @brief Define a function to build an #ItplKeySet from the keys of an iterable's elements.
+ *
+ * The defined function takes in an iterable of type `T`, a pointer to the set to build, a key function of type
+ * `uint64_t (*key)(T x)`, and whether probes should be exact. Exact probes keep a sorted copy of the keys around, but
+ * only if the keys are not dense enough for a bitmap- bitmaps are always exact.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { uint32_t id; double score; } Row;
+ *
+ * // The defined function has the signature:-
+ * // `bool build_rowset(Iterable(Row) it, ItplKeySet* set, uint64_t (*key)(Row x), bool exact)`
+ * define_semijoin_build_func(Row, build_rowset)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t row_id(Row x) { return x.id; }
+ * @endcode
+ *
+ * @code
+ * ItplKeySet ids;
+ * // Build a set of the ids of the rows in `it` (of type `Iterable(Row)`)
+ * if (!build_rowset(it, &ids, row_id, true)) {
+ *     // Out of memory
+ * }
+ * ...
+ * itpl_keyset_free(&ids);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note The function returns `false`, and leaves the set empty, if memory could not be allocated.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_semijoin_build_func(T, Name)                                                                            \
+    bool Name(Iterable(T) it, ItplKeySet* set, uint64_t (*key)(T x), bool exact)                                       \
+    {                                                                                                                  \
+        size_t size    = ITPLUS_SEMIJOIN_BATCH;                                                                        \
+        size_t len     = 0;                                                                                            \
+        uint64_t* keys = malloc(size * sizeof(*keys));                                                                 \
+        *set           = (ItplKeySet){0};                                                                              \
+        if (keys == NULL) {                                                                                            \
+            return false;                                                                                              \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (len == size) {                                                                                         \
+                size *= 2;                                                                                             \
+                uint64_t* const temp = realloc(keys, size * sizeof(*keys));                                            \
+                if (temp == NULL) {                                                                                    \
+                    free(keys);                                                                                        \
+                    return false;                                                                                      \
+                }                                                                                                      \
+                keys = temp;                                                                                           \
+            }                                                                                                          \
+            keys[len++] = key(x);                                                                                      \
+        }                                                                                                              \
+        return itpl_keyset_build(set, keys, len, exact);                                                               \
+    }
+
+/**
+ * @def IterSemiJoin(T)
+ * @brief Convenience macro to get the type of the IterSemiJoin struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int);
+ * IterSemiJoin(int) i; // Declares a variable of type IterSemiJoin(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield. Must be the same type name
+ * passed to #DefineIterSemiJoin(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterSemiJoin(T) ITPL_CONCAT(IterSemiJoin_, T)
+
+/**
+ * @def DefineIterSemiJoin(T)
+ * @brief Define an IterSemiJoin struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `set` - The set of keys to keep elements for.
+ * * `key` - The key function.
+ * * `src` - The source iterable.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int); // Defines an IterSemiJoin(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterSemiJoin(T)                                                                                          \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        ItplKeySet const* set;                                                                                         \
+        uint64_t (*key)(T x);                                                                                          \
+        /* The current batch, and the position of the next element to test in it */                                    \
+        T batch[ITPLUS_SEMIJOIN_BATCH];                                                                                \
+        uint64_t keys[ITPLUS_SEMIJOIN_BATCH];                                                                          \
+        size_t pos;                                                                                                    \
+        size_t len;                                                                                                    \
+        bool exhausted;                                                                                                \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterSemiJoin(T)
+
+/**
+ * @def define_itersemijoin_func(T, Name)
+ * @brief Define a function to turn an #IterSemiJoin(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterSemiJoin(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterSemiJoin(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterSemiJoin(int);
+ *
+ * // Implement `Iterator` for `IterSemiJoin(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intsemijoin(IterSemiJoin(int)* x)`
+ * define_itersemijoin_func(int, wrap_intsemijoin)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Keep the elements of `it` (of type `Iterable(Row)`) whose id is in `ids` (of type `ItplKeySet`)
+ * Iterable(Row) joined = wrap_rowsemijoin(&(IterSemiJoin(Row)){ .set = &ids, .key = row_id, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterSemiJoin` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note Up to #ITPLUS_SEMIJOIN_BATCH elements are extracted from the source ahead of the element being yielded.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterSemiJoin(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersemijoin_func(T, Name)                                                                              \
+    static Maybe(T) ITPL_CONCAT(IterSemiJoin(T), _nxt)(IterSemiJoin(T) * self)                                         \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        while (1) {                                                                                                    \
+            while (self->pos < self->len) {                                                                            \
+                size_t const i = self->pos++;                                                                          \
+                if (itpl_keyset_has(self->set, self->keys[i])) {                                                       \
+                    return Just(self->batch[i], T);                                                                    \
+                }                                                                                                      \
+            }                                                                                                          \
+            if (self->exhausted) {                                                                                     \
+                return Nothing(T);                                                                                     \
+            }                                                                                                          \
+            /* Extract the next batch, and prefetch the lines all of its probes will touch */                          \
+            self->pos = 0;                                                                                             \
+            self->len = 0;                                                                                             \
+            while (self->len < ITPLUS_SEMIJOIN_BATCH) {                                                                \
+                Maybe(T) const res = srcit.tc->next(srcit.self);                                                       \
+                if (is_nothing(res)) {                                                                                 \
+                    self->exhausted = true;                                                                            \
+                    break;                                                                                             \
+                }                                                                                                      \
+                T const x              = from_just_(res);                                                              \
+                self->batch[self->len] = x;                                                                            \
+                self->keys[self->len]  = self->key(x);                                                                 \
+                ITPL_PREFETCH(itpl_keyset_line(self->set, self->keys[self->len]));                                     \
+                ++(self->len);                                                                                         \
+            }                                                                                                          \
+        }                                                                                                              \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterSemiJoin(T)*, T, Name, ITPL_CONCAT(IterSemiJoin(T), _nxt))
+
+/**
+ * @def IterShard(T)
+ * @brief Convenience macro to get the type of the IterShard struct with given element type.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int);
+ * IterShard(int) i; // Declares a variable of type IterShard(int)
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield. Must be the same type name passed
+ * to #DefineIterShard(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterShard(T) ITPL_CONCAT(IterShard_, T)
+
+/**
+ * @def DefineIterShard(T)
+ * @brief Define an IterShard struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int); // Defines an IterShard(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterShard(T)                                                                                             \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t n;                                                                                                      \
+        size_t k;                                                                                                      \
+        size_t i;                                                                                                      \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterShard(T)
+
+/**
+ * @def define_itershard_func(T, Name)
+ * @brief Define a function to turn an #IterShard(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterShard(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterShard(T)*` and wraps it in an `Iterable(T)`. The number of
+ * shards, `n`, must be at least 1, and the shard to yield, `k`, less than `n`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterShard(int);
+ *
+ * // Implement `Iterator` for `IterShard(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intshard(IterShard(int)* x)`
+ * define_itershard_func(int, wrap_intshard)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // The share of worker number 2, out of 4, of `it` (of type `Iterable(int)`)
+ * Iterable(int) mine = wrap_intshard(&(IterShard(int)){.n = 4, .k = 2, .src = it});
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterShard` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterShard(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itershard_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterShard(T), _nxt)(IterShard(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        for (Maybe(T) res = srcit.tc->next(srcit.self); is_just(res); res = srcit.tc->next(srcit.self)) {              \
+            size_t const i = self->i;                                                                                  \
+            self->i        = i + 1 == self->n ? 0 : i + 1;                                                             \
+            if (i == self->k) {                                                                                        \
+                return res;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterShard(T)*, T, Name, ITPL_CONCAT(IterShard(T), _nxt))
+
+#ifndef ITPLUS_HLL_PRECISION
+#define ITPLUS_HLL_PRECISION 12
+#endif /* !ITPLUS_HLL_PRECISION */
+
+#ifndef ITPLUS_QSKETCH_K
+#define ITPLUS_QSKETCH_K 64
+#endif /* !ITPLUS_QSKETCH_K */
+
+#ifndef ITPLUS_QSKETCH_LEVELS
+#define ITPLUS_QSKETCH_LEVELS 32
+#endif /* !ITPLUS_QSKETCH_LEVELS */
+
+/**
+ * @def ITPL_HLL_SERIALIZED_SIZE
+ * @brief The number of bytes a serialized #ItplHll takes.
+ */
+#define ITPL_HLL_SERIALIZED_SIZE (1 + (1 << ITPLUS_HLL_PRECISION))
+
+/* HyperLogLog sketch, must be zero initialized */
+typedef struct
+{
+    uint8_t reg[1 << ITPLUS_HLL_PRECISION];
+} ItplHll;
+
+/* Quantile sketch, must be zero initialized */
+typedef struct
+{
+    double items[ITPLUS_QSKETCH_LEVELS][ITPLUS_QSKETCH_K];
+    uint32_t len[ITPLUS_QSKETCH_LEVELS];
+    /* Total number of values added */
+    uint64_t n;
+    /* Alternates which half of a level is promoted */
+    uint64_t coin;
+} ItplQSketch;
+
+/**
+ * @brief Add an element, given its 64 bit hash, to a HyperLogLog sketch.
+ *
+ * The hash should be of good quality in all bits- e.g run integers through #itpl_hash_u64 (see itplus_hash.h).
+ */
+static inline void itpl_hll_add(ItplHll* hll, uint64_t h)
+{
+    uint8_t const maxrank = 64 - ITPLUS_HLL_PRECISION + 1;
+    uint8_t rank          = 1;
+    uint64_t w            = h << ITPLUS_HLL_PRECISION;
+    while (rank < maxrank && !(w & (UINT64_C(1) << 63))) {
+        w <<= 1;
+        rank++;
+    }
+    size_t const idx = (size_t)(h >> (64 - ITPLUS_HLL_PRECISION));
+    if (hll->reg[idx] < rank) {
+        hll->reg[idx] = rank;
+    }
+}
+
+/**
+ * @brief Estimate the number of distinct elements added to a HyperLogLog sketch.
+ */
+static inline double itpl_hll_count(ItplHll const* hll)
+{
+    double const m = (double)(1 << ITPLUS_HLL_PRECISION);
+    double sum     = 0;
+    size_t zeros   = 0;
+    for (size_t i = 0; i < (1 << ITPLUS_HLL_PRECISION); i++) {
+        sum += ldexp(1.0, -hll->reg[i]);
+        zeros += hll->reg[i] == 0;
+    }
+    double const est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    /* Fall back to linear counting for small cardinalities */
+    return est <= 2.5 * m && zeros > 0 ? m * log(m / (double)zeros) : est;
+}
+
+/**
+ * @brief Merge HyperLogLog sketch `src` into `dst`.
+ *
+ * The result is the same as if every element added to `src` had been added to `dst`.
+ */
+static inline void itpl_hll_merge(ItplHll* dst, ItplHll const* src)
+{
+    /* Simple enough for compilers to vectorize */
+    for (size_t i = 0; i < (1 << ITPLUS_HLL_PRECISION); i++) {
+        dst->reg[i] = dst->reg[i] < src->reg[i] ? src->reg[i] : dst->reg[i];
+    }
+}
+
+/**
+ * @brief Serialize a HyperLogLog sketch into #ITPL_HLL_SERIALIZED_SIZE bytes.
+ */
+static inline void itpl_hll_serialize(ItplHll const* hll, unsigned char* out)
+{
+    out[0] = ITPLUS_HLL_PRECISION;
+    memcpy(out + 1, hll->reg, sizeof(hll->reg));
+}
+
+/**
+ * @brief Deserialize a HyperLogLog sketch from `len` bytes.
+ *
+ * @return `false` if the bytes are not a sketch serialized with the same precision.
+ */
+static inline bool itpl_hll_deserialize(ItplHll* hll, unsigned char const* in, size_t len)
+{
+    if (len != ITPL_HLL_SERIALIZED_SIZE || in[0] != ITPLUS_HLL_PRECISION) {
+        return false;
+    }
+    memcpy(hll->reg, in + 1, sizeof(hll->reg));
+    return true;
+}
+
+static inline void itpl_qsketch_push(ItplQSketch* s, size_t level, double x);
+
+/* Insertion sort, levels are short */
+static inline void itpl_qsketch_sort(double* items, uint32_t len)
+{
+    for (uint32_t i = 1; i < len; i++) {
+        double const x = items[i];
+        uint32_t j     = i;
+        for (; j > 0 && items[j - 1] > x; j--) {
+            items[j] = items[j - 1];
+        }
+        items[j] = x;
+    }
+}
+
+/* Sort a level, and promote every other value (starting at an alternating offset) to the next level */
+static inline void itpl_qsketch_compact(ItplQSketch* s, size_t level)
+{
+    double* const items = s->items[level];
+    uint32_t const len  = s->len[level];
+    itpl_qsketch_sort(items, len);
+    s->len[level] = 0;
+    if (level + 1 == ITPLUS_QSKETCH_LEVELS) {
+        /* Out of levels, halve the top level in place (its weights are no longer exact) */
+        for (uint32_t i = (uint32_t)(s->coin++ & 1); i < len; i += 2) {
+            items[s->len[level]++] = items[i];
+        }
+        return;
+    }
+    for (uint32_t i = (uint32_t)(s->coin++ & 1); i < len; i += 2) {
+        itpl_qsketch_push(s, level + 1, items[i]);
+    }
+}
+
+static inline void itpl_qsketch_push(ItplQSketch* s, size_t level, double x)
+{
+    if (s->len[level] == ITPLUS_QSKETCH_K) {
+        itpl_qsketch_compact(s, level);
+    }
+    s->items[level][s->len[level]++] = x;
+}
+
+/**
+ * @brief Add a value to a quantile sketch.
+ */
+static inline void itpl_qsketch_add(ItplQSketch* s, double x)
+{
+    itpl_qsketch_push(s, 0, x);
+    s->n++;
+}
+
+/**
+ * @brief Merge quantile sketch `src` into `dst`.
+ */
+static inline void itpl_qsketch_merge(ItplQSketch* dst, ItplQSketch const* src)
+{
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < src->len[level]; i++) {
+            itpl_qsketch_push(dst, level, src->items[level][i]);
+        }
+    }
+    dst->n += src->n;
+}
+
+/**
+ * @brief Estimate the value at quantile `q` (from 0 to 1) of the values added to a quantile sketch.
+ *
+ * Returns NaN if the sketch is empty. The sketch is not changed, but its levels are reordered.
+ */
+static inline double itpl_qsketch_quantile(ItplQSketch* s, double q)
+{
+    size_t pos[ITPLUS_QSKETCH_LEVELS] = {0};
+    uint64_t total                    = 0;
+    /* Sort every level, and walk all of them in merged order, accumulating the weights */
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        itpl_qsketch_sort(s->items[level], s->len[level]);
+        total += (uint64_t)s->len[level] << level;
+    }
+    if (total == 0) {
+        return NAN;
+    }
+    double const target = q * (double)total;
+    double res          = NAN;
+    uint64_t seen       = 0;
+    while (1) {
+        size_t minlevel = ITPLUS_QSKETCH_LEVELS;
+        for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+            if (pos[level] == s->len[level]) {
+                continue;
+            }
+            if (minlevel == ITPLUS_QSKETCH_LEVELS || s->items[level][pos[level]] < s->items[minlevel][pos[minlevel]]) {
+                minlevel = level;
+            }
+        }
+        if (minlevel == ITPLUS_QSKETCH_LEVELS) {
+            return res;
+        }
+        res = s->items[minlevel][pos[minlevel]++];
+        seen += UINT64_C(1) << minlevel;
+        if ((double)seen >= target) {
+            return res;
+        }
+    }
+}
+
+/**
+ * @brief Get the number of bytes a quantile sketch serializes into.
+ */
+static inline size_t itpl_qsketch_serialized_size(ItplQSketch const* s)
+{
+    size_t size = 8 + 4 * ITPLUS_QSKETCH_LEVELS;
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        size += 8 * (size_t)s->len[level];
+    }
+    return size;
+}
+
+static inline unsigned char* itpl_sketch_put_u64(unsigned char* out, uint64_t x, int nbytes)
+{
+    for (int i = 0; i < nbytes; i++) {
+        *out++ = (unsigned char)(x >> (8 * i));
+    }
+    return out;
+}
+
+static inline unsigned char const* itpl_sketch_get_u64(unsigned char const* in, uint64_t* x, int nbytes)
+{
+    *x = 0;
+    for (int i = 0; i < nbytes; i++) {
+        *x |= (uint64_t)*in++ << (8 * i);
+    }
+    return in;
+}
+
+/**
+ * @brief Serialize a quantile sketch into #itpl_qsketch_serialized_size bytes.
+ *
+ * The format is little endian- the count of values, followed by the length of every level, followed by the values of
+ * every level as IEEE 754 doubles.
+ */
+static inline void itpl_qsketch_serialize(ItplQSketch const* s, unsigned char* out)
+{
+    out = itpl_sketch_put_u64(out, s->n, 8);
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        out = itpl_sketch_put_u64(out, s->len[level], 4);
+    }
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < s->len[level]; i++) {
+            uint64_t bits;
+            memcpy(&bits, &s->items[level][i], sizeof(bits));
+            out = itpl_sketch_put_u64(out, bits, 8);
+        }
+    }
+}
+
+/**
+ * @brief Deserialize a quantile sketch from `len` bytes.
  *
- * The defined function takes in a value of type `IterDropWhile(T)*` and wraps it in an `Iterable(T)`.
+ * @return `false` if the bytes are not a quantile sketch serialized with the same parameters.
+ */
+static inline bool itpl_qsketch_deserialize(ItplQSketch* s, unsigned char const* in, size_t len)
+{
+    unsigned char const* const end = in + len;
+    uint64_t x                     = 0;
+    if (len < 8 + 4 * ITPLUS_QSKETCH_LEVELS) {
+        return false;
+    }
+    memset(s, 0, sizeof(*s));
+    in   = itpl_sketch_get_u64(in, &x, 8);
+    s->n = x;
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        in = itpl_sketch_get_u64(in, &x, 4);
+        if (x > ITPLUS_QSKETCH_K) {
+            return false;
+        }
+        s->len[level] = (uint32_t)x;
+    }
+    if (itpl_qsketch_serialized_size(s) != len) {
+        return false;
+    }
+    for (size_t level = 0; level < ITPLUS_QSKETCH_LEVELS; level++) {
+        for (uint32_t i = 0; i < s->len[level]; i++) {
+            in = itpl_sketch_get_u64(in, &x, 8);
+            memcpy(&s->items[level][i], &x, sizeof(x));
+        }
+    }
+    return in == end;
+}
+
+/**
+ * @def define_itercountdistinct_func(T, Name)
+ * @brief Define the `count_distinct` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, a HyperLogLog sketch, and a hash function of type
+ * `uint64_t (*hash)(T x)`. It adds every element of the iterable to the sketch, and returns the estimated number of
+ * distinct elements added to the sketch so far.
+ *
+ * This defined function will consume the given iterable.
  *
  * # Example
  *
  * @code
- * DefineIterDropWhile(int);
+ * // The defined function has the signature:-
+ * // `double count_distinct_int(Iterable(int) it, ItplHll* hll, uint64_t (*hash)(int x))`
+ * define_itercountdistinct_func(int, count_distinct_int)
+ * @endcode
  *
- * // Implement `Iterator` for `IterDropWhile(int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrdrpwhl(IterDropWhile(int)* x)`
- * define_iterdropwhile_func(int, wrap_intitrdrpwhl)
+ * Usage of the defined function-
+ *
+ * @code
+ * static uint64_t int_hash(int x) { return itpl_hash_u64((uint64_t)x); }
+ * @endcode
+ *
+ * @code
+ * // Estimate the number of distinct elements in `it` (of type `Iterable(int)`)
+ * ItplHll hll    = { 0 };
+ * double const n = count_distinct_int(it, &hll, int_hash);
+ * @endcode
+ *
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
+ */
+#define define_itercountdistinct_func(T, Name)                                                                         \
+    double Name(Iterable(T) it, ItplHll* hll, uint64_t (*hash)(T x))                                                   \
+    {                                                                                                                  \
+        foreach (T, x, it) {                                                                                           \
+            itpl_hll_add(hll, hash(x));                                                                                \
+        }                                                                                                              \
+        return itpl_hll_count(hll);                                                                                    \
+    }
+
+/**
+ * @def define_iterqsketch_func(T, Name)
+ * @brief Define a function to feed an iterable into a quantile sketch.
+ *
+ * The defined function takes in an iterable of type `T`, a quantile sketch, and a function of type
+ * `double (*val)(T x)`, which gives the value of an element. It adds the value of every element of the iterable to the
+ * sketch. The sketch can then be queried with #itpl_qsketch_quantile.
+ *
+ * This defined function will consume the given iterable.
+ *
+ * # Example
+ *
+ * @code
+ * typedef struct { int id; double latency; } Request;
+ *
+ * // The defined function has the signature:-
+ * // `void sketch_requests(Iterable(Request) it, ItplQSketch* s, double (*val)(Request x))`
+ * define_iterqsketch_func(Request, sketch_requests)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * static bool is_even(int x) { return x % 2 == 0; }
+ * static double req_latency(Request x) { return x.latency; }
  * @endcode
  *
  * @code
- * // Drop (skip) elements from `it` (of type `Iterable(int)`), while they satisfy `is_even`, and create a new iterable
- * Iterable(int) after_evens = wrap_intitrdrpwhl(&(IterDropWhile(int)){ .pred = is_even, .src = it });
+ * // Estimate the 99th percentile latency of the requests in `it` (of type `Iterable(Request)`)
+ * static ItplQSketch s;
+ * sketch_requests(it, &s, req_latency);
+ * double const p99 = itpl_qsketch_quantile(&s, 0.99);
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterDropWhile` will yield.
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
  * @param Name Name to define the function as.
  *
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
- * alphanumerics.
- * @note An #IterDropWhile(T) for the given `T` **must** exist.
- * @note This should not be delimited by a semicolon.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note This should not be delimited with a semicolon.
  */
-#define define_iterdropwhile_func(T, Name)                                                                             \
-    static Maybe(T) ITPL_CONCAT(IterDropWhile(T), _nxt)(IterDropWhile(T) * self)                                       \
+#define define_iterqsketch_func(T, Name)                                                                               \
+    void Name(Iterable(T) it, ItplQSketch* s, double (*val)(T x))                                                      \
     {                                                                                                                  \
-        if (self->done) {                                                                                              \
-            return Nothing(T);                                                                                         \
+        foreach (T, x, it) {                                                                                           \
+            itpl_qsketch_add(s, val(x));                                                                               \
         }                                                                                                              \
-        Iterable(T) const srcit = self->src;                                                                           \
-        foreach (T, x, srcit) {                                                                                        \
-            if (!self->pred(x)) {                                                                                      \
-                self->done = true;                                                                                     \
-                return Just(x, T);                                                                                     \
+    }
+
+/**
+ * @brief A set of bytes.
+ */
+typedef struct
+{
+    uint64_t bits[4];
+} ItplByteSet;
+
+/**
+ * @brief Create the set of the bytes in a NUL terminated string.
+ */
+static inline ItplByteSet itpl_byteset_of(char const* bytes)
+{
+    ItplByteSet set = {{0}};
+    for (; *bytes != '\0'; bytes++) {
+        unsigned char const b = (unsigned char)*bytes;
+        set.bits[b / 64] |= (uint64_t)1 << (b % 64);
+    }
+    return set;
+}
+
+/**
+ * @brief Create the set of ASCII whitespace bytes- space, `\t`, `\n`, `\v`, `\f` and `\r`.
+ */
+static inline ItplByteSet itpl_byteset_whitespace(void) { return itpl_byteset_of(" \t\n\v\f\r"); }
+
+static inline bool itpl_byteset_has(ItplByteSet const* set, unsigned char b)
+{
+    return (set->bits[b / 64] >> (b % 64)) & 1;
+}
+
+/**
+ * @brief A string splitting iterator, yielding `Slice(char)`s.
+ *
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to split.
+ * * `delim`, `delimlen` - The delimiter to split by, if splitting by a single or multi byte delimiter.
+ * * `set` - The set of bytes to split by, if splitting by any byte of a set. Takes precedence over `delim`.
+ * * `skip_empty` - (Optional) Whether to skip empty pieces.
+ *
+ * If there is neither a `set` nor a delimiter, the whole buffer is yielded as one piece.
+ */
+typedef struct
+{
+    char const* buf;
+    size_t len;
+    char const* delim;
+    size_t delimlen;
+    ItplByteSet const* set;
+    bool skip_empty;
+    size_t pos;
+    bool done;
+    ITPL_STATS_MEMBER
+} IterSplit;
+
+/**
+ * @brief Find the end of the piece starting at `self->pos`, and advance `self->pos` past the delimiter that follows it.
+ *
+ * @return The end of the piece. Sets `self->done` if the piece is the last one.
+ */
+static inline size_t itpl_split_piece(IterSplit* self)
+{
+    char const* const buf = self->buf;
+    size_t const start    = self->pos;
+    size_t end            = self->len;
+    size_t skip           = 0;
+    if (self->set != NULL) {
+        end = start;
+        while (end < self->len && !itpl_byteset_has(self->set, (unsigned char)buf[end])) {
+            end++;
+        }
+        skip = 1;
+    } else if (self->delimlen > 0) {
+        char const first = self->delim[0];
+        size_t i         = start;
+        while (self->len - i >= self->delimlen) {
+            char const* const p = memchr(buf + i, first, self->len - i - self->delimlen + 1);
+            if (p == NULL) {
+                break;
+            }
+            i = (size_t)(p - buf);
+            if (memcmp(p + 1, self->delim + 1, self->delimlen - 1) == 0) {
+                end = i;
+                break;
+            }
+            i++;
+        }
+        skip = self->delimlen;
+    }
+    if (end >= self->len) {
+        self->done = true;
+        return self->len;
+    }
+    self->pos = end + skip;
+    return end;
+}
+
+/**
+ * @def define_itersplit_func(Name)
+ * @brief Define a function to turn an #IterSplit into an `Iterable(Slice(char))`.
+ *
+ * Define the `next` function implementation for the #IterSplit struct, and use it to implement the Iterator
+ * typeclass.
+ *
+ * The defined function takes in a value of type `IterSplit*` and wraps it in an `Iterable(Slice(char))`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineSlice(char);
+ * DefineMaybe(Slice(char))
+ * DefineIteratorOf(Slice(char));
+ *
+ * // Implement `Iterator` for `IterSplit`
+ * // The defined function has the signature- `Iterable(Slice(char)) wrap_split(IterSplit* x)`
+ * define_itersplit_func(wrap_split)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * char const csv[] = "a,b,,c";
+ * // Yields "a", "b", "", "c"
+ * Iterable(Slice(char)) fields = wrap_split(&(IterSplit){ .buf = csv, .len = sizeof(csv) - 1, .delim = ",",
+ *     .delimlen = 1 });
+ * @endcode
+ *
+ * @code
+ * // Yields the words of `text` (of type `char const*`)
+ * ItplByteSet const ws = itpl_byteset_whitespace();
+ * Iterable(Slice(char)) words = wrap_split(&(IterSplit){ .buf = text, .len = strlen(text), .set = &ws,
+ *     .skip_empty = true });
+ * @endcode
+ *
+ * @param Name Name to define the function as.
+ *
+ * @note An #Iterator(T) for `T = Slice(char)` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itersplit_func(Name)                                                                                    \
+    static Maybe(Slice(char)) ITPL_CONCAT(Name, _nxt)(IterSplit * self)                                                \
+    {                                                                                                                  \
+        while (!self->done) {                                                                                          \
+            size_t const start = self->pos;                                                                            \
+            size_t const end   = itpl_split_piece(self);                                                               \
+            if (!self->skip_empty || end > start) {                                                                    \
+                return Just(SliceOf(self->buf + start, end - start, char), Slice(char));                               \
             }                                                                                                          \
         }                                                                                                              \
-        return Nothing(T);                                                                                             \
+        return Nothing(Slice(char));                                                                                   \
     }                                                                                                                  \
-    impl_iterator(IterDropWhile(T)*, T, Name, ITPL_CONCAT(IterDropWhile(T), _nxt))
+    impl_instrumented_iterator(IterSplit*, Slice(char), Name, ITPL_CONCAT(Name, _nxt))
 
 /**
- * @def IterEnumr(T, U)
- * @brief Convenience macro to get the type of the IterEnumr struct with given element types.
+ * @def IterTake(T)
+ * @brief Convenience macro to get the type of the IterTake struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterEnumr(int);
- * IterEnumr(int) i; // Declares a variable of type IterEnumr(int)
+ * DefineIterTake(int);
+ * IterTake(int) i; // Declares a variable of type IterTake(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterEnumr` will yield. Must be the same type name
- * passed to #DefineIterEnumr(T).
+ * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name passed to
+ * #DefineIterTake(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterTake(T) ITPL_CONCAT(IterTake, T)
+
+/**
+ * @def DefineIterTake(T)
+ * @brief Define an IterTake struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTake(int); // Defines an IterTake(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
+ */
+#define DefineIterTake(T)                                                                                              \
+    typedef struct                                                                                                     \
+    {                                                                                                                  \
+        size_t i;                                                                                                      \
+        size_t limit;                                                                                                  \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterTake(T)
+
+/**
+ * @def define_itertake_func(T, Name)
+ * @brief Define a function to turn an #IterTake(T) into an #Iterable(T).
+ *
+ * Define the `next` function implementation for the #IterTake(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
+ *
+ * The defined function takes in a value of type `IterTake(T)*` and wraps it in an `Iterable(T)`.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTake(int);
+ *
+ * // Implement `Iterator` for `IterTake(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrtk(IterTake(int)* x)`
+ * define_itertake_func(int, wrap_intitrtk)
+ * @endcode
+ *
+ * Usage of the defined function-
+ *
+ * @code
+ * // Take the first 10 elements from `it` (of type `Iterable(int)`)
+ * Iterable(int) it10 = wrap_intitrtk(&(IterTake(int)){ .limit = 10, .src = it });
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield.
+ * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
  * alphanumerics.
+ * @note An #IterTake(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
  */
-#define IterEnumr(T) ITPL_CONCAT(IterEnumr_, T)
+#define define_itertake_func(T, Name)                                                                                  \
+    static Maybe(T) ITPL_CONCAT(IterTake(T), _nxt)(IterTake(T) * self)                                                 \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        if (self->i < self->limit) {                                                                                   \
+            ++(self->i);                                                                                               \
+            Iterable(T) const srcit = self->src;                                                                       \
+            return srcit.tc->next(srcit.self);                                                                         \
+        }                                                                                                              \
+        return Nothing(T);                                                                                             \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterTake(T)*, T, Name, ITPL_CONCAT(IterTake(T), _nxt))
 
 /**
- * @def DefineIterEnumr(T)
- * @brief Define an IterEnumr struct that works with on `Iterable(T)`s.
+ * @def IterTakeWhile(T)
+ * @brief Convenience macro to get the type of the IterTakeWhile struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterEnumr(int); // Defines an IterEnumr(int) struct
+ * DefineIterTakeWhile(int);
+ * IterTakeWhile(int) i; // Declares a variable of type IterTakeWhile(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterEnumr` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield. Must be the same type name
+ * passed to #DefineIterTakeWhile(T).
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ */
+#define IterTakeWhile(T) ITPL_CONCAT(IterTakeWhile_, T)
+
+/**
+ * @def DefineIterTakeWhile(T)
+ * @brief Define an IterTakeWhile struct that works on `Iterable(T)`s.
+ *
+ * # Example
+ *
+ * @code
+ * DefineIterTakeWhile(int); // Defines an IterTakeWhile(int) struct
+ * @endcode
+ *
+ * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield.
  *
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
- * alphanumerics.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterEnumr(T)                                                                                             \
+#define DefineIterTakeWhile(T)                                                                                         \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        size_t i;                                                                                                      \
+        bool (*pred)(T x);                                                                                             \
+        bool done;                                                                                                     \
         Iterable(T) src;                                                                                               \
-    } IterEnumr(T)
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterTakeWhile(T)
 
 /**
- * @def define_iterenumr_func(T, Name)
- * @brief Define a function to turn an #IterEnumr(T) into an #Iterable(T) where `T = Pair(size_t, T)`.
+ * @def define_itertakewhile_func(T, Name)
+ * @brief Define a function to turn an #IterTakeWhile(T) into an #Iterable(T).
  *
- * Define the `next` function implementation for the #IterEnumr(T) struct, and use it to implement the Iterator
+ * Define the `next` function implementation for the #IterTakeWhile(T) struct, and use it to implement the Iterator
  * typeclass, for given `T`.
  *
- * The defined function takes in a value of type `IterEnumr(T)*` and wraps it in an `Iterable(Pair(size_t, T))`.
+ * The defined function takes in a value of type `IterTakeWhile(T)*` and wraps it in an `Iterable(T)`.
  *
  * # Example
  *
  * @code
- * DefineIterEnumr(int);
+ * DefineIterTakeWhile(int);
  *
- * // Implement `Iterator` for `IterEnumr(int)`
- * // The defined function has the signature- `Iterable(Pair(size_t, int)) wrap_intenumr(IterEnumr(int)* x)`
- * define_iterenumr_func(int, wrap_intenumr)
+ * // Implement `Iterator` for `IterTakeWhile(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_intitrtkwhl(IterTakeWhile(int)* x)`
+ * define_itertakewhile_func(int, wrap_intitrtkwhl)
  * @endcode
  *
  * Usage of the defined function-
  *
+ * * @code
+ * static bool is_even(int x) { return x % 2 == 0; }
+ * @endcode
+ *
  * @code
- * // Enumerate `it` (of type `Iterable(int)`) to create a new iterable
- * Iterable(Pair(size_t, int)) enumerated = wrap_intenumr(&(IterEnumr(int)){ .src = it });
+ * // Take elements from `it` (of type `Iterable(int)`), while they satisfy `is_even`, and create a new iterable
+ * Iterable(int) first_evens = wrap_intitrtkwhl(&(IterTakeWhile(int)){ .pred = is_even, .src = it });
  * @endcode
  *
- * @param T The type of value the first `Iterable` wrapped in this `IterEnumr` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield.
  * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
  * alphanumerics.
- * @note An #IterEnumr(T) for the given `T` **must** exist.
- * @note An #Iterator(T), with `T = Pair(size_t, T)`, for the given `T`.
+ * @note An #IterTakeWhile(T) for the given `T` **must** exist.
  * @note This should not be delimited by a semicolon.
  */
-#define define_iterenumr_func(T, Name)                                                                                 \
-    static Maybe(Pair(size_t, T)) ITPL_CONCAT(IterEnumr(T), _nxt)(IterEnumr(T) * self)                                 \
+#define define_itertakewhile_func(T, Name)                                                                             \
+    static Maybe(T) ITPL_CONCAT(IterTakeWhile(T), _nxt)(IterTakeWhile(T) * self)                                       \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        if (self->done) {                                                                                              \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
         Iterable(T) const srcit = self->src;                                                                           \
         Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
-        return is_just(res) ? Just(PairOf(self->i++, from_just_(res), size_t, T), Pair(size_t, T))                     \
-                            : Nothing(Pair(size_t, T));                                                                \
+        if (is_nothing(res) || !self->pred(from_just_(res))) {                                                         \
+            self->done = true;                                                                                         \
+            return Nothing(T);                                                                                         \
+        }                                                                                                              \
+        return res;                                                                                                    \
     }                                                                                                                  \
-    impl_iterator(IterEnumr(T)*, Pair(size_t, T), Name, ITPL_CONCAT(IterEnumr(T), _nxt))
+    impl_instrumented_iterator(IterTakeWhile(T)*, T, Name, ITPL_CONCAT(IterTakeWhile(T), _nxt))
+
+/* Define a function that sifts `x` down a 4-ary min heap of `n` elements, starting from index `i` */
+#define ITPL_TOPK_SIFT_FUNC(T, FnName)                                                                                 \
+    static void FnName(T* heap, size_t n, size_t i, T x, int (*cmp)(T a, T b))                                         \
+    {                                                                                                                  \
+        while (1) {                                                                                                    \
+            size_t const fstchild = 4 * i + 1;                                                                         \
+            if (fstchild >= n) {                                                                                       \
+                break;                                                                                                 \
+            }                                                                                                          \
+            size_t const lastchild = fstchild + 4 < n ? fstchild + 4 : n;                                              \
+            size_t minchild        = fstchild;                                                                         \
+            for (size_t c = fstchild + 1; c < lastchild; c++) {                                                        \
+                minchild = cmp(heap[c], heap[minchild]) < 0 ? c : minchild;                                            \
+            }                                                                                                          \
+            if (cmp(heap[minchild], x) >= 0) {                                                                         \
+                break;                                                                                                 \
+            }                                                                                                          \
+            heap[i] = heap[minchild];                                                                                  \
+            i       = minchild;                                                                                        \
+        }                                                                                                              \
+        heap[i] = x;                                                                                                   \
+    }
 
 /**
- * @def IterFilt(T)
- * @brief Convenience macro to get the type of the IterFilt struct with given element type.
+ * @def define_itertopk_func(T, Name)
+ * @brief Define the `top_k` function for an iterable.
+ *
+ * The defined function takes in an iterable of type `T`, an output buffer of at least `k` elements, `k`, and a
+ * comparison function of type `int (*cmp)(T a, T b)`. `cmp` must return a negative value if `a` is less than `b`, a
+ * positive value if `a` is greater than `b`, and 0 otherwise - the same contract as `qsort` comparators, but taking
+ * the elements by value.
+ *
+ * The `k` greatest elements of the iterable (or all of them, if there are fewer) are written to the output buffer, in
+ * descending order, and their count is returned. Among equal elements, which ones are kept is unspecified.
+ *
+ * This defined function will consume the given iterable.
  *
  * # Example
  *
  * @code
- * DefineIterFilt(int);
- * IterFilt(int) i; // Declares a variable of type IterFilt(int)
+ * // The defined function has the signature:-
+ * // `size_t top_k_int(Iterable(int) it, int* out, size_t k, int (*cmp)(int a, int b))`
+ * define_itertopk_func(int, top_k_int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield. Must be the same type name passed to
- * #DefineIterFilt(T).
- *
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
- */
-#define IterFilt(T) ITPL_CONCAT(IterFilt_, T)
-
-/**
- * @def DefineIterFilt(T)
- * @brief Define an IterFilt struct that works on `Iterable(T)`s.
+ * Usage of the defined function-
  *
- * # Example
+ * @code
+ * static int cmp_int(int a, int b) { return (a > b) - (a < b); }
+ * @endcode
  *
  * @code
- * DefineIterFilt(int); // Defines an IterFilt(int) struct
+ * // Find the 100 greatest elements in `it` (of type `Iterable(int)`)
+ * int best[100];
+ * size_t const n = top_k_int(it, best, 100, cmp_int);
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield.
+ * @param T The type of value the `Iterable`, for which this is being implemented, yields.
+ * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note An #Iterator(T) for the given `T` **must** also exist.
+ * @note To find the `k` smallest elements instead, flip the comparison function.
+ * @note This should not be delimited with a semicolon.
  */
-#define DefineIterFilt(T)                                                                                              \
-    typedef struct                                                                                                     \
+#define define_itertopk_func(T, Name)                                                                                  \
+    ITPL_TOPK_SIFT_FUNC(T, ITPL_CONCAT(Name, _sift))                                                                   \
+    size_t Name(Iterable(T) it, T* out, size_t k, int (*cmp)(T a, T b))                                                \
     {                                                                                                                  \
-        bool (*pred)(T x);                                                                                             \
-        Iterable(T) src;                                                                                               \
-    } IterFilt(T)
+        size_t n = 0;                                                                                                  \
+        if (k == 0) {                                                                                                  \
+            return 0;                                                                                                  \
+        }                                                                                                              \
+        foreach (T, x, it) {                                                                                           \
+            if (n < k) {                                                                                               \
+                /* Sift up */                                                                                          \
+                size_t i = n++;                                                                                        \
+                while (i > 0 && cmp(x, out[(i - 1) / 4]) < 0) {                                                        \
+                    out[i] = out[(i - 1) / 4];                                                                         \
+                    i      = (i - 1) / 4;                                                                              \
+                }                                                                                                      \
+                out[i] = x;                                                                                            \
+            } else if (cmp(x, out[0]) > 0) {                                                                           \
+                /* Greater than the smallest element kept so far, replace it */                                        \
+                ITPL_CONCAT(Name, _sift)(out, n, 0, x, cmp);                                                           \
+            }                                                                                                          \
+        }                                                                                                              \
+        /* Heapsort - repeatedly move the smallest remaining element to the back */                                    \
+        for (size_t len = n; len > 1; len--) {                                                                         \
+            T const min = out[0];                                                                                      \
+            ITPL_CONCAT(Name, _sift)(out, len - 1, 0, out[len - 1], cmp);                                              \
+            out[len - 1] = min;                                                                                        \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
 
 /**
- * @def define_iterfilt_func(T, Name)
- * @brief Define a function to turn an #IterFilt(T) into an #Iterable(T).
+ * @def define_topk_merge_func(T, Name)
+ * @brief Define a function to merge 2 results of a `top_k` function.
  *
- * Define the `next` function implementation for the #IterFilt(T) struct, and use it to implement the Iterator
- * typeclass, for given `T`.
+ * The defined function takes in 2 arrays sorted in descending order (as produced by `top_k`)- `dst` of length
+ * `dstlen`, and `src` of length `srclen`, along with `k` and a comparison function. The greatest `k` elements of both
+ * arrays are written into `dst`, in descending order, and their count is returned. `dst` must have room for at least
+ * `k` elements.
  *
- * The defined function takes in a value of type `IterFilt(T)*` and wraps it in an `Iterable(T)`.
+ * This is the final step of a partitioned `top_k`- the top `k` of each partition of the input is found separately
+ * (e.g by its own thread), and the results are then merged together.
  *
  * # Example
  *
  * @code
- * DefineIterFilt(int);
- *
- * // Implement `Iterator` for `IterFilt(int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrfilt(IterFilt(int)* x)`
- * define_iterfilt_func(int, wrap_intitrfilt)
+ * // The defined function has the signature:-
+ * // `size_t merge_top_k_int(int* dst, size_t dstlen, int const* src, size_t srclen, size_t k,
+ * //                         int (*cmp)(int a, int b))`
+ * define_topk_merge_func(int, merge_top_k_int)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * static bool is_even(int x) { return x % 2 == 0; }
- * @endcode
- *
- * @code
- * // Filter `it` (of type `Iterable(int)`) by `is_even`
- * Iterable(int) evens = wrap_intitrfilt(&(IterFilt(int)){ .pred = is_even, .src = it });
+ * // Combine the top 100 of 2 partitions, `part1` and `part2` (of type `Iterable(int)`)
+ * int best[100], best2[100];
+ * size_t n        = top_k_int(part1, best, 100, cmp_int);
+ * size_t const n2 = top_k_int(part2, best2, 100, cmp_int);
+ * n               = merge_top_k_int(best, n, best2, n2, 100, cmp_int);
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterFilt` will yield.
+ * @param T The type of the elements being merged.
  * @param Name Name to define the function as.
  *
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
- * alphanumerics.
- * @note An #IterFilt(T) for the given `T` **must** exist.
- * @note This should not be delimited by a semicolon.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note This should not be delimited with a semicolon.
  */
-#define define_iterfilt_func(T, Name)                                                                                  \
-    static Maybe(T) ITPL_CONCAT(IterFilt(T), _nxt)(IterFilt(T) * self)                                                 \
+#define define_topk_merge_func(T, Name)                                                                                \
+    size_t Name(T* dst, size_t dstlen, T const* src, size_t srclen, size_t k, int (*cmp)(T a, T b))                    \
     {                                                                                                                  \
-        Iterable(T) const srcit = self->src;                                                                           \
-        foreach (T, el, srcit) {                                                                                       \
-            if (self->pred(el)) {                                                                                      \
-                return Just(el, T);                                                                                    \
+        /* Find out how many elements of each array make it into the result */                                         \
+        size_t a = 0, b = 0;                                                                                           \
+        while (a + b < k && (a < dstlen || b < srclen)) {                                                              \
+            if (b == srclen || (a < dstlen && cmp(dst[a], src[b]) >= 0)) {                                             \
+                a++;                                                                                                   \
+            } else {                                                                                                   \
+                b++;                                                                                                   \
             }                                                                                                          \
         }                                                                                                              \
-        return Nothing(T);                                                                                             \
-    }                                                                                                                  \
-    impl_iterator(IterFilt(T)*, T, Name, ITPL_CONCAT(IterFilt(T), _nxt))
+        /* Merge from the back, so the elements of `dst` are never overwritten before they're read */                  \
+        size_t const n = a + b;                                                                                        \
+        for (size_t w = n; b > 0; w--) {                                                                               \
+            if (a > 0 && cmp(dst[a - 1], src[b - 1]) < 0) {                                                            \
+                dst[w - 1] = dst[--a];                                                                                 \
+            } else {                                                                                                   \
+                dst[w - 1] = src[--b];                                                                                 \
+            }                                                                                                          \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+#ifndef ITPLUS_TRACE_BATCH
+#define ITPLUS_TRACE_BATCH 1024
+#endif /* !ITPLUS_TRACE_BATCH */
+
+#ifndef ITPLUS_TRACE_CLOCK
+#define ITPLUS_TRACE_CLOCK() itpl_trace_now()
+#endif /* !ITPLUS_TRACE_CLOCK */
 
 /**
- * @def IterFiltMap(ElmntType, FnRetType)
- * @brief Convenience macro to get the type of the IterFiltMap struct with given element type and function raw return
- * type.
+ * @brief Get the current time, in nanoseconds, from an unspecified starting point.
+ */
+static inline uint64_t itpl_trace_now(void)
+{
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0 && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#else
+    /* Processor time, not wall time */
+    return (uint64_t)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+
+/**
+ * @brief A span recorded by an IterTrace.
+ */
+typedef struct
+{
+    char const* name;
+    uint64_t start;
+    uint64_t end;
+    size_t count;
+} ItplTraceEvent;
+
+/**
+ * @brief A buffer of spans, written to by a single thread.
+ *
+ * The members to be filled in by the caller are-
+ * * `events`, `cap` - The storage for the spans.
+ * * `tid` - The id of the thread writing to this buffer, as shown in the exported trace.
+ */
+typedef struct
+{
+    ItplTraceEvent* events;
+    size_t cap;
+    size_t len;
+    uint32_t tid;
+    /* Number of spans that did not fit into the buffer */
+    size_t dropped;
+} ItplTraceBuf;
+
+/**
+ * @brief Record a span into a trace buffer.
+ */
+static inline void itpl_trace_record(ItplTraceBuf* buf, char const* name, uint64_t start, uint64_t end, size_t count)
+{
+    if (buf->len == buf->cap) {
+        ++(buf->dropped);
+        return;
+    }
+    buf->events[buf->len++] = (ItplTraceEvent){.name = name, .start = start, .end = end, .count = count};
+}
+
+static inline void itpl_trace_write_str(FILE* f, char const* s)
+{
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        unsigned char const c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/**
+ * @brief Write the spans of given trace buffers as a Chrome `trace_event` JSON object.
+ *
+ * Timestamps are relative to the earliest span across all buffers.
+ *
+ * @return `false` if writing to the file failed.
+ */
+static inline bool itpl_trace_write_json(FILE* f, ItplTraceBuf const* bufs, size_t nbufs)
+{
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < nbufs; i++) {
+        for (size_t j = 0; j < bufs[i].len; j++) {
+            origin = bufs[i].events[j].start < origin ? bufs[i].events[j].start : origin;
+        }
+    }
+    bool first = true;
+    fputs("{\"traceEvents\":[", f);
+    for (size_t i = 0; i < nbufs; i++) {
+        for (size_t j = 0; j < bufs[i].len; j++) {
+            ItplTraceEvent const* const e = bufs[i].events + j;
+            fputs(first ? "\n" : ",\n", f);
+            first = false;
+            fputs("{\"name\":", f);
+            itpl_trace_write_str(f, e->name);
+            /* Chrome expects microseconds */
+            fprintf(f, ",\"cat\":\"iterplus\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f",
+                (unsigned long)bufs[i].tid, (double)(e->start - origin) / 1000, (double)(e->end - e->start) / 1000);
+            fprintf(f, ",\"args\":{\"count\":%lu}}", (unsigned long)e->count);
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", f);
+    return !ferror(f);
+}
+
+/**
+ * @def IterTrace(T)
+ * @brief Convenience macro to get the type of the IterTrace struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterFiltMap(int, int);
- * IterFiltMap(int, int) i; // Declares a variable of type IterFiltMap(int, int)
+ * DefineIterTrace(int);
+ * IterTrace(int) i; // Declares a variable of type IterTrace(int)
  * @endcode
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name
- * passed to #DefineIterFiltMap(ElmntType, FnRetType).
- * @param FnRetType The type of value the function contained within an `IterFiltMap` struct will return. Must be the
- * same type name passed to #DefineIterFiltMap(ElmntType, FnRetType).
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield. Must be the same type name passed
+ * to #DefineIterTrace(T).
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  */
-#define IterFiltMap(ElmntType, FnRetType) ITPL_CONCAT(ITPL_CONCAT(IterFiltMap_, ElmntType), ITPL_CONCAT(_, FnRetType))
+#define IterTrace(T) ITPL_CONCAT(IterTrace_, T)
 
 /**
- * @def DefineIterFiltMap(ElmntType, FnRetType)
- * @brief Define an IterFiltMap struct that maps a function of type `FnRetType (*)(ElmntType)` over an
- * `Iterable(ElmntType)`.
+ * @def DefineIterTrace(T)
+ * @brief Define an IterTrace struct that works on `Iterable(T)`s.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `name` - The name of the stage, shown in the exported trace. Must outlive the buffer.
+ * * `buf` - The trace buffer to record spans into.
+ * * `batch` - (Optional) The number of elements per span. Defaults to #ITPLUS_TRACE_BATCH.
+ * * `src` - The source iterable.
  *
  * # Example
  *
  * @code
- * DefineIterFiltMap(int, int); // Defines an IterFiltMap(int, int) struct
+ * DefineIterTrace(int); // Defines an IterTrace(int) struct
  * @endcode
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterFiltMap` will yield.
- * @param FnRetType The **raw** type of value the function contained within an `IterFiltMap` struct will return. A
- * #Maybe(T) for given `FnRetType` must exist.
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield.
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics.
- * @note An #Iterator(T) for given `ElmntType`, and `FnRetType` **must** also exist.
- * @note A filter-map function returns a #Maybe(T), where `T` is `FnRetType`, also referred to as the "raw" return type.
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
+ * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterFiltMap(ElmntType, FnRetType)                                                                        \
+#define DefineIterTrace(T)                                                                                             \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        Maybe(FnRetType) (*f)(ElmntType x);                                                                            \
-        Iterable(ElmntType) src;                                                                                       \
-    } IterFiltMap(ElmntType, FnRetType)
+        char const* name;                                                                                              \
+        ItplTraceBuf* buf;                                                                                             \
+        size_t batch;                                                                                                  \
+        /* Start of the current span, and the number of elements yielded in it so far */                               \
+        uint64_t start;                                                                                                \
+        size_t count;                                                                                                  \
+        Iterable(T) src;                                                                                               \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterTrace(T)
 
 /**
- * @def define_iterfiltmap_func(ElmntType, FnRetType, Name)
- * @brief Define a function to turn an #IterFiltMap(ElmntType, FnRetType) into an #Iterable(FnRetType).
+ * @def define_itertrace_func(T, Name)
+ * @brief Define a function to turn an #IterTrace(T) into an #Iterable(T).
  *
- * Define the `next` function implementation for the #IterFiltMap(ElmntType, FnRetType) struct, and use it to implement
- * the Iterator typeclass, for given `ElmntType` and `FnRetType`.
+ * Define the `next` function implementation for the #IterTrace(T) struct, and use it to implement the Iterator
+ * typeclass, for given `T`.
  *
- * The defined function takes in a value of type `IterFiltMap(ElmntType, FnRetType)*` and wraps it in an
- * `Iterable(FnRetType)`.
+ * The defined function takes in a value of type `IterTrace(T)*` and wraps it in an `Iterable(T)`.
  *
  * # Example
  *
  * @code
- * DefineIterFiltMap(int);
+ * DefineIterTrace(int);
  *
- * // Implement `Iterator` for `IterFiltMap(int, int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrfiltmp(IterFiltMap(int, int)* x)`
- * define_iterfiltmap_func(int, int, wrap_intitrfiltmp)
+ * // Implement `Iterator` for `IterTrace(int)`
+ * // The defined function has the signature- `Iterable(int) wrap_inttrace(IterTrace(int)* x)`
+ * define_itertrace_func(int, wrap_inttrace)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * // Filter evens and then increment the even numbers
- * static Maybe(int) is_even_incr(int x) { return x % 2 == 0 ? Just(x + 1, int) : Nothing(int); }
+ * static ItplTraceEvent events[4096];
+ * ItplTraceBuf buf = {.events = events, .cap = 4096, .tid = 1};
+ * // Record a span for every 1024 elements of `it` (of type `Iterable(int)`)
+ * Iterable(int) traced = wrap_inttrace(&(IterTrace(int)){ .name = "parse", .buf = &buf, .src = it });
+ * ...
+ * itpl_trace_write_json(f, &buf, 1);
  * @endcode
  *
- * @code
- * // Filter Map `it` (of type `Iterable(int)`) by `is_even_incr`
- * Iterable(int) incr_evens = wrap_intitrfiltmp(&(IterFiltMap(int, int)){ .f = is_even_incr, .src = it });
- * @endcode
+ * @param T The type of value the `Iterable` wrapped in this `IterTrace` will yield.
+ * @param Name Name to define the function as.
+ *
+ * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
+ * alphanumerics.
+ * @note An #IterTrace(T) for the given `T` **must** exist.
+ * @note This should not be delimited by a semicolon.
+ */
+#define define_itertrace_func(T, Name)                                                                                 \
+    static Maybe(T) ITPL_CONCAT(IterTrace(T), _nxt)(IterTrace(T) * self)                                               \
+    {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        size_t const batch      = self->batch == 0 ? ITPLUS_TRACE_BATCH : self->batch;                                 \
+        if (self->count == 0) {                                                                                        \
+            self->start = ITPLUS_TRACE_CLOCK();                                                                        \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_just(res)) {                                                                                            \
+            ++(self->count);                                                                                           \
+        }                                                                                                              \
+        if (self->count > 0 && (self->count == batch || is_nothing(res))) {                                            \
+            itpl_trace_record(self->buf, self->name, self->start, ITPLUS_TRACE_CLOCK(), self->count);                  \
+            self->count = 0;                                                                                           \
+        }                                                                                                              \
+        return res;                                                                                                    \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterTrace(T)*, T, Name, ITPL_CONCAT(IterTrace(T), _nxt))
+
+/**
+ * @def ITPL_UTF8_REPLACEMENT
+ * @brief The code point invalid sequences are replaced with (U+FFFD).
+ */
+#define ITPL_UTF8_REPLACEMENT 0xFFFDU
+
+/**
+ * @brief What to do on invalid UTF-8.
+ */
+typedef enum
+{
+    /* Replace every maximal invalid subpart with U+FFFD */
+    ITPL_UTF8_REPLACE,
+    /* Stop at the first invalid sequence */
+    ITPL_UTF8_STOP
+} ItplUtf8Mode;
+
+/**
+ * @brief Get the number of leading ASCII bytes in a buffer, checking 8 bytes at a time.
+ */
+static inline size_t itpl_utf8_ascii_run(unsigned char const* s, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) {
+            break;
+        }
+    }
+    while (i < len && s[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Decode the code point at the start of a (non empty) buffer.
+ *
+ * @param s The buffer.
+ * @param len Length of the buffer, must not be 0.
+ * @param cp Where to store the code point.
+ *
+ * @return The number of bytes decoded. If the bytes are not valid UTF-8, this is the length of the maximal invalid
+ * subpart (at least 1), and `*cp` is set to `UINT32_MAX`.
+ */
+static inline size_t itpl_utf8_decode_one(unsigned char const* s, size_t len, uint32_t* cp)
+{
+    unsigned char const b = s[0];
+    size_t n;
+    /* The range of the second byte is narrowed to exclude overlongs, surrogates and values above U+10FFFF */
+    unsigned char lo = 0x80, hi = 0xBF;
+    uint32_t c;
+    if (b < 0x80) {
+        *cp = b;
+        return 1;
+    } else if (b >= 0xC2 && b <= 0xDF) {
+        n = 2;
+        c = b & 0x1F;
+    } else if (b >= 0xE0 && b <= 0xEF) {
+        n  = 3;
+        c  = b & 0x0F;
+        lo = b == 0xE0 ? 0xA0 : 0x80;
+        hi = b == 0xED ? 0x9F : 0xBF;
+    } else if (b >= 0xF0 && b <= 0xF4) {
+        n  = 4;
+        c  = b & 0x07;
+        lo = b == 0xF0 ? 0x90 : 0x80;
+        hi = b == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        *cp = UINT32_MAX;
+        return 1;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if (i == len || s[i] < lo || s[i] > hi) {
+            *cp = UINT32_MAX;
+            return i;
+        }
+        c  = (c << 6) | (s[i] & 0x3F);
+        lo = 0x80;
+        hi = 0xBF;
+    }
+    *cp = c;
+    return n;
+}
+
+/**
+ * @brief Decode a UTF-8 buffer into an array of code points.
+ *
+ * Decoding starts at `*pos`, and continues until the end of the buffer, until `cap` code points have been written, or-
+ * in #ITPL_UTF8_STOP mode- until an invalid sequence. `*pos` is advanced past everything decoded, so it points to the
+ * invalid sequence in the last case, and the function can be called again (with the same `pos`) to continue decoding.
+ *
+ * @param s The buffer.
+ * @param len Length of the buffer.
+ * @param pos Position in the buffer to start decoding from, updated to where decoding stopped.
+ * @param out Where to write the code points.
+ * @param cap Maximum number of code points to write.
+ * @param mode What to do on invalid sequences.
+ * @param invalid Set to `true` if an invalid sequence was encountered, left untouched otherwise.
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterFiltMap` will yield.
- * @param FnRetType The **raw** type of value the function contained within an `IterFiltMap` struct will return.
- * @param Name Name to define the function as.
+ * @return The number of code points written.
+ */
+static inline size_t itpl_utf8_decode(unsigned char const* s, size_t len, size_t* pos, uint32_t* out, size_t cap,
+    ItplUtf8Mode mode, bool* invalid)
+{
+    size_t i = *pos, n = 0;
+    while (i < len && n < cap) {
+        /* Widen a run of ASCII bytes directly */
+        size_t const run = itpl_utf8_ascii_run(s + i, (len - i) < (cap - n) ? (len - i) : (cap - n));
+        for (size_t j = 0; j < run; j++) {
+            out[n + j] = s[i + j];
+        }
+        i += run;
+        n += run;
+        if (i == len || n == cap) {
+            break;
+        }
+        uint32_t cp;
+        size_t const used = itpl_utf8_decode_one(s + i, len - i, &cp);
+        if (cp == UINT32_MAX) {
+            *invalid = true;
+            if (mode == ITPL_UTF8_STOP) {
+                break;
+            }
+            cp = ITPL_UTF8_REPLACEMENT;
+        }
+        out[n++] = cp;
+        i += used;
+    }
+    *pos = i;
+    return n;
+}
+
+/**
+ * @brief A UTF-8 decoding iterator, yielding one code point at a time.
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics..
- * @note An #IterFiltMap(ElmntType, FnRetType) for the given `ElmntType` and `FnRetType` **must** exist.
- * @note A filter-map function returns a #Maybe(T), where `T` is `FnRetType`, also referred to as the "raw" return type.
- * @note This should not be delimited by a semicolon.
+ * The members to be filled in by the caller are-
+ * * `buf`, `len` - The buffer to decode.
+ * * `mode` - (Optional) What to do on invalid sequences. Defaults to replacing them.
+ *
+ * After iteration, `invalid` tells whether any invalid sequence was encountered. In #ITPL_UTF8_STOP mode, `pos` is
+ * the position of the invalid sequence the iteration stopped at.
  */
-#define define_iterfiltmap_func(ElmntType, FnRetType, Name)                                                            \
-    static Maybe(FnRetType)                                                                                            \
-        ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt)(IterFiltMap(ElmntType, FnRetType) * self)                 \
-    {                                                                                                                  \
-        Iterable(ElmntType) const srcit = self->src;                                                                   \
-        foreach (ElmntType, el, srcit) {                                                                               \
-            Maybe(FnRetType) const mapped = self->f(el);                                                               \
-            if (is_just(mapped)) {                                                                                     \
-                return mapped;                                                                                         \
-            }                                                                                                          \
-        }                                                                                                              \
-        return Nothing(FnRetType);                                                                                     \
-    }                                                                                                                  \
-    impl_iterator(                                                                                                     \
-        IterFiltMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterFiltMap(ElmntType, FnRetType), _nxt))
+typedef struct
+{
+    unsigned char const* buf;
+    size_t len;
+    size_t pos;
+    ItplUtf8Mode mode;
+    bool invalid;
+    ITPL_STATS_MEMBER
+} IterUtf8;
 
 /**
- * @def define_iterfold_func(T, Acc, Name)
- * @brief Define the `fold` function for an iterable and an accumulator type.
+ * @def define_iterutf8_func(Name)
+ * @brief Define a function to turn an #IterUtf8 into an `Iterable(uint32_t)`.
  *
- * The defined fold function takes in an iterable of type `T`, a function of type `Acc (*const f)(Acc acc, T x)`, and
- * a starting value of type `Acc`, and folds the iterable to a singular value of type `Acc`, by repeatedly applying `f`
- * onto it.
+ * Define the `next` function implementation for the #IterUtf8 struct, and use it to implement the Iterator
+ * typeclass.
  *
- * This defined function will consume the given iterable.
+ * The defined function takes in a value of type `IterUtf8*` and wraps it in an `Iterable(uint32_t)`.
  *
  * # Example
  *
  * @code
- * typedef struct boxint { int x; } BoxInt;
- *
- * // The defined function has the signature:-
- * // `BoxInt int_boxint_fold(Iterable(int), BoxInt init, BoxInt (*f)(BoxInt acc, int x))`
- * define_iterfold_func(int, boxint, int_boxint_fold)
+ * // Implement `Iterator` for `IterUtf8`
+ * // The defined function has the signature- `Iterable(uint32_t) wrap_utf8(IterUtf8* x)`
+ * define_iterutf8_func(wrap_utf8)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * // Add 2 ints within 2 BoxInts
- * static BoxInt boxed_add(BoxInt a, BoxInt b) { return (BoxInt){ .x = a.x + b.x }; }
- * @endcode
- *
- * @code
- * // Fold `it` with `boxed_add`
- * BoxInt boxed_sum = int_boxint_fold(it, (BoxInt){0}, boxed_add);
+ * char const text[] = "na\xC3\xAFve";
+ * IterUtf8 u        = {.buf = (unsigned char const*)text, .len = sizeof(text) - 1};
+ * // Yields 'n', 'a', U+00EF, 'v', 'e'
+ * Iterable(uint32_t) cps = wrap_utf8(&u);
  * @endcode
  *
- * @param T The type of value the `Iterable`, for which this is being implemented, yields.
- * @param Acc The accumulator type the fold function being defined should work on.
  * @param Name Name to define the function as.
  *
- * @note If `T` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
- * alphanumerics.
- * @note An #Iterator(T) for the given `T` **must** also exist.
- * @note This should not be delimited with a semicolon.
+ * @note An #Iterator(T) for `T = uint32_t` **must** exist.
+ * @note This should not be delimited by a semicolon.
  */
-#define define_iterfold_func(T, Acc, Name)                                                                             \
-    Acc Name(Iterable(T) it, Acc init, Acc (*f)(Acc acc, T x))                                                         \
+#define define_iterutf8_func(Name)                                                                                     \
+    static Maybe(uint32_t) ITPL_CONCAT(Name, _nxt)(IterUtf8 * self)                                                    \
     {                                                                                                                  \
-        Acc acc = init;                                                                                                \
-        foreach (T, x, it) {                                                                                           \
-            acc = f(acc, x);                                                                                           \
+        if (self->pos == self->len) {                                                                                  \
+            return Nothing(uint32_t);                                                                                  \
         }                                                                                                              \
-        return acc;                                                                                                    \
-    }
+        unsigned char const b = self->buf[self->pos];                                                                  \
+        if (b < 0x80) {                                                                                                \
+            ++(self->pos);                                                                                             \
+            return Just((uint32_t)b, uint32_t);                                                                        \
+        }                                                                                                              \
+        uint32_t cp;                                                                                                   \
+        size_t const used = itpl_utf8_decode_one(self->buf + self->pos, self->len - self->pos, &cp);                   \
+        if (cp == UINT32_MAX) {                                                                                        \
+            self->invalid = true;                                                                                      \
+            if (self->mode == ITPL_UTF8_STOP) {                                                                        \
+                return Nothing(uint32_t);                                                                              \
+            }                                                                                                          \
+            cp = ITPL_UTF8_REPLACEMENT;                                                                                \
+        }                                                                                                              \
+        self->pos += used;                                                                                             \
+        return Just(cp, uint32_t);                                                                                     \
+    }                                                                                                                  \
+    impl_instrumented_iterator(IterUtf8*, uint32_t, Name, ITPL_CONCAT(Name, _nxt))
 
 /**
- * @def IterMap(ElmntType, FnRetType)
- * @brief Convenience macro to get the type of the IterMap struct with given element type and function return type.
+ * @def IterWindowAgg(ElmntType, Acc)
+ * @brief Convenience macro to get the type of the IterWindowAgg struct with given element type and accumulator type.
  *
  * # Example
  *
  * @code
- * DefineIterMap(int, int);
- * IterMap(int, int) i; // Declares a variable of type IterMap(int, int)
+ * DefineIterWindowAgg(int, long);
+ * IterWindowAgg(int, long) i; // Declares a variable of type IterWindowAgg(int, long)
  * @endcode
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name
- * passed to #DefineIterMap(ElmntType, FnRetType).
- * @param FnRetType The type of value the function contained within an `IterMap` struct will return. Must be the same
- * type name passed to #DefineIterMap(ElmntType, FnRetType).
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield. Must be the same type
+ * name passed to #DefineIterWindowAgg(ElmntType, Acc).
+ * @param Acc The accumulator type of the aggregation. Must be the same type name passed to
+ * #DefineIterWindowAgg(ElmntType, Acc).
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics.
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
  */
-#define IterMap(ElmntType, FnRetType) ITPL_CONCAT(ITPL_CONCAT(IterMap_, ElmntType), ITPL_CONCAT(_, FnRetType))
+#define IterWindowAgg(ElmntType, Acc) ITPL_CONCAT(ITPL_CONCAT(IterWindowAgg_, ElmntType), ITPL_CONCAT(_, Acc))
 
 /**
- * @def DefineIterMap(ElmntType, FnRetType)
- * @brief Define an IterMap struct that maps a function of type `FnRetType (*)(ElmntType)` over an
- * `Iterable(ElmntType)`.
+ * @def DefineIterWindowAgg(ElmntType, Acc)
+ * @brief Define an IterWindowAgg struct that aggregates windows of an `Iterable(ElmntType)` into `Acc` values.
+ *
+ * The struct members to be filled in by the caller are-
+ * * `size` - The window size.
+ * * `init` - The identity value of the aggregation (e.g `0` for sum, the largest value for min).
+ * * `f` - The accumulating function, same as the one used with `fold`.
+ * * `inv` - The inverse of `f`, removes an element's contribution from an accumulator. May be `NULL`.
+ * * `merge` - Combines 2 accumulators, `merge(a, b)` must be the aggregate of `a`'s elements followed by `b`'s. Only
+ *   required if `inv` is `NULL`.
+ * * `buf` - Ring buffer of at least `size` elements.
+ * * `aggs` - Buffer of at least `size` accumulators. Only required if `inv` is `NULL`.
+ * * `src` - The source iterable.
  *
  * # Example
  *
  * @code
- * DefineIterMap(int, int); // Defines an IterMap(int, int) struct
+ * DefineIterWindowAgg(int, long); // Defines an IterWindowAgg(int, long) struct
  * @endcode
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterMap` will yield.
- * @param FnRetType The type of value the function contained within an `IterMap` struct will return.
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield.
+ * @param Acc The accumulator type of the aggregation.
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics.
- * @note An #Iterator(T) for given `ElmntType`, and `FnRetType` **must** also exist.
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
+ * @note An #Iterator(T) for given `ElmntType`, and `Acc` **must** also exist.
  */
-#define DefineIterMap(ElmntType, FnRetType)                                                                            \
+#define DefineIterWindowAgg(ElmntType, Acc)                                                                            \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        FnRetType (*f)(ElmntType x);                                                                                   \
+        size_t size;                                                                                                   \
+        Acc init;                                                                                                      \
+        Acc (*f)(Acc acc, ElmntType x);                                                                                \
+        Acc (*inv)(Acc acc, ElmntType x);                                                                              \
+        Acc (*merge)(Acc a, Acc b);                                                                                    \
+        ElmntType* buf;                                                                                                \
+        Acc* aggs;                                                                                                     \
+        size_t filled;                                                                                                 \
+        size_t head;                                                                                                   \
+        /* Number of elements in the front stack (two stack method only) */                                            \
+        size_t flen;                                                                                                   \
+        /* The running aggregate (or the aggregate of the back stack) */                                               \
+        Acc acc;                                                                                                       \
         Iterable(ElmntType) src;                                                                                       \
-    } IterMap(ElmntType, FnRetType)
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterWindowAgg(ElmntType, Acc)
 
 /**
- * @def define_itermap_func(ElmntType, FnRetType, Name)
- * @brief Define a function to turn an #IterMap(ElmntType, FnRetType) into an #Iterable(FnRetType).
+ * @def define_iterwindowagg_func(ElmntType, Acc, Name)
+ * @brief Define a function to turn an #IterWindowAgg(ElmntType, Acc) into an #Iterable(Acc).
  *
- * Define the `next` function implementation for the #IterMap(ElmntType, FnRetType) struct, and use it to implement the
- * Iterator typeclass, for given `ElmntType` and `FnRetType`.
+ * Define the `next` function implementation for the #IterWindowAgg(ElmntType, Acc) struct, and use it to implement
+ * the Iterator typeclass, for given `ElmntType` and `Acc`.
  *
- * The defined function takes in a value of type `IterMap(ElmntType, FnRetType)*` and wraps it in an
- * `Iterable(FnRetType)`.
+ * The defined function takes in a value of type `IterWindowAgg(ElmntType, Acc)*` and wraps it in an `Iterable(Acc)`.
  *
  * # Example
  *
  * @code
- * DefineIterMap(int);
+ * DefineIterWindowAgg(int, long);
  *
- * // Implement `Iterator` for `IterMap(int, int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrmp(IterMap(int, int)* x)`
- * define_itermap_func(int, int, wrap_intitrmp)
+ * // Implement `Iterator` for `IterWindowAgg(int, long)`
+ * // The defined function has the signature- `Iterable(long) wrap_intlongwagg(IterWindowAgg(int, long)* x)`
+ * define_iterwindowagg_func(int, long, wrap_intlongwagg)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * // Decrement an int
- * static int decr(int a) { return a - 1; }
+ * static long add(long acc, int x) { return acc + x; }
+ * static long sub(long acc, int x) { return acc - x; }
+ * static long max(long acc, int x) { return x > acc ? x : acc; }
+ * static long max2(long a, long b) { return a > b ? a : b; }
  * @endcode
  *
  * @code
- * // Map `decr` over `it` (of type `Iterable(int)`)
- * Iterable(int) decr_it = wrap_intitrmp(&(IterMap(int, int)){ .f = decr, .src = it });
+ * int ring[16];
+ * long aggs[16];
+ * // Rolling sum over windows of 16 elements in `it` (of type `Iterable(int)`)
+ * Iterable(long) sums = wrap_intlongwagg(&(IterWindowAgg(int, long)){
+ *     .size = 16, .init = 0, .f = add, .inv = sub, .buf = ring, .src = it });
+ * // Rolling max over windows of 16 elements in `it` (of type `Iterable(int)`)
+ * Iterable(long) maxs = wrap_intlongwagg(&(IterWindowAgg(int, long)){
+ *     .size = 16, .init = LONG_MIN, .f = max, .merge = max2, .buf = ring, .aggs = aggs, .src = it });
  * @endcode
  *
- * @param ElmntType The type of value the `Iterable` wrapped in this `IterMap` will yield.
- * @param FnRetType The type of value the function contained within an `IterMap` struct will return.
+ * @param ElmntType The type of value the `Iterable` wrapped in this `IterWindowAgg` will yield.
+ * @param Acc The accumulator type of the aggregation.
  * @param Name Name to define the function as.
  *
- * @note If `ElmntType` (or `FnRetType`) is a pointer, it needs to be typedef-ed into a type that does not contain the
- * `*`. Only alphanumerics..
- * @note An #IterMap(ElmntType, FnRetType) for the given `ElmntType` and `FnRetType` **must** exist.
+ * @note If `ElmntType` (or `Acc`) is a pointer, it needs to be typedef-ed into a type that does not contain the `*`.
+ * Only alphanumerics.
+ * @note An #IterWindowAgg(ElmntType, Acc) for the given `ElmntType` and `Acc` **must** exist.
  * @note This should not be delimited by a semicolon.
  */
-#define define_itermap_func(ElmntType, FnRetType, Name)                                                                \
-    static Maybe(FnRetType) ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt)(IterMap(ElmntType, FnRetType) * self)     \
+#define define_iterwindowagg_func(ElmntType, Acc, Name)                                                                \
+    static Maybe(Acc) ITPL_CONCAT(IterWindowAgg(ElmntType, Acc), _nxt)(IterWindowAgg(ElmntType, Acc) * self)           \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
         Iterable(ElmntType) const srcit = self->src;                                                                   \
-        Maybe(ElmntType) const res      = srcit.tc->next(srcit.self);                                                  \
-        return fmap_maybe(res, self->f, FnRetType);                                                                    \
-    }                                                                                                                  \
-    impl_iterator(IterMap(ElmntType, FnRetType)*, FnRetType, Name, ITPL_CONCAT(IterMap(ElmntType, FnRetType), _nxt))
-
-/**
- * @def define_iterreduce_func(T, Name)
- * @brief Define the `reduce` function for an iterable.
- *
- * The defined reduce function takes in an iterable of type `T`, and a function of type `T (*const f)(T acc, T x)`, and
- * reduces the iterable to a singular value of type `T`, by repeatedly applying `f` onto it.
- *
- * If the given iterable was empty, `Nothing` is returned. Otherwise, a `Just` value is returned.
- *
- * This defined function will consume the given iterable.
- *
- * # Example
- *
- * @code
- * // The defined function has the signature:-
- * // `Maybe(int) int_reduce(Iterable(int), int (*f)(int acc, int x))`
- * define_iterreduce_func(int, int_reduce)
- * @endcode
- *
- * Usage of the defined function-
- *
- * @code
- * // Add 2 ints
- * static int add(int a, int b) { return a + b; }
- * @endcode
- *
- * @code
- * // Reduce `it` (of type `Iterable(int)`) with `add`
- * Maybe(int) maybe_sum = int_reduce(it, add);
- * @endcode
- *
- * @param T The type of value the `Iterable`, for which this is being implemented, yields.
- * @param Name Name to define the function as.
- *
- * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
- * @note An #Iterator(T) for the given `T` **must** also exist.
- * @note This should not be delimited with a semicolon.
- */
-#define define_iterreduce_func(T, Name)                                                                                \
-    Maybe(T) Name(Iterable(T) it, T (*f)(T acc, T x))                                                                  \
-    {                                                                                                                  \
-        Maybe(T) const res = it.tc->next(it.self);                                                                     \
+        if (self->size == 0) {                                                                                         \
+            return Nothing(Acc);                                                                                       \
+        }                                                                                                              \
+        if (self->filled < self->size) {                                                                               \
+            if (self->filled == 0) {                                                                                   \
+                self->acc = self->init;                                                                                \
+            }                                                                                                          \
+            while (self->filled < self->size) {                                                                        \
+                Maybe(ElmntType) const res = srcit.tc->next(srcit.self);                                               \
+                if (is_nothing(res)) {                                                                                 \
+                    return Nothing(Acc);                                                                               \
+                }                                                                                                      \
+                self->buf[self->filled++] = from_just_(res);                                                           \
+                self->acc                 = self->f(self->acc, from_just_(res));                                       \
+            }                                                                                                          \
+            return Just(self->acc, Acc);                                                                               \
+        }                                                                                                              \
+        Maybe(ElmntType) const res = srcit.tc->next(srcit.self);                                                       \
         if (is_nothing(res)) {                                                                                         \
-            return Nothing(T);                                                                                         \
+            return Nothing(Acc);                                                                                       \
         }                                                                                                              \
-        T acc = from_just_(res);                                                                                       \
-        foreach (T, x, it) {                                                                                           \
-            acc = f(acc, x);                                                                                           \
+        size_t const oldest = self->head;                                                                              \
+        self->head          = self->head + 1 == self->size ? 0 : self->head + 1;                                       \
+        if (self->inv != NULL) {                                                                                       \
+            self->acc         = self->f(self->inv(self->acc, self->buf[oldest]), from_just_(res));                     \
+            self->buf[oldest] = from_just_(res);                                                                       \
+            return Just(self->acc, Acc);                                                                               \
         }                                                                                                              \
-        return Just(acc, T);                                                                                           \
-    }
+        if (self->flen == 0) {                                                                                         \
+            /* Front stack ran out - move the whole window over, storing the aggregate of every suffix */              \
+            size_t pos      = oldest == 0 ? self->size - 1 : oldest - 1;                                               \
+            self->aggs[pos] = self->f(self->init, self->buf[pos]);                                                     \
+            for (size_t i = 1; i < self->size; i++) {                                                                  \
+                size_t const nxtpos = pos;                                                                             \
+                pos                 = pos == 0 ? self->size - 1 : pos - 1;                                             \
+                self->aggs[pos]     = self->merge(self->f(self->init, self->buf[pos]), self->aggs[nxtpos]);            \
+            }                                                                                                          \
+            self->flen = self->size;                                                                                   \
+            self->acc  = self->init;                                                                                   \
+        }                                                                                                              \
+        /* Pop the oldest element off the front stack, push the new one onto the back stack */                         \
+        --(self->flen);                                                                                                \
+        self->buf[oldest] = from_just_(res);                                                                           \
+        self->acc         = self->f(self->acc, from_just_(res));                                                       \
+        return Just(self->flen == 0 ? self->acc : self->merge(self->aggs[self->head], self->acc), Acc);                \
+    }                                                                                                                  \
+    impl_instrumented_iterator(                                                                                        \
+        IterWindowAgg(ElmntType, Acc)*, Acc, Name, ITPL_CONCAT(IterWindowAgg(ElmntType, Acc), _nxt))
 
 /**
- * @def IterTake(T)
- * @brief Convenience macro to get the type of the IterTake struct with given element type.
+ * @def IterWindows(T)
+ * @brief Convenience macro to get the type of the IterWindows struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterTake(int);
- * IterTake(int) i; // Declares a variable of type IterTake(int)
+ * DefineIterWindows(int);
+ * IterWindows(int) i; // Declares a variable of type IterWindows(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield. Must be the same type name passed to
- * #DefineIterTake(T).
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield. Must be the same type name passed
+ * to #DefineIterWindows(T).
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  */
-#define IterTake(T) ITPL_CONCAT(IterTake, T)
+#define IterWindows(T) ITPL_CONCAT(IterWindows_, T)
 
 /**
- * @def DefineIterTake(T)
- * @brief Define an IterTake struct that works on `Iterable(T)`s.
+ * @def DefineIterWindows(T)
+ * @brief Define an IterWindows struct that works on `Iterable(T)`s.
  *
  * # Example
  *
  * @code
- * DefineIterTake(int); // Defines an IterTake(int) struct
+ * DefineIterWindows(int); // Defines an IterWindows(int) struct
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterTake(T)                                                                                              \
+#define DefineIterWindows(T)                                                                                           \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        size_t i;                                                                                                      \
-        size_t limit;                                                                                                  \
+        size_t size;                                                                                                   \
+        /* Ring buffer of at least `2 * size` elements */                                                              \
+        T* buf;                                                                                                        \
+        size_t filled;                                                                                                 \
+        size_t head;                                                                                                   \
         Iterable(T) src;                                                                                               \
-    } IterTake(T)
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterWindows(T)
 
 /**
- * @def define_itertake_func(T, Name)
- * @brief Define a function to turn an #IterTake(T) into an #Iterable(T).
+ * @def define_iterwindows_func(T, Name)
+ * @brief Define a function to turn an #IterWindows(T) into an #Iterable(T) where `T = Slice(T)`.
  *
- * Define the `next` function implementation for the #IterTake(T) struct, and use it to implement the Iterator
+ * Define the `next` function implementation for the #IterWindows(T) struct, and use it to implement the Iterator
  * typeclass, for given `T`.
  *
- * The defined function takes in a value of type `IterTake(T)*` and wraps it in an `Iterable(T)`.
+ * The defined function takes in a value of type `IterWindows(T)*` and wraps it in an `Iterable(Slice(T))`.
  *
  * # Example
  *
  * @code
- * DefineIterTake(int);
+ * DefineIterWindows(int);
  *
- * // Implement `Iterator` for `IterTake(int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrtk(IterTake(int)* x)`
- * define_itertake_func(int, wrap_intitrtk)
+ * // Implement `Iterator` for `IterWindows(int)`
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intwindows(IterWindows(int)* x)`
+ * define_iterwindows_func(int, wrap_intwindows)
  * @endcode
  *
  * Usage of the defined function-
  *
  * @code
- * // Take the first 10 elements from `it` (of type `Iterable(int)`)
- * Iterable(int) it10 = wrap_intitrtk(&(IterTake(int)){ .limit = 10, .src = it });
+ * // View every window of 8 consecutive elements in `it` (of type `Iterable(int)`)
+ * int ring[2 * 8];
+ * Iterable(Slice(int)) wins = wrap_intwindows(&(IterWindows(int)){ .size = 8, .buf = ring, .src = it });
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTake` will yield.
+ * @param T The type of value the `Iterable` wrapped in this `IterWindows` will yield.
  * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
  * alphanumerics.
- * @note An #IterTake(T) for the given `T` **must** exist.
+ * @note An #IterWindows(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
+ * @note A yielded slice points into `buf` and is only valid until the next element is extracted.
  * @note This should not be delimited by a semicolon.
  */
-#define define_itertake_func(T, Name)                                                                                  \
-    static Maybe(T) ITPL_CONCAT(IterTake(T), _nxt)(IterTake(T) * self)                                                 \
+#define define_iterwindows_func(T, Name)                                                                               \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterWindows(T), _nxt)(IterWindows(T) * self)                                    \
     {                                                                                                                  \
-        if (self->i < self->limit) {                                                                                   \
-            ++(self->i);                                                                                               \
-            Iterable(T) const srcit = self->src;                                                                       \
-            return srcit.tc->next(srcit.self);                                                                         \
+        ITPL_STATS_SRC(self, 0, self->src);                                                                            \
+        Iterable(T) const srcit = self->src;                                                                           \
+        if (self->size == 0) {                                                                                         \
+            return Nothing(Slice(T));                                                                                  \
         }                                                                                                              \
-        return Nothing(T);                                                                                             \
+        while (self->filled < self->size) {                                                                            \
+            Maybe(T) const res = srcit.tc->next(srcit.self);                                                           \
+            if (is_nothing(res)) {                                                                                     \
+                return Nothing(Slice(T));                                                                              \
+            }                                                                                                          \
+            self->buf[self->filled] = self->buf[self->filled + self->size] = from_just_(res);                          \
+            ++(self->filled);                                                                                          \
+            if (self->filled == self->size) {                                                                          \
+                return Just(SliceOf(self->buf, self->size, T), Slice(T));                                              \
+            }                                                                                                          \
+        }                                                                                                              \
+        Maybe(T) const res = srcit.tc->next(srcit.self);                                                               \
+        if (is_nothing(res)) {                                                                                         \
+            return Nothing(Slice(T));                                                                                  \
+        }                                                                                                              \
+        /* Overwrite the oldest element, the window now starts right after it */                                       \
+        self->buf[self->head] = self->buf[self->head + self->size] = from_just_(res);                                  \
+        self->head = self->head + 1 == self->size ? 0 : self->head + 1;                                                \
+        return Just(SliceOf(self->buf + self->head, self->size, T), Slice(T));                                         \
     }                                                                                                                  \
-    impl_iterator(IterTake(T)*, T, Name, ITPL_CONCAT(IterTake(T), _nxt))
+    impl_instrumented_iterator(IterWindows(T)*, Slice(T), Name, ITPL_CONCAT(IterWindows(T), _nxt))
 
 /**
- * @def IterTakeWhile(T)
- * @brief Convenience macro to get the type of the IterTakeWhile struct with given element type.
+ * @def IterArrWindows(T)
+ * @brief Convenience macro to get the type of the IterArrWindows struct with given element type.
  *
  * # Example
  *
  * @code
- * DefineIterTakeWhile(int);
- * IterTakeWhile(int) i; // Declares a variable of type IterTakeWhile(int)
+ * DefineIterArrWindows(int);
+ * IterArrWindows(int) i; // Declares a variable of type IterArrWindows(int)
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield. Must be the same type name
- * passed to #DefineIterTakeWhile(T).
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`. Must be the same type name passed
+ * to #DefineIterArrWindows(T).
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
  */
-#define IterTakeWhile(T) ITPL_CONCAT(IterTakeWhile_, T)
+#define IterArrWindows(T) ITPL_CONCAT(IterArrWindows_, T)
 
 /**
- * @def DefineIterTakeWhile(T)
- * @brief Define an IterTakeWhile struct that works on `Iterable(T)`s.
+ * @def DefineIterArrWindows(T)
+ * @brief Define an IterArrWindows struct that works on arrays of `T`.
  *
  * # Example
  *
  * @code
- * DefineIterTakeWhile(int); // Defines an IterTakeWhile(int) struct
+ * DefineIterArrWindows(int); // Defines an IterArrWindows(int) struct
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield.
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only alphanumerics.
- * @note An #Iterator(T) for the given `T` **must** also exist.
  */
-#define DefineIterTakeWhile(T)                                                                                         \
+#define DefineIterArrWindows(T)                                                                                        \
     typedef struct                                                                                                     \
     {                                                                                                                  \
-        bool (*pred)(T x);                                                                                             \
-        bool done;                                                                                                     \
-        Iterable(T) src;                                                                                               \
-    } IterTakeWhile(T)
+        size_t i;                                                                                                      \
+        size_t size;                                                                                                   \
+        size_t len;                                                                                                    \
+        T const* arr;                                                                                                  \
+        ITPL_STATS_MEMBER                                                                                              \
+    } IterArrWindows(T)
 
 /**
- * @def define_itertakewhile_func(T, Name)
- * @brief Define a function to turn an #IterTakeWhile(T) into an #Iterable(T).
- *
- * Define the `next` function implementation for the #IterTakeWhile(T) struct, and use it to implement the Iterator
- * typeclass, for given `T`.
+ * @def define_iterarrwindows_func(T, Name)
+ * @brief Define a function to turn an #IterArrWindows(T) into an #Iterable(T) where `T = Slice(T)`.
  *
- * The defined function takes in a value of type `IterTakeWhile(T)*` and wraps it in an `Iterable(T)`.
+ * The defined function takes in a value of type `IterArrWindows(T)*` and wraps it in an `Iterable(Slice(T))`. Each
+ * yielded slice points directly into the source array.
  *
  * # Example
  *
  * @code
- * DefineIterTakeWhile(int);
+ * DefineIterArrWindows(int);
  *
- * // Implement `Iterator` for `IterTakeWhile(int)`
- * // The defined function has the signature- `Iterable(int) wrap_intitrtkwhl(IterTakeWhile(int)* x)`
- * define_itertakewhile_func(int, wrap_intitrtkwhl)
+ * // The defined function has the signature- `Iterable(Slice(int)) wrap_intarrwindows(IterArrWindows(int)* x)`
+ * define_iterarrwindows_func(int, wrap_intarrwindows)
  * @endcode
  *
  * Usage of the defined function-
  *
- * * @code
- * static bool is_even(int x) { return x % 2 == 0; }
- * @endcode
- *
  * @code
- * // Take elements from `it` (of type `Iterable(int)`), while they satisfy `is_even`, and create a new iterable
- * Iterable(int) first_evens = wrap_intitrtkwhl(&(IterTakeWhile(int)){ .pred = is_even, .src = it });
+ * // View every window of 8 consecutive elements in `arr` (an array of `arrlen` ints)
+ * Iterable(Slice(int)) wins = wrap_intarrwindows(&(IterArrWindows(int)){ .size = 8, .len = arrlen, .arr = arr });
  * @endcode
  *
- * @param T The type of value the `Iterable` wrapped in this `IterTakeWhile` will yield.
+ * @param T The type of the elements in the array wrapped in this `IterArrWindows`.
  * @param Name Name to define the function as.
  *
  * @note If `T` is a pointer, it needs to be typedef-ed into a type that does not contain the `*`. Only
  * alphanumerics.
- * @note An #IterTakeWhile(T) for the given `T` **must** exist.
+ * @note An #IterArrWindows(T) for the given `T` **must** exist.
+ * @note An #Iterator(T), with `T = Slice(T)`, for the given `T` must exist.
  * @note This should not be delimited by a semicolon.
  */
-#define define_itertakewhile_func(T, Name)                                                                             \
-    static Maybe(T) ITPL_CONCAT(IterTakeWhile(T), _nxt)(IterTakeWhile(T) * self)                                       \
+#define define_iterarrwindows_func(T, Name)                                                                            \
+    static Maybe(Slice(T)) ITPL_CONCAT(IterArrWindows(T), _nxt)(IterArrWindows(T) * self)                              \
     {                                                                                                                  \
-        if (self->done) {                                                                                              \
-            return Nothing(T);                                                                                         \
-        }                                                                                                              \
-        Iterable(T) const srcit = self->src;                                                                           \
-        Maybe(T) const res      = srcit.tc->next(srcit.self);                                                          \
-        if (is_nothing(res) || !self->pred(from_just_(res))) {                                                         \
-            self->done = true;                                                                                         \
-            return Nothing(T);                                                                                         \
+        if (self->size == 0 || self->size > self->len || self->i > self->len - self->size) {                           \
+            return Nothing(Slice(T));                                                                                  \
         }                                                                                                              \
-        return res;                                                                                                    \
+        return Just(SliceOf(self->arr + self->i++, self->size, T), Slice(T));                                          \
     }                                                                                                                  \
-    impl_iterator(IterTakeWhile(T)*, T, Name, ITPL_CONCAT(IterTakeWhile(T), _nxt))
+    impl_instrumented_iterator(IterArrWindows(T)*, Slice(T), Name, ITPL_CONCAT(IterArrWindows(T), _nxt))
 
 /**
  * @def IterZip(T, U)
@@ -1487,6 +9098,7 @@ typedef enum
     {                                                                                                                  \
         Iterable(T) asrc;                                                                                              \
         Iterable(U) bsrc;                                                                                              \
+        ITPL_STATS_MEMBER                                                                                              \
     } IterZip(T, U)
 
 /**
@@ -1528,6 +9140,8 @@ typedef enum
 #define define_iterzip_func(T, U, Name)                                                                                \
     static Maybe(Pair(T, U)) ITPL_CONCAT(IterZip(T, U), _nxt)(IterZip(T, U) * self)                                    \
     {                                                                                                                  \
+        ITPL_STATS_SRC(self, 0, self->asrc);                                                                           \
+        ITPL_STATS_SRC(self, 1, self->bsrc);                                                                           \
         Iterable(T) const asrcit = self->asrc;                                                                         \
         Iterable(U) const bsrcit = self->bsrc;                                                                         \
         Maybe(T) const ares      = asrcit.tc->next(asrcit.self);                                                       \
@@ -1540,7 +9154,7 @@ typedef enum
         }                                                                                                              \
         return Just(PairOf(from_just_(ares), from_just_(bres), T, U), Pair(T, U));                                     \
     }                                                                                                                  \
-    impl_iterator(IterZip(T, U)*, Pair(T, U), Name, ITPL_CONCAT(IterZip(T, U), _nxt))
+    impl_instrumented_iterator(IterZip(T, U)*, Pair(T, U), Name, ITPL_CONCAT(IterZip(T, U), _nxt))
 
 /**
  * @def Iterplus(T)
@@ -6,25 +6,54 @@
 #ifndef LIB_ITPLUS_COMMON_H
 #define LIB_ITPLUS_COMMON_H
 
+#include "itplus_blockread.h"
 #include "itplus_chain.h"
+#include "itplus_chunks.h"
 #include "itplus_collect.h"
+#include "itplus_collectsorted.h"
+#include "itplus_csv.h"
 #include "itplus_defn.h"
+#include "itplus_distinct.h"
 #include "itplus_drop.h"
 #include "itplus_dropwhile.h"
 #include "itplus_enumerate.h"
+#include "itplus_extsort.h"
+#include "itplus_files.h"
 #include "itplus_filter.h"
 #include "itplus_filtermap.h"
 #include "itplus_fold.h"
 #include "itplus_foreach.h"
+#include "itplus_gather.h"
+#include "itplus_gen.h"
+#include "itplus_groupby.h"
+#include "itplus_hash.h"
+#include "itplus_hashagg.h"
+#include "itplus_intcodec.h"
 #include "itplus_iterator.h"
+#include "itplus_lz4.h"
 #include "itplus_macro_utils.h"
 #include "itplus_map.h"
 #include "itplus_maybe.h"
+#include "itplus_ndjson.h"
 #include "itplus_pair.h"
+#include "itplus_prefetch.h"
+#include "itplus_recstream.h"
 #include "itplus_reduce.h"
+#include "itplus_rng.h"
+#include "itplus_sample.h"
+#include "itplus_semijoin.h"
+#include "itplus_shard.h"
+#include "itplus_sketch.h"
+#include "itplus_slice.h"
+#include "itplus_split.h"
 #include "itplus_take.h"
 #include "itplus_takewhile.h"
+#include "itplus_topk.h"
+#include "itplus_trace.h"
 #include "itplus_typeclass.h"
+#include "itplus_utf8.h"
+#include "itplus_windowagg.h"
+#include "itplus_windows.h"
 #include "itplus_zip.h"
 
 #include <stdint.h>
@@ -58,4 +87,77 @@ DefineIterFiltMap(string, NumType);
 /* Extend `Iterplus(uint32_t)` map support to uint32_t -> NumType */
 DefineIterMap(uint32_t, NumType);
 
+// clang-format off
+/* Slices of uint32_t, yielded by the chunks and windows utilities */
+DefineSlice(uint32_t);
+DefineMaybe(Slice(uint32_t))
+DefineIteratorOf(Slice(uint32_t));
+// clang-format on
+DefineIterChunks(uint32_t);
+DefineIterArrChunks(uint32_t);
+DefineIterWindows(uint32_t);
+DefineIterArrWindows(uint32_t);
+DefineIterWindowAgg(uint32_t, uint32_t);
+
+// clang-format off
+/* Groups of uint32_t elements keyed by their NumType */
+DefinePair(NumType, size_t);
+DefinePair(NumType, uint32_t);
+DefinePair(NumType, Slice(uint32_t));
+DefineMaybe(Pair(NumType, size_t))
+DefineMaybe(Pair(NumType, uint32_t))
+DefineMaybe(Pair(NumType, Slice(uint32_t)))
+DefineIteratorOf(Pair(NumType, size_t));
+DefineIteratorOf(Pair(NumType, uint32_t));
+DefineIteratorOf(Pair(NumType, Slice(uint32_t)));
+// clang-format on
+DefineIterGroupBy(uint32_t, NumType);
+DefineIterGroupFold(uint32_t, NumType, uint32_t);
+DefineIterArrGroupBy(uint32_t, NumType);
+
+DefineIterDistinct(uint32_t);
+DefineIterDedup(string);
+
+/* Hash aggregation of uint32_t elements into uint32_t accumulators, keyed by uint32_t */
+DefineHashAgg(uint32_t, uint32_t);
+DefineIterHashAgg(uint32_t, uint32_t);
+
+DefineIterExternalSort(uint32_t);
+DefineIterSample(uint32_t);
+DefineIterSemiJoin(uint32_t);
+DefineIterTrace(uint32_t);
+DefineIterRecRead(uint32_t);
+DefineIterDeltaEncode(uint32_t);
+DefineIterDeltaDecode(uint32_t);
+DefineIterVarintDecode(uint32_t);
+DefineIterBitpackDecode(uint32_t);
+
+/* Views into strings */
+DefineSlice(char);
+DefineMaybe(Slice(char))
+DefineIteratorOf(Slice(char));
+DefineIterArrChunks(char);
+DefineIterLz4Compress(char);
+DefineIterLz4Decompress(char);
+
+/* Records of CSV data */
+DefineMaybe(ItplCsvRecord)
+DefineIteratorOf(ItplCsvRecord);
+DefineIterFilt(ItplCsvRecord);
+
+/* Records of NDJSON data */
+DefineMaybe(ItplJsonRecord)
+DefineIteratorOf(ItplJsonRecord);
+DefineIterFilt(ItplJsonRecord);
+DefineIterMap(ItplJsonRecord, uint32_t);
+
+/* Prefetching and gathering of the rows indexed by uint32_t iterables */
+DefineIterPrefetch(uint32_t);
+DefineIterGather(uint32_t);
+
+/* Paths of files */
+DefineIterGlob(string);
+DefineIterShard(string);
+DefineIterFileContents(string);
+
 #endif /* !LIB_ITPLUS_COMMON_H */
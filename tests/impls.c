@@ -24,11 +24,19 @@ static Maybe(string) strarrnxt(StrArrIter* self)
     return self->i < self->size ? Just(self->arr[self->i++], string) : Nothing(string);
 }
 
+/* `next` implementation for the `U32ArrIter` struct */
+static Maybe(uint32_t) u32arrnxt(U32ArrIter* self)
+{
+    return self->i < self->size ? Just(self->arr[self->i++], uint32_t) : Nothing(uint32_t);
+}
+
 // clang-format off
 /* Implement `Iterator` for `Fibonacci*` */
 impl_iterator(Fibonacci*, uint32_t, prep_fib_itr, fibnxt)
 /* Implement `Iterator` for `StrArrIter` */
 impl_iterator(StrArrIter*, string, prep_strarr_itr, strarrnxt)
+/* Implement `Iterator` for `U32ArrIter` */
+impl_iterator(U32ArrIter*, uint32_t, prep_u32arr_itr, u32arrnxt)
 
 /* Implement the iterplus utilities for `uint32_t` iterables */
 DefnIterplus(
@@ -53,3 +61,134 @@ define_iterfold_func(string, uint32_t, fold_str_u32)
 
 /* Extend `Iterplus(uint32_t)` map support to uint32_t -> NumType */
 define_itermap_func(uint32_t, NumType, u32numtypemap_to_itr)
+
+/* Implement the chunks and windows utilities for uint32_t iterables and arrays */
+define_iterchunks_func(uint32_t, u32chunks_to_itr)
+define_iterarrchunks_func(uint32_t, u32arrchunks_to_itr)
+define_iterwindows_func(uint32_t, u32windows_to_itr)
+define_iterarrwindows_func(uint32_t, u32arrwindows_to_itr)
+define_iterwindowagg_func(uint32_t, uint32_t, u32u32windowagg_to_itr)
+
+/* Implement the group_by utilities for uint32_t iterables and arrays, keyed by NumType */
+define_itergroupby_func(uint32_t, NumType, u32numtypegrp_to_itr)
+define_itergroupfold_func(uint32_t, NumType, uint32_t, u32numtypegrpfold_to_itr)
+define_iterarrgroupby_func(uint32_t, NumType, u32numtypearrgrp_to_itr)
+
+/* Implement the distinct utility for uint32_t iterables, and the dedup utility for string iterables */
+define_iterdistinct_func(uint32_t, u32distinct_to_itr)
+define_iterdedup_func(string, strdedup_to_itr)
+
+/* Implement the hash aggregation utilities for uint32_t iterables, keyed by uint32_t */
+define_hashagg_fold_func(uint32_t, uint32_t, uint32_t, group_fold_u32_u32_u32)
+define_hashagg_merge_func(uint32_t, uint32_t, merge_u32_u32)
+define_iterhashagg_func(uint32_t, uint32_t, u32u32hashagg_to_itr)
+
+/* Implement the top_k utilities for uint32_t iterables */
+define_itertopk_func(uint32_t, top_k_u32)
+define_topk_merge_func(uint32_t, merge_top_k_u32)
+
+/* Implement the collect_sorted utility for uint32_t iterables */
+define_itercollectsorted_func(uint32_t, collect_sorted_u32)
+
+/* Implement the external sort utility for uint32_t iterables */
+define_iterextsort_func(uint32_t, u32extsort_to_itr)
+
+/* Implement the sampling utilities for uint32_t iterables */
+define_itersample_func(uint32_t, u32sample_to_itr)
+define_iterreservoir_func(uint32_t, reservoir_u32)
+
+/* Implement the sketching utilities for uint32_t iterables */
+define_itercountdistinct_func(uint32_t, count_distinct_u32)
+define_iterqsketch_func(uint32_t, qsketch_u32)
+
+/* Implement the semi join utilities for uint32_t iterables */
+define_semijoin_build_func(uint32_t, build_u32set)
+define_itersemijoin_func(uint32_t, u32semijoin_to_itr)
+
+/* Implement the tracing utility for uint32_t iterables */
+define_itertrace_func(uint32_t, u32trace_to_itr)
+
+/* Implement the UTF-8 decoding utility */
+define_iterutf8_func(utf8_to_itr)
+
+/* Implement the string splitting utility */
+define_itersplit_func(split_to_itr)
+
+/* Implement the CSV utilities */
+define_itercsv_func(csv_to_itr)
+define_iterfilt_func(ItplCsvRecord, csvfilt_to_itr)
+
+/* Implement the NDJSON utilities */
+define_iterndjson_func(ndjson_to_itr)
+define_iterfilt_func(ItplJsonRecord, ndjsonfilt_to_itr)
+define_itermap_func(ItplJsonRecord, uint32_t, ndjsonu32map_to_itr)
+
+/* Implement the record stream utilities */
+define_recwrite_func(uint32_t, write_u32)
+define_iterrecread_func(uint32_t, u32recread_to_itr)
+define_iterrecbytes_func(recbytes_to_itr)
+
+/* Implement the integer codec utilities for uint32_t iterables */
+define_iterdeltaencode_func(uint32_t, u32deltaenc_to_itr)
+define_iterdeltadecode_func(uint32_t, u32deltadec_to_itr)
+define_varintencode_func(uint32_t, varint_u32)
+define_bitpackencode_func(uint32_t, bitpack_u32)
+define_itervarintdecode_func(uint32_t, u32varint_to_itr)
+define_iterbitpackdecode_func(uint32_t, u32unpack_to_itr)
+
+/* Implement the LZ4 stream utilities */
+define_iterarrchunks_func(char, chararrchunks_to_itr)
+define_iterlz4compress_func(char, lz4c_to_itr)
+define_iterlz4decompress_func(char, lz4d_to_itr)
+
+/* Implement the generator utilities */
+ITPL_GENERATOR(U32Pairs, uint32_t, u32pairs_to_itr)
+{
+    ITPL_GEN_BEGIN(self);
+    for (self->i = 0; self->i < self->n; self->i++) {
+        for (self->j = 0; self->j < self->i; self->j++) {
+            ITPL_YIELD(self, uint32_t, self->i * 100 + self->j);
+        }
+    }
+    ITPL_GEN_END(self, uint32_t);
+}
+
+size_t fill_u32pairs(U32Pairs* self, uint32_t* out, size_t cap)
+{
+    ITPL_FILL_BEGIN(self, cap);
+    for (self->i = 0; self->i < self->n; self->i++) {
+        for (self->j = 0; self->j < self->i; self->j++) {
+            ITPL_YIELD_INTO(self, out, cap, self->i * 100 + self->j);
+        }
+    }
+    ITPL_FILL_END(self);
+}
+
+ITPL_GENERATOR(FibGen, uint32_t, fibgen_to_itr)
+{
+    ITPL_GEN_BEGIN(self);
+    for (self->curr = 0, self->next = 1;;) {
+        ITPL_YIELD(self, uint32_t, self->curr);
+        uint32_t const prev_curr = self->curr;
+        self->curr               = self->next;
+        self->next              += prev_curr;
+    }
+    ITPL_GEN_END(self, uint32_t);
+}
+
+define_iterfill_func(uint32_t, fill_u32)
+
+/* Implement the file block source */
+define_iterfileblocks_func(fileblocks_to_itr)
+
+/* Implement the multi file utilities */
+define_iterglob_func(string, strglob_to_itr)
+define_itershard_func(string, strshard_to_itr)
+define_iterfilecontents_func(string, strcontents_to_itr)
+
+/* Implement the prefetching utility for uint32_t iterables */
+define_iterprefetch_func(uint32_t, u32prefetch_to_itr)
+
+/* Implement the gather and scatter utilities for uint32_t columns */
+define_itergather_func(uint32_t, u32gather_to_itr)
+define_scatterinto_func(uint32_t, scatter_u32)
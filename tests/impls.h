@@ -25,18 +25,32 @@ typedef struct
     string const* const arr;
 } StrArrIter;
 
+typedef struct
+{
+    size_t i;
+    size_t const size;
+    /* Array of uint32_t values */
+    uint32_t const* const arr;
+} U32ArrIter;
+
 /* Turn a pointer to a `Fibonacci` struct to an iterable */
 Iterable(uint32_t) prep_fib_itr(Fibonacci* self);
 
 /* Turn a pointer to a `StrArrIter` struct to an iterable */
 Iterable(string) prep_strarr_itr(StrArrIter* self);
 
+/* Turn a pointer to a `U32ArrIter` struct to an iterable */
+Iterable(uint32_t) prep_u32arr_itr(U32ArrIter* self);
+
 /* Create an infinite `Iterable` representing the fibonacci sequence */
 #define get_fibitr() prep_fib_itr(&(Fibonacci){.curr = 0, .next = 1})
 
 /* Convert an array of string literals into an `Iterable` */
 #define strarr_to_iter(srcarr, len) prep_strarr_itr(&(StrArrIter){.i = 0, .size = (len), .arr = (srcarr)})
 
+/* Convert an array of uint32_t values into an `Iterable` */
+#define u32arr_to_iter(srcarr, len) prep_u32arr_itr(&(U32ArrIter){.i = 0, .size = (len), .arr = (srcarr)})
+
 /* Declaration of the iterplus utilities implemented for uint32_t iterables */
 DeclIterplus(uint32_t, u32tk_to_itr, u32drp_to_itr, u32u32map_to_itr, u32filt_to_itr, reduce_u32, fold_u32_u32,
     u32u32filtmap_to_itr, u32chn_to_itr, u32tkwhl_to_itr, u32drpwhl_to_itr, u32enumr_to_itr, u32u32zip_to_itr,
@@ -54,4 +68,124 @@ uint32_t fold_str_u32(Iterable(string) it, uint32_t init, uint32_t (*f)(uint32_t
 /* Declaration for `Iterplus(uint32_t)` map support to uint32_t -> NumType */
 Iterable(NumType) u32numtypemap_to_itr(IterMap(uint32_t, NumType) * x);
 
+/* Declarations of the chunks and windows utilities for uint32_t iterables and arrays */
+Iterable(Slice(uint32_t)) u32chunks_to_itr(IterChunks(uint32_t) * x);
+Iterable(Slice(uint32_t)) u32arrchunks_to_itr(IterArrChunks(uint32_t) * x);
+Iterable(Slice(uint32_t)) u32windows_to_itr(IterWindows(uint32_t) * x);
+Iterable(Slice(uint32_t)) u32arrwindows_to_itr(IterArrWindows(uint32_t) * x);
+Iterable(uint32_t) u32u32windowagg_to_itr(IterWindowAgg(uint32_t, uint32_t) * x);
+
+/* Declarations of the group_by utilities for uint32_t iterables and arrays, keyed by NumType */
+Iterable(Pair(NumType, size_t)) u32numtypegrp_to_itr(IterGroupBy(uint32_t, NumType) * x);
+Iterable(Pair(NumType, uint32_t)) u32numtypegrpfold_to_itr(IterGroupFold(uint32_t, NumType, uint32_t) * x);
+Iterable(Pair(NumType, Slice(uint32_t))) u32numtypearrgrp_to_itr(IterArrGroupBy(uint32_t, NumType) * x);
+
+/* Declarations of the distinct utility for uint32_t iterables, and the dedup utility for string iterables */
+Iterable(uint32_t) u32distinct_to_itr(IterDistinct(uint32_t) * x);
+Iterable(string) strdedup_to_itr(IterDedup(string) * x);
+
+/* Declarations of the hash aggregation utilities for uint32_t iterables, keyed by uint32_t */
+bool group_fold_u32_u32_u32(Iterable(uint32_t) it, HashAgg(uint32_t, uint32_t) * tbl, uint32_t (*key)(uint32_t x),
+    uint32_t init, uint32_t (*f)(uint32_t acc, uint32_t x));
+bool merge_u32_u32(HashAgg(uint32_t, uint32_t) * dst, HashAgg(uint32_t, uint32_t) const* src,
+    uint32_t (*merge)(uint32_t a, uint32_t b));
+Iterable(Pair(uint32_t, uint32_t)) u32u32hashagg_to_itr(IterHashAgg(uint32_t, uint32_t) * x);
+
+/* Declarations of the top_k utilities for uint32_t iterables */
+size_t top_k_u32(Iterable(uint32_t) it, uint32_t* out, size_t k, int (*cmp)(uint32_t a, uint32_t b));
+size_t merge_top_k_u32(
+    uint32_t* dst, size_t dstlen, uint32_t const* src, size_t srclen, size_t k, int (*cmp)(uint32_t a, uint32_t b));
+
+/* Declaration of the collect_sorted utility for uint32_t iterables */
+uint32_t* collect_sorted_u32(Iterable(uint32_t) it, size_t* len, uint64_t (*key)(uint32_t x));
+
+/* Declaration of the external sort utility for uint32_t iterables */
+Iterable(uint32_t) u32extsort_to_itr(IterExternalSort(uint32_t) * x);
+
+/* Declarations of the sampling utilities for uint32_t iterables */
+Iterable(uint32_t) u32sample_to_itr(IterSample(uint32_t) * x);
+size_t reservoir_u32(Iterable(uint32_t) it, uint32_t* out, size_t k, ItplRng* rng);
+
+/* Declarations of the sketching utilities for uint32_t iterables */
+double count_distinct_u32(Iterable(uint32_t) it, ItplHll* hll, uint64_t (*hash)(uint32_t x));
+void qsketch_u32(Iterable(uint32_t) it, ItplQSketch* s, double (*val)(uint32_t x));
+
+/* Declarations of the semi join utilities for uint32_t iterables */
+bool build_u32set(Iterable(uint32_t) it, ItplKeySet* set, uint64_t (*key)(uint32_t x), bool exact);
+Iterable(uint32_t) u32semijoin_to_itr(IterSemiJoin(uint32_t) * x);
+
+/* Declaration of the tracing utility for uint32_t iterables */
+Iterable(uint32_t) u32trace_to_itr(IterTrace(uint32_t) * x);
+
+/* Declaration of the UTF-8 decoding utility */
+Iterable(uint32_t) utf8_to_itr(IterUtf8* x);
+
+/* Declaration of the string splitting utility */
+Iterable(Slice(char)) split_to_itr(IterSplit* x);
+
+/* Declarations of the CSV utilities */
+Iterable(ItplCsvRecord) csv_to_itr(IterCsv* x);
+Iterable(ItplCsvRecord) csvfilt_to_itr(IterFilt(ItplCsvRecord) * x);
+
+/* Declarations of the NDJSON utilities */
+Iterable(ItplJsonRecord) ndjson_to_itr(IterNdjson* x);
+Iterable(ItplJsonRecord) ndjsonfilt_to_itr(IterFilt(ItplJsonRecord) * x);
+Iterable(uint32_t) ndjsonu32map_to_itr(IterMap(ItplJsonRecord, uint32_t) * x);
+
+/* Declarations of the record stream utilities */
+bool write_u32(Iterable(uint32_t) it, ItplRecWriter* w);
+Iterable(uint32_t) u32recread_to_itr(IterRecRead(uint32_t) * x);
+Iterable(Slice(char)) recbytes_to_itr(IterRecBytes* x);
+
+/* Declarations of the integer codec utilities for uint32_t iterables */
+Iterable(uint32_t) u32deltaenc_to_itr(IterDeltaEncode(uint32_t) * x);
+Iterable(uint32_t) u32deltadec_to_itr(IterDeltaDecode(uint32_t) * x);
+bool varint_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len);
+bool bitpack_u32(Iterable(uint32_t) it, unsigned char* out, size_t cap, size_t* len);
+Iterable(uint32_t) u32varint_to_itr(IterVarintDecode(uint32_t) * x);
+Iterable(uint32_t) u32unpack_to_itr(IterBitpackDecode(uint32_t) * x);
+
+/* Declarations of the LZ4 stream utilities */
+Iterable(Slice(char)) chararrchunks_to_itr(IterArrChunks(char) * x);
+Iterable(Slice(char)) lz4c_to_itr(IterLz4Compress(char) * x);
+Iterable(Slice(char)) lz4d_to_itr(IterLz4Decompress(char) * x);
+
+/* A generator of the pairs `(i, j)` with `0 <= j < i < n`, as `i * 100 + j` */
+typedef struct
+{
+    uint32_t n;
+    uint32_t i;
+    uint32_t j;
+    ITPL_GEN_MEMBER
+} U32Pairs;
+
+/* A generator of the Fibonacci sequence */
+typedef struct
+{
+    uint32_t curr;
+    uint32_t next;
+    ITPL_GEN_MEMBER
+} FibGen;
+
+/* Declarations of the generator utilities */
+Iterable(uint32_t) u32pairs_to_itr(U32Pairs* x);
+size_t fill_u32pairs(U32Pairs* self, uint32_t* out, size_t cap);
+Iterable(uint32_t) fibgen_to_itr(FibGen* x);
+size_t fill_u32(Iterable(uint32_t) it, uint32_t* out, size_t cap);
+
+/* Declarations of the file block source */
+Iterable(Slice(char)) fileblocks_to_itr(IterFileBlocks* x);
+
+/* Declarations of the multi file utilities */
+Iterable(string) strglob_to_itr(IterGlob(string) * x);
+Iterable(string) strshard_to_itr(IterShard(string) * x);
+Iterable(Slice(char)) strcontents_to_itr(IterFileContents(string) * x);
+
+/* Declaration of the prefetching utility for uint32_t iterables */
+Iterable(uint32_t) u32prefetch_to_itr(IterPrefetch(uint32_t) * x);
+
+/* Declarations of the gather and scatter utilities for uint32_t columns */
+Iterable(uint32_t) u32gather_to_itr(IterGather(uint32_t) * x);
+bool scatter_u32(Iterable(uint32_t) idxs, Iterable(uint32_t) it, uint32_t* col, size_t len);
+
 #endif /* !LIB_ITPLUS_IMPL_H */
@@ -4,13 +4,15 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define FIBSEQ_MINSZ 10U
 
-#define TEST_COUNT 13U
+#define TEST_COUNT 39U
 
 #define DECIMAL_BASE 10
 
@@ -496,6 +498,1750 @@ static bool test_zip(void)
     return true;
 }
 
+static bool test_chunks(void)
+{
+    /* Build a fibonacci array, for verification later */
+    uint32_t fibarr[FIBSEQ_MINSZ] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ; i++) {
+        fibarr[i] = fibarr[i - 1] + fibarr[i - 2];
+    }
+
+    /* Group the first FIBSEQ_MINSZ number of items from the fibonacci sequence into chunks of 3 */
+    uint32_t chunkbuf[3];
+    Iterable(Slice(uint32_t)) chunked =
+        u32chunks_to_itr(&(IterChunks(uint32_t)){.size = 3, .buf = chunkbuf, .src = take(get_fibitr(), FIBSEQ_MINSZ)});
+    /* The same chunks, viewed directly out of the array */
+    Iterable(Slice(uint32_t)) arrchunked =
+        u32arrchunks_to_itr(&(IterArrChunks(uint32_t)){.size = 3, .len = FIBSEQ_MINSZ, .arr = fibarr});
+    size_t i = 0;
+    foreach (Slice(uint32_t), chunk, chunked) {
+        Slice(uint32_t) const arrchunk = from_just(arrchunked.tc->next(arrchunked.self), Slice(uint32_t));
+        if (arrchunk.ptr != fibarr + i) {
+            fprintf(stderr, "%s: Array chunk does not point into the source array at index: %zu\n", __func__, i);
+            return false;
+        }
+        if (chunk.len != arrchunk.len) {
+            fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, arrchunk.len, chunk.len);
+            return false;
+        }
+        for (size_t j = 0; j < chunk.len; j++, i++) {
+            if (chunk.ptr[j] != fibarr[i]) {
+                fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", __func__, fibarr[i],
+                    chunk.ptr[j], i);
+                return false;
+            }
+        }
+    }
+    if (i != FIBSEQ_MINSZ) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, (size_t)FIBSEQ_MINSZ, i);
+        return false;
+    }
+    if (is_just(arrchunked.tc->next(arrchunked.self))) {
+        fprintf(stderr, "%s: Array chunks yielded more chunks than expected\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+#define WINDOWSZ 4U
+
+static bool test_windows(void)
+{
+    /* Build a fibonacci array, for verification later */
+    uint32_t fibarr[FIBSEQ_MINSZ] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ; i++) {
+        fibarr[i] = fibarr[i - 1] + fibarr[i - 2];
+    }
+
+    /* View every window of WINDOWSZ consecutive items in the first FIBSEQ_MINSZ items of the fibonacci sequence */
+    uint32_t ring[WINDOWSZ * 2];
+    Iterable(Slice(uint32_t)) wins = u32windows_to_itr(
+        &(IterWindows(uint32_t)){.size = WINDOWSZ, .buf = ring, .src = take(get_fibitr(), FIBSEQ_MINSZ)});
+    /* The same windows, viewed directly out of the array */
+    Iterable(Slice(uint32_t)) arrwins =
+        u32arrwindows_to_itr(&(IterArrWindows(uint32_t)){.size = WINDOWSZ, .len = FIBSEQ_MINSZ, .arr = fibarr});
+    size_t i = 0;
+    foreach (Slice(uint32_t), win, wins) {
+        Slice(uint32_t) const arrwin = from_just(arrwins.tc->next(arrwins.self), Slice(uint32_t));
+        if (win.len != WINDOWSZ || arrwin.len != WINDOWSZ || arrwin.ptr != fibarr + i) {
+            fprintf(stderr, "%s: Malformed window at index: %zu\n", __func__, i);
+            return false;
+        }
+        for (size_t j = 0; j < WINDOWSZ; j++) {
+            if (win.ptr[j] != fibarr[i + j]) {
+                fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", __func__,
+                    fibarr[i + j], win.ptr[j], i + j);
+                return false;
+            }
+        }
+        i++;
+    }
+    if (i != FIBSEQ_MINSZ - WINDOWSZ + 1) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, (size_t)(FIBSEQ_MINSZ - WINDOWSZ + 1), i);
+        return false;
+    }
+    if (is_just(arrwins.tc->next(arrwins.self))) {
+        fprintf(stderr, "%s: Array windows yielded more windows than expected\n", __func__);
+        return false;
+    }
+
+    /* Make sure a source shorter than the window yields no windows */
+    Iterable(Slice(uint32_t)) nowins = u32windows_to_itr(
+        &(IterWindows(uint32_t)){.size = WINDOWSZ, .buf = ring, .src = take(get_fibitr(), WINDOWSZ - 1)});
+    if (is_just(nowins.tc->next(nowins.self))) {
+        fprintf(stderr, "%s: Expected no windows from a source shorter than the window size\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t sub_u32(uint32_t x, uint32_t y) { return x - y; }
+static uint32_t max_u32(uint32_t x, uint32_t y) { return x > y ? x : y; }
+static uint32_t min_u32(uint32_t x, uint32_t y) { return x < y ? x : y; }
+
+static bool test_windowagg(void)
+{
+    /* Build a sequence with some ups and downs (fibonacci numbers modulo a small number), for verification later */
+    uint32_t arr[FIBSEQ_MINSZ * 3] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 3; i++) {
+        arr[i] = arr[i - 1] + arr[i - 2];
+    }
+    for (size_t i = 0; i < FIBSEQ_MINSZ * 3; i++) {
+        arr[i] %= 17;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+
+    uint32_t ring[WINDOWSZ];
+    uint32_t aggs[WINDOWSZ];
+    /* Rolling sum, using the inverse of addition */
+    Iterable(uint32_t) sums = u32u32windowagg_to_itr(&(IterWindowAgg(uint32_t, uint32_t)){
+        .size = WINDOWSZ, .init = 0, .f = add_u32, .inv = sub_u32, .buf = ring, .src = u32arr_to_iter(arr, arrlen)});
+    /* Rolling max and min, using the two stack method */
+    uint32_t ring2[WINDOWSZ];
+    Iterable(uint32_t) maxs = u32u32windowagg_to_itr(&(IterWindowAgg(uint32_t, uint32_t)){.size = WINDOWSZ,
+        .init = 0, .f = max_u32, .merge = max_u32, .buf = ring2, .aggs = aggs, .src = u32arr_to_iter(arr, arrlen)});
+    uint32_t ring3[WINDOWSZ];
+    uint32_t aggs3[WINDOWSZ];
+    Iterable(uint32_t) mins = u32u32windowagg_to_itr(&(IterWindowAgg(uint32_t, uint32_t)){.size = WINDOWSZ,
+        .init = UINT32_MAX, .f = min_u32, .merge = min_u32, .buf = ring3, .aggs = aggs3,
+        .src = u32arr_to_iter(arr, arrlen)});
+
+    size_t i = 0;
+    foreach (uint32_t, sum, sums) {
+        /* Compute the aggregates of this window the slow way */
+        uint32_t expectedsum = 0, expectedmax = 0, expectedmin = UINT32_MAX;
+        for (size_t j = i; j < i + WINDOWSZ; j++) {
+            expectedsum += arr[j];
+            expectedmax = max_u32(expectedmax, arr[j]);
+            expectedmin = min_u32(expectedmin, arr[j]);
+        }
+        uint32_t const max = from_just(maxs.tc->next(maxs.self), uint32_t);
+        uint32_t const min = from_just(mins.tc->next(mins.self), uint32_t);
+        if (sum != expectedsum || max != expectedmax || min != expectedmin) {
+            fprintf(stderr,
+                "%s: Expected: (%" PRIu32 ", %" PRIu32 ", %" PRIu32 ") Actual: (%" PRIu32 ", %" PRIu32 ", %" PRIu32
+                ") at index: %zu\n",
+                __func__, expectedsum, expectedmax, expectedmin, sum, max, min, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != arrlen - WINDOWSZ + 1) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, arrlen - WINDOWSZ + 1, i);
+        return false;
+    }
+    if (is_just(maxs.tc->next(maxs.self)) || is_just(mins.tc->next(mins.self))) {
+        fprintf(stderr, "%s: Yielded more aggregates than expected\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+static bool numtype_eq(NumType a, NumType b) { return a == b; }
+
+static bool test_groupby(void)
+{
+    /* Build a fibonacci array, for verification later - the parities go even, odd, odd, even, odd, odd... */
+    uint32_t fibarr[FIBSEQ_MINSZ] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ; i++) {
+        fibarr[i] = fibarr[i - 1] + fibarr[i - 2];
+    }
+
+    /* Run length encode, sum up, and view the runs of same parity fibonacci numbers */
+    Iterable(Pair(NumType, size_t)) runs = u32numtypegrp_to_itr(&(IterGroupBy(uint32_t, NumType)){
+        .key = u32_to_numtype, .eq = numtype_eq, .src = take(get_fibitr(), FIBSEQ_MINSZ)});
+    Iterable(Pair(NumType, uint32_t)) sums = u32numtypegrpfold_to_itr(&(IterGroupFold(uint32_t, NumType, uint32_t)){
+        .key = u32_to_numtype, .eq = numtype_eq, .init = 0, .f = add_u32, .src = take(get_fibitr(), FIBSEQ_MINSZ)});
+    Iterable(Pair(NumType, Slice(uint32_t))) views = u32numtypearrgrp_to_itr(&(IterArrGroupBy(uint32_t, NumType)){
+        .key = u32_to_numtype, .eq = numtype_eq, .len = FIBSEQ_MINSZ, .arr = fibarr});
+
+    size_t i = 0;
+    foreach (Pair(NumType, size_t), run, runs) {
+        /* Find the expected run the slow way */
+        NumType const expectedkey = u32_to_numtype(fibarr[i]);
+        size_t expectedlen        = 0;
+        uint32_t expectedsum      = 0;
+        for (size_t j = i; j < FIBSEQ_MINSZ && u32_to_numtype(fibarr[j]) == expectedkey; j++) {
+            expectedlen++;
+            expectedsum += fibarr[j];
+        }
+
+        Pair(NumType, uint32_t) const sum = from_just(sums.tc->next(sums.self), Pair(NumType, uint32_t));
+        Pair(NumType, Slice(uint32_t)) const view =
+            from_just(views.tc->next(views.self), Pair(NumType, Slice(uint32_t)));
+        if (fst(run) != expectedkey || fst(sum) != expectedkey || fst(view) != expectedkey) {
+            fprintf(stderr, "%s: Expected key: %d at index: %zu\n", __func__, expectedkey, i);
+            return false;
+        }
+        if (snd(run) != expectedlen || snd(view).len != expectedlen || snd(view).ptr != fibarr + i) {
+            fprintf(stderr, "%s: Expected: %zu Actual: %zu at index: %zu\n", __func__, expectedlen, snd(run), i);
+            return false;
+        }
+        if (snd(sum) != expectedsum) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", __func__, expectedsum,
+                snd(sum), i);
+            return false;
+        }
+        i += expectedlen;
+    }
+    if (i != FIBSEQ_MINSZ) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, (size_t)FIBSEQ_MINSZ, i);
+        return false;
+    }
+    if (is_just(sums.tc->next(sums.self)) || is_just(views.tc->next(views.self))) {
+        fprintf(stderr, "%s: Yielded more groups than expected\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+static uint64_t hash_u32(uint32_t x) { return itpl_hash_u64(x); }
+static bool u32_eq(uint32_t a, uint32_t b) { return a == b; }
+static bool str_eq(string a, string b) { return strcmp(a, b) == 0; }
+
+static bool occurs_in(uint32_t const* arr, size_t len, uint32_t x)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (arr[i] == x) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Check that `it` yields the elements of `arr`, in order */
+static bool yields_u32arr(Iterable(uint32_t) it, uint32_t const* arr, size_t arrlen, char const* name)
+{
+    size_t i = 0;
+    foreach (uint32_t, x, it) {
+        if (i == arrlen || x != arr[i]) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", name,
+                i < arrlen ? arr[i] : 0, x, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != arrlen) {
+        fprintf(stderr, "%s: Expected: %zu elements Actual: %zu\n", name, arrlen, i);
+        return false;
+    }
+    return true;
+}
+
+static bool test_distinct(void)
+{
+    /* Build a sequence with lots of repeated elements, more distinct ones than the initial set can hold */
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = (arr[i - 1] + arr[i - 2]) % 50;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+
+    uint8_t ctrl[ITPLUS_HASH_MINCAP] = {0};
+    uint32_t slots[ITPLUS_HASH_MINCAP];
+    IterDistinct(uint32_t) d = {.hash = hash_u32, .eq = u32_eq, .ctrl = ctrl, .slots = slots,
+        .cap = ITPLUS_HASH_MINCAP, .src = u32arr_to_iter(arr, arrlen)};
+    Iterable(uint32_t) uniq = u32distinct_to_itr(&d);
+    size_t i                = 0;
+    foreach (uint32_t, x, uniq) {
+        /* Find the next first occurrence the slow way */
+        while (i < arrlen && occurs_in(arr, i, arr[i])) {
+            i++;
+        }
+        if (i == arrlen || x != arr[i]) {
+            fprintf(stderr, "%s: Expected first occurrence at index: %zu Actual: %" PRIu32 "\n", __func__, i, x);
+            iterdistinct_free(&d);
+            return false;
+        }
+        i++;
+    }
+    while (i < arrlen && occurs_in(arr, i, arr[i])) {
+        i++;
+    }
+    bool const grown = d.owned;
+    iterdistinct_free(&d);
+    if (i != arrlen) {
+        fprintf(stderr, "%s: Missed the first occurrence at index: %zu\n", __func__, i);
+        return false;
+    }
+    if (d.failed || !grown) {
+        fprintf(stderr, "%s: Expected the set to grow onto the heap\n", __func__);
+        return false;
+    }
+
+    /* A caller supplied set too small for the maximum load to leave a slot empty must still grow */
+    uint32_t const few[] = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+    uint8_t tinyctrl[4]  = {0};
+    uint32_t tinyslots[4];
+    IterDistinct(uint32_t) tiny = {.hash = hash_u32, .eq = u32_eq, .ctrl = tinyctrl, .slots = tinyslots, .cap = 4,
+        .src = u32arr_to_iter(few, sizeof(few) / sizeof(*few))};
+    bool const tinyok = yields_u32arr(u32distinct_to_itr(&tiny), (uint32_t[]){3, 1, 4, 5, 9, 2, 6}, 7, __func__);
+    iterdistinct_free(&tiny);
+    if (!tinyok || tiny.failed) {
+        return false;
+    }
+
+    /* Collapse the runs of equal strings */
+    Iterable(string) runs =
+        strdedup_to_itr(&(IterDedup(string)){.eq = str_eq, .src = strarr_to_iter(cheese, cheeselen)});
+    i = 0;
+    foreach (string, s, runs) {
+        if (s != cheese[i]) {
+            fprintf(stderr, "%s: Expected: %s Actual: %s\n", __func__, cheese[i], s);
+            return false;
+        }
+        while (i < cheeselen && strcmp(cheese[i], s) == 0) {
+            i++;
+        }
+    }
+    if (i != cheeselen) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, cheeselen, i);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t mod37(uint32_t x) { return x % 37; }
+
+static bool test_hashagg(void)
+{
+    /* Build a sequence with more distinct keys than the initial table can hold */
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = (arr[i - 1] + arr[i - 2]) % 1000;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+
+    /* Sum up each half by key separately, one starting off in caller storage, and then merge the 2 tables */
+    uint8_t ctrl[ITPLUS_HASH_MINCAP] = {0};
+    uint32_t keys[ITPLUS_HASH_MINCAP];
+    uint32_t accs[ITPLUS_HASH_MINCAP];
+    HashAgg(uint32_t, uint32_t) fsthalf = {
+        .hash = hash_u32, .eq = u32_eq, .ctrl = ctrl, .keys = keys, .accs = accs, .cap = ITPLUS_HASH_MINCAP};
+    HashAgg(uint32_t, uint32_t) sndhalf = {.hash = hash_u32, .eq = u32_eq, .hint = 37};
+    bool const ok = group_fold_u32_u32_u32(u32arr_to_iter(arr, arrlen / 2), &fsthalf, mod37, 0, add_u32) &&
+        group_fold_u32_u32_u32(u32arr_to_iter(arr + arrlen / 2, arrlen - arrlen / 2), &sndhalf, mod37, 0, add_u32) &&
+        merge_u32_u32(&fsthalf, &sndhalf, add_u32);
+    hashagg_free(&sndhalf);
+    if (!ok) {
+        fprintf(stderr, "%s: Allocation failure\n", __func__);
+        hashagg_free(&fsthalf);
+        return false;
+    }
+
+    /* Compare every entry against the sum computed the slow way */
+    Iterable(Pair(uint32_t, uint32_t)) entries =
+        u32u32hashagg_to_itr(&(IterHashAgg(uint32_t, uint32_t)){.tbl = &fsthalf});
+    size_t nkeys = 0;
+    foreach (Pair(uint32_t, uint32_t), entry, entries) {
+        uint32_t expectedsum = 0;
+        for (size_t i = 0; i < arrlen; i++) {
+            if (mod37(arr[i]) == fst(entry)) {
+                expectedsum += arr[i];
+            }
+        }
+        if (snd(entry) != expectedsum) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " for key: %" PRIu32 "\n", __func__,
+                expectedsum, snd(entry), fst(entry));
+            hashagg_free(&fsthalf);
+            return false;
+        }
+        nkeys++;
+    }
+    hashagg_free(&fsthalf);
+    size_t expectednkeys = 0;
+    for (uint32_t k = 0; k < 37; k++) {
+        bool found = false;
+        for (size_t i = 0; i < arrlen && !found; i++) {
+            found = mod37(arr[i]) == k;
+        }
+        expectednkeys += found;
+    }
+    if (nkeys != expectednkeys || nkeys != fsthalf.len) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, expectednkeys, nkeys);
+        return false;
+    }
+
+    /* A caller supplied table too small for the maximum load to leave a slot empty must still grow */
+    uint8_t tinyctrl[4] = {0};
+    uint32_t tinykeys[4];
+    uint32_t tinyaccs[4];
+    HashAgg(uint32_t, uint32_t) tiny = {
+        .hash = hash_u32, .eq = u32_eq, .ctrl = tinyctrl, .keys = tinykeys, .accs = tinyaccs, .cap = 4};
+    bool const tinyok    = group_fold_u32_u32_u32(u32arr_to_iter(arr, arrlen), &tiny, mod37, 0, add_u32);
+    size_t const tinylen = tiny.len;
+    hashagg_free(&tiny);
+    if (!tinyok || tinylen != expectednkeys) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu keys in a small table\n", __func__, expectednkeys, tinylen);
+        return false;
+    }
+    return true;
+}
+
+#define TOPK 7U
+
+static int cmp_u32(uint32_t a, uint32_t b) { return (a > b) - (a < b); }
+static int qsort_desc_u32(void const* a, void const* b) { return cmp_u32(*(uint32_t const*)b, *(uint32_t const*)a); }
+
+static bool test_topk(void)
+{
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = (arr[i - 1] + arr[i - 2]) % 1000;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+    /* Sort a copy of the array, for verification later */
+    uint32_t sorted[FIBSEQ_MINSZ * 15];
+    memcpy(sorted, arr, sizeof(arr));
+    qsort(sorted, arrlen, sizeof(*sorted), qsort_desc_u32);
+
+    /* Find the top k of the whole array, and of each half separately (merged afterwards) */
+    uint32_t best[TOPK], best2[TOPK];
+    size_t const n = top_k_u32(u32arr_to_iter(arr, arrlen), best, TOPK, cmp_u32);
+    size_t n2      = top_k_u32(u32arr_to_iter(arr, arrlen / 2), best2, TOPK, cmp_u32);
+    uint32_t rest[TOPK];
+    size_t const nrest = top_k_u32(u32arr_to_iter(arr + arrlen / 2, arrlen - arrlen / 2), rest, TOPK, cmp_u32);
+    n2                 = merge_top_k_u32(best2, n2, rest, nrest, TOPK, cmp_u32);
+    if (n != TOPK || n2 != TOPK) {
+        fprintf(stderr, "%s: Expected: %u Actual: (%zu, %zu)\n", __func__, TOPK, n, n2);
+        return false;
+    }
+    for (size_t i = 0; i < TOPK; i++) {
+        if (best[i] != sorted[i] || best2[i] != sorted[i]) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: (%" PRIu32 ", %" PRIu32 ") at index: %zu\n", __func__,
+                sorted[i], best[i], best2[i], i);
+            return false;
+        }
+    }
+
+    /* Fewer elements than k */
+    uint32_t all[FIBSEQ_MINSZ];
+    size_t const nall = top_k_u32(u32arr_to_iter(arr, 5), all, FIBSEQ_MINSZ, cmp_u32);
+    qsort(arr, 5, sizeof(*arr), qsort_desc_u32);
+    if (nall != 5 || memcmp(all, arr, 5 * sizeof(*arr)) != 0) {
+        fprintf(stderr, "%s: Expected all 5 elements in descending order\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+static uint64_t u32_key(uint32_t x) { return x; }
+static uint64_t lastdigit_key(uint32_t x) { return x % DECIMAL_BASE; }
+static int qsort_asc_u32(void const* a, void const* b) { return cmp_u32(*(uint32_t const*)a, *(uint32_t const*)b); }
+
+static bool test_collectsorted(void)
+{
+    /* More elements than the initial collect buffer, with keys spanning several digits */
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = (arr[i - 1] + arr[i - 2]) % 100000;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+    uint32_t expected[FIBSEQ_MINSZ * 15];
+    memcpy(expected, arr, sizeof(arr));
+    qsort(expected, arrlen, sizeof(*expected), qsort_asc_u32);
+
+    size_t len          = 0;
+    uint32_t* const res = collect_sorted_u32(u32arr_to_iter(arr, arrlen), &len, u32_key);
+    if (res == NULL || len != arrlen || memcmp(res, expected, sizeof(expected)) != 0) {
+        fprintf(stderr, "%s: Expected %zu elements in ascending order\n", __func__, arrlen);
+        free(res);
+        return false;
+    }
+    free(res);
+
+    /* Sorting by the last digit only must keep elements with equal keys in their original order */
+    for (size_t i = 0, j = 0; i < DECIMAL_BASE; i++) {
+        for (size_t k = 0; k < arrlen; k++) {
+            if (lastdigit_key(arr[k]) == i) {
+                expected[j++] = arr[k];
+            }
+        }
+    }
+    uint32_t* const stableres = collect_sorted_u32(u32arr_to_iter(arr, arrlen), &len, lastdigit_key);
+    if (stableres == NULL || len != arrlen || memcmp(stableres, expected, sizeof(expected)) != 0) {
+        fprintf(stderr, "%s: Expected %zu elements stably sorted by their last digit\n", __func__, arrlen);
+        free(stableres);
+        return false;
+    }
+    free(stableres);
+    return true;
+}
+
+#define EXTSORT_BUFSZ 8U
+
+static bool test_extsort(void)
+{
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = (arr[i - 1] + arr[i - 2]) % 100000;
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+    uint32_t expected[FIBSEQ_MINSZ * 15];
+    memcpy(expected, arr, sizeof(arr));
+    qsort(expected, arrlen, sizeof(*expected), qsort_asc_u32);
+
+    /* A buffer this small forces many runs, which have to be merged in multiple passes */
+    uint32_t buf[EXTSORT_BUFSZ];
+    IterExternalSort(uint32_t) spilled = {
+        .cmp = qsort_asc_u32, .buf = buf, .cap = EXTSORT_BUFSZ, .tmpdir = ".", .src = u32arr_to_iter(arr, arrlen)};
+    /* Everything fits in this one */
+    uint32_t bigbuf[FIBSEQ_MINSZ * 15];
+    IterExternalSort(uint32_t) inmem = {
+        .cmp = qsort_asc_u32, .buf = bigbuf, .cap = arrlen, .src = u32arr_to_iter(arr, arrlen)};
+    Iterable(uint32_t) sorted      = u32extsort_to_itr(&spilled);
+    Iterable(uint32_t) inmemsorted = u32extsort_to_itr(&inmem);
+
+    size_t i = 0;
+    foreach (uint32_t, x, sorted) {
+        Maybe(uint32_t) const y = inmemsorted.tc->next(inmemsorted.self);
+        if (i == arrlen || x != expected[i] || is_nothing(y) || from_just_(y) != expected[i]) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", __func__,
+                i < arrlen ? expected[i] : 0, x, i);
+            iterextsort_free(&spilled);
+            return false;
+        }
+        i++;
+    }
+    if (i != arrlen || spilled.state.failed || spilled.state.nruns != 0) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, arrlen, i);
+        return false;
+    }
+    if (is_just(inmemsorted.tc->next(inmemsorted.self)) || inmem.state.nruns != 0) {
+        fprintf(stderr, "%s: Expected the in memory sort to not spill\n", __func__);
+        return false;
+    }
+
+    /* A buffer too small to merge from is rejected, instead of yielding nothing */
+    IterExternalSort(uint32_t) tiny = {.cmp = qsort_asc_u32, .buf = buf, .cap = 1, .src = u32arr_to_iter(arr, arrlen)};
+    Iterable(uint32_t) tinysorted   = u32extsort_to_itr(&tiny);
+    if (is_just(tinysorted.tc->next(tinysorted.self)) || !tiny.state.failed || tiny.state.nruns != 0) {
+        fprintf(stderr, "%s: Expected a buffer of 1 element to fail\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+#define SAMPLESZ 1000U
+#define RESERVOIRSZ 10U
+
+static bool test_sample(void)
+{
+    /* Elements are their own indices */
+    uint32_t arr[SAMPLESZ];
+    for (size_t i = 0; i < SAMPLESZ; i++) {
+        arr[i] = (uint32_t)i;
+    }
+
+    /* Each element should be kept with probability 1/4, in order */
+    Iterable(uint32_t) sample = u32sample_to_itr(
+        &(IterSample(uint32_t)){.p = 0.25, .rng = itpl_rng_seed(42), .src = u32arr_to_iter(arr, SAMPLESZ)});
+    size_t nkept = 0;
+    uint32_t nxt = 0;
+    foreach (uint32_t, x, sample) {
+        if (x < nxt) {
+            fprintf(stderr, "%s: Expected an element after: %" PRIu32 " Actual: %" PRIu32 "\n", __func__, nxt, x);
+            return false;
+        }
+        nxt = x + 1;
+        nkept++;
+    }
+    /* More than 5 standard deviations away from the expected 250 */
+    if (nkept < 180 || nkept > 320) {
+        fprintf(stderr, "%s: Expected: ~%u Actual: %zu\n", __func__, SAMPLESZ / 4, nkept);
+        return false;
+    }
+    Iterable(uint32_t) all = u32sample_to_itr(
+        &(IterSample(uint32_t)){.p = 1, .rng = itpl_rng_seed(42), .src = u32arr_to_iter(arr, SAMPLESZ)});
+    Iterable(uint32_t) none = u32sample_to_itr(
+        &(IterSample(uint32_t)){.p = 0, .rng = itpl_rng_seed(42), .src = u32arr_to_iter(arr, SAMPLESZ)});
+    if (fold_u32_u32(all, 0, add_u32) != SAMPLESZ * (SAMPLESZ - 1) / 2 || is_just(none.tc->next(none.self))) {
+        fprintf(stderr, "%s: Expected all elements with p = 1, and none with p = 0\n", __func__);
+        return false;
+    }
+
+    /* Pick distinct elements with reservoir sampling, or all of them if there are too few */
+    uint32_t picked[RESERVOIRSZ];
+    ItplRng rng         = itpl_rng_seed(42);
+    size_t const npick  = reservoir_u32(u32arr_to_iter(arr, SAMPLESZ), picked, RESERVOIRSZ, &rng);
+    bool seen[SAMPLESZ] = {0};
+    for (size_t i = 0; i < npick; i++) {
+        if (picked[i] >= SAMPLESZ || seen[picked[i]]) {
+            fprintf(stderr, "%s: Picked an invalid or repeated element: %" PRIu32 "\n", __func__, picked[i]);
+            return false;
+        }
+        seen[picked[i]] = true;
+    }
+    size_t const nfew = reservoir_u32(u32arr_to_iter(arr, RESERVOIRSZ / 2), picked, RESERVOIRSZ, &rng);
+    if (npick != RESERVOIRSZ || nfew != RESERVOIRSZ / 2) {
+        fprintf(stderr, "%s: Expected: (%u, %u) Actual: (%zu, %zu)\n", __func__, RESERVOIRSZ, RESERVOIRSZ / 2, npick,
+            nfew);
+        return false;
+    }
+    if (itpl_rng_below(&rng, 0) != 0 || itpl_rng_below(&rng, 1) != 0) {
+        fprintf(stderr, "%s: Expected 0 from an empty or single element range\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+#define SKETCHSZ 10000U
+#define NDISTINCT 600U
+
+static double u32_to_double(uint32_t x) { return x; }
+
+static bool test_sketch(void)
+{
+    /* A permutation of 0..SKETCHSZ-1 */
+    static uint32_t arr[SKETCHSZ];
+    for (size_t i = 0; i < SKETCHSZ; i++) {
+        arr[i] = (uint32_t)(i * 7919 % SKETCHSZ);
+    }
+    for (size_t i = 0; i < SKETCHSZ; i++) {
+        arr[i] %= NDISTINCT;
+    }
+
+    /* Count the distinct elements of the whole array, and of each half separately (merged afterwards) */
+    ItplHll hll = {0}, fsthalf = {0}, sndhalf = {0};
+    double const est = count_distinct_u32(u32arr_to_iter(arr, SKETCHSZ), &hll, hash_u32);
+    count_distinct_u32(u32arr_to_iter(arr, SKETCHSZ / 2), &fsthalf, hash_u32);
+    count_distinct_u32(u32arr_to_iter(arr + SKETCHSZ / 2, SKETCHSZ / 2), &sndhalf, hash_u32);
+    itpl_hll_merge(&fsthalf, &sndhalf);
+    unsigned char bytes[ITPL_HLL_SERIALIZED_SIZE];
+    ItplHll deserialized = {0};
+    itpl_hll_serialize(&fsthalf, bytes);
+    if (!itpl_hll_deserialize(&deserialized, bytes, sizeof(bytes)) || memcmp(&deserialized, &hll, sizeof(hll)) != 0) {
+        fprintf(stderr, "%s: Expected the merged and deserialized sketch to match\n", __func__);
+        return false;
+    }
+    if (est < NDISTINCT * 0.95 || est > NDISTINCT * 1.05) {
+        fprintf(stderr, "%s: Expected: ~%u Actual: %f\n", __func__, NDISTINCT, est);
+        return false;
+    }
+
+    /* Estimate quantiles of the whole permutation, and of each half separately (merged afterwards) */
+    for (size_t i = 0; i < SKETCHSZ; i++) {
+        arr[i] = (uint32_t)(i * 7919 % SKETCHSZ);
+    }
+    static ItplQSketch qs, qfsthalf, qsndhalf, qdeserialized;
+    static unsigned char qbytes[sizeof(ItplQSketch) * 2];
+    qsketch_u32(u32arr_to_iter(arr, SKETCHSZ), &qs, u32_to_double);
+    qsketch_u32(u32arr_to_iter(arr, SKETCHSZ / 2), &qfsthalf, u32_to_double);
+    qsketch_u32(u32arr_to_iter(arr + SKETCHSZ / 2, SKETCHSZ / 2), &qsndhalf, u32_to_double);
+    itpl_qsketch_merge(&qfsthalf, &qsndhalf);
+    size_t const qlen = itpl_qsketch_serialized_size(&qfsthalf);
+    itpl_qsketch_serialize(&qfsthalf, qbytes);
+    if (!itpl_qsketch_deserialize(&qdeserialized, qbytes, qlen) || qdeserialized.n != SKETCHSZ) {
+        fprintf(stderr, "%s: Expected the quantile sketch to deserialize\n", __func__);
+        return false;
+    }
+    double const quantiles[] = {0.1, 0.5, 0.9, 0.99};
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(*quantiles); i++) {
+        double const whole    = itpl_qsketch_quantile(&qs, quantiles[i]);
+        double const merged   = itpl_qsketch_quantile(&qfsthalf, quantiles[i]);
+        double const restored = itpl_qsketch_quantile(&qdeserialized, quantiles[i]);
+        double const expected = quantiles[i] * SKETCHSZ;
+        if (fabs(whole - expected) > SKETCHSZ * 0.03 || fabs(merged - expected) > SKETCHSZ * 0.03 ||
+            restored != merged) {
+            fprintf(stderr, "%s: Expected: ~%f Actual: (%f, %f, %f)\n", __func__, expected, whole, merged, restored);
+            return false;
+        }
+    }
+    return true;
+}
+
+#define SEMIJOINSZ 3000U
+
+/* Count the elements yielded by a semi join of 0..SEMIJOINSZ-1 (scaled by `scale`) against `set`, and check that every
+ * element yielded passes `expected` */
+static size_t semijoin_count(ItplKeySet const* set, uint32_t scale, bool (*expected)(uint32_t x), bool* ok)
+{
+    static uint32_t arr[SEMIJOINSZ];
+    for (uint32_t i = 0; i < SEMIJOINSZ; i++) {
+        arr[i] = i * scale;
+    }
+    IterSemiJoin(uint32_t) sj = {.set = set, .key = u32_key, .src = u32arr_to_iter(arr, SEMIJOINSZ)};
+    size_t n                  = 0;
+    uint32_t prev             = 0;
+    foreach (uint32_t, x, u32semijoin_to_itr(&sj)) {
+        if ((n > 0 && x <= prev) || (expected != NULL && !expected(x))) {
+            *ok = false;
+        }
+        prev = x;
+        n++;
+    }
+    return n;
+}
+
+static bool multiple_of_3(uint32_t x) { return x % 3 == 0; }
+static bool in_sparse(uint32_t x) { return x % (3 * 7919) == 0 && x / (3 * 7919) < SEMIJOINSZ; }
+
+static bool test_semijoin(void)
+{
+    static uint32_t keys[SEMIJOINSZ];
+    for (uint32_t i = 0; i < SEMIJOINSZ; i++) {
+        keys[i] = i * 3;
+    }
+    bool ok = true;
+
+    /* Dense keys, the set is a bitmap */
+    ItplKeySet dense;
+    if (!build_u32set(u32arr_to_iter(keys, SEMIJOINSZ / 3), &dense, u32_key, false) || !dense.dense) {
+        fprintf(stderr, "%s: Expected a bitmap for dense keys\n", __func__);
+        return false;
+    }
+    size_t const ndense = semijoin_count(&dense, 1, multiple_of_3, &ok);
+    itpl_keyset_free(&dense);
+    if (!ok || ndense != SEMIJOINSZ / 3) {
+        fprintf(stderr, "%s: Expected: %u Actual: %zu\n", __func__, SEMIJOINSZ / 3, ndense);
+        return false;
+    }
+
+    /* Sparse keys, the set is a bloom filter */
+    for (uint32_t i = 0; i < SEMIJOINSZ; i++) {
+        keys[i] = i * 3 * 7919;
+    }
+    ItplKeySet exact, approx;
+    if (!build_u32set(u32arr_to_iter(keys, SEMIJOINSZ), &exact, u32_key, true) ||
+        !build_u32set(u32arr_to_iter(keys, SEMIJOINSZ), &approx, u32_key, false) || exact.dense || approx.dense) {
+        fprintf(stderr, "%s: Expected bloom filters for sparse keys\n", __func__);
+        return false;
+    }
+    /* Probe with multiples of 7 * 7919, some of which are keys */
+    size_t expected = 0;
+    for (uint32_t i = 0; i < SEMIJOINSZ; i++) {
+        expected += in_sparse(i * 7 * 7919);
+    }
+    size_t const nexact  = semijoin_count(&exact, 7 * 7919, in_sparse, &ok);
+    size_t const napprox = semijoin_count(&approx, 7 * 7919, NULL, &ok);
+    itpl_keyset_free(&exact);
+    itpl_keyset_free(&approx);
+    /* The bloom filter alone finds every key, and lets through a few false positives */
+    if (!ok || nexact != expected || napprox < expected || napprox > expected + SEMIJOINSZ / 100) {
+        fprintf(
+            stderr, "%s: Expected: (%zu, ~%zu) Actual: (%zu, %zu)\n", __func__, expected, expected, nexact, napprox);
+        return false;
+    }
+    return true;
+}
+
+#ifdef ITPLUS_INSTRUMENT
+static void count_stats(ItplStats const* stats, unsigned depth, void* ctx)
+{
+    (void)stats;
+    unsigned* const maxdepth = ctx;
+    *maxdepth                = depth > *maxdepth ? depth : *maxdepth;
+}
+#endif /* ITPLUS_INSTRUMENT */
+
+static bool test_instrument(void)
+{
+    uint32_t arr[FIBSEQ_MINSZ * 4];
+    for (uint32_t i = 0; i < FIBSEQ_MINSZ * 4; i++) {
+        arr[i] = i;
+    }
+    /* Take the first FIBSEQ_MINSZ even numbers */
+    Iterable(uint32_t) it = take(filter(u32arr_to_iter(arr, FIBSEQ_MINSZ * 4), is_even), FIBSEQ_MINSZ);
+    size_t n              = 0;
+    foreach (uint32_t, x, it) {
+        (void)x;
+        n++;
+    }
+    ItplStats const* const stats = itpl_stats_of(it);
+#ifdef ITPLUS_INSTRUMENT
+    unsigned maxdepth = 0;
+    itpl_stats_walk(stats, 0, count_stats, &maxdepth);
+    if (n != FIBSEQ_MINSZ || stats == NULL || strcmp(stats->name, "IterTake(uint32_t)*") != 0 ||
+        stats->yielded != FIBSEQ_MINSZ || stats->calls != FIBSEQ_MINSZ + 1 || stats->nsrcs != 1 ||
+        stats->srcs[0] == NULL || stats->srcs[0]->yielded != FIBSEQ_MINSZ || stats->srcs[0]->nsrcs != 1 ||
+        stats->srcs[0]->srcs[0] != NULL || maxdepth != 2) {
+        fprintf(stderr, "%s: Unexpected stats:-\n", __func__);
+        itpl_stats_dump(stderr, stats);
+        return false;
+    }
+#else
+    /* Nothing is recorded without ITPLUS_INSTRUMENT */
+    if (n != FIBSEQ_MINSZ || stats != NULL) {
+        fprintf(stderr, "%s: Expected: %u elements and no stats Actual: %zu elements\n", __func__, FIBSEQ_MINSZ, n);
+        return false;
+    }
+#endif /* ITPLUS_INSTRUMENT */
+    return true;
+}
+
+#define TRACESZ 100U
+#define TRACEBATCH 32U
+
+static bool test_trace(void)
+{
+    uint32_t arr[TRACESZ];
+    for (uint32_t i = 0; i < TRACESZ; i++) {
+        arr[i] = i;
+    }
+    ItplTraceEvent events[8], fewevents[2];
+    ItplTraceBuf bufs[] = {{.events = events, .cap = 8, .tid = 1}, {.events = fewevents, .cap = 2, .tid = 2}};
+    /* Trace the same elements on 2 (pretend) threads, the second one with room for fewer spans */
+    for (size_t t = 0; t < 2; t++) {
+        IterTrace(uint32_t) tr = {
+            .name = "\"stage\"", .buf = bufs + t, .batch = TRACEBATCH, .src = u32arr_to_iter(arr, TRACESZ)};
+        uint32_t expected = 0;
+        foreach (uint32_t, x, u32trace_to_itr(&tr)) {
+            if (x != expected++) {
+                fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 "\n", __func__, expected - 1, x);
+                return false;
+            }
+        }
+    }
+    if (bufs[0].len != 4 || bufs[0].dropped != 0 || bufs[1].len != 2 || bufs[1].dropped != 2 ||
+        events[0].count != TRACEBATCH || events[3].count != TRACESZ % TRACEBATCH || events[3].end < events[0].start) {
+        fprintf(stderr, "%s: Expected: 4 and 2 spans Actual: %zu and %zu spans\n", __func__, bufs[0].len, bufs[1].len);
+        return false;
+    }
+
+    /* Export, and count the spans in the output */
+    FILE* const f = tmpfile();
+    if (f == NULL || !itpl_trace_write_json(f, bufs, 2)) {
+        fprintf(stderr, "%s: Could not write the trace\n", __func__);
+        return false;
+    }
+    rewind(f);
+    char line[256];
+    size_t nspans = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        nspans += strstr(line, "{\"name\":\"\\\"stage\\\"\",\"cat\":\"iterplus\",\"ph\":\"X\"") != NULL;
+    }
+    fclose(f);
+    if (nspans != 6) {
+        fprintf(stderr, "%s: Expected: 6 Actual: %zu\n", __func__, nspans);
+        return false;
+    }
+    return true;
+}
+
+static bool test_utf8(void)
+{
+    /* Valid sequences of every length, a long ASCII run, then invalid ones- a truncated sequence followed by ASCII, an
+     * overlong encoding, a surrogate, a code point above U+10FFFF, and a truncated sequence at the end */
+    static char const text[] = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80 plain ascii text, long enough for a few words"
+                               "\xE2\x82X\xC0\x80\xED\xA0\x80\xF4\x90\xF0\x9F\x98";
+    static uint32_t const expected[] = {'a', 0xE9, 0x20AC, 0x1F600, ' ', 'p', 'l', 'a', 'i', 'n', ' ', 'a', 's', 'c',
+        'i', 'i', ' ', 't', 'e', 'x', 't', ',', ' ', 'l', 'o', 'n', 'g', ' ', 'e', 'n', 'o', 'u', 'g', 'h', ' ', 'f',
+        'o', 'r', ' ', 'a', ' ', 'f', 'e', 'w', ' ', 'w', 'o', 'r', 'd', 's', 0xFFFD, 'X', 0xFFFD, 0xFFFD, 0xFFFD,
+        0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD};
+    size_t const explen              = sizeof(expected) / sizeof(*expected);
+    unsigned char const* const bytes = (unsigned char const*)text;
+    size_t const len                 = sizeof(text) - 1;
+
+    IterUtf8 u = {.buf = bytes, .len = len};
+    size_t i   = 0;
+    foreach (uint32_t, cp, utf8_to_itr(&u)) {
+        if (i >= explen || cp != expected[i]) {
+            fprintf(stderr, "%s: Expected: %" PRIx32 " Actual: %" PRIx32 " at index: %zu\n", __func__,
+                i < explen ? expected[i] : 0, cp, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != explen || !u.invalid) {
+        fprintf(stderr, "%s: Expected: %zu code points Actual: %zu\n", __func__, explen, i);
+        return false;
+    }
+
+    /* Decode in batches of 7 code points */
+    uint32_t out[sizeof(expected) / sizeof(*expected)];
+    size_t pos = 0, n = 0;
+    bool invalid = false;
+    while (pos < len) {
+        n += itpl_utf8_decode(bytes, len, &pos, out + n, explen - n < 7 ? explen - n : 7, ITPL_UTF8_REPLACE, &invalid);
+    }
+    if (n != explen || !invalid || memcmp(out, expected, sizeof(expected)) != 0) {
+        fprintf(stderr, "%s: Expected: %zu code points from batches Actual: %zu\n", __func__, explen, n);
+        return false;
+    }
+
+    /* Stop at the first invalid sequence, in both modes of iteration */
+    IterUtf8 s = {.buf = bytes, .len = len, .mode = ITPL_UTF8_STOP};
+    i          = 0;
+    foreach (uint32_t, cp, utf8_to_itr(&s)) {
+        (void)cp;
+        i++;
+    }
+    pos     = 0;
+    invalid = false;
+    n       = itpl_utf8_decode(bytes, len, &pos, out, explen, ITPL_UTF8_STOP, &invalid);
+    /* The first invalid sequence is the truncated one right before 'X' */
+    size_t const stop = (size_t)(strchr(text, 'X') - text) - 2;
+    if (i != 50 || s.pos != stop || n != 50 || pos != stop || !invalid) {
+        fprintf(stderr, "%s: Expected to stop after 50 code points Actual: %zu, %zu\n", __func__, i, n);
+        return false;
+    }
+    return true;
+}
+
+/* Check that splitting yields exactly the expected pieces, `expected` is terminated by NULL */
+static bool split_matches(IterSplit* x, char const* const* expected, char const* fname)
+{
+    size_t i = 0;
+    foreach (Slice(char), piece, split_to_itr(x)) {
+        if (expected[i] == NULL || strlen(expected[i]) != piece.len || memcmp(expected[i], piece.ptr, piece.len) != 0) {
+            fprintf(stderr, "%s: Expected: \"%s\" Actual: \"%.*s\" at index: %zu\n", fname,
+                expected[i] == NULL ? "(end)" : expected[i], (int)piece.len, piece.ptr, i);
+            return false;
+        }
+        i++;
+    }
+    if (expected[i] != NULL) {
+        fprintf(stderr, "%s: Expected: \"%s\" Actual: (end) at index: %zu\n", fname, expected[i], i);
+        return false;
+    }
+    return true;
+}
+
+static bool test_split(void)
+{
+    static char const csv[]   = "a,b,,c,";
+    static char const multi[] = "x::y:::z";
+    static char const mixed[] = "a;b,c";
+    static char const text[]  = "  hello \t world\n";
+    ItplByteSet const punct   = itpl_byteset_of(",;");
+    ItplByteSet const ws      = itpl_byteset_whitespace();
+    return split_matches(&(IterSplit){.buf = csv, .len = sizeof(csv) - 1, .delim = ",", .delimlen = 1},
+               (char const* const[]){"a", "b", "", "c", "", NULL}, __func__) &&
+        split_matches(&(IterSplit){.buf = multi, .len = sizeof(multi) - 1, .delim = "::", .delimlen = 2},
+            (char const* const[]){"x", "y", ":z", NULL}, __func__) &&
+        split_matches(&(IterSplit){.buf = mixed, .len = sizeof(mixed) - 1, .set = &punct},
+            (char const* const[]){"a", "b", "c", NULL}, __func__) &&
+        split_matches(&(IterSplit){.buf = text, .len = sizeof(text) - 1, .set = &ws, .skip_empty = true},
+            (char const* const[]){"hello", "world", NULL}, __func__) &&
+        split_matches(&(IterSplit){.buf = "", .len = 0, .delim = ",", .delimlen = 1}, (char const* const[]){"", NULL},
+            __func__) &&
+        split_matches(&(IterSplit){.buf = "", .len = 0, .set = &ws, .skip_empty = true}, (char const* const[]){NULL},
+            __func__);
+}
+
+#define CSV_MAXFIELDS 3U
+
+/* Keep the records whose second field is not empty */
+static bool has_second(ItplCsvRecord rec) { return rec.len > 1 && rec.fields[1].len > 0; }
+
+static bool test_csv(void)
+{
+    static char const data[] = "name,age,quote\r\n"
+                               "alice,30,\"hello, \"\"world\"\"\"\n"
+                               "bob,,\"multi\nline\"\n"
+                               "\n"
+                               "carol,41,x,extra\n";
+    static char const* const expected[][CSV_MAXFIELDS] = {
+        {"name", "age", "quote"}, {"alice", "30", "hello, \"world\""}, {"carol", "41", "x"}};
+    ItplCsvField fields[CSV_MAXFIELDS];
+    IterCsv csv                  = {.buf = data, .len = sizeof(data) - 1, .fields = fields, .cap = CSV_MAXFIELDS};
+    IterFilt(ItplCsvRecord) filt = {.pred = has_second, .src = csv_to_itr(&csv)};
+    size_t i                     = 0;
+    foreach (ItplCsvRecord, rec, csvfilt_to_itr(&filt)) {
+        /* The last record has an extra field, that does not fit */
+        if (i == sizeof(expected) / sizeof(*expected) || rec.len != CSV_MAXFIELDS ||
+            rec.nfields != CSV_MAXFIELDS + (i == 2)) {
+            fprintf(stderr, "%s: Unexpected record at index: %zu\n", __func__, i);
+            return false;
+        }
+        for (size_t j = 0; j < CSV_MAXFIELDS; j++) {
+            char field[32];
+            size_t const len = itpl_csv_unquote(rec.fields[j], field);
+            if (len != strlen(expected[i][j]) || memcmp(field, expected[i][j], len) != 0) {
+                fprintf(stderr, "%s: Expected: %s Actual: %.*s\n", __func__, expected[i][j], (int)len, field);
+                return false;
+            }
+        }
+        i++;
+    }
+    if (i != sizeof(expected) / sizeof(*expected) || csv.malformed) {
+        fprintf(stderr, "%s: Expected: %zu records Actual: %zu\n", __func__, sizeof(expected) / sizeof(*expected), i);
+        return false;
+    }
+
+    /* TSV, with a malformed quoted field */
+    static char const tsv[] = "a\t\"b\"c\td";
+    IterCsv t               = {.buf = tsv, .len = sizeof(tsv) - 1, .fields = fields, .cap = CSV_MAXFIELDS};
+    t.delim                 = '\t';
+
+    Iterable(ItplCsvRecord) const tsvit = csv_to_itr(&t);
+    Maybe(ItplCsvRecord) const rec      = tsvit.tc->next(tsvit.self);
+    if (is_nothing(rec) || from_just_(rec).len != 3 || fields[1].len != 1 || fields[2].len != 1 || !t.malformed) {
+        fprintf(stderr, "%s: Expected 3 fields from the TSV record\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+/* Keep the records of adults */
+static bool is_adult(ItplJsonRecord rec)
+{
+    ItplJsonMember m;
+    long long age;
+    return itpl_json_get(rec, "age", &m) && itpl_json_as_int(&m, &age) && age >= 18;
+}
+
+/* Extract the id of a record */
+static uint32_t record_id(ItplJsonRecord rec)
+{
+    ItplJsonMember m;
+    long long id;
+    return itpl_json_get(rec, "id", &m) && itpl_json_as_int(&m, &id) ? (uint32_t)id : UINT32_MAX;
+}
+
+static bool test_ndjson(void)
+{
+    static char const data[] = "{\"id\": 1, \"meta\": {\"age\": 5, \"s\": \"}\"}, \"age\": 30,"
+                               " \"tags\": [\"a\", [1]]}\n"
+                               "{\"id\":2,\"age\":17}\r\n"
+                               "\n"
+                               " \t\r\n"
+                               "{\"age\":\"n/a\",\"id\":3}\n"
+                               "{\"id\":4,\"age\":18}";
+    static uint32_t const expected[] = {1, 4};
+
+    IterNdjson nd                         = {.buf = data, .len = sizeof(data) - 1};
+    IterFilt(ItplJsonRecord) filt         = {.pred = is_adult, .src = ndjson_to_itr(&nd)};
+    IterMap(ItplJsonRecord, uint32_t) ids = {.f = record_id, .src = ndjsonfilt_to_itr(&filt)};
+    size_t i                              = 0;
+    foreach (uint32_t, id, ndjsonu32map_to_itr(&ids)) {
+        if (i == sizeof(expected) / sizeof(*expected) || id != expected[i]) {
+            fprintf(stderr, "%s: Unexpected id %" PRIu32 " at index: %zu\n", __func__, id, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != sizeof(expected) / sizeof(*expected)) {
+        fprintf(stderr, "%s: Expected: %zu records Actual: %zu\n", __func__, sizeof(expected) / sizeof(*expected), i);
+        return false;
+    }
+
+    /* Blank lines are skipped, and the last record ends the buffer without a newline */
+    IterNdjson all                   = {.buf = data, .len = sizeof(data) - 1};
+    Iterable(ItplJsonRecord) allrecs = ndjson_to_itr(&all);
+    i                                = 0;
+    foreach (ItplJsonRecord, r, allrecs) {
+        if (r.len == 0 || r.ptr[0] != '{' || r.ptr[r.len - 1] != '}') {
+            fprintf(stderr, "%s: Unexpected record: %.*s\n", __func__, (int)r.len, r.ptr);
+            return false;
+        }
+        i++;
+    }
+    if (i != 4 || all.pos != all.len) {
+        fprintf(stderr, "%s: Expected: 4 records ending at: %zu Actual: %zu ending at: %zu\n", __func__, all.len, i,
+            all.pos);
+        return false;
+    }
+
+    /* Index a record with every kind of value */
+    static char const rec[] = " { \"name\" : \"caf\\u00e9 \\\"\\ud83d\\ude00\\\"\", \"score\": -1.25e1, \"ok\": true,"
+                              " \"none\": null } ";
+    ItplJsonMember members[8];
+    size_t const n = itpl_json_index((ItplJsonRecord){.ptr = rec, .len = sizeof(rec) - 1}, members, 8);
+    if (n != 4) {
+        fprintf(stderr, "%s: Expected: 4 members Actual: %zu\n", __func__, n);
+        return false;
+    }
+    ItplJsonMember const* const name  = itpl_json_find(members, n, "name");
+    ItplJsonMember const* const score = itpl_json_find(members, n, "score");
+    ItplJsonMember const* const ok    = itpl_json_find(members, n, "ok");
+    char const* str;
+    size_t len;
+    char buf[32];
+    double x;
+    bool b;
+    if (name == NULL || !itpl_json_as_str(name, &str, &len) || score == NULL || !itpl_json_as_double(score, &x) ||
+        x != -12.5 || ok == NULL || !itpl_json_as_bool(ok, &b) || !b || itpl_json_find(members, n, "id") != NULL) {
+        fprintf(stderr, "%s: Unexpected member values\n", __func__);
+        return false;
+    }
+    static char const decoded[] = "caf\xC3\xA9 \"\xF0\x9F\x98\x80\"";
+    len                         = itpl_json_unescape(str, len, buf);
+    if (len != sizeof(decoded) - 1 || memcmp(buf, decoded, len) != 0) {
+        fprintf(stderr, "%s: Unexpected decoded string: %.*s\n", __func__, (int)len, buf);
+        return false;
+    }
+
+    /* Malformed records */
+    static char const* const bad[] = {"[1, 2]", "{\"a\": }", "{\"a\": \"b}", "{\"a\" 1}"};
+    for (size_t j = 0; j < sizeof(bad) / sizeof(*bad); j++) {
+        if (itpl_json_index((ItplJsonRecord){.ptr = bad[j], .len = strlen(bad[j])}, members, 8) != SIZE_MAX) {
+            fprintf(stderr, "%s: Expected record to be malformed: %s\n", __func__, bad[j]);
+            return false;
+        }
+    }
+    return true;
+}
+
+#define RECSTREAM_BLKSZ 64U
+
+/* Read all of a file into a buffer */
+static size_t read_all(FILE* f, uint64_t* buf, size_t cap)
+{
+    rewind(f);
+    return fread(buf, 1, cap * sizeof(*buf), f);
+}
+
+static bool test_recstream(void)
+{
+    uint32_t arr[FIBSEQ_MINSZ * 15] = {0, 1};
+    for (size_t i = 2; i < FIBSEQ_MINSZ * 15; i++) {
+        arr[i] = arr[i - 1] + arr[i - 2];
+    }
+    size_t const arrlen = sizeof(arr) / sizeof(*arr);
+    /* The stream is read from an 8 byte aligned buffer */
+    static uint64_t stream[512];
+    unsigned char blk[RECSTREAM_BLKSZ];
+
+    FILE* const f = tmpfile();
+    if (f == NULL) {
+        fprintf(stderr, "%s: Could not create a temporary file\n", __func__);
+        return false;
+    }
+    /* A block this small splits the stream into many */
+    ItplRecWriter w = {.f = f, .buf = blk, .cap = RECSTREAM_BLKSZ, .elsize = sizeof(uint32_t), .checksum = true};
+    bool const ok   = write_u32(u32arr_to_iter(arr, arrlen), &w);
+    size_t len      = read_all(f, stream, 512);
+    fclose(f);
+    if (!ok || len == 0 || len % 8 != 0) {
+        fprintf(stderr, "%s: Could not write the stream\n", __func__);
+        return false;
+    }
+
+    IterRecRead(uint32_t) r = {.rd = {.buf = (unsigned char const*)stream, .len = len}};
+    size_t i                = 0;
+    foreach (uint32_t, x, u32recread_to_itr(&r)) {
+        if (i == arrlen || x != arr[i]) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 " at index: %zu\n", __func__,
+                i < arrlen ? arr[i] : 0, x, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != arrlen || r.rd.corrupt) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, arrlen, i);
+        return false;
+    }
+
+    /* Flip a bit in the last block, which the checksum catches */
+    ((unsigned char*)stream)[len - 8] ^= 1;
+    IterRecRead(uint32_t) bad = {.rd = {.buf = (unsigned char const*)stream, .len = len}};
+    i                         = 0;
+    foreach (uint32_t, x, u32recread_to_itr(&bad)) {
+        (void)x;
+        i++;
+    }
+    if (i >= arrlen || !bad.rd.corrupt) {
+        fprintf(stderr, "%s: Expected the corrupted stream to be detected\n", __func__);
+        return false;
+    }
+
+    /* Variable length records, one of which is too large for the block buffer */
+    static char const* const strs[] = {"", "a", "hello, world",
+        "a record longer than the block buffer, which has to be written as a block of its own", "last"};
+    size_t const nstrs = sizeof(strs) / sizeof(*strs);
+    FILE* const vf     = tmpfile();
+    if (vf == NULL) {
+        fprintf(stderr, "%s: Could not create a temporary file\n", __func__);
+        return false;
+    }
+    ItplRecWriter vw = {.f = vf, .buf = blk, .cap = RECSTREAM_BLKSZ};
+    bool vok         = true;
+    for (size_t j = 0; j < nstrs; j++) {
+        vok = vok && itpl_rec_put(&vw, strs[j], strlen(strs[j]));
+    }
+    vok = vok && itpl_rec_flush(&vw);
+    len = read_all(vf, stream, 512);
+    fclose(vf);
+    if (!vok) {
+        fprintf(stderr, "%s: Could not write the variable length stream\n", __func__);
+        return false;
+    }
+    IterRecBytes rb = {.rd = {.buf = (unsigned char const*)stream, .len = len}};
+    i               = 0;
+    foreach (Slice(char), rec, recbytes_to_itr(&rb)) {
+        if (i == nstrs || rec.len != strlen(strs[i]) || memcmp(rec.ptr, strs[i], rec.len) != 0 ||
+            ((uintptr_t)rec.ptr) % 8 != 0) {
+            fprintf(stderr, "%s: Unexpected record at index: %zu\n", __func__, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != nstrs || rb.rd.corrupt) {
+        fprintf(stderr, "%s: Expected: %zu records Actual: %zu\n", __func__, nstrs, i);
+        return false;
+    }
+    return true;
+}
+
+#define INTCODEC_LEN 300U
+
+static bool test_intcodec(void)
+{
+    /* Sorted ids, with small gaps, and a few large ones */
+    uint32_t ids[INTCODEC_LEN];
+    uint32_t id = 7;
+    for (size_t i = 0; i < INTCODEC_LEN; i++) {
+        id     += i % 97 == 0 ? 1000000 : (uint32_t)(i % 13);
+        ids[i]  = id;
+    }
+    ids[INTCODEC_LEN - 1] = UINT32_MAX;
+    unsigned char buf[INTCODEC_LEN * sizeof(uint32_t)];
+    size_t len;
+
+    bool ok = varint_u32(u32deltaenc_to_itr(&(IterDeltaEncode(uint32_t)){.src = u32arr_to_iter(ids, INTCODEC_LEN)}),
+        buf, sizeof(buf), &len);
+    IterVarintDecode(uint32_t) v = {.buf = buf, .len = len};
+    if (!ok || len >= sizeof(ids) / 2 ||
+        !yields_u32arr(u32deltadec_to_itr(&(IterDeltaDecode(uint32_t)){.src = u32varint_to_itr(&v)}), ids, INTCODEC_LEN,
+            __func__) ||
+        v.malformed) {
+        fprintf(stderr, "%s: Varint round trip failed, encoded length: %zu\n", __func__, len);
+        return false;
+    }
+
+    ok = bitpack_u32(u32deltaenc_to_itr(&(IterDeltaEncode(uint32_t)){.src = u32arr_to_iter(ids, INTCODEC_LEN)}), buf,
+        sizeof(buf), &len);
+    IterBitpackDecode(uint32_t) b = {.buf = buf, .len = len};
+    if (!ok || len >= sizeof(ids) ||
+        !yields_u32arr(u32deltadec_to_itr(&(IterDeltaDecode(uint32_t)){.src = u32unpack_to_itr(&b)}), ids, INTCODEC_LEN,
+            __func__) ||
+        b.malformed) {
+        fprintf(stderr, "%s: Bit packing round trip failed, encoded length: %zu\n", __func__, len);
+        return false;
+    }
+
+    /* A buffer too small, and a truncated stream */
+    ok = bitpack_u32(u32arr_to_iter(ids, INTCODEC_LEN), buf, 64, &len);
+    IterBitpackDecode(uint32_t) trunc = {.buf = buf, .len = 8};
+    if (ok || !yields_u32arr(u32unpack_to_itr(&trunc), ids, 0, __func__) || !trunc.malformed) {
+        fprintf(stderr, "%s: Expected the truncated stream to be detected\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+#define LZ4_BLOCKSZ 4096U
+#define LZ4_DATALEN (LZ4_BLOCKSZ * 5 + 123)
+
+/* Compress `data` read in chunks of `chunksz`, and decompress it back read in chunks of `cchunksz` */
+static bool lz4_roundtrip(char const* data, size_t chunksz, size_t cchunksz, size_t* clen)
+{
+    static unsigned char cin[LZ4_BLOCKSZ], cout[ITPL_LZ4_FRAMEBOUND(LZ4_BLOCKSZ)];
+    static unsigned char din[ITPL_LZ4_FRAMEBOUND(LZ4_BLOCKSZ)], dout[LZ4_BLOCKSZ];
+    static char compressed[ITPL_LZ4_FRAMEBOUND(LZ4_BLOCKSZ) * 6];
+    IterArrChunks(char) chunks = {.size = chunksz, .len = LZ4_DATALEN, .arr = data};
+    IterLz4Compress(char) c    = {
+        .blocksize = LZ4_BLOCKSZ, .in = cin, .out = cout, .src = chararrchunks_to_itr(&chunks)};
+    *clen                      = 0;
+    foreach (Slice(char), blk, lz4c_to_itr(&c)) {
+        memcpy(compressed + *clen, blk.ptr, blk.len);
+        *clen += blk.len;
+    }
+
+    IterArrChunks(char) cchunks = {.size = cchunksz, .len = *clen, .arr = compressed};
+    IterLz4Decompress(char) d   = {
+        .blocksize = LZ4_BLOCKSZ, .in = din, .out = dout, .src = chararrchunks_to_itr(&cchunks)};
+    size_t pos                  = 0;
+    foreach (Slice(char), blk, lz4d_to_itr(&d)) {
+        if (blk.len > LZ4_DATALEN - pos || memcmp(blk.ptr, data + pos, blk.len) != 0) {
+            fprintf(stderr, "%s: Unexpected block at offset: %zu\n", __func__, pos);
+            return false;
+        }
+        pos += blk.len;
+    }
+    if (pos != LZ4_DATALEN || d.malformed) {
+        fprintf(stderr, "%s: Expected: %u bytes Actual: %zu\n", __func__, LZ4_DATALEN, pos);
+        return false;
+    }
+    return true;
+}
+
+static bool test_lz4(void)
+{
+    /* Text with a lot of repetition, and noise that does not compress */
+    static char text[LZ4_DATALEN], noise[LZ4_DATALEN];
+    static char const* const words[] = {"iterator ", "chunk ", "block ", "compress ", "lz4 ", "stream "};
+    uint32_t x                       = 2463534242U;
+    for (size_t i = 0; i < LZ4_DATALEN;) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        for (char const* w = words[x % 6]; *w != '\0' && i < LZ4_DATALEN; w++) {
+            text[i++] = *w;
+        }
+    }
+    for (size_t i = 0; i < LZ4_DATALEN; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        noise[i] = (char)(x & 0xFF);
+    }
+
+    size_t clen;
+    /* Chunks smaller than, larger than, and straddling blocks */
+    if (!lz4_roundtrip(text, 1000, 7, &clen) || clen >= LZ4_DATALEN / 2 || !lz4_roundtrip(text, 10000, 100000, &clen) ||
+        !lz4_roundtrip(noise, 333, 4100, &clen) || clen > ITPL_LZ4_FRAMEBOUND(LZ4_DATALEN) + 20) {
+        fprintf(stderr, "%s: Round trip failed, compressed length: %zu\n", __func__, clen);
+        return false;
+    }
+
+    /* A corrupted block */
+    static unsigned char blk[ITPL_LZ4_FRAMEBOUND(LZ4_BLOCKSZ)], out[LZ4_BLOCKSZ];
+    size_t const n = itpl_lz4_frame((unsigned char const*)text, LZ4_BLOCKSZ, blk);
+    size_t len;
+    blk[4] = 0xF0;
+    if (itpl_lz4_unframe(blk, out, LZ4_BLOCKSZ, &len) != NULL || n >= LZ4_BLOCKSZ) {
+        fprintf(stderr, "%s: Expected the corrupted block to be detected\n", __func__);
+        return false;
+    }
+
+    /* A stored block larger than the room given for one */
+    itpl_lz4_frame((unsigned char const*)noise, LZ4_BLOCKSZ, blk);
+    if (itpl_lz4_unframe(blk, out, LZ4_BLOCKSZ - 1, &len) != NULL ||
+        itpl_lz4_unframe(blk, out, LZ4_BLOCKSZ, &len) != blk + 4 || len != LZ4_BLOCKSZ) {
+        fprintf(stderr, "%s: Expected a stored block to be checked against the block size\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+#define GEN_PAIRSN 13U
+#define GEN_BUFSZ  10U
+
+static bool test_gen(void)
+{
+    /* The generators must yield the same as their hand written counterparts */
+    uint32_t expected[GEN_PAIRSN * GEN_PAIRSN];
+    size_t len = 0;
+    for (uint32_t i = 0; i < GEN_PAIRSN; i++) {
+        for (uint32_t j = 0; j < i; j++) {
+            expected[len++] = i * 100 + j;
+        }
+    }
+    Iterable(uint32_t) const fib    = get_fibitr();
+    Iterable(uint32_t) const fibgen = take(fibgen_to_itr(&(FibGen){0}), FIBSEQ_MINSZ * 4);
+    foreach (uint32_t, x, fibgen) {
+        Maybe(uint32_t) const y = fib.tc->next(fib.self);
+        if (is_nothing(y) || x != from_just_(y)) {
+            fprintf(stderr, "%s: Expected: %" PRIu32 " Actual: %" PRIu32 "\n", __func__, from_just_(y), x);
+            return false;
+        }
+    }
+    if (!yields_u32arr(u32pairs_to_itr(&(U32Pairs){.n = GEN_PAIRSN}), expected, len, __func__)) {
+        return false;
+    }
+
+    /* Filling a buffer at a time, from the generator, and from any iterable */
+    U32Pairs gen                = {.n = GEN_PAIRSN};
+    Iterable(uint32_t) const it = u32pairs_to_itr(&(U32Pairs){.n = GEN_PAIRSN});
+    uint32_t buf[GEN_BUFSZ], buf2[GEN_BUFSZ];
+    size_t n, total = 0;
+    /* An empty buffer is left alone, without resuming the generator */
+    buf[0] = UINT32_MAX;
+    if (fill_u32pairs(&gen, buf, 0) != 0 || fill_u32(it, buf, 0) != 0 || buf[0] != UINT32_MAX) {
+        fprintf(stderr, "%s: Expected nothing to be written into an empty buffer\n", __func__);
+        return false;
+    }
+    while ((n = fill_u32pairs(&gen, buf, GEN_BUFSZ)) > 0) {
+        if (n > len - total || memcmp(buf, expected + total, n * sizeof(*buf)) != 0 ||
+            fill_u32(it, buf2, GEN_BUFSZ) != n || memcmp(buf, buf2, n * sizeof(*buf)) != 0) {
+            fprintf(stderr, "%s: Unexpected buffer at index: %zu\n", __func__, total);
+            return false;
+        }
+        total += n;
+    }
+    if (total != len || fill_u32pairs(&gen, buf, GEN_BUFSZ) != 0 || fill_u32(it, buf2, GEN_BUFSZ) != 0) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", __func__, len, total);
+        return false;
+    }
+    return true;
+}
+
+#define BLOCKREAD_DATALEN 10000U
+#define BLOCKREAD_BLKSZ   1024U
+#define BLOCKREAD_DEPTH   3U
+#define BLOCKREAD_OFF     1500U
+
+/* A backend over a buffer that only reads in `wait`, like an asynchronous one would complete then */
+typedef struct
+{
+    unsigned char const* data;
+    size_t len;
+    size_t inflight;
+    size_t maxinflight;
+    /* (Optional) The number of the submit to fail, counting from 1, and the offset of a read to fail */
+    size_t failsubmit;
+    size_t submits;
+    bool failread;
+    uint64_t failoff;
+} DeferredReads;
+
+static bool deferred_submit(void* ctx, ItplReadSlot* slot, size_t cap)
+{
+    DeferredReads* const dr = ctx;
+    if (++(dr->submits) == dr->failsubmit) {
+        return false;
+    }
+    slot->user = (void*)(uintptr_t)cap;
+    if (++(dr->inflight) > dr->maxinflight) {
+        dr->maxinflight = dr->inflight;
+    }
+    return true;
+}
+
+static void deferred_wait(void* ctx, ItplReadSlot* slot)
+{
+    DeferredReads* const dr = ctx;
+    size_t const cap        = (size_t)(uintptr_t)slot->user;
+    size_t const off        = slot->off < dr->len ? (size_t)slot->off : dr->len;
+    slot->len               = dr->len - off < cap ? dr->len - off : cap;
+    memcpy(slot->buf, dr->data + off, slot->len);
+    slot->failed = dr->failread && slot->off == dr->failoff;
+    dr->inflight--;
+}
+
+/* Check that the blocks read cover the first `len` bytes of `data` in order, with every block but the last full */
+static bool blocks_match(IterFileBlocks* fb, unsigned char const* data, size_t len, bool failed, char const* name)
+{
+    size_t total = 0;
+    foreach (Slice(char), blk, fileblocks_to_itr(fb)) {
+        if (blk.len > len - total || (blk.len != BLOCKREAD_BLKSZ && total + blk.len != len) ||
+            memcmp(blk.ptr, data + total, blk.len) != 0) {
+            fprintf(stderr, "%s: Unexpected block at offset: %zu\n", name, total);
+            return false;
+        }
+        total += blk.len;
+    }
+    if (total != len || fb->failed != failed || fb->inflight != 0) {
+        fprintf(stderr, "%s: Expected: %zu Actual: %zu\n", name, len, total);
+        return false;
+    }
+    return true;
+}
+
+static bool test_blockread(void)
+{
+    static unsigned char data[BLOCKREAD_DATALEN], bufs[BLOCKREAD_DEPTH][BLOCKREAD_BLKSZ];
+    for (size_t i = 0; i < BLOCKREAD_DATALEN; i++) {
+        data[i] = (unsigned char)(i * 31 + i / 251);
+    }
+    ItplReadSlot slots[BLOCKREAD_DEPTH] = {{.buf = bufs[0]}, {.buf = bufs[1]}, {.buf = bufs[2]}};
+
+    FILE* const f = tmpfile();
+    if (f == NULL) {
+        fprintf(stderr, "%s: Could not create a temporary file\n", __func__);
+        return false;
+    }
+    setvbuf(f, NULL, _IONBF, 0);
+    bool const written = fwrite(data, 1, BLOCKREAD_DATALEN, f) == BLOCKREAD_DATALEN && fflush(f) == 0;
+    rewind(f);
+    IterFileBlocks fb = {
+        .backend = itpl_stdio_backend(f), .slots = slots, .depth = BLOCKREAD_DEPTH, .blocksize = BLOCKREAD_BLKSZ};
+    bool ok = written && blocks_match(&fb, data, BLOCKREAD_DATALEN, false, __func__);
+    /* Starting from an offset, which the file is positioned at */
+    IterFileBlocks offb = {.backend   = itpl_stdio_backend(f),
+                           .slots     = slots,
+                           .depth     = BLOCKREAD_DEPTH,
+                           .blocksize = BLOCKREAD_BLKSZ,
+                           .off       = BLOCKREAD_OFF};
+    ok = ok && blocks_match(&offb, data + BLOCKREAD_OFF, BLOCKREAD_DATALEN - BLOCKREAD_OFF, false, __func__);
+    fclose(f);
+    if (!ok) {
+        return false;
+    }
+
+    /* A file that's a multiple of the block size, read with all the slots' reads in flight at once */
+    DeferredReads dr   = {.data = data, .len = BLOCKREAD_BLKSZ * 5};
+    IterFileBlocks dfb = {.backend   = {.submit = deferred_submit, .wait = deferred_wait, .ctx = &dr},
+                          .slots     = slots,
+                          .depth     = BLOCKREAD_DEPTH,
+                          .blocksize = BLOCKREAD_BLKSZ};
+    if (!blocks_match(&dfb, data, dr.len, false, __func__)) {
+        return false;
+    }
+    if (dr.maxinflight != BLOCKREAD_DEPTH || dr.inflight != 0) {
+        fprintf(stderr, "%s: Expected %u reads in flight, Actual: %zu\n", __func__, BLOCKREAD_DEPTH, dr.maxinflight);
+        return false;
+    }
+
+    /* The blocks submitted before a failed submit are still yielded */
+    DeferredReads subfail   = {.data = data, .len = BLOCKREAD_BLKSZ * 5, .failsubmit = 3};
+    IterFileBlocks subfailb = {.backend   = {.submit = deferred_submit, .wait = deferred_wait, .ctx = &subfail},
+                               .slots     = slots,
+                               .depth     = BLOCKREAD_DEPTH,
+                               .blocksize = BLOCKREAD_BLKSZ};
+    /* The reads in flight past a failed read are waited for */
+    DeferredReads readfail   = {.data = data, .len = BLOCKREAD_BLKSZ * 5, .failread = true, .failoff = BLOCKREAD_BLKSZ};
+    IterFileBlocks readfailb = {.backend   = {.submit = deferred_submit, .wait = deferred_wait, .ctx = &readfail},
+                                .slots     = slots,
+                                .depth     = BLOCKREAD_DEPTH,
+                                .blocksize = BLOCKREAD_BLKSZ};
+    if (!blocks_match(&subfailb, data, BLOCKREAD_BLKSZ * 2, true, __func__) ||
+        !blocks_match(&readfailb, data, BLOCKREAD_BLKSZ, true, __func__)) {
+        return false;
+    }
+    if (subfail.inflight != 0 || readfail.inflight != 0) {
+        fprintf(stderr, "%s: Expected no reads in flight, Actual: %zu and %zu\n", __func__, subfail.inflight,
+            readfail.inflight);
+        return false;
+    }
+    return true;
+}
+
+#define FILES_COUNT 4U
+#define FILES_BUFSZ 64U
+
+/* Count the paths passed to the prefetch hook */
+static void record_prefetch(void* ctx, char const* path)
+{
+    size_t* const calls = ctx;
+    (void)path;
+    ++(*calls);
+}
+
+static bool test_files(void)
+{
+    static struct
+    {
+        char const* pat;
+        char const* s;
+        bool match;
+    } const globs[] = {{"*.log", "a.log", true}, {"*.log", "a.log.1", false}, {"a*b*c", "aXbYbZc", true},
+        {"a?c", "abc", true}, {"a?c", "ac", false}, {"[a-c]x", "bx", true}, {"[!a-c]x", "bx", false},
+        {"[]a]", "]", true}, {"[ab", "[ab", true}, {"**", "", true}, {"*x", "", false}};
+    for (size_t i = 0; i < sizeof(globs) / sizeof(*globs); i++) {
+        if (itpl_glob_match(globs[i].pat, globs[i].s) != globs[i].match) {
+            fprintf(stderr, "%s: Unexpected glob match of %s against %s\n", __func__, globs[i].s, globs[i].pat);
+            return false;
+        }
+    }
+
+    /* A pattern without a `/` only looks at the file names */
+    string const paths[]            = {"logs/a.log", "logs/b.txt", "c.log", "logs/x/d.log", "e.log.txt"};
+    size_t const pathslen           = sizeof(paths) / sizeof(*paths);
+    Iterable(string) const allpaths = strarr_to_iter(paths, pathslen);
+    size_t nlogs = 0, nsub = 0;
+    foreach (string, p, strglob_to_itr(&(IterGlob(string)){.pattern = "*.log", .src = allpaths})) {
+        (void)p;
+        nlogs++;
+    }
+    Iterable(string) const allpaths2 = strarr_to_iter(paths, pathslen);
+    foreach (string, p, strglob_to_itr(&(IterGlob(string)){.pattern = "logs/*.log", .src = allpaths2})) {
+        (void)p;
+        nsub++;
+    }
+    if (nlogs != 3 || nsub != 2) {
+        fprintf(stderr, "%s: Expected 3 and 2 matches, Actual: %zu and %zu\n", __func__, nlogs, nsub);
+        return false;
+    }
+
+    /* Files of different sizes, one of them empty */
+    string const names[FILES_COUNT] = {"itpl_files_0.tmp", "itpl_files_1.tmp", "itpl_files_2.tmp", "itpl_files_3.tmp"};
+    size_t const sizes[FILES_COUNT] = {100, 0, FILES_BUFSZ, 7};
+    static char expected[2][256];
+    size_t explen[2] = {0};
+    bool ok          = true;
+    for (size_t i = 0; i < FILES_COUNT; i++) {
+        FILE* const f = fopen(names[i], "wb");
+        if (f == NULL) {
+            ok = false;
+            break;
+        }
+        for (size_t j = 0; j < sizes[i]; j++) {
+            char const c                       = (char)('a' + (i * 7 + j) % 26);
+            ok                                 = ok && fputc(c, f) != EOF;
+            expected[i % 2][(explen[i % 2])++] = c;
+        }
+        ok = fclose(f) == 0 && ok;
+    }
+
+    /* Each of the 2 shards of the files reads its own in turn */
+    for (size_t k = 0; ok && k < 2; k++) {
+        static unsigned char buf[FILES_BUFSZ];
+        string ahead[2];
+        size_t calls                  = 0;
+        Iterable(string) const fnames = strarr_to_iter(names, FILES_COUNT);
+        Iterable(string) const mine   = strshard_to_itr(&(IterShard(string)){.n = 2, .k = k, .src = fnames});
+        IterFileContents(string) fc   = {.buf      = buf,
+                                         .cap      = FILES_BUFSZ,
+                                         .ahead    = ahead,
+                                         .depth    = 2,
+                                         .prefetch = record_prefetch,
+                                         .ctx      = &calls,
+                                         .src      = mine};
+        size_t total = 0;
+        foreach (Slice(char), blk, strcontents_to_itr(&fc)) {
+            /* Both of the shard's files are looked ahead before the first is read */
+            if (calls != 2 || blk.len > explen[k] - total || memcmp(blk.ptr, expected[k] + total, blk.len) != 0) {
+                fprintf(stderr, "%s: Unexpected block at offset: %zu of shard: %zu\n", __func__, total, k);
+                ok = false;
+                break;
+            }
+            total += blk.len;
+        }
+        if (ok && (total != explen[k] || fc.failed)) {
+            fprintf(stderr, "%s: Expected: %zu Actual: %zu in shard: %zu\n", __func__, explen[k], total, k);
+            ok = false;
+        }
+    }
+
+    /* A missing file */
+    if (ok) {
+        static unsigned char buf[FILES_BUFSZ];
+        string ahead[1];
+        string const missing[]      = {names[0], "itpl_files_missing.tmp"};
+        IterFileContents(string) fc = {
+            .buf = buf, .cap = FILES_BUFSZ, .ahead = ahead, .depth = 1, .src = strarr_to_iter(missing, 2)};
+        size_t total = 0;
+        foreach (Slice(char), blk, strcontents_to_itr(&fc)) {
+            total += blk.len;
+        }
+        if (total != sizes[0] || !fc.failed) {
+            fprintf(stderr, "%s: Expected the missing file to be detected\n", __func__);
+            ok = false;
+        }
+    }
+    for (size_t i = 0; i < FILES_COUNT; i++) {
+        remove(names[i]);
+    }
+    return ok;
+}
+
+#define PREFETCH_TABLESZ 1000U
+#define PREFETCH_IDXSZ   300U
+
+static uint64_t prefetch_table[PREFETCH_TABLESZ];
+static size_t prefetch_calls;
+
+static void const* table_addr(uint32_t i)
+{
+    prefetch_calls++;
+    return prefetch_table + i;
+}
+
+static bool test_prefetch(void)
+{
+    static uint32_t idxs[PREFETCH_IDXSZ];
+    uint32_t x = 2463534242U;
+    for (size_t i = 0; i < PREFETCH_IDXSZ; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        idxs[i] = x % PREFETCH_TABLESZ;
+    }
+    /* Distances shorter and longer than the source, and the default */
+    size_t const distances[] = {1, 3, 0, ITPLUS_PREFETCH_MAX * 2};
+    size_t const lens[]      = {PREFETCH_IDXSZ, PREFETCH_IDXSZ, PREFETCH_IDXSZ, 5};
+    for (size_t d = 0; d < sizeof(distances) / sizeof(*distances); d++) {
+        size_t const ahead =
+            distances[d] == 0 || distances[d] > ITPLUS_PREFETCH_MAX ? ITPLUS_PREFETCH_MAX : distances[d];
+        Iterable(uint32_t) const src = u32arr_to_iter(idxs, lens[d]);
+        Iterable(uint32_t) const it =
+            u32prefetch_to_itr(&(IterPrefetch(uint32_t)){.addr = table_addr, .distance = distances[d], .src = src});
+        size_t i       = 0;
+        prefetch_calls = 0;
+        foreach (uint32_t, idx, it) {
+            /* Every element is prefetched exactly once, `distance` elements before it's yielded */
+            size_t const expected = i + ahead < lens[d] ? i + ahead : lens[d];
+            if (i == lens[d] || idx != idxs[i] || prefetch_calls != expected) {
+                fprintf(stderr, "%s: Unexpected element at index: %zu with distance: %zu, prefetched: %zu\n", __func__,
+                    i, distances[d], prefetch_calls);
+                return false;
+            }
+            i++;
+        }
+        if (i != lens[d] || prefetch_calls != lens[d]) {
+            fprintf(stderr, "%s: Expected: %zu Actual: %zu with distance: %zu\n", __func__, lens[d], i, distances[d]);
+            return false;
+        }
+    }
+    return true;
+}
+
+#define GATHER_COLSZ 1000U
+#define GATHER_IDXSZ 100U
+
+static bool test_gather(void)
+{
+    static uint32_t col[GATHER_COLSZ], idxs[GATHER_IDXSZ], vals[GATHER_IDXSZ], out[GATHER_COLSZ];
+    uint32_t x = 2463534242U;
+    for (size_t i = 0; i < GATHER_COLSZ; i++) {
+        col[i] = (uint32_t)(i * i) ^ 0x5A5AU;
+    }
+    /* Distinct indices, so scattering them can be checked */
+    for (size_t i = 0; i < GATHER_IDXSZ; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        idxs[i] = (uint32_t)(i * (GATHER_COLSZ / GATHER_IDXSZ)) + x % (GATHER_COLSZ / GATHER_IDXSZ);
+        vals[i] = x;
+    }
+
+    /* More than one batch, and a partial one */
+    Iterable(uint32_t) const rows = u32arr_to_iter(idxs, GATHER_IDXSZ);
+    IterGather(uint32_t) g        = {.col = col, .len = GATHER_COLSZ, .src = rows};
+    size_t i                      = 0;
+    foreach (uint32_t, v, u32gather_to_itr(&g)) {
+        if (i == GATHER_IDXSZ || v != col[idxs[i]]) {
+            fprintf(stderr, "%s: Unexpected value at index: %zu\n", __func__, i);
+            return false;
+        }
+        i++;
+    }
+    if (i != GATHER_IDXSZ || g.failed) {
+        fprintf(stderr, "%s: Expected: %u Actual: %zu\n", __func__, GATHER_IDXSZ, i);
+        return false;
+    }
+
+    if (!scatter_u32(u32arr_to_iter(idxs, GATHER_IDXSZ), u32arr_to_iter(vals, GATHER_IDXSZ), out, GATHER_COLSZ)) {
+        fprintf(stderr, "%s: Could not scatter the values\n", __func__);
+        return false;
+    }
+    for (size_t j = 0; j < GATHER_IDXSZ; j++) {
+        if (out[idxs[j]] != vals[j]) {
+            fprintf(stderr, "%s: Unexpected scattered value at index: %zu\n", __func__, j);
+            return false;
+        }
+    }
+
+    /* An index out of range stops both */
+    idxs[GATHER_IDXSZ - 10]          = GATHER_COLSZ;
+    Iterable(uint32_t) const badrows = u32arr_to_iter(idxs, GATHER_IDXSZ);
+    IterGather(uint32_t) bad         = {.col = col, .len = GATHER_COLSZ, .src = badrows};
+    i                                = 0;
+    foreach (uint32_t, v, u32gather_to_itr(&bad)) {
+        (void)v;
+        i++;
+    }
+    if (i != GATHER_IDXSZ - 10 || !bad.failed ||
+        scatter_u32(u32arr_to_iter(idxs, GATHER_IDXSZ), u32arr_to_iter(vals, GATHER_IDXSZ), out, GATHER_COLSZ)) {
+        fprintf(stderr, "%s: Expected the index out of range to be detected\n", __func__);
+        return false;
+    }
+    return true;
+}
+
 int main(void)
 {
     size_t passed = 0;
@@ -538,6 +2284,84 @@ int main(void)
     if (test_zip()) {
         passed++;
     }
+    if (test_chunks()) {
+        passed++;
+    }
+    if (test_windows()) {
+        passed++;
+    }
+    if (test_windowagg()) {
+        passed++;
+    }
+    if (test_groupby()) {
+        passed++;
+    }
+    if (test_distinct()) {
+        passed++;
+    }
+    if (test_hashagg()) {
+        passed++;
+    }
+    if (test_topk()) {
+        passed++;
+    }
+    if (test_collectsorted()) {
+        passed++;
+    }
+    if (test_extsort()) {
+        passed++;
+    }
+    if (test_sample()) {
+        passed++;
+    }
+    if (test_sketch()) {
+        passed++;
+    }
+    if (test_semijoin()) {
+        passed++;
+    }
+    if (test_instrument()) {
+        passed++;
+    }
+    if (test_trace()) {
+        passed++;
+    }
+    if (test_utf8()) {
+        passed++;
+    }
+    if (test_split()) {
+        passed++;
+    }
+    if (test_csv()) {
+        passed++;
+    }
+    if (test_ndjson()) {
+        passed++;
+    }
+    if (test_recstream()) {
+        passed++;
+    }
+    if (test_intcodec()) {
+        passed++;
+    }
+    if (test_lz4()) {
+        passed++;
+    }
+    if (test_gen()) {
+        passed++;
+    }
+    if (test_blockread()) {
+        passed++;
+    }
+    if (test_files()) {
+        passed++;
+    }
+    if (test_prefetch()) {
+        passed++;
+    }
+    if (test_gather()) {
+        passed++;
+    }
     if (passed == TEST_COUNT) {
         puts("All tests passing....");
     } else {